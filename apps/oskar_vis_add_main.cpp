@@ -6,19 +6,45 @@
 #include "log/oskar_log.h"
 #include "settings/oskar_option_parser.h"
 #include "utility/oskar_get_error_string.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_thread.h"
 #include "utility/oskar_version_string.h"
 #include "vis/oskar_vis_block.h"
 #include "vis/oskar_vis_header.h"
 
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace std;
 
+struct ThreadArgs
+{
+    int num_threads, thread_id, num_blocks, num_in_files, *status;
+    const char* const* in_files;
+    oskar_Binary** files;
+    oskar_VisHeader** headers;
+    oskar_VisBlock*** sum;
+    oskar_VisBlock** buf;
+    oskar_Binary* out_file;
+    oskar_Barrier* barrier;
+};
+typedef struct ThreadArgs ThreadArgs;
+
 static bool is_compatible(
         const oskar_VisHeader* vis1, const oskar_VisHeader* vis2);
+static void add_block(oskar_VisBlock* b0, const oskar_VisBlock* b1,
+        int* status);
+static void combine_files(int num_in_files, const char* const* in_files,
+        const char* out_path, int num_threads, int* status);
+static void combine_tree(int num_in_files, const char* const* in_files,
+        const char* out_path, int fan_in, int num_threads, int level,
+        bool verbose, int* status);
 
 int main(int argc, char** argv)
 {
@@ -28,11 +54,18 @@ int main(int argc, char** argv)
     opt.set_description("Application to combine OSKAR visibility files.");
     opt.add_required("OSKAR visibility files...");
     opt.add_flag("-o", "Output visibility file name", 1, "out.vis", false, "--output");
+    opt.add_flag("-t", "Number of reader threads (default: all cores)",
+            1, "0", false, "--threads");
+    opt.add_flag("-f", "Maximum number of files to combine at once. "
+            "If more input files are given, they are combined in a tree "
+            "of intermediate files (default: no limit)",
+            1, "0", false, "--fan-in");
     opt.add_flag("-q", "Disable log messages", false, "--quiet");
     opt.add_example("oskar_vis_add file1.vis file2.vis");
     opt.add_example("oskar_vis_add file1.vis file2.vis -o combined.vis");
     opt.add_example("oskar_vis_add -q file1.vis file2.vis file3.vis");
     opt.add_example("oskar_vis_add *.vis");
+    opt.add_example("oskar_vis_add -t 8 -f 64 *.vis");
     if (!opt.check_options(argc, argv)) return EXIT_FAILURE;
 
     // Get the options.
@@ -40,11 +73,19 @@ int main(int argc, char** argv)
     const char* const* in_files = opt.get_input_files(2, &num_in_files);
     const char* out_path = opt.get_string("-o");
     const bool verbose = opt.is_set("-q") ? false : true;
+    int num_threads = opt.get_int("-t");
+    const int fan_in = opt.get_int("-f");
     if (num_in_files < 2)
     {
         opt.error("Please provide 2 or more visibility files to combine.");
         return EXIT_FAILURE;
     }
+    if (fan_in == 1)
+    {
+        opt.error("The fan-in must be at least 2.");
+        return EXIT_FAILURE;
+    }
+    if (num_threads < 1) num_threads = oskar_get_num_procs();
 
     // Print if verbose.
     if (verbose)
@@ -55,17 +96,88 @@ int main(int argc, char** argv)
             printf("  [%02d] %s\n", i, in_files[i]);
     }
 
+    // Combine the files.
+    combine_tree(num_in_files, in_files, out_path, fan_in, num_threads, 0,
+            verbose, &status);
+    return status ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static void* run_blocks(void* arg)
+{
+    ThreadArgs* a = (ThreadArgs*) arg;
+    int* status = a->status;
+    const int num_threads = a->num_threads;
+    const int thread_id = a->thread_id;
+    const int num_readers = num_threads - 1;
+    const int reader_id = thread_id - 1;
+
+    /* Loop over visibility blocks, reading, combining and writing one
+     * block at a time. Reading and file output are overlapped by using
+     * double buffering, and a dedicated thread is used for file output.
+     *
+     * Thread 0 is used for file writes.
+     * Threads 1 to n read and sum every n-th input file into their own
+     * partial sum, which are then added pairwise in a reduction tree.
+     *
+     * Note that no write is launched on the first loop counter (as no
+     * data are ready yet) and no reads are performed for the last loop
+     * counter (which corresponds to the last block + 1) as this iteration
+     * simply writes the last block.
+     */
+    for (int b = 0; b < a->num_blocks + 1; ++b)
+    {
+        oskar_VisBlock** sum = a->sum[b % 2];
+        if (thread_id > 0 && b < a->num_blocks)
+        {
+            for (int i = reader_id; i < a->num_in_files; i += num_readers)
+            {
+                oskar_VisBlock* blk = (i == reader_id) ?
+                        sum[reader_id] : a->buf[reader_id];
+                oskar_vis_block_read(blk, a->headers[i], a->files[i], b,
+                        status);
+                if (*status)
+                {
+                    oskar_log_error(0, "Failed to read visibility block "
+                            "in '%s'", a->in_files[i]);
+                    break;
+                }
+                if (i != reader_id) add_block(sum[reader_id], blk, status);
+            }
+        }
+        if (thread_id == 0 && b > 0)
+            oskar_vis_block_write(a->sum[(b - 1) % 2][0], a->out_file,
+                    b - 1, status);
+
+        /* Add the partial sums pairwise, synchronising after each level.
+         * The final barrier also synchronises before the next block. */
+        int stride = 1;
+        do
+        {
+            oskar_barrier_wait(a->barrier);
+            if (thread_id > 0 && b < a->num_blocks &&
+                    reader_id % (2 * stride) == 0 &&
+                    reader_id + stride < num_readers)
+                add_block(sum[reader_id], sum[reader_id + stride], status);
+            stride *= 2;
+        }
+        while (stride < 2 * num_readers);
+    }
+    return 0;
+}
+
+static void combine_files(int num_in_files, const char* const* in_files,
+        const char* out_path, int num_threads, int* status)
+{
     // Read all the visibility headers and check consistency.
     oskar_Binary **files = 0, *out_file = 0;
     oskar_VisHeader** headers = 0;
-    oskar_VisBlock *block0 = 0, *block1 = 0;
     files = (oskar_Binary**) calloc(num_in_files, sizeof(oskar_Binary*));
     headers = (oskar_VisHeader**) calloc(num_in_files, sizeof(oskar_VisHeader*));
     for (int i = 0; i < num_in_files; ++i)
     {
-        files[i] = oskar_binary_create(in_files[i], 'r', &status);
-        headers[i] = oskar_vis_header_read(files[i], &status);
-        if (status)
+        files[i] = oskar_binary_create(in_files[i], 'm', status);
+        headers[i] = oskar_vis_header_read(files[i], status);
+        if (*status)
         {
             oskar_log_error(0,
                     "Failed to read visibility data file '%s'", in_files[i]);
@@ -73,7 +185,7 @@ int main(int argc, char** argv)
         }
         if (i > 0 && !is_compatible(headers[0], headers[i]))
         {
-            status = OSKAR_ERR_TYPE_MISMATCH;
+            *status = OSKAR_ERR_TYPE_MISMATCH;
             oskar_log_error(0,
                     "Input visibility file '%s' does not have "
                     "the same dimensions", in_files[i]);
@@ -82,61 +194,152 @@ int main(int argc, char** argv)
     }
 
     // Write the output file using the first header.
-    if (!status)
+    if (!*status)
     {
-        block0 = oskar_vis_block_create_from_header(
-                OSKAR_CPU, headers[0], &status);
-        block1 = oskar_vis_block_create_from_header(
-                OSKAR_CPU, headers[0], &status);
         oskar_mem_clear_contents(oskar_vis_header_settings(
-                headers[0]), &status);
+                headers[0]), status);
         oskar_mem_clear_contents(oskar_vis_header_telescope_path(
-                headers[0]), &status);
-        out_file = oskar_vis_header_write(headers[0], out_path, &status);
-        if (status)
+                headers[0]), status);
+        out_file = oskar_vis_header_write(headers[0], out_path, status);
+        if (*status)
             oskar_log_error(0,
                     "Failed to write output visibility data file '%s'",
                     out_path);
     }
 
-    // Loop over each block in each file.
-    const int num_blocks = oskar_vis_header_num_blocks(headers[0]);
-    for (int b = 0; (b < num_blocks) && !status; ++b)
+    // Create double-buffered partial sums and a read buffer per reader.
+    const int num_readers = min(num_threads, num_in_files);
+    oskar_VisBlock** sum[2];
+    oskar_VisBlock** buf = 0;
+    sum[0] = (oskar_VisBlock**) calloc(num_readers, sizeof(oskar_VisBlock*));
+    sum[1] = (oskar_VisBlock**) calloc(num_readers, sizeof(oskar_VisBlock*));
+    buf = (oskar_VisBlock**) calloc(num_readers, sizeof(oskar_VisBlock*));
+    for (int i = 0; i < num_readers && !*status; ++i)
     {
-        // Read reference block.
-        oskar_vis_block_read(block0, headers[0], files[0], b, &status);
+        sum[0][i] = oskar_vis_block_create_from_header(
+                OSKAR_CPU, headers[0], status);
+        sum[1][i] = oskar_vis_block_create_from_header(
+                OSKAR_CPU, headers[0], status);
+        if (i + num_readers < num_in_files)
+            buf[i] = oskar_vis_block_create_from_header(
+                    OSKAR_CPU, headers[0], status);
+    }
 
-        // Read blocks from other files and combine them.
-        for (int i = 1; (i < num_in_files) && !status; ++i)
+    // Start the reader threads and the writer thread, then wait for them.
+    if (!*status)
+    {
+        const int num_total = num_readers + 1;
+        oskar_Barrier* barrier = oskar_barrier_create(num_total);
+        oskar_Thread** threads =
+                (oskar_Thread**) calloc(num_total, sizeof(oskar_Thread*));
+        ThreadArgs* args = (ThreadArgs*) calloc(num_total, sizeof(ThreadArgs));
+        for (int i = 0; i < num_total; ++i)
         {
-            oskar_vis_block_read(block1, headers[i], files[i], b, &status);
-            if (status)
-            {
-                oskar_log_error(0, "Failed to read visibility block in '%s'",
-                        in_files[i]);
-                break;
-            }
-            oskar_Mem* b0 = oskar_vis_block_cross_correlations(block0);
-            const oskar_Mem* b1 =
-                    oskar_vis_block_cross_correlations_const(block1);
-            oskar_mem_add(b0, b0, b1, 0, 0, 0, oskar_mem_length(b0), &status);
+            args[i].num_threads = num_total;
+            args[i].thread_id = i;
+            args[i].num_blocks = oskar_vis_header_num_blocks(headers[0]);
+            args[i].num_in_files = num_in_files;
+            args[i].status = status;
+            args[i].in_files = in_files;
+            args[i].files = files;
+            args[i].headers = headers;
+            args[i].sum = sum;
+            args[i].buf = buf;
+            args[i].out_file = out_file;
+            args[i].barrier = barrier;
         }
-
-        // Write combined block.
-        oskar_vis_block_write(block0, out_file, b, &status);
+        for (int i = 0; i < num_total; ++i)
+            threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+        for (int i = 0; i < num_total; ++i)
+        {
+            oskar_thread_join(threads[i]);
+            oskar_thread_free(threads[i]);
+        }
+        oskar_barrier_free(barrier);
+        free(threads);
+        free(args);
     }
 
     // Free memory and close files.
-    oskar_vis_block_free(block0, &status);
-    oskar_vis_block_free(block1, &status);
+    for (int i = 0; i < num_readers; ++i)
+    {
+        oskar_vis_block_free(sum[0][i], status);
+        oskar_vis_block_free(sum[1][i], status);
+        oskar_vis_block_free(buf[i], status);
+    }
+    free(sum[0]);
+    free(sum[1]);
+    free(buf);
     for (int i = 0; i < num_in_files; ++i)
     {
-        oskar_vis_header_free(headers[i], &status);
+        oskar_vis_header_free(headers[i], status);
         oskar_binary_free(files[i]);
     }
+    free(headers);
+    free(files);
     oskar_binary_free(out_file);
+}
 
-    return status ? EXIT_FAILURE : EXIT_SUCCESS;
+static void combine_tree(int num_in_files, const char* const* in_files,
+        const char* out_path, int fan_in, int num_threads, int level,
+        bool verbose, int* status)
+{
+    if (*status) return;
+    if (fan_in < 2 || num_in_files <= fan_in)
+    {
+        combine_files(num_in_files, in_files, out_path, num_threads, status);
+        return;
+    }
+
+    // Combine groups of input files into intermediate files.
+    const int num_groups = (num_in_files + fan_in - 1) / fan_in;
+    // Reserve space for the names, so the pointers to them in group_files
+    // are not invalidated as more are added.
+    vector<string> temp_files;
+    vector<const char*> group_files(num_groups);
+    temp_files.reserve(num_groups);
+    for (int g = 0; g < num_groups && !*status; ++g)
+    {
+        const int offset = g * fan_in;
+        const int num = min(fan_in, num_in_files - offset);
+        if (num == 1)
+        {
+            group_files[g] = in_files[offset];
+            continue;
+        }
+        ostringstream name;
+        name << out_path << ".tmp_" << level << "_" << g;
+        temp_files.push_back(name.str());
+        group_files[g] = temp_files.back().c_str();
+        if (verbose)
+            printf("Combining files %d to %d into '%s'\n",
+                    offset, offset + num - 1, group_files[g]);
+        combine_files(num, in_files + offset, group_files[g], num_threads,
+                status);
+    }
+
+    // Combine the intermediate files, then remove them.
+    combine_tree(num_groups, &group_files[0], out_path, fan_in, num_threads,
+            level + 1, verbose, status);
+    for (size_t i = 0; i < temp_files.size(); ++i)
+        remove(temp_files[i].c_str());
+}
+
+static void add_block(oskar_VisBlock* b0, const oskar_VisBlock* b1,
+        int* status)
+{
+    if (oskar_vis_block_has_cross_correlations(b0))
+    {
+        oskar_Mem* xc0 = oskar_vis_block_cross_correlations(b0);
+        oskar_mem_add(xc0, xc0, oskar_vis_block_cross_correlations_const(b1),
+                0, 0, 0, oskar_mem_length(xc0), status);
+    }
+    if (oskar_vis_block_has_auto_correlations(b0))
+    {
+        oskar_Mem* ac0 = oskar_vis_block_auto_correlations(b0);
+        oskar_mem_add(ac0, ac0, oskar_vis_block_auto_correlations_const(b1),
+                0, 0, 0, oskar_mem_length(ac0), status);
+    }
 }
 
 static bool is_compatible(const oskar_VisHeader* v1, const oskar_VisHeader* v2)
@@ -38,6 +38,8 @@ int main(int argc, char** argv)
             "files.");
     opt.add_required("OSKAR visibility file(s)...");
     opt.add_flag("-s", "OSKAR settings file (noise settings).", 1, "", true);
+    opt.add_flag("-t", "Number of threads used to generate the noise "
+            "(default: all cores)", 1, "0", false, "--threads");
     opt.add_flag("-v", "Verbose logging.");
     opt.add_flag("-q", "Suppress all logging output.");
     if (!opt.check_options(argc, argv)) return EXIT_FAILURE;
@@ -47,6 +49,7 @@ int main(int argc, char** argv)
     const char* const* vis_filename_in = opt.get_input_files(1, &num_files);
     bool verbose = opt.is_set("-v") ? true : false;
     bool quiet   = opt.is_set("-q") ? true : false;
+    int num_threads = opt.get_int("-t");
 
     // Set log parameters.
     oskar_Log* log = 0;
@@ -121,7 +124,7 @@ int main(int argc, char** argv)
         oskar_log_value(log, 'D', -1, "Loading visibility file", "%s", in_file);
 
         // Load the input file and create the output file.
-        oskar_Binary* h_in = oskar_binary_create(in_file, 'r', &status);
+        oskar_Binary* h_in = oskar_binary_create(in_file, 'm', &status);
         oskar_VisHeader* hdr = oskar_vis_header_read(h_in, &status);
         oskar_Binary* h_out = oskar_vis_header_write(hdr, out_file, &status);
 
@@ -143,8 +146,8 @@ int main(int argc, char** argv)
         {
             if (status) break;
             oskar_vis_block_read(blk, hdr, h_in, b, &status);
-            oskar_vis_block_add_system_noise(blk, hdr, tel, b, station_work,
-                    &status);
+            oskar_vis_block_add_system_noise_threads(blk, hdr, tel, b,
+                    num_threads, station_work, &status);
             oskar_vis_block_write(blk, h_out, b, &status);
         }
 
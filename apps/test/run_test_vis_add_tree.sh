@@ -0,0 +1,76 @@
+#!/bin/bash
+
+###############################################################################
+#
+# Description:
+#   Tests combining visibility files in a tree of intermediate files.
+#
+# Method:
+#   1. Generate an OSKAR visibility binary file, and make six copies of it.
+#   2. Combine the copies using oskar_vis_add, first in one pass and then
+#      with a fan-in of 2 (which uses two levels of intermediate files).
+#   3. Check that both runs succeed, that no intermediate files are left,
+#      and that the visibility statistics of the two outputs agree.
+#
+###############################################################################
+
+source @OSKAR_BINARY_DIR@/apps/test/test_utility.sh
+
+echo "Running OSKAR test of tree-mode visibility file combination"
+echo ""
+
+# Work in a scratch directory inside the test data directory.
+work_dir="${example_data_dir}/vis_add_tree"
+rm -rf "${work_dir}"
+mkdir -p "${work_dir}"
+cd "${work_dir}"
+cp ../oskar_sim_interferometer.ini ../sky.osm .
+cp -r ../telescope.tm .
+
+app_sim=${oskar_app_path}/oskar_sim_interferometer
+app_add=${oskar_app_path}/oskar_vis_add
+ini_sim=oskar_sim_interferometer.ini
+set_setting $app_sim $ini_sim simulator/keep_log_file false
+set_setting $app_sim $ini_sim simulator/double_precision true
+set_setting $app_sim $ini_sim sky/oskar_sky_model/file sky.osm
+set_setting $app_sim $ini_sim telescope/input_directory telescope.tm
+set_setting $app_sim $ini_sim observation/num_channels 1
+set_setting $app_sim $ini_sim observation/num_time_steps 2
+set_setting $app_sim $ini_sim interferometer/oskar_vis_filename in.vis
+
+# Generate the input files.
+run_sim_interferometer -q $ini_sim
+in_files=""
+for i in 0 1 2 3 4 5; do
+    cp in.vis in_${i}.vis
+    in_files="${in_files} in_${i}.vis"
+done
+
+# Combine the files in one pass, and in a tree.
+# Short output names are used so that the intermediate file names
+# are short enough for std::string to store them inline.
+$app_add -q -t 2 -o flat.vis ${in_files}
+if [ $? != 0 ]; then
+    echo "ERROR: oskar_vis_add failed in single-pass mode."
+    exit_ 1
+fi
+$app_add -q -f 2 -t 2 -o t.vis ${in_files}
+if [ $? != 0 ]; then
+    echo "ERROR: oskar_vis_add failed in tree mode."
+    exit_ 1
+fi
+if ls t.vis.tmp_* &> /dev/null; then
+    echo "ERROR: Intermediate files were not removed."
+    exit_ 1
+fi
+
+# Compare the outputs.
+run_vis_stats flat.vis | grep -v "^OSKAR\|flat\.vis" > flat.txt
+run_vis_stats t.vis | grep -v "^OSKAR\|t\.vis" > tree.txt
+if ! diff flat.txt tree.txt; then
+    echo "ERROR: Visibility statistics differ."
+    exit_ 1
+fi
+echo "Tree-mode combination OK"
+cd ..
+rm -rf "${work_dir}"
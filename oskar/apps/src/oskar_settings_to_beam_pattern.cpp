@@ -28,6 +28,7 @@
 
 #include "apps/oskar_settings_log.h"
 #include "apps/oskar_settings_to_beam_pattern.h"
+#include "utility/oskar_trace.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -73,10 +74,14 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
         oskar_beam_pattern_set_num_devices(h, -1);
     else
         oskar_beam_pattern_set_num_devices(h, s->to_int("num_devices", status));
+    oskar_beam_pattern_set_numa_pinning(h, s->to_int("numa_pinning", status));
     oskar_log_set_keep_file(log_, s->to_int("keep_log_file", status));
     oskar_log_set_file_priority(log_,
             s->to_int("write_status_to_log_file", status) ?
             OSKAR_LOG_STATUS : OSKAR_LOG_MESSAGE);
+    const char* trace_file = s->to_string("trace_file", status);
+    if (trace_file && strlen(trace_file) > 0)
+        oskar_trace_set_file(trace_file);
     s->end_group();
 
     // Set observation settings.
@@ -95,6 +95,8 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
     oskar_imager_set_time_max_utc(h, s->to_double("time_max_utc", status));
     oskar_imager_set_uv_filter_min(h, s->to_double("uv_filter_min", status));
     oskar_imager_set_uv_filter_max(h, s->to_double("uv_filter_max", status));
+    oskar_imager_set_bda_max_cell_fraction(h,
+            s->to_double("bda_max_cell_fraction", status));
     oskar_imager_set_algorithm(h,
             s->to_string("algorithm", status), status);
     oskar_imager_set_weighting(h,
@@ -112,8 +114,12 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
                 s->to_int("wproj/num_w_planes", status));
     oskar_imager_set_fft_on_gpu(h, s->to_int("fft/use_gpu", status));
     oskar_imager_set_grid_on_gpu(h, s->to_int("fft/grid_on_gpu", status));
+    oskar_imager_set_single_precision_grids(h,
+            s->to_int("fft/single_precision_grids", status));
     oskar_imager_set_generate_w_kernels_on_gpu(h,
             s->to_int("wproj/generate_w_kernels_on_gpu", status));
+    oskar_imager_set_w_kernel_cache_dir(h,
+            s->to_string("wproj/kernel_cache_dir", status));
     if (s->first_letter("direction", status) == 'R')
         oskar_imager_set_direction(h,
                 s->to_double("direction/ra_deg", status),
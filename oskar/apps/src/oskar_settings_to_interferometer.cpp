@@ -5,6 +5,7 @@
 
 #include "apps/oskar_settings_log.h"
 #include "apps/oskar_settings_to_interferometer.h"
+#include "utility/oskar_trace.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -52,10 +53,19 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
     else
         oskar_interferometer_set_num_devices(h,
                 s->to_int("num_devices", status));
+    oskar_interferometer_set_numa_pinning(h,
+            s->to_int("numa_pinning", status));
+    oskar_interferometer_set_planar_jones(h,
+            s->to_int("planar_jones", status));
+    oskar_interferometer_set_prefetch_sky(h,
+            s->to_int("prefetch_sky", status));
     oskar_log_set_keep_file(log_, s->to_int("keep_log_file", status));
     oskar_log_set_file_priority(log_,
             s->to_int("write_status_to_log_file", status) ?
                     OSKAR_LOG_STATUS : OSKAR_LOG_MESSAGE);
+    const char* trace_file = s->to_string("trace_file", status);
+    if (trace_file && strlen(trace_file) > 0)
+        oskar_trace_set_file(trace_file);
     s->end_group();
 
     // Set sky settings.
@@ -80,6 +90,8 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_int("max_channels_per_block", status));
     oskar_interferometer_set_output_vis_file(h,
             s->to_string("oskar_vis_filename", status));
+    oskar_interferometer_set_compress_vis_file(h,
+            s->to_int("compress_vis_file", status));
     oskar_interferometer_set_output_measurement_set(h,
             s->to_string("ms_filename", status));
     oskar_interferometer_set_force_polarised_ms(h,
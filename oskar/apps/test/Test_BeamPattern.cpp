@@ -6,9 +6,13 @@
 #include <gtest/gtest.h>
 
 #include "apps/oskar_apps.h"
+#include "beam_pattern/private_beam_pattern.h"
+#include "mem/oskar_mem_read_fits.h"
+#include "utility/oskar_dir.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_version_string.h"
 
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
@@ -160,3 +164,116 @@ TEST(apps_test, test_beam_pattern_modes)
         }
     }
 }
+
+TEST(apps_test, test_beam_pattern_memory_plan)
+{
+    int status = 0;
+    printf("OSKAR %s: Testing beam pattern memory plan...\n",
+            oskar_version_string());
+
+    // Create a telescope model directory.
+    const char* tel_model_dir = "apps_test_telescope.tm";
+    create_telescope_model(tel_model_dir, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Set parameters. The image size is chosen so that the pixels do not
+    // divide evenly between the devices.
+    const char* sim_par[] = {
+            "simulator/double_precision", "true",
+            "simulator/use_gpus", "false",
+            "observation/phase_centre_ra_deg", "20.0",
+            "observation/phase_centre_dec_deg", "-30.0",
+            "observation/start_frequency_hz", "100e6",
+            "observation/num_channels", "1",
+            "observation/start_time_utc", "2000-01-01 12:00:00.0",
+            "observation/length", "02:00:00.0",
+            "observation/num_time_steps", "2",
+            "telescope/input_directory", tel_model_dir,
+            "telescope/pol_mode", "Full",
+            "beam_pattern/beam_image/size", "95",
+            "beam_pattern/beam_image/fov_deg", "180.0",
+            "beam_pattern/station_outputs/fits_image/auto_power", "true",
+            NULL, NULL
+    };
+    // Write the images to a scratch directory, removed at the end.
+    const char* out_dir = "apps_test_bp_plan";
+    const string root_names[] = {
+            string(out_dir) + oskar_dir_separator() + "auto",
+            string(out_dir) + oskar_dir_separator() + "set"
+    };
+    oskar_dir_remove(out_dir);
+    ASSERT_TRUE(oskar_dir_mkpath(out_dir));
+    const int num_devices = 3, num_pixels = 95 * 95;
+    oskar_Mem* image[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        // Create a beam pattern simulator and a telescope model.
+        SettingsTree* sim_settings = oskar_app_settings_tree(
+                app_beam_pattern, 0);
+        ASSERT_TRUE(sim_settings->set_values(0, sim_par));
+        ASSERT_TRUE(sim_settings->set_value(
+                "beam_pattern/root_path", root_names[i].c_str()));
+        oskar_BeamPattern* sim = oskar_settings_to_beam_pattern(
+                sim_settings, 0, &status);
+        oskar_Telescope* tel = oskar_settings_to_telescope(
+                sim_settings, 0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        oskar_beam_pattern_set_telescope_model(sim, tel, &status);
+        oskar_beam_pattern_set_num_devices(sim, num_devices);
+        oskar_beam_pattern_set_max_chunk_size(sim, i == 0 ? 0 : 1000);
+        oskar_beam_pattern_check_init(sim, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ(num_pixels, sim->num_pixels);
+        if (i == 0)
+        {
+            // Each device should get one chunk per round,
+            // and the chunk sizes should be even.
+            const int last_chunk = num_pixels -
+                    (sim->num_chunks - 1) * sim->max_chunk_size;
+            EXPECT_GE(sim->num_chunks, num_devices);
+            EXPECT_EQ(0, sim->num_chunks % num_devices);
+            EXPECT_GT(last_chunk, 0);
+            EXPECT_LT(sim->max_chunk_size - last_chunk, sim->num_chunks);
+        }
+        else
+        {
+            EXPECT_EQ(1000, sim->max_chunk_size);
+            EXPECT_EQ(10, sim->num_chunks);
+        }
+
+        // Run the simulation and read the image.
+        oskar_beam_pattern_run(sim, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const int start_index[] = {0};
+        string fits_name = root_names[i] +
+                "_S0000_TIME_SEP_CHAN_SEP_AUTO_POWER_AMP_I_I.fits";
+        image[i] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+        oskar_mem_read_fits(image[i], 0, 0, fits_name.c_str(), -1,
+                start_index, 0, 0, 0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ((size_t) (2 * num_pixels), oskar_mem_length(image[i]));
+
+        // Delete objects.
+        oskar_beam_pattern_free(sim, &status);
+        oskar_telescope_free(tel, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        SettingsTree::free(sim_settings);
+    }
+
+    // Check the images match. Pixels below the horizon are NaN in both.
+    const double* a = oskar_mem_double_const(image[0], &status);
+    const double* b = oskar_mem_double_const(image[1], &status);
+    int num_valid = 0;
+    for (int i = 0; i < 2 * num_pixels; ++i)
+    {
+        ASSERT_EQ(std::isnan(a[i]), std::isnan(b[i])) << "Pixel " << i;
+        if (std::isnan(a[i])) continue;
+        EXPECT_NEAR(a[i], b[i], 1e-10 * fabs(b[i])) << "Pixel " << i;
+        num_valid++;
+    }
+    EXPECT_GT(num_valid, 0);
+    oskar_mem_free(image[0], &status);
+    oskar_mem_free(image[1], &status);
+    oskar_dir_remove(out_dir);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""Compares the results of two runs of oskar_benchmark_suite.
+
+Usage: oskar_benchmark_compare.py [options] <baseline.json> <results.json>
+
+Each benchmark in the results is matched with the one in the baseline with
+the same name and parameters, and is flagged as a regression if it is
+slower by more than the threshold. The exit code is 1 if any benchmark
+regressed, or 0 otherwise, so this can be used in release checks.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(filename):
+    with open(filename) as f:
+        data = json.load(f)
+    results = {}
+    for b in data['benchmarks']:
+        key = b['name'] + ' ' + json.dumps(b['params'], sort_keys=True)
+        results[key] = b
+    return data, results
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Compares two sets of OSKAR benchmark results.')
+    parser.add_argument('baseline', help='Baseline results (JSON).')
+    parser.add_argument('results', help='New results (JSON).')
+    parser.add_argument('-t', '--threshold', type=float, default=0.1,
+                        help='Allowed fractional slow-down (default: 0.1).')
+    parser.add_argument('-m', '--metric', default='median',
+                        choices=['median', 'min', 'mean'],
+                        help='Timing statistic to compare (default: median).')
+    args = parser.parse_args()
+
+    base_data, base = load(args.baseline)
+    new_data, new = load(args.results)
+    for item in ('precision', 'location', 'scale', 'num_threads'):
+        if base_data.get(item) != new_data.get(item):
+            print('WARNING: %s differs (baseline %s, results %s)' %
+                  (item, base_data.get(item), new_data.get(item)))
+
+    print('%-60s %11s %11s %8s' % ('Benchmark', 'Baseline', 'Result',
+                                   'Ratio'))
+    num_regressed = 0
+    for key in sorted(new):
+        t_new = new[key][args.metric]
+        if key not in base:
+            print('%-60s %11s %11.6f %8s  NEW' % (key, '-', t_new, '-'))
+            continue
+        t_base = base[key][args.metric]
+        ratio = t_new / t_base if t_base > 0 else float('inf')
+        flag = ''
+        if ratio > 1.0 + args.threshold:
+            flag = '  REGRESSION'
+            num_regressed += 1
+        elif ratio < 1.0 - args.threshold:
+            flag = '  IMPROVED'
+        print('%-60s %11.6f %11.6f %8.3f%s' %
+              (key, t_base, t_new, ratio, flag))
+    for key in sorted(set(base) - set(new)):
+        print('%-60s %11.6f %11s %8s  MISSING' %
+              (key, base[key][args.metric], '-', '-'))
+
+    if num_regressed:
+        print('%d benchmark(s) regressed by more than %.0f%%.' %
+              (num_regressed, 100.0 * args.threshold))
+        return 1
+    print('No regressions.')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
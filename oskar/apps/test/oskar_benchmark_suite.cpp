@@ -0,0 +1,946 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "apps/oskar_apps.h"
+#include "correlate/oskar_cross_correlate.h"
+#include "interferometer/oskar_jones.h"
+#include "settings/oskar_option_parser.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_evaluate_image_lmn_grid.h"
+#include "math/oskar_fft.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#include "oskar_version.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using oskar::SettingsTree;
+using std::string;
+using std::vector;
+
+// Timings of one benchmark, with the parameters that define it.
+struct Result
+{
+    string name, params;
+    double items;
+    const char* unit;
+    vector<double> times;
+    Result() : items(0.0), unit(0) {}
+    void param(const char* key, double value)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%s\"%s\": %.17g",
+                params.empty() ? "" : ", ", key, value);
+        params += buf;
+    }
+    void param(const char* key, const char* value)
+    {
+        params += string(params.empty() ? "" : ", ") +
+                "\"" + key + "\": \"" + value + "\"";
+    }
+    double min() const
+    {
+        return times.empty() ? 0.0 : *std::min_element(times.begin(),
+                times.end());
+    }
+    double median() const
+    {
+        if (times.empty()) return 0.0;
+        vector<double> t(times);
+        std::sort(t.begin(), t.end());
+        const size_t n = t.size();
+        return (n % 2) ? t[n / 2] : 0.5 * (t[n / 2 - 1] + t[n / 2]);
+    }
+    double mean() const
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < times.size(); ++i) sum += times[i];
+        return times.empty() ? 0.0 : sum / times.size();
+    }
+    double std_dev() const
+    {
+        double sum = 0.0;
+        const double m = mean();
+        for (size_t i = 0; i < times.size(); ++i)
+            sum += (times[i] - m) * (times[i] - m);
+        return times.size() < 2 ? 0.0 : sqrt(sum / (times.size() - 1));
+    }
+};
+
+// Common state for all benchmarks.
+struct Suite
+{
+    int prec, location, niter;
+    double scale;
+    string filter, work_dir;
+    vector<Result> results;
+    oskar_Timer* timer;
+
+    bool wanted(const char* name) const
+    {
+        return filter.empty() || strstr(name, filter.c_str());
+    }
+    const char* prec_string() const
+    {
+        return prec == OSKAR_SINGLE ? "single" : "double";
+    }
+    string path(const char* name) const
+    {
+        return work_dir + oskar_dir_separator() + name;
+    }
+
+    // Waits for all work on the device to finish, by reading back
+    // one element of its output.
+    void sync(const oskar_Mem* mem, int* status) const
+    {
+        if (!mem || oskar_mem_location(mem) == OSKAR_CPU) return;
+        oskar_Mem* tmp = oskar_mem_create(oskar_mem_type(mem), OSKAR_CPU,
+                1, status);
+        oskar_mem_copy_contents(tmp, mem, 0, 0, 1, status);
+        oskar_mem_free(tmp, status);
+    }
+
+    // Starts an iteration.
+    void start() { oskar_timer_start(timer); }
+
+    // Ends an iteration. The first iteration is a warm-up, and is not kept.
+    void stop(Result& r, int iter, const oskar_Mem* mem, int* status)
+    {
+        sync(mem, status);
+        const double elapsed = oskar_timer_elapsed(timer);
+        if (iter > 0) r.times.push_back(elapsed);
+    }
+};
+
+// Returns a deterministic uniform random number in [lo, hi).
+// Creates a new, uniquely-named directory inside the given one, so that
+// only files written by the suite are removed at the end.
+static string make_work_dir(const char* parent)
+{
+    if (!oskar_dir_mkpath(parent)) return string();
+    const unsigned long t = (unsigned long) time(0);
+    for (int i = 0; i < 1000; ++i)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "run_%lu_%d", t, i);
+        const string path = string(parent) + oskar_dir_separator() + name;
+        if (!oskar_dir_exists(path.c_str()) &&
+                oskar_dir_mkdir(path.c_str()))
+            return path;
+    }
+    return string();
+}
+
+// Returns a problem size scaled by the suite scale factor,
+// which is at least the given minimum.
+static int scaled(double value, int min_value = 1)
+{
+    return value < min_value ? min_value : (int) value;
+}
+
+static double uniform(unsigned int* state, double lo, double hi)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (*state >> 8) / 16777216.0;
+}
+
+// Fills a CPU array with deterministic random values in [lo, hi).
+static void fill(oskar_Mem* mem, unsigned int seed, double lo, double hi,
+        int* status)
+{
+    const size_t n = oskar_mem_length(mem);
+    for (size_t i = 0; i < n; ++i)
+        oskar_mem_set_element_real(mem, i, uniform(&seed, lo, hi), status);
+}
+
+// Writes a telescope model with stations on a spiral, all with the same
+// square grid of elements.
+static void write_telescope(const char* dir, int num_stations,
+        int num_elements, int* status)
+{
+    if (*status) return;
+    const string station_dir = string(dir) + oskar_dir_separator() + "station";
+    oskar_dir_remove(dir);
+    if (!oskar_dir_mkpath(station_dir.c_str()))
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    const string position = string(dir) + oskar_dir_separator() +
+            "position.txt";
+    const string layout = string(dir) + oskar_dir_separator() + "layout.txt";
+    const string station = station_dir + oskar_dir_separator() + "layout.txt";
+    FILE* f = fopen(position.c_str(), "w");
+    if (!f)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    fprintf(f, "0.0, -50.0\n");
+    fclose(f);
+    f = fopen(layout.c_str(), "w");
+    if (!f)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    for (int i = 0; i < num_stations; ++i)
+    {
+        const double r = 2000.0 * sqrt((i + 0.5) / num_stations);
+        const double theta = i * M_PI * (3.0 - sqrt(5.0));
+        fprintf(f, "%.3f, %.3f\n", r * cos(theta), r * sin(theta));
+    }
+    fclose(f);
+    f = fopen(station.c_str(), "w");
+    if (!f)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    const int side = (int) ceil(sqrt((double) num_elements));
+    for (int i = 0; i < num_elements; ++i)
+        fprintf(f, "%.3f, %.3f\n", 1.5 * (i % side - 0.5 * (side - 1)),
+                1.5 * (i / side - 0.5 * (side - 1)));
+    fclose(f);
+}
+
+// Returns a settings tree for an application, with common values set.
+static SettingsTree* settings(const Suite& s, const char* app,
+        const char* tel_dir)
+{
+    SettingsTree* t = oskar_app_settings_tree(app, 0);
+    if (!t) return 0;
+    const char* par[] = {
+            "observation/phase_centre_ra_deg", "0.0",
+            "observation/phase_centre_dec_deg", "-50.0",
+            "observation/start_frequency_hz", "100e6",
+            "observation/frequency_inc_hz", "1e6",
+            "observation/start_time_utc", "2000-01-01 12:00:00.0",
+            "observation/length", "01:00:00.0",
+            "telescope/input_directory", tel_dir,
+            "telescope/allow_station_beam_duplication", "true",
+            NULL, NULL
+    };
+    t->set_values(0, par);
+    t->set_value("simulator/double_precision",
+            s.prec == OSKAR_DOUBLE ? "true" : "false");
+    t->set_value("simulator/use_gpus",
+            s.location == OSKAR_CPU ? "false" : "true");
+    return t;
+}
+
+// Loads the synthetic telescope model into memory.
+static oskar_Telescope* load_telescope(const Suite& s, const char* tel_dir,
+        int* status)
+{
+    SettingsTree* t = settings(s, "oskar_sim_interferometer", tel_dir);
+    if (!t)
+    {
+        *status = OSKAR_ERR_SETTINGS_TELESCOPE;
+        return 0;
+    }
+    oskar_Telescope* tel = oskar_settings_to_telescope(t, 0, status);
+    SettingsTree::free(t);
+    return tel;
+}
+
+static void bench_sky_scale_flux(Suite& s, int* status)
+{
+    if (!s.wanted("sky_scale_flux") || *status) return;
+    const int num_sources = scaled(1048576 * s.scale);
+    Result r;
+    r.name = "sky_scale_flux";
+    r.param("num_sources", num_sources);
+    oskar_Sky* sky_cpu = oskar_sky_create(s.prec, OSKAR_CPU, num_sources,
+            status);
+    fill(oskar_sky_I(sky_cpu), 1, 0.1, 10.0, status);
+    fill(oskar_sky_spectral_index(sky_cpu), 2, -1.0, 0.0, status);
+    oskar_mem_set_value_real(oskar_sky_reference_freq_hz(sky_cpu),
+            100e6, 0, num_sources, status);
+    oskar_Sky* sky = oskar_sky_create_copy(sky_cpu, s.location, status);
+    for (int i = 0; i <= s.niter && !*status; ++i)
+    {
+        s.start();
+        oskar_sky_scale_flux_with_frequency(sky, (i % 2) ? 100e6 : 120e6,
+                status);
+        s.stop(r, i, oskar_sky_I_const(sky), status);
+    }
+    r.items = num_sources;
+    r.unit = "sources";
+    s.results.push_back(r);
+    oskar_sky_free(sky, status);
+    oskar_sky_free(sky_cpu, status);
+}
+
+static void bench_horizon_clip(Suite& s, const oskar_Telescope* tel_cpu,
+        int* status)
+{
+    if (!s.wanted("horizon_clip") || *status) return;
+    const int num_sources = scaled(1048576 * s.scale);
+    Result r;
+    r.name = "horizon_clip";
+    r.param("num_sources", num_sources);
+    r.param("num_stations", oskar_telescope_num_stations(tel_cpu));
+
+    // Sources are spread uniformly over the whole sky.
+    oskar_Sky* sky_cpu = oskar_sky_create(s.prec, OSKAR_CPU, num_sources,
+            status);
+    oskar_Mem* sin_dec = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, status);
+    fill(oskar_sky_ra_rad(sky_cpu), 3, 0.0, 2.0 * M_PI, status);
+    fill(sin_dec, 4, -1.0, 1.0, status);
+    fill(oskar_sky_I(sky_cpu), 5, 0.1, 10.0, status);
+    for (int i = 0; i < num_sources && !*status; ++i)
+        oskar_mem_set_element_real(oskar_sky_dec_rad(sky_cpu), i,
+                asin(oskar_mem_get_element(sin_dec, i, status)), status);
+    oskar_Sky* sky = oskar_sky_create_copy(sky_cpu, s.location, status);
+    oskar_Sky* out = oskar_sky_create(s.prec, s.location, 0, status);
+    oskar_Telescope* tel = oskar_telescope_create_copy(tel_cpu,
+            s.location, status);
+    oskar_StationWork* work = oskar_station_work_create(s.prec, s.location,
+            status);
+    for (int i = 0; i <= s.niter && !*status; ++i)
+    {
+        s.start();
+        oskar_sky_horizon_clip(out, sky, tel, 0.1 * i, work, status);
+        s.stop(r, i, oskar_sky_I_const(out), status);
+    }
+    r.items = num_sources;
+    r.unit = "sources";
+    s.results.push_back(r);
+    oskar_station_work_free(work, status);
+    oskar_telescope_free(tel, status);
+    oskar_mem_free(sin_dec, status);
+    oskar_sky_free(out, status);
+    oskar_sky_free(sky, status);
+    oskar_sky_free(sky_cpu, status);
+}
+
+static void bench_station_beam(Suite& s, const oskar_Telescope* tel_cpu,
+        int* status)
+{
+    if (!s.wanted("station_beam") || *status) return;
+    const int side = 256, num_points = side * side;
+    const int num_elements = oskar_station_num_elements(
+            oskar_telescope_station_const(tel_cpu, 0));
+    Result r;
+    r.name = "station_beam";
+    r.param("num_elements", num_elements);
+    r.param("num_points", num_points);
+
+    // Points are on a grid of horizon direction cosines around the zenith.
+    oskar_Mem *xyz_cpu[3], *xyz[3];
+    for (int i = 0; i < 3; ++i)
+        xyz_cpu[i] = oskar_mem_create(s.prec, OSKAR_CPU, num_points, status);
+    oskar_evaluate_image_lmn_grid(side, side, M_PI / 2.0, M_PI / 2.0, 0,
+            xyz_cpu[0], xyz_cpu[1], xyz_cpu[2], status);
+    for (int i = 0; i < 3; ++i)
+        xyz[i] = oskar_mem_create_copy(xyz_cpu[i], s.location, status);
+    oskar_Telescope* tel = oskar_telescope_create_copy(tel_cpu,
+            s.location, status);
+    const oskar_Station* station = oskar_telescope_station_const(tel, 0);
+    oskar_StationWork* work = oskar_station_work_create(s.prec, s.location,
+            status);
+    oskar_Mem* beam = oskar_mem_create(s.prec | OSKAR_COMPLEX | OSKAR_MATRIX,
+            s.location, num_points, status);
+    const oskar_Mem* const coords[] = {xyz[0], xyz[1], xyz[2]};
+    for (int i = 0; i <= s.niter && !*status; ++i)
+    {
+        s.start();
+        oskar_station_beam(station, work, OSKAR_COORDS_ENU_DIR, num_points,
+                coords, 0.0, 0.0,
+                oskar_telescope_phase_centre_coord_type(tel),
+                oskar_telescope_phase_centre_longitude_rad(tel),
+                oskar_telescope_phase_centre_latitude_rad(tel),
+                0, 0.0, 100e6, 0, beam, status);
+        s.stop(r, i, beam, status);
+    }
+    r.items = (double) num_points * num_elements;
+    r.unit = "element-points";
+    s.results.push_back(r);
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(xyz[i], status);
+        oskar_mem_free(xyz_cpu[i], status);
+    }
+    oskar_mem_free(beam, status);
+    oskar_station_work_free(work, status);
+    oskar_telescope_free(tel, status);
+}
+
+static void bench_jones_chain(Suite& s, int* status)
+{
+    if (!s.wanted("jones_chain") || *status) return;
+    const int num_sources = scaled(16384 * s.scale);
+    const int num_stations = 64;
+    const int scalar = s.prec | OSKAR_COMPLEX;
+    const int matrix = scalar | OSKAR_MATRIX;
+
+    // Terms as used by the interferometer: G * K * E * R.
+    oskar_Jones *K, *R, *E, *J;
+    K = oskar_jones_create(scalar, s.location, num_stations, num_sources,
+            status);
+    R = oskar_jones_create(matrix, s.location, num_stations, num_sources,
+            status);
+    E = oskar_jones_create(matrix, s.location, num_stations, num_sources,
+            status);
+    J = oskar_jones_create(matrix, s.location, num_stations, num_sources,
+            status);
+    oskar_Mem* G = oskar_mem_create(matrix, s.location, num_stations,
+            status);
+    srand(1);
+    oskar_mem_random_range(oskar_jones_mem(K), 1.0, 2.0, status);
+    oskar_mem_random_range(oskar_jones_mem(E), 1.0, 2.0, status);
+    oskar_mem_random_range(G, 1.0, 2.0, status);
+    const oskar_Jones* terms[] = {K, E, R};
+    for (int fused = 0; fused < 2 && !*status; ++fused)
+    {
+        Result r;
+        r.name = "jones_chain";
+        r.param("num_sources", num_sources);
+        r.param("num_stations", num_stations);
+        r.param("method", fused ? "fused" : "pairwise");
+        for (int i = 0; i <= s.niter && !*status; ++i)
+        {
+            oskar_mem_random_range(oskar_jones_mem(R), 1.0, 2.0, status);
+            s.start();
+            if (fused)
+                oskar_jones_chain(J, 3, terms, G, status);
+            else
+            {
+                oskar_jones_join(R, E, R, status);
+                oskar_jones_join(J, K, R, status);
+                oskar_jones_apply_station_gains(J, G, status);
+            }
+            s.stop(r, i, oskar_jones_mem(J), status);
+        }
+        r.items = (double) num_sources * num_stations;
+        r.unit = "matrices";
+        s.results.push_back(r);
+    }
+    oskar_jones_free(K, status);
+    oskar_jones_free(R, status);
+    oskar_jones_free(E, status);
+    oskar_jones_free(J, status);
+    oskar_mem_free(G, status);
+}
+
+static void bench_cross_correlate(Suite& s, const oskar_Telescope* tel_cpu,
+        int* status)
+{
+    if (!s.wanted("cross_correlate") || *status) return;
+    const int num_sources = scaled(4096 * s.scale);
+    const int num_stations = oskar_telescope_num_stations(tel_cpu);
+    const int type = s.prec | OSKAR_COMPLEX | OSKAR_MATRIX;
+
+    // Source and station data are in the same ranges as the unit tests.
+    oskar_Mem *src_flux[4], *src_dir[3], *src_ext[3], *uvw[3];
+    for (int i = 0; i < 4; ++i)
+    {
+        oskar_Mem* t = oskar_mem_create(s.prec, OSKAR_CPU, num_sources,
+                status);
+        fill(t, 10 + i, 0.1, 1.0, status);
+        src_flux[i] = oskar_mem_create_copy(t, s.location, status);
+        oskar_mem_free(t, status);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_Mem* t = oskar_mem_create(s.prec, OSKAR_CPU, num_sources,
+                status);
+        fill(t, 20 + i, 0.1, 0.9, status);
+        src_dir[i] = oskar_mem_create_copy(t, s.location, status);
+        fill(t, 30 + i, 0.1e-6, 0.2e-6, status);
+        src_ext[i] = oskar_mem_create_copy(t, s.location, status);
+        oskar_mem_free(t, status);
+        t = oskar_mem_create(s.prec, OSKAR_CPU, num_stations, status);
+        fill(t, 40 + i, 1.0, 5.0, status);
+        uvw[i] = oskar_mem_create_copy(t, s.location, status);
+        oskar_mem_free(t, status);
+    }
+    oskar_Jones* J_cpu = oskar_jones_create(type, OSKAR_CPU, num_stations,
+            num_sources, status);
+    srand(1);
+    oskar_mem_random_range(oskar_jones_mem(J_cpu), 1.0, 5.0, status);
+    oskar_Telescope* tel = oskar_telescope_create_copy(tel_cpu,
+            s.location, status);
+    const int num_baselines = oskar_telescope_num_baselines(tel);
+    oskar_Mem* vis = oskar_mem_create(type, s.location, num_baselines,
+            status);
+
+    // The planar Jones layout is only available on the CPU.
+    const int num_layouts = (s.location == OSKAR_CPU) ? 2 : 1;
+    for (int planar = 0; planar < num_layouts && !*status; ++planar)
+    {
+        Result r;
+        r.name = "cross_correlate";
+        r.param("num_sources", num_sources);
+        r.param("num_stations", num_stations);
+        r.param("layout", planar ? "planar" : "interleaved");
+        oskar_Jones* J = 0;
+        if (planar)
+        {
+            J = oskar_jones_create_planar(type, OSKAR_CPU, num_stations,
+                    num_sources, status);
+            oskar_jones_convert(J, J_cpu, status);
+        }
+        else
+            J = oskar_jones_create_copy(J_cpu, s.location, status);
+        for (int i = 0; i <= s.niter && !*status; ++i)
+        {
+            oskar_mem_clear_contents(vis, status);
+            s.start();
+            oskar_cross_correlate(0, num_sources, J, src_flux, src_dir,
+                    src_ext, tel, uvw, 0.0, 100e6, 0, vis, status);
+            s.stop(r, i, vis, status);
+        }
+        r.items = (double) num_sources * num_baselines;
+        r.unit = "source-baselines";
+        s.results.push_back(r);
+        oskar_jones_free(J, status);
+    }
+    for (int i = 0; i < 4; ++i)
+        oskar_mem_free(src_flux[i], status);
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(src_dir[i], status);
+        oskar_mem_free(src_ext[i], status);
+        oskar_mem_free(uvw[i], status);
+    }
+    oskar_mem_free(vis, status);
+    oskar_jones_free(J_cpu, status);
+    oskar_telescope_free(tel, status);
+}
+
+static void bench_fft(Suite& s, int* status)
+{
+    if (!s.wanted("fft") || *status) return;
+    int side = scaled(2048 * sqrt(s.scale), 2);
+    side += side % 2;
+    Result r;
+    r.name = "fft";
+    r.param("side", side);
+    const size_t num_cells = (size_t) side * side;
+    oskar_Mem* grid_cpu = oskar_mem_create(s.prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_cells, status);
+    oskar_mem_clear_contents(grid_cpu, status);
+    oskar_mem_set_element_real(grid_cpu, num_cells / 2 + side / 2, 1.0,
+            status);
+    oskar_Mem* grid = oskar_mem_create_copy(grid_cpu, s.location, status);
+    oskar_FFT* fft = oskar_fft_create(s.prec, s.location, 2, side, 0, status);
+    for (int i = 0; i <= s.niter && !*status; ++i)
+    {
+        s.start();
+        oskar_fft_exec(fft, grid, status);
+        s.stop(r, i, grid, status);
+    }
+    r.items = (double) num_cells;
+    r.unit = "cells";
+    s.results.push_back(r);
+    oskar_fft_free(fft);
+    oskar_mem_free(grid, status);
+    oskar_mem_free(grid_cpu, status);
+}
+
+// Creates a block of visibility data with random baseline coordinates.
+static oskar_VisBlock* create_vis_block(const Suite& s, int num_stations,
+        int num_times, int num_channels, int pol, oskar_VisHeader** hdr,
+        int* status)
+{
+    const int amp_type = s.prec | OSKAR_COMPLEX | (pol ? OSKAR_MATRIX : 0);
+    *hdr = oskar_vis_header_create(amp_type, s.prec, num_times, num_times,
+            num_channels, num_channels, num_stations, 0, 1, status);
+    oskar_vis_header_set_freq_start_hz(*hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(*hdr, 1e6);
+    oskar_VisBlock* block = oskar_vis_block_create_from_header(
+            OSKAR_CPU, *hdr, status);
+    oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(block, 0),
+            0, 1, 2, 3, 500.0, status);
+    oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(block, 1),
+            4, 5, 6, 7, 500.0, status);
+    oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(block, 2),
+            8, 9, 10, 11, 50.0, status);
+    oskar_mem_random_gaussian(oskar_vis_block_cross_correlations(block),
+            12, 13, 14, 15, 1.0, status);
+    return block;
+}
+
+static void bench_imager_grid(Suite& s, int* status)
+{
+    const char* algorithms[] = {"FFT", "W-projection", "W-stacking"};
+    const int num_stations = scaled(256 * sqrt(s.scale), 2);
+    const int num_times = 16;
+    const int size = 2048;
+    if (!s.wanted("imager_grid") || *status) return;
+    oskar_VisHeader* hdr = 0;
+    oskar_VisBlock* block = create_vis_block(s, num_stations, num_times, 1,
+            0, &hdr, status);
+    const double num_vis = (double) num_times *
+            oskar_vis_block_num_baselines(block);
+    for (int a = 0; a < 3 && !*status; ++a)
+    {
+        Result r;
+        r.name = "imager_grid";
+        r.param("algorithm", algorithms[a]);
+        r.param("num_vis", num_vis);
+        r.param("size", size);
+        for (int i = 0; i <= s.niter && !*status; ++i)
+        {
+            // Set up the imager first, as done by the coordinate pass.
+            oskar_Imager* im = oskar_imager_create(s.prec, status);
+            oskar_imager_set_algorithm(im, algorithms[a], status);
+            oskar_imager_set_fov(im, 2.0);
+            oskar_imager_set_size(im, size, status);
+            oskar_imager_set_num_w_planes(im, 16);
+            if (s.location != OSKAR_CPU)
+            {
+                oskar_imager_set_gpus(im, -1, 0, status);
+                oskar_imager_set_grid_on_gpu(im, 1);
+            }
+            oskar_imager_set_coords_only(im, 1);
+            oskar_imager_update_from_block(im, hdr, block, status);
+            oskar_imager_set_coords_only(im, 0);
+            oskar_imager_check_init(im, status);
+
+            // Time the gridding.
+            s.start();
+            oskar_imager_update_from_block(im, hdr, block, status);
+            s.stop(r, i, 0, status);
+            oskar_imager_free(im, status);
+        }
+        r.items = num_vis;
+        r.unit = "visibilities";
+        s.results.push_back(r);
+    }
+    oskar_vis_block_free(block, status);
+    oskar_vis_header_free(hdr, status);
+}
+
+static void bench_fits_write(Suite& s, int* status)
+{
+    if (!s.wanted("fits_write") || *status) return;
+    int side = scaled(2048 * sqrt(s.scale));
+    Result r;
+    r.name = "fits_write";
+    r.param("side", side);
+    const size_t num_pixels = (size_t) side * side;
+    const string root = s.path("fits_write");
+    const string filename = root + ".fits";
+    oskar_Mem* image = oskar_mem_create(s.prec, OSKAR_CPU, num_pixels,
+            status);
+    fill(image, 6, -1.0, 1.0, status);
+    for (int i = 0; i <= s.niter && !*status; ++i)
+    {
+        remove(filename.c_str());
+        s.start();
+        oskar_mem_write_fits_cube(image, root.c_str(), side, side, 1, 0,
+                status);
+        s.stop(r, i, 0, status);
+    }
+    remove(filename.c_str());
+    r.items = (double) num_pixels * oskar_mem_element_size(s.prec);
+    r.unit = "bytes";
+    s.results.push_back(r);
+    oskar_mem_free(image, status);
+}
+
+static void bench_vis_write(Suite& s, int* status)
+{
+    if (!s.wanted("vis_write") || *status) return;
+    const int num_stations = 256, num_times = scaled(8 * s.scale);
+    Result r;
+    r.name = "vis_write";
+    r.param("num_stations", num_stations);
+    r.param("num_times", num_times);
+    const string filename = s.path("vis_write.vis");
+    oskar_VisHeader* hdr = 0;
+    oskar_VisBlock* block = create_vis_block(s, num_stations, num_times, 1,
+            1, &hdr, status);
+    for (int i = 0; i <= s.niter && !*status; ++i)
+    {
+        remove(filename.c_str());
+        s.start();
+        oskar_Binary* file = oskar_vis_header_write(hdr, filename.c_str(),
+                status);
+        oskar_vis_block_write(block, file, 0, status);
+        oskar_binary_free(file);
+        s.stop(r, i, 0, status);
+    }
+    remove(filename.c_str());
+    r.items = (double) oskar_mem_length(
+            oskar_vis_block_cross_correlations(block)) *
+            oskar_mem_element_size(s.prec | OSKAR_COMPLEX | OSKAR_MATRIX);
+    r.unit = "bytes";
+    s.results.push_back(r);
+    oskar_vis_block_free(block, status);
+    oskar_vis_header_free(hdr, status);
+}
+
+static void bench_interferometer_run(Suite& s, const char* tel_dir,
+        const string& vis_file, int* status)
+{
+    const int side = scaled(32 * sqrt(s.scale)), num_times = 16;
+    if (*status) return;
+    Result r;
+    r.name = "interferometer_run";
+    r.param("num_sources", side * side);
+    r.param("num_times", num_times);
+    SettingsTree* t = settings(s, "oskar_sim_interferometer", tel_dir);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%d", side);
+    t->set_value("sky/generator/grid/side_length", buf);
+    t->set_value("sky/generator/grid/fov_deg", "5.0");
+    t->set_value("sky/generator/grid/mean_flux_jy", "1.0");
+    snprintf(buf, sizeof(buf), "%d", num_times);
+    t->set_value("observation/num_time_steps", buf);
+    t->set_value("observation/num_channels", "2");
+    t->set_value("interferometer/oskar_vis_filename", vis_file.c_str());
+    t->set_value("interferometer/ms_filename", "");
+
+    // Run once without timing if only the imager needs the data.
+    const int niter = s.wanted("interferometer_run") ? s.niter : 0;
+    for (int i = 0; i <= niter && !*status; ++i)
+    {
+        oskar_Interferometer* sim = oskar_settings_to_interferometer(
+                t, 0, status);
+        oskar_Sky* sky = oskar_settings_to_sky(t, 0, status);
+        oskar_Telescope* tel = oskar_settings_to_telescope(t, 0, status);
+        oskar_interferometer_set_telescope_model(sim, tel, status);
+        oskar_interferometer_set_sky_model(sim, sky, status);
+        s.start();
+        oskar_interferometer_run(sim, status);
+        s.stop(r, i, 0, status);
+        oskar_interferometer_free(sim, status);
+        oskar_sky_free(sky, status);
+        oskar_telescope_free(tel, status);
+    }
+    SettingsTree::free(t);
+    if (niter == 0) return;
+    r.items = (double) side * side * num_times * 2;
+    r.unit = "source-samples";
+    s.results.push_back(r);
+}
+
+static void bench_beam_pattern_run(Suite& s, const char* tel_dir,
+        int* status)
+{
+    const int size = scaled(256 * sqrt(s.scale)), num_times = 4;
+    if (!s.wanted("beam_pattern_run") || *status) return;
+    Result r;
+    r.name = "beam_pattern_run";
+    r.param("size", size);
+    r.param("num_times", num_times);
+    SettingsTree* t = settings(s, "oskar_sim_beam_pattern", tel_dir);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%d", size);
+    t->set_value("beam_pattern/beam_image/size", buf);
+    t->set_value("beam_pattern/beam_image/fov_deg", "180.0");
+    snprintf(buf, sizeof(buf), "%d", num_times);
+    t->set_value("observation/num_time_steps", buf);
+    t->set_value("observation/num_channels", "1");
+    t->set_value("beam_pattern/station_outputs/fits_image/auto_power", "true");
+    t->set_value("beam_pattern/root_path", s.path("beam_pattern").c_str());
+    for (int i = 0; i <= s.niter && !*status; ++i)
+    {
+        oskar_BeamPattern* sim = oskar_settings_to_beam_pattern(t, 0, status);
+        oskar_Telescope* tel = oskar_settings_to_telescope(t, 0, status);
+        oskar_beam_pattern_set_telescope_model(sim, tel, status);
+        s.start();
+        oskar_beam_pattern_run(sim, status);
+        s.stop(r, i, 0, status);
+        oskar_beam_pattern_free(sim, status);
+        oskar_telescope_free(tel, status);
+    }
+    SettingsTree::free(t);
+    r.items = (double) size * size * num_times;
+    r.unit = "pixel-samples";
+    s.results.push_back(r);
+}
+
+static void bench_imager_run(Suite& s, const string& vis_file, int* status)
+{
+    const char* algorithms[] = {"FFT", "W-stacking"};
+    if (!s.wanted("imager_run") || *status) return;
+    for (int a = 0; a < 2 && !*status; ++a)
+    {
+        Result r;
+        r.name = "imager_run";
+        r.param("algorithm", algorithms[a]);
+        r.param("size", 1024);
+        SettingsTree* t = oskar_app_settings_tree("oskar_imager", 0);
+        t->set_value("image/double_precision",
+                s.prec == OSKAR_DOUBLE ? "true" : "false");
+        t->set_value("image/use_gpus",
+                s.location == OSKAR_CPU ? "false" : "true");
+        t->set_value("image/size", "1024");
+        t->set_value("image/fov_deg", "2.0");
+        t->set_value("image/algorithm", algorithms[a]);
+        t->set_value("image/wproj/num_w_planes", "16");
+        t->set_value("image/input_vis_data", vis_file.c_str());
+        t->set_value("image/root_path", s.path("imager").c_str());
+        for (int i = 0; i <= s.niter && !*status; ++i)
+        {
+            oskar_Imager* im = oskar_settings_to_imager(t, 0, status);
+            s.start();
+            oskar_imager_run(im, 0, 0, 0, 0, status);
+            s.stop(r, i, 0, status);
+            oskar_imager_free(im, status);
+        }
+        SettingsTree::free(t);
+        s.results.push_back(r);
+    }
+}
+
+static void write_json(const Suite& s, FILE* f)
+{
+    char date[32];
+    const time_t now = time(0);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    int num_threads = 1;
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    fprintf(f, "{\n");
+    fprintf(f, "  \"version\": \"%s\",\n", OSKAR_VERSION_STR);
+    fprintf(f, "  \"date\": \"%s\",\n", date);
+    fprintf(f, "  \"precision\": \"%s\",\n", s.prec_string());
+    fprintf(f, "  \"location\": \"%s\",\n", s.location == OSKAR_GPU ? "GPU" :
+            (s.location == OSKAR_CL ? "OpenCL" : "CPU"));
+    fprintf(f, "  \"num_threads\": %d,\n", num_threads);
+    fprintf(f, "  \"scale\": %.17g,\n", s.scale);
+    fprintf(f, "  \"benchmarks\": [");
+    for (size_t i = 0; i < s.results.size(); ++i)
+    {
+        const Result& r = s.results[i];
+        fprintf(f, "%s\n    {\"name\": \"%s\", \"params\": {%s},\n",
+                i > 0 ? "," : "", r.name.c_str(), r.params.c_str());
+        fprintf(f, "     \"min\": %.9g, \"median\": %.9g, \"mean\": %.9g, "
+                "\"std_dev\": %.9g,\n", r.min(), r.median(), r.mean(),
+                r.std_dev());
+        if (r.unit)
+            fprintf(f, "     \"items\": %.17g, \"unit\": \"%s\",\n",
+                    r.items, r.unit);
+        fprintf(f, "     \"times\": [");
+        for (size_t j = 0; j < r.times.size(); ++j)
+            fprintf(f, "%s%.9g", j > 0 ? ", " : "", r.times[j]);
+        fprintf(f, "]}");
+    }
+    fprintf(f, "\n  ]\n}\n");
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_benchmark_suite", OSKAR_VERSION_STR);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-g", "Run on the GPU");
+    opt.add_flag("-cl", "Run using OpenCL");
+    opt.add_flag("-n", "Number of timed iterations of each benchmark.",
+            1, "3", false);
+    opt.add_flag("-scale", "Problem size scale factor.", 1, "1.0", false);
+    opt.add_flag("-f", "Only run benchmarks with names containing this.",
+            1, "", false);
+    opt.add_flag("-o", "Write results to this JSON file.", 1, "", false);
+    opt.add_flag("-w", "Directory in which to create a temporary "
+            "working directory, which is removed afterwards.",
+            1, "oskar_benchmark_suite_data", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0;
+    Suite s;
+    s.prec = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    s.location = OSKAR_CPU;
+    if (opt.is_set("-g")) s.location = OSKAR_GPU;
+    if (opt.is_set("-cl")) s.location = OSKAR_CL;
+    s.niter = opt.get_int("-n");
+    s.scale = opt.get_double("-scale");
+    s.filter = opt.get_string("-f");
+    s.timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    if (s.niter < 1 || s.scale <= 0.0)
+    {
+        fprintf(stderr, "ERROR: Invalid number of iterations or scale.\n");
+        return EXIT_FAILURE;
+    }
+    if (s.location != OSKAR_CPU)
+        oskar_device_set(s.location, 0, &status);
+    s.work_dir = make_work_dir(opt.get_string("-w"));
+    if (s.work_dir.empty())
+    {
+        fprintf(stderr, "ERROR: Unable to create working directory in '%s'.\n",
+                opt.get_string("-w"));
+        return EXIT_FAILURE;
+    }
+
+    // Write and load the synthetic telescope model.
+    const string tel_dir = s.path("telescope.tm");
+    const string vis_file = s.path("interferometer.vis");
+    write_telescope(tel_dir.c_str(), 64, scaled(256 * s.scale), &status);
+    oskar_Telescope* tel = load_telescope(s, tel_dir.c_str(), &status);
+
+    // Run the benchmarks.
+    bench_sky_scale_flux(s, &status);
+    bench_horizon_clip(s, tel, &status);
+    bench_station_beam(s, tel, &status);
+    bench_jones_chain(s, &status);
+    bench_cross_correlate(s, tel, &status);
+    bench_fft(s, &status);
+    bench_imager_grid(s, &status);
+    bench_fits_write(s, &status);
+    bench_vis_write(s, &status);
+    if (s.wanted("interferometer_run") || s.wanted("imager_run"))
+        bench_interferometer_run(s, tel_dir.c_str(), vis_file, &status);
+    bench_beam_pattern_run(s, tel_dir.c_str(), &status);
+    bench_imager_run(s, vis_file, &status);
+    oskar_telescope_free(tel, &status);
+    oskar_timer_free(s.timer);
+    oskar_dir_remove(s.work_dir.c_str());
+
+    // Check for errors.
+    if (status)
+    {
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+
+    // Print a summary, and write the results.
+    printf("%-20s %12s %12s %12s  %s\n", "Benchmark", "Median [s]",
+            "Min [s]", "Std dev [s]", "Parameters");
+    for (size_t i = 0; i < s.results.size(); ++i)
+    {
+        const Result& r = s.results[i];
+        printf("%-20s %12.6f %12.6f %12.6f  %s\n", r.name.c_str(),
+                r.median(), r.min(), r.std_dev(), r.params.c_str());
+    }
+    const string out = opt.get_string("-o");
+    if (!out.empty())
+    {
+        FILE* f = fopen(out.c_str(), "w");
+        if (!f)
+        {
+            fprintf(stderr, "ERROR: Unable to open '%s'\n", out.c_str());
+            return EXIT_FAILURE;
+        }
+        write_json(s, f);
+        fclose(f);
+    }
+    if (s.location != OSKAR_CPU)
+        oskar_device_reset_all();
+    return EXIT_SUCCESS;
+}
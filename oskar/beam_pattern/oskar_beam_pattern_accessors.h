@@ -123,12 +123,28 @@ OSKAR_EXPORT
 void oskar_beam_pattern_set_image_fov(oskar_BeamPattern* h,
         double width_deg, double height_deg);
 
+/**
+ * @brief
+ * Sets the maximum number of pixels processed concurrently on each device.
+ *
+ * @details
+ * Sets the maximum number of pixels processed concurrently on each
+ * compute device.
+ * If \p value is zero or negative, the chunk size is chosen automatically
+ * from the available host and device memory when the beam pattern
+ * simulator is initialised.
+ *
+ * @param[in] value  Maximum number, or <= 0 to choose automatically.
+ */
 OSKAR_EXPORT
 void oskar_beam_pattern_set_max_chunk_size(oskar_BeamPattern* h, int value);
 
 OSKAR_EXPORT
 void oskar_beam_pattern_set_num_devices(oskar_BeamPattern* h, int value);
 
+OSKAR_EXPORT
+void oskar_beam_pattern_set_numa_pinning(oskar_BeamPattern* h, int value);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_observation_frequency(oskar_BeamPattern* h,
         double start_hz, double inc_hz, int num_channels);
@@ -65,7 +65,7 @@ struct oskar_BeamPattern
 {
     /* Settings. */
     int prec, num_devices, num_gpus_avail, dev_loc, num_gpus, *gpu_ids;
-    int max_chunk_size;
+    int max_chunk_size, auto_chunk_size, numa_pinning;
     int num_time_steps, num_channels, num_chunks;
     int pol_mode, width, height, nside;
     int num_active_stations, *station_ids;
@@ -222,7 +222,9 @@ void oskar_beam_pattern_set_image_fov(oskar_BeamPattern* h,
 
 void oskar_beam_pattern_set_max_chunk_size(oskar_BeamPattern* h, int value)
 {
-    h->max_chunk_size = value;
+    /* Values <= 0 are sized by the memory planner in check_init. */
+    h->auto_chunk_size = (value <= 0);
+    h->max_chunk_size = (value > 0) ? value : 16384;
 }
 
 
@@ -239,6 +241,15 @@ void oskar_beam_pattern_set_num_devices(oskar_BeamPattern* h, int value)
 }
 
 
+void oskar_beam_pattern_set_numa_pinning(oskar_BeamPattern* h, int value)
+{
+    int status = 0;
+    if (h->numa_pinning == value) return;
+    oskar_beam_pattern_free_device_data(h, &status);
+    h->numa_pinning = value;
+}
+
+
 void oskar_beam_pattern_set_observation_frequency(oskar_BeamPattern* h,
         double start_hz, double inc_hz, int num_channels)
 {
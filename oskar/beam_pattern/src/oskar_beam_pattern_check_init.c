@@ -11,6 +11,7 @@
 #include "math/private_cond2_2x2.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_file_exists.h"
+#include "utility/oskar_numa.h"
 #include "oskar_version.h"
 
 #include <stdlib.h>
@@ -26,7 +27,11 @@
 extern "C" {
 #endif
 
+/* Fractions of free host and device memory that the planner may use. */
+#define PLAN_HOST_FRACTION 0.5
+#define PLAN_DEVICE_FRACTION 0.8
 
+static void plan_memory(oskar_BeamPattern* h, int* status);
 static void set_up_host_data(oskar_BeamPattern* h, int *status);
 static void create_averaged_products(oskar_BeamPattern* h, int ta, int ca,
         int* status);
@@ -85,6 +90,8 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
             OSKAR_COORDS_RADEC, status);
 
     /* Work out how many pixel chunks have to be processed. */
+    if (!h->pix)
+        plan_memory(h, status);
     h->num_chunks = (h->num_pixels + h->max_chunk_size - 1) / h->max_chunk_size;
 
     /* Create scratch arrays for output pixel data. */
@@ -180,6 +187,122 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
 }
 
 
+/* Chooses the largest pixel chunk size that fits in memory, if it was not
+ * set explicitly, and reports the plan. Estimates cover the arrays
+ * allocated in init_device(). */
+static void plan_memory(oskar_BeamPattern* h, int* status)
+{
+    int i, beam_type;
+    size_t host_free = 0, host_total = 0, host_max = 0;
+    size_t dev_free = 0, dev_max = 0;
+    const double mib = 1024.0 * 1024.0;
+    if (*status) return;
+
+    /* Get dimensions.
+     * Devices are expanded to the number of GPUs in set_up_device_data. */
+    const int num_gpus = h->num_gpus;
+    const int num_devices =
+            (h->num_devices > num_gpus) ? h->num_devices : num_gpus;
+    const int num_cpu = num_devices - num_gpus;
+    const int num_pixels = h->num_pixels > 0 ? h->num_pixels : 1;
+    const size_t num_st = (size_t) h->num_active_stations;
+    beam_type = h->prec | OSKAR_COMPLEX;
+    if (h->pol_mode == OSKAR_POL_MODE_FULL)
+        beam_type |= OSKAR_MATRIX;
+    const int raw_data = h->ixr_txt || h->ixr_fits ||
+            h->voltage_raw_txt || h->voltage_amp_txt || h->voltage_phase_txt ||
+            h->voltage_amp_fits || h->voltage_phase_fits;
+    const int auto_power = h->auto_power_txt || h->auto_power_fits ||
+            h->auto_power_phase_fits ||
+            h->auto_power_real_fits || h->auto_power_imag_fits;
+    const int cross_power = h->cross_power_raw_txt ||
+            h->cross_power_amp_fits || h->cross_power_phase_fits ||
+            h->cross_power_amp_txt || h->cross_power_phase_txt ||
+            h->cross_power_real_fits || h->cross_power_imag_fits;
+    const size_t num_stokes = (h->stokes[0] ? 1 : 0) + (h->stokes[1] ? 1 : 0);
+    const size_t num_avg = (h->average_single_axis == 'T' ? 1 : 0) +
+            (h->average_single_axis == 'C' ? 1 : 0) +
+            (h->average_time_and_channel ? 1 : 0);
+
+    /* Bytes per pixel in a chunk, on each device and on the host.
+     * Host buffers are double-buffered for writing, plus any averages. */
+    const size_t real_size = oskar_mem_element_size(h->prec);
+    const size_t beam_size = oskar_mem_element_size(beam_type);
+    const size_t per_pixel_dev = num_st * beam_size *
+            (1 + (auto_power ? num_stokes : 0)) +
+            (cross_power ? num_stokes * beam_size : 0) + 5 * real_size +
+            oskar_station_work_bytes_per_point(beam_type,
+                    oskar_telescope_max_station_depth(h->tel));
+    const size_t per_pixel_host = (raw_data ? 2 * num_st * beam_size : 0) +
+            (auto_power ? num_stokes * (2 + num_avg) * num_st * beam_size : 0) +
+            (cross_power ? num_stokes * (2 + num_avg) * beam_size : 0);
+    const double per_pixel_total = (double)num_devices * per_pixel_host +
+            (double)num_cpu * per_pixel_dev + 3.0 * real_size;
+
+    /* Get the free memory on the host and on the GPUs. */
+    oskar_device_mem_info(OSKAR_CPU, 0, &host_free, &host_total, &host_max);
+    for (i = 0; i < num_gpus; ++i)
+    {
+        size_t mem_free = 0, mem_total = 0, max_alloc = 0;
+        oskar_device_mem_info(h->dev_loc, h->gpu_ids[i],
+                &mem_free, &mem_total, &max_alloc);
+        if (i == 0 || mem_free < dev_free) dev_free = mem_free;
+        if (i == 0 || max_alloc < dev_max) dev_max = max_alloc;
+    }
+    const double host_budget = PLAN_HOST_FRACTION * host_free;
+    const double dev_budget = PLAN_DEVICE_FRACTION * dev_free;
+    const int use_dev = num_gpus > 0 && dev_free > 0;
+
+    /* Choose the chunk size, using no more than one chunk per device
+     * in each round, and even up the chunk sizes. */
+    if (h->auto_chunk_size && host_free > 0)
+    {
+        double limit = (double)(num_pixels + num_devices - 1) / num_devices;
+        if (host_budget / per_pixel_total < limit)
+            limit = host_budget / per_pixel_total;
+        if (use_dev)
+        {
+            if (dev_budget / per_pixel_dev < limit)
+                limit = dev_budget / per_pixel_dev;
+            if ((double)dev_max / (num_st * beam_size) < limit)
+                limit = (double)dev_max / (num_st * beam_size);
+        }
+        if (limit < 1.0)
+        {
+            limit = 1.0;
+            oskar_log_warning(h->log, "There may not be enough memory "
+                    "to hold one pixel per chunk.");
+        }
+        const int num_chunks = (num_pixels + (int)limit - 1) / (int)limit;
+        const int num_rounds = (num_chunks + num_devices - 1) / num_devices;
+        h->max_chunk_size = (num_pixels + num_rounds * num_devices - 1) /
+                (num_rounds * num_devices);
+    }
+    else if (h->auto_chunk_size)
+        oskar_log_warning(h->log, "Unable to determine free memory: "
+                "using default chunk size.");
+
+    /* Report the plan. */
+    const double host_bytes = per_pixel_total * h->max_chunk_size;
+    const double dev_bytes = (double)per_pixel_dev * h->max_chunk_size;
+    oskar_log_section(h->log, 'M', "Memory plan");
+    oskar_log_value(h->log, 'M', 0, "Pixels per chunk", "%d%s",
+            h->max_chunk_size, h->auto_chunk_size ? " (auto)" : "");
+    oskar_log_value(h->log, 'M', 0, "Num. pixel chunks", "%d",
+            (num_pixels + h->max_chunk_size - 1) / h->max_chunk_size);
+    if (num_gpus > 0)
+        oskar_log_value(h->log, 'M', 0, "Est. memory per GPU",
+                "%.1f MiB (%.1f MiB free)", dev_bytes / mib, dev_free / mib);
+    oskar_log_value(h->log, 'M', 0, "Est. host memory",
+            "%.1f MiB (%.1f MiB free)", host_bytes / mib, host_free / mib);
+    if ((host_free > 0 && host_bytes > host_budget) ||
+            (use_dev && dev_bytes > dev_budget))
+        oskar_log_warning(h->log, "Estimated memory use exceeds the "
+                "planning budget. Reduce the chunk size "
+                "if the simulation runs out of memory.");
+}
+
+
 static void create_averaged_products(oskar_BeamPattern* h, int ta, int ca,
         int* status)
 {
@@ -553,14 +676,141 @@ static const char* stokes_type_to_string(int type)
 }
 
 
+struct ThreadArgs
+{
+    oskar_BeamPattern* h;
+    int thread_id, beam_type, auto_power, cross_power, raw_data, *status;
+};
+typedef struct ThreadArgs ThreadArgs;
+
+static void* init_device(void* arg)
+{
+    int dev_loc, i_stokes_type;
+    ThreadArgs* a = (ThreadArgs*)arg;
+    oskar_BeamPattern* h = a->h;
+    DeviceData* d = &h->d[a->thread_id];
+    int* status = a->status;
+    const int i = a->thread_id;
+    const int max_src = h->max_chunk_size;
+    const int max_size = h->num_active_stations * max_src;
+    const int beam_type = a->beam_type;
+    const int auto_power = a->auto_power, cross_power = a->cross_power;
+    const int raw_data = a->raw_data;
+    if (*status) return 0;
+
+    /* Select the device. */
+    if (i < h->num_gpus)
+    {
+        oskar_device_set(h->dev_loc, h->gpu_ids[i], status);
+        dev_loc = h->dev_loc;
+    }
+    else
+    {
+        dev_loc = OSKAR_CPU;
+    }
+
+    /* Device memory. */
+    d->previous_chunk_index = -1;
+    if (!d->tel)
+    {
+        d->jones_data = oskar_mem_create(beam_type, dev_loc, max_size,
+                status);
+        d->lon_rad = oskar_mem_create(h->prec, dev_loc, 1 + max_src, status);
+        d->lat_rad = oskar_mem_create(h->prec, dev_loc, 1 + max_src, status);
+        d->x    = oskar_mem_create(h->prec, dev_loc, 1 + max_src, status);
+        d->y    = oskar_mem_create(h->prec, dev_loc, 1 + max_src, status);
+        d->z    = oskar_mem_create(h->prec, dev_loc, 1 + max_src, status);
+        d->tel  = oskar_telescope_create_copy(h->tel, dev_loc, status);
+        d->work = oskar_station_work_create(h->prec, dev_loc, status);
+        oskar_station_work_set_tec_screen_common_params(d->work,
+                oskar_telescope_ionosphere_screen_type(d->tel),
+                oskar_telescope_tec_screen_height_km(d->tel),
+                oskar_telescope_tec_screen_pixel_size_m(d->tel),
+                oskar_telescope_tec_screen_time_interval_sec(d->tel));
+        if (oskar_telescope_ionosphere_screen_type(d->tel) == 'E')
+            oskar_station_work_set_tec_screen_path(d->work,
+                    oskar_telescope_tec_screen_path(d->tel));
+    }
+
+    /* Host memory. */
+    if (!d->jones_data_cpu[0] && raw_data)
+    {
+        d->jones_data_cpu[0] = oskar_mem_create(beam_type, OSKAR_CPU,
+                max_size, status);
+        d->jones_data_cpu[1] = oskar_mem_create(beam_type, OSKAR_CPU,
+                max_size, status);
+    }
+
+    /* Auto-correlation beam output arrays. */
+    for (i_stokes_type = 0; i_stokes_type < 2; ++i_stokes_type)
+    {
+        if (!h->stokes[i_stokes_type]) continue;
+
+        if (!d->auto_power[i_stokes_type] && auto_power)
+        {
+            /* Device memory. */
+            d->auto_power[i_stokes_type] = oskar_mem_create(
+                    beam_type, dev_loc, max_size, status);
+            oskar_mem_clear_contents(d->auto_power[i_stokes_type], status);
+
+            /* Host memory. */
+            d->auto_power_cpu[i_stokes_type][0] = oskar_mem_create(
+                    beam_type, OSKAR_CPU, max_size, status);
+            d->auto_power_cpu[i_stokes_type][1] = oskar_mem_create(
+                    beam_type, OSKAR_CPU, max_size, status);
+            if (h->average_single_axis == 'T')
+                d->auto_power_time_avg[i_stokes_type] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_size, status);
+            if (h->average_single_axis == 'C')
+                d->auto_power_channel_avg[i_stokes_type] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_size, status);
+            if (h->average_time_and_channel)
+                d->auto_power_channel_and_time_avg[i_stokes_type] =
+                        oskar_mem_create(beam_type, OSKAR_CPU,
+                                max_size, status);
+        }
+
+        /* Cross-correlation beam output arrays. */
+        if (!d->cross_power[i_stokes_type] && cross_power)
+        {
+            /* Device memory. */
+            d->cross_power[i_stokes_type] = oskar_mem_create(
+                    beam_type, dev_loc, max_src, status);
+            oskar_mem_clear_contents(d->cross_power[i_stokes_type], status);
+
+            /* Host memory. */
+            d->cross_power_cpu[i_stokes_type][0] = oskar_mem_create(
+                    beam_type, OSKAR_CPU, max_src, status);
+            d->cross_power_cpu[i_stokes_type][1] = oskar_mem_create(
+                    beam_type, OSKAR_CPU, max_src, status);
+            if (h->average_single_axis == 'T')
+                d->cross_power_time_avg[i_stokes_type] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_src, status);
+            if (h->average_single_axis == 'C')
+                d->cross_power_channel_avg[i_stokes_type] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_src, status);
+            if (h->average_time_and_channel)
+                d->cross_power_channel_and_time_avg[i_stokes_type] =
+                        oskar_mem_create(beam_type, OSKAR_CPU,
+                                max_src, status);
+        }
+    }
+
+    /* Timers. */
+    if (!d->tmr_compute)
+        d->tmr_compute = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    return 0;
+}
+
+
 static void set_up_device_data(oskar_BeamPattern* h, int* status)
 {
-    int i, beam_type, max_src, max_size, auto_power, cross_power, raw_data;
+    int i, beam_type, auto_power, cross_power, raw_data;
+    oskar_Thread** threads = 0;
+    ThreadArgs* args = 0;
     if (*status) return;
 
     /* Get local variables. */
-    max_src = h->max_chunk_size;
-    max_size = h->num_active_stations * max_src;
     beam_type = h->prec | OSKAR_COMPLEX;
     if (h->pol_mode == OSKAR_POL_MODE_FULL)
         beam_type |= OSKAR_MATRIX;
@@ -580,122 +830,43 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
     if (h->num_devices < h->num_gpus)
         oskar_beam_pattern_set_num_devices(h, h->num_gpus);
 
-    for (i = 0; i < h->num_devices; ++i)
+    if (cross_power && h->num_active_stations < 2)
     {
-        int dev_loc, i_stokes_type;
-        DeviceData* d = &h->d[i];
-        if (*status) break;
-
-        /* Select the device. */
-        if (i < h->num_gpus)
-        {
-            oskar_device_set(h->dev_loc, h->gpu_ids[i], status);
-            dev_loc = h->dev_loc;
-        }
-        else
-        {
-            dev_loc = OSKAR_CPU;
-        }
-
-        /* Device memory. */
-        d->previous_chunk_index = -1;
-        if (!d->tel)
-        {
-            d->jones_data = oskar_mem_create(beam_type, dev_loc, max_size,
-                    status);
-            d->lon_rad = oskar_mem_create(h->prec, dev_loc, 1 + max_src, status);
-            d->lat_rad = oskar_mem_create(h->prec, dev_loc, 1 + max_src, status);
-            d->x    = oskar_mem_create(h->prec, dev_loc, 1 + max_src, status);
-            d->y    = oskar_mem_create(h->prec, dev_loc, 1 + max_src, status);
-            d->z    = oskar_mem_create(h->prec, dev_loc, 1 + max_src, status);
-            d->tel  = oskar_telescope_create_copy(h->tel, dev_loc, status);
-            d->work = oskar_station_work_create(h->prec, dev_loc, status);
-            oskar_station_work_set_tec_screen_common_params(d->work,
-                    oskar_telescope_ionosphere_screen_type(d->tel),
-                    oskar_telescope_tec_screen_height_km(d->tel),
-                    oskar_telescope_tec_screen_pixel_size_m(d->tel),
-                    oskar_telescope_tec_screen_time_interval_sec(d->tel));
-            if (oskar_telescope_ionosphere_screen_type(d->tel) == 'E')
-                oskar_station_work_set_tec_screen_path(d->work,
-                        oskar_telescope_tec_screen_path(d->tel));
-        }
-
-        /* Host memory. */
-        if (!d->jones_data_cpu[0] && raw_data)
-        {
-            d->jones_data_cpu[0] = oskar_mem_create(beam_type, OSKAR_CPU,
-                    max_size, status);
-            d->jones_data_cpu[1] = oskar_mem_create(beam_type, OSKAR_CPU,
-                    max_size, status);
-        }
-
-        /* Auto-correlation beam output arrays. */
-        for (i_stokes_type = 0; i_stokes_type < 2; ++i_stokes_type)
-        {
-            if (!h->stokes[i_stokes_type]) continue;
-
-            if (!d->auto_power[i_stokes_type] && auto_power)
-            {
-                /* Device memory. */
-                d->auto_power[i_stokes_type] = oskar_mem_create(
-                        beam_type, dev_loc, max_size, status);
-                oskar_mem_clear_contents(d->auto_power[i_stokes_type], status);
-
-                /* Host memory. */
-                d->auto_power_cpu[i_stokes_type][0] = oskar_mem_create(
-                        beam_type, OSKAR_CPU, max_size, status);
-                d->auto_power_cpu[i_stokes_type][1] = oskar_mem_create(
-                        beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_single_axis == 'T')
-                    d->auto_power_time_avg[i_stokes_type] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_single_axis == 'C')
-                    d->auto_power_channel_avg[i_stokes_type] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_time_and_channel)
-                    d->auto_power_channel_and_time_avg[i_stokes_type] =
-                            oskar_mem_create(beam_type, OSKAR_CPU,
-                                    max_size, status);
-            }
-
-            /* Cross-correlation beam output arrays. */
-            if (!d->cross_power[i_stokes_type] && cross_power)
-            {
-                if (h->num_active_stations < 2)
-                {
-                    oskar_log_error(h->log, "Cannot create cross-power beam "
-                            "using less than two active stations.");
-                    *status = OSKAR_ERR_INVALID_ARGUMENT;
-                    break;
-                }
-
-                /* Device memory. */
-                d->cross_power[i_stokes_type] = oskar_mem_create(
-                        beam_type, dev_loc, max_src, status);
-                oskar_mem_clear_contents(d->cross_power[i_stokes_type], status);
-
-                /* Host memory. */
-                d->cross_power_cpu[i_stokes_type][0] = oskar_mem_create(
-                        beam_type, OSKAR_CPU, max_src, status);
-                d->cross_power_cpu[i_stokes_type][1] = oskar_mem_create(
-                        beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_single_axis == 'T')
-                    d->cross_power_time_avg[i_stokes_type] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_single_axis == 'C')
-                    d->cross_power_channel_avg[i_stokes_type] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_time_and_channel)
-                    d->cross_power_channel_and_time_avg[i_stokes_type] =
-                            oskar_mem_create(beam_type, OSKAR_CPU,
-                                    max_src, status);
-            }
-        }
+        oskar_log_error(h->log, "Cannot create cross-power beam "
+                "using less than two active stations.");
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
 
-        /* Timers. */
-        if (!d->tmr_compute)
-            d->tmr_compute = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    /* Set up devices in parallel.
+     * If pinned, CPU device buffers are first touched on their NUMA node. */
+    const int num_devices = h->num_devices;
+    const int num_cpu = num_devices - h->num_gpus;
+    if (h->numa_pinning && !h->d[0].tmr_compute)
+        oskar_device_log_numa(h->num_gpus, num_cpu, h->log);
+    threads = (oskar_Thread**) calloc(num_devices, sizeof(oskar_Thread*));
+    args = (ThreadArgs*) calloc(num_devices, sizeof(ThreadArgs));
+    for (i = 0; i < num_devices; ++i)
+    {
+        const int node = (h->numa_pinning && i >= h->num_gpus) ?
+                oskar_numa_node_for_device(i - h->num_gpus, num_cpu) : -1;
+        args[i].h = h;
+        args[i].thread_id = i;
+        args[i].beam_type = beam_type;
+        args[i].auto_power = auto_power;
+        args[i].cross_power = cross_power;
+        args[i].raw_data = raw_data;
+        args[i].status = status;
+        threads[i] = oskar_thread_create_on_node(init_device,
+                (void*)&args[i], 0, node);
+    }
+    for (i = 0; i < num_devices; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
     }
+    free(threads);
+    free(args);
 }
 
 #ifdef __cplusplus
@@ -55,7 +55,7 @@ oskar_BeamPattern* oskar_beam_pattern_create(int precision, int* status)
     /* Set sensible defaults. */
     oskar_beam_pattern_set_gpus(h, -1, 0, status);
     oskar_beam_pattern_set_num_devices(h, -1);
-    oskar_beam_pattern_set_max_chunk_size(h, 16384);
+    oskar_beam_pattern_set_max_chunk_size(h, 0);
     oskar_beam_pattern_set_station_ids(h, 1, &station_id);
     oskar_beam_pattern_set_test_source_stokes_i(h, 1);
     oskar_beam_pattern_set_test_source_stokes_custom(h,
@@ -14,6 +14,8 @@
 #include "utility/oskar_file_exists.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_numa.h"
+#include "utility/oskar_trace.h"
 #include "oskar_version.h"
 
 #include <stdlib.h>
@@ -111,9 +113,19 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
     /* Start simulation timer. */
     oskar_timer_start(h->tmr_sim);
 
-    /* Start the worker threads. */
+    /* Start the worker threads.
+     * If required, pin CPU devices to the same NUMA nodes used in
+     * oskar_beam_pattern_check_init(). Thread 0 is not pinned. */
     for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+    {
+        int node = -1;
+        const int i_cpu = i - 1 - h->num_gpus;
+        if (h->numa_pinning && i_cpu >= 0)
+            node = oskar_numa_node_for_device(i_cpu,
+                    h->num_devices - h->num_gpus);
+        threads[i] = oskar_thread_create_on_node(run_blocks,
+                (void*)&args[i], 0, node);
+    }
 
     /* Wait for worker threads to finish. */
     for (i = 0; i < num_threads; ++i)
@@ -140,6 +152,15 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
         record_timing(h);
     }
 
+    /* Write the trace file, if enabled. */
+    if (oskar_trace_enabled())
+    {
+        int trace_status = 0;
+        oskar_trace_write(&trace_status);
+        if (trace_status)
+            oskar_log_warning(h->log, "Unable to write trace file.");
+    }
+
     /* Finalise. */
     oskar_beam_pattern_reset_cache(h, status);
 
@@ -275,18 +296,25 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
     if ((i_chunk + 1) * h->max_chunk_size > h->num_pixels)
         chunk_size = h->num_pixels - i_chunk * h->max_chunk_size;
 
-    /* Copy pixel chunk coordinate data to GPU only if chunk is different. */
+    /* Copy pixel chunk coordinate data to GPU only if chunk is different.
+     * For OpenCL, the copies are queued together, and kernels wait for
+     * them on the device rather than the host waiting for each one. */
     if (i_chunk != d->previous_chunk_index)
     {
+        struct _cl_event* event[5] = {0, 0, 0, 0, 0};
         const int offset = i_chunk * h->max_chunk_size;
         d->previous_chunk_index = i_chunk;
-        oskar_mem_copy_contents(d->lon_rad, h->lon_rad,
-                0, offset, chunk_size, status);
-        oskar_mem_copy_contents(d->lat_rad, h->lat_rad,
-                0, offset, chunk_size, status);
-        oskar_mem_copy_contents(d->x, h->x, 0, offset, chunk_size, status);
-        oskar_mem_copy_contents(d->y, h->y, 0, offset, chunk_size, status);
-        oskar_mem_copy_contents(d->z, h->z, 0, offset, chunk_size, status);
+        oskar_mem_copy_contents_async(d->lon_rad, h->lon_rad,
+                0, offset, chunk_size, 0, 0, &event[0], status);
+        oskar_mem_copy_contents_async(d->lat_rad, h->lat_rad,
+                0, offset, chunk_size, 0, 0, &event[1], status);
+        oskar_mem_copy_contents_async(d->x, h->x,
+                0, offset, chunk_size, 0, 0, &event[2], status);
+        oskar_mem_copy_contents_async(d->y, h->y,
+                0, offset, chunk_size, 0, 0, &event[3], status);
+        oskar_mem_copy_contents_async(d->z, h->z,
+                0, offset, chunk_size, 0, 0, &event[4], status);
+        oskar_device_events_enqueue_wait(5, event, status);
     }
 
     /* Generate beam for this pixel chunk, for all active stations. */
@@ -332,19 +360,31 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
                 h->test_source_stokes[3],
                 0, d->cross_power[1], status);
 
-    /* Copy the output data into host memory. */
-    if (d->jones_data_cpu[i_active])
-        oskar_mem_copy_contents(d->jones_data_cpu[i_active], d->jones_data,
-                0, 0, chunk_size * h->num_active_stations, status);
-    for (i = 0; i < 2; ++i)
+    /* Copy the output data into host memory.
+     * For OpenCL, all the reads are queued once the kernels have finished,
+     * and the host then waits for them together. */
     {
-        if (d->auto_power[i])
-            oskar_mem_copy_contents(d->auto_power_cpu[i][i_active],
-                    d->auto_power[i], 0, 0,
-                    chunk_size * h->num_active_stations, status);
-        if (d->cross_power[i])
-            oskar_mem_copy_contents(d->cross_power_cpu[i][i_active],
-                    d->cross_power[i], 0, 0, chunk_size, status);
+        struct _cl_event *done = 0, *event[5] = {0, 0, 0, 0, 0};
+        oskar_device_event_record(oskar_mem_location(d->jones_data),
+                &done, status);
+        if (d->jones_data_cpu[i_active])
+            oskar_mem_copy_contents_async(d->jones_data_cpu[i_active],
+                    d->jones_data, 0, 0, chunk_size * h->num_active_stations,
+                    1, &done, &event[0], status);
+        for (i = 0; i < 2; ++i)
+        {
+            if (d->auto_power[i])
+                oskar_mem_copy_contents_async(d->auto_power_cpu[i][i_active],
+                        d->auto_power[i], 0, 0,
+                        chunk_size * h->num_active_stations,
+                        1, &done, &event[1 + i], status);
+            if (d->cross_power[i])
+                oskar_mem_copy_contents_async(d->cross_power_cpu[i][i_active],
+                        d->cross_power[i], 0, 0, chunk_size,
+                        1, &done, &event[3 + i], status);
+        }
+        oskar_device_events_wait(5, event, status);
+        oskar_device_events_release(1, &done);
     }
     oskar_mutex_lock(h->mutex);
     oskar_log_message(h->log, 'S', 1, "Chunk %*i/%i, "
@@ -626,12 +666,21 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
             firstpix[1] = 1 + (i_chunk * h->max_chunk_size) / h->width;
             firstpix[2] = 1 + i_channel;
             firstpix[3] = 1 + i_time;
+            const double t0 = oskar_trace_time();
             fits_write_pix(f, (h->prec == OSKAR_DOUBLE ? TDOUBLE : TFLOAT),
                     firstpix, num_pix, oskar_mem_void(h->pix), status);
+            oskar_trace_add("io", "fits_write_pix", t0, -1, "bytes",
+                    num_pix * oskar_mem_element_size(oskar_mem_type(h->pix)));
         }
 
         /* Check for text file. */
-        if (t) oskar_mem_save_ascii(t, 1, 0, num_pix, status, h->pix);
+        if (t)
+        {
+            const double t0 = oskar_trace_time();
+            oskar_mem_save_ascii(t, 1, 0, num_pix, status, h->pix);
+            oskar_trace_add("io", "save_ascii", t0, -1, "elements",
+                    (size_t) num_pix);
+        }
     }
 }
 
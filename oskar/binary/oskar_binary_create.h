@@ -48,8 +48,14 @@ extern "C" {
  * The handle must be released by calling oskar_binary_free() when it has been
  * finished with.
  *
+ * Mode 'm' opens the file for reading, and also maps it into memory
+ * (where supported by the operating system), so that payloads can be used
+ * in place by calling oskar_binary_map_block(). If the file cannot be
+ * mapped, the handle behaves as if it had been opened in mode 'r'.
+ *
  * @param[in] filename    Filename to open.
- * @param[in] mode        Mode: either 'w' (write), or 'r' (read).
+ * @param[in] mode        Mode: 'w' (write), 'a' (append), 'r' (read),
+ *                        or 'm' (read, using a memory-mapped file).
  * @param[in,out] status  Status return code.
  */
 OSKAR_BINARY_EXPORT
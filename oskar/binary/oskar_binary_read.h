@@ -59,6 +59,35 @@ OSKAR_BINARY_EXPORT
 void oskar_binary_read_block(oskar_Binary* handle,
         int chunk_index, size_t data_size, void* data, int* status);
 
+/**
+ * @brief Returns a pointer to the payload of a tag in a memory-mapped file.
+ *
+ * @details
+ * This function returns a pointer to the payload of a single tag,
+ * without copying it, if the file was opened in mode 'm'.
+ *
+ * A null pointer is returned without setting an error if the payload cannot
+ * be used in place: that is, if the file is not memory-mapped, if the
+ * payload is empty, if its byte order does not match the host, or if it is
+ * not suitably aligned for its data type. In this case, the caller should
+ * fall back to oskar_binary_read_block().
+ *
+ * The CRC code of the payload, if present, is checked the first time it is
+ * accessed. The mapping is private, so the payload may be modified in place
+ * without changing the file, although subsequent reads of the same tag
+ * through this handle will return the modified data.
+ * The pointer is valid only until the handle is freed.
+ *
+ * @param[in,out] handle   Binary file handle.
+ * @param[in] chunk_index  Sequence index of the chunk's tag in the file.
+ * @param[in,out] status   Status return code.
+ *
+ * @return Pointer to the payload, or NULL if it cannot be used in place.
+ */
+OSKAR_BINARY_EXPORT
+void* oskar_binary_map_block(oskar_Binary* handle, int chunk_index,
+        int* status);
+
 /**
  * @brief Reads a block of binary data for a single tag from an input stream.
  *
@@ -40,6 +40,34 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Sets the compression codec used for subsequent writes.
+ *
+ * @details
+ * This function sets the codec used to compress the payloads of subsequent
+ * tags written using the handle.
+ *
+ * If \p codec is OSKAR_BINARY_COMPRESSION_SHUFFLE_LZ, numerical payloads of
+ * at least 4 kB are stored compressed, if that makes them smaller.
+ * The bytes of each element are first shuffled to group together those of
+ * similar significance, before the data are compressed using a fast LZ77
+ * scheme. Compression is done in parallel, over sub-blocks of the payload,
+ * using the given number of threads (or all available processor cores,
+ * if \p num_threads is less than 1).
+ *
+ * Compressed payloads are decompressed transparently when they are read.
+ * Note that versions of this library before 2.8 will report such files
+ * as invalid.
+ *
+ * @param[in,out] handle   Binary file handle.
+ * @param[in] codec        Compression codec (enumerator), or 0 for none.
+ * @param[in] num_threads  Number of threads to use for compression.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_BINARY_EXPORT
+void oskar_binary_set_compression(oskar_Binary* handle, int codec,
+        int num_threads, int* status);
+
 /**
  * @brief Writes a block of binary data to an output stream.
  *
@@ -65,6 +93,30 @@ void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
         unsigned char id_group, unsigned char id_tag, int user_index,
         size_t data_size, const void* data, int* status);
 
+/**
+ * @brief Writes a padding block to align the payload of the next block.
+ *
+ * @details
+ * This function writes a block of zero bytes, sized so that the payload
+ * of the next standard block written to the stream starts at a multiple
+ * of \p alignment bytes from the start of the file. This allows that
+ * payload to be memory-mapped when the file is read, if it is not
+ * compressed.
+ *
+ * The tag is specified as a standard tag, using a group ID and a tag ID
+ * that are both given as bytes.
+ *
+ * @param[in,out] handle   Binary file handle.
+ * @param[in] id_group     Tag group identifier.
+ * @param[in] id_tag       Tag identifier.
+ * @param[in] user_index   User-defined index.
+ * @param[in] alignment    Required alignment of the next payload, in bytes.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_BINARY_EXPORT
+void oskar_binary_write_padding(oskar_Binary* handle, unsigned char id_group,
+        unsigned char id_tag, int user_index, size_t alignment, int* status);
+
 /**
  * @brief Writes a single double-precision value to an output stream.
  *
@@ -34,6 +34,10 @@
 #include <stdint.h>
 #include <binary/oskar_crc.h>
 
+#if !defined(_WIN32)
+#define OSKAR_BINARY_HAVE_MMAP 1
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -101,7 +105,9 @@ typedef struct oskar_BinaryHeader oskar_BinaryHeader;
  *
  * Bit  Meaning when set
  * ----------------------------------------------------------------------------
- * 0-4  Reserved. (Must be 0.)
+ * 0-3  Reserved. (Must be 0.)
+ * 4    Payload data is compressed. (The layout of compressed data is
+ *      described in oskar_binary_compress.c.)
  * 5    Payload data is in big-endian format.
  *      (If clear, it is in little-endian format.)
  * 6    A little-endian 4-byte CRC-32C code for the chunk is present
@@ -187,8 +193,26 @@ struct oskar_Binary
     int* user_index;            /* Tag index. */
     int64_t* payload_offset_bytes; /* Payload offset from start of file. */
     size_t* payload_size_bytes; /* Payload size.*/
+    size_t* stored_size_bytes;  /* Payload size in file, if compressed. */
     unsigned long* crc;         /* CRC-32C code. */
     unsigned long* crc_header;  /* CRC-32C code of payload identifier. */
+    unsigned char* flags;       /* Chunk flags. */
+    unsigned char* crc_checked; /* True if mapped payload CRC was checked. */
+
+    /* Hash table of tag identifiers, chained in file order. */
+    int hash_size;              /* Number of buckets (a power of two). */
+    int* hash_head;             /* First tag index in each bucket, or -1. */
+    int* hash_next;             /* Next tag index in the same bucket, or -1. */
+
+    /* Compression settings and work buffers. */
+    int compression;            /* Codec used to compress written payloads. */
+    int num_threads;            /* Number of threads for (de)compression. */
+    unsigned char* work[2];     /* Work buffers. */
+    size_t work_size[2];        /* Size of each work buffer, in bytes. */
+
+    /* Memory-mapped file contents, if opened in mode 'm'. */
+    unsigned char* map_data;    /* Start of mapped file, or NULL. */
+    size_t map_size;            /* Size of mapped file, in bytes. */
 
     /* Data tables used for CRC computation. */
     oskar_CRC* crc_data;
@@ -199,6 +223,36 @@ struct oskar_Binary
 typedef struct oskar_Binary oskar_Binary;
 #endif /* OSKAR_BINARY_TYPEDEF_ */
 
+/* Builds the hash table for the tags in the index. */
+void oskar_binary_index_build(oskar_Binary* handle);
+
+/* Returns the index of the first matching tag at or after the
+ * query search start, or -1 if not found. */
+int oskar_binary_index_find(const oskar_Binary* handle, int extended,
+        int data_type, int id_group, int id_tag, int user_index,
+        const char* name_group, const char* name_tag);
+
+/* Returns the maximum size of a compressed payload. */
+size_t oskar_binary_compress_bound(size_t size);
+
+/* Compresses a payload into dst, using a work buffer at least as large as
+ * the payload. Returns the size of the compressed payload. */
+size_t oskar_binary_compress(const void* data, size_t size, int data_type,
+        unsigned char* dst, unsigned char* work, int num_threads);
+
+/* Returns the uncompressed size given the start of a compressed payload. */
+size_t oskar_binary_compressed_size(const unsigned char* header);
+
+/* Decompresses a payload, using a work buffer at least as large as the
+ * uncompressed payload. */
+void oskar_binary_decompress(const unsigned char* src, size_t src_size,
+        void* data, size_t size, unsigned char* work, int num_threads,
+        int* status);
+
+/* Returns a work buffer of at least the given size. */
+unsigned char* oskar_binary_work(oskar_Binary* handle, int which,
+        size_t size);
+
 #ifdef __cplusplus
 }
 #endif
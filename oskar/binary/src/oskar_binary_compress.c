@@ -0,0 +1,398 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "binary/oskar_binary.h"
+#include "binary/private_binary.h"
+#include <string.h>
+#include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Compressed payloads have the following layout.
+ * All integers are little-endian.
+ *
+ * Offset  Length  Description
+ * ----------------------------------------------------------------------------
+ *  0      8       Uncompressed payload size in bytes.
+ *  8      4       Uncompressed size of each sub-block in bytes
+ *                 (except the last, which may be smaller).
+ * 12      1       Codec (OSKAR_BINARY_COMPRESSION_SHUFFLE_LZ).
+ * 13      1       Element size used for byte shuffling.
+ * 14      2       Reserved. (Must be 0.)
+ * 16      4 * n   Stored size of each of the n sub-blocks in bytes.
+ * 16+4n   ...     Sub-block data.
+ *
+ * Sub-blocks are compressed independently, so they can be processed in
+ * parallel. Within each sub-block, the bytes of each element are first
+ * shuffled so that byte 0 of all elements comes first, then byte 1, etc.,
+ * which groups the slowly-varying sign and exponent bytes of floating-point
+ * data. The shuffled bytes are then compressed using an LZ77 scheme with the
+ * same sequence format as LZ4. If a sub-block does not compress, its stored
+ * size equals its uncompressed size and the shuffled bytes are stored as-is.
+ */
+
+#define HEADER_SIZE 16
+#define SUB_BLOCK_SIZE (1 << 18)
+#define HASH_LOG 13
+#define MIN_MATCH 4
+#define LAST_LITERALS 5
+#define MF_LIMIT 12
+
+static unsigned int read32(const unsigned char* p)
+{
+    unsigned int v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static void put_le(unsigned char* p, size_t value, int num_bytes)
+{
+    int i;
+    for (i = 0; i < num_bytes; ++i, value >>= 8)
+        p[i] = (unsigned char) (value & 0xFF);
+}
+
+static size_t get_le(const unsigned char* p, int num_bytes)
+{
+    int i;
+    size_t value = 0;
+    for (i = num_bytes - 1; i >= 0; --i)
+        value = (value << 8) | p[i];
+    return value;
+}
+
+static size_t lz_bound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+static unsigned char* put_length(unsigned char* op, size_t len)
+{
+    for (; len >= 255; len -= 255) *op++ = 255;
+    *op++ = (unsigned char) len;
+    return op;
+}
+
+/* Returns the compressed size, or 0 if it would not be smaller. */
+static size_t lz_compress(const unsigned char* src, size_t size,
+        unsigned char* dst)
+{
+    unsigned int table[1 << HASH_LOG];
+    const unsigned char *ip = src, *anchor = src;
+    const unsigned char* const iend = src + size;
+    unsigned char* op = dst;
+    size_t lit;
+    if (size > MF_LIMIT)
+    {
+        const unsigned char* const mflimit = iend - MF_LIMIT;
+        const unsigned char* const matchlimit = iend - LAST_LITERALS;
+        memset(table, 0, sizeof(table));
+        while (ip < mflimit)
+        {
+            const unsigned char *ref, *mp, *rp;
+            size_t mlen;
+            const unsigned int seq = read32(ip);
+            const unsigned int h = (seq * 2654435761u) >> (32 - HASH_LOG);
+            ref = src + table[h];
+            table[h] = (unsigned int) (ip - src);
+            if (ref >= ip || ip - ref > 65535 || read32(ref) != seq)
+            {
+                /* Skip faster through data that does not compress. */
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            /* Extend the match backwards, then forwards. */
+            while (ip > anchor && ref > src && ip[-1] == ref[-1])
+            {
+                --ip;
+                --ref;
+            }
+            for (mp = ip + MIN_MATCH, rp = ref + MIN_MATCH;
+                    mp < matchlimit && *mp == *rp; ++mp, ++rp);
+            lit = (size_t) (ip - anchor);
+            mlen = (size_t) (mp - ip) - MIN_MATCH;
+            if ((size_t) (op - dst) + lit + lit / 255 + mlen / 255 + 5 >= size)
+                return 0;
+
+            /* Write the sequence. */
+            *op++ = (unsigned char) (((lit < 15 ? lit : 15) << 4) |
+                    (mlen < 15 ? mlen : 15));
+            if (lit >= 15) op = put_length(op, lit - 15);
+            memcpy(op, anchor, lit);
+            op += lit;
+            put_le(op, (size_t) (ip - ref), 2);
+            op += 2;
+            if (mlen >= 15) op = put_length(op, mlen - 15);
+            ip = anchor = mp;
+        }
+    }
+
+    /* Write the final literals. */
+    lit = (size_t) (iend - anchor);
+    if ((size_t) (op - dst) + lit + lit / 255 + 2 >= size)
+        return 0;
+    *op++ = (unsigned char) ((lit < 15 ? lit : 15) << 4);
+    if (lit >= 15) op = put_length(op, lit - 15);
+    memcpy(op, anchor, lit);
+    op += lit;
+    return (size_t) (op - dst);
+}
+
+/* Returns 0 on success, or 1 if the compressed data are invalid. */
+static int lz_decompress(const unsigned char* src, size_t src_size,
+        unsigned char* dst, size_t dst_size)
+{
+    const unsigned char* ip = src;
+    const unsigned char* const iend = src + src_size;
+    unsigned char* op = dst;
+    unsigned char* const oend = dst + dst_size;
+    while (ip < iend)
+    {
+        size_t lit, mlen, offset;
+        const unsigned int token = *ip++;
+        lit = token >> 4;
+        if (lit == 15)
+        {
+            unsigned int b;
+            do
+            {
+                if (ip >= iend) return 1;
+                b = *ip++;
+                lit += b;
+            } while (b == 255);
+        }
+        if (lit > (size_t) (iend - ip) || lit > (size_t) (oend - op))
+            return 1;
+        memcpy(op, ip, lit);
+        op += lit;
+        ip += lit;
+        if (ip >= iend) break;
+
+        /* Copy the match. */
+        if (iend - ip < 2) return 1;
+        offset = get_le(ip, 2);
+        ip += 2;
+        if (offset == 0 || offset > (size_t) (op - dst)) return 1;
+        mlen = token & 15;
+        if (mlen == 15)
+        {
+            unsigned int b;
+            do
+            {
+                if (ip >= iend) return 1;
+                b = *ip++;
+                mlen += b;
+            } while (b == 255);
+        }
+        mlen += MIN_MATCH;
+        if (mlen > (size_t) (oend - op)) return 1;
+        if (offset >= mlen)
+            memcpy(op, op - offset, mlen);
+        else
+        {
+            size_t i;
+            for (i = 0; i < mlen; ++i) op[i] = op[i - offset];
+        }
+        op += mlen;
+    }
+    return op == oend ? 0 : 1;
+}
+
+static void shuffle(const unsigned char* src, size_t size, size_t elem,
+        unsigned char* dst)
+{
+    size_t b, i;
+    const size_t n = size / elem;
+    for (b = 0; b < elem; ++b)
+        for (i = 0; i < n; ++i)
+            dst[b * n + i] = src[i * elem + b];
+    memcpy(dst + n * elem, src + n * elem, size - n * elem);
+}
+
+static void unshuffle(const unsigned char* src, size_t size, size_t elem,
+        unsigned char* dst)
+{
+    size_t b, i;
+    const size_t n = size / elem;
+    for (b = 0; b < elem; ++b)
+        for (i = 0; i < n; ++i)
+            dst[i * elem + b] = src[b * n + i];
+    memcpy(dst + n * elem, src + n * elem, size - n * elem);
+}
+
+static int get_num_threads(int num_threads)
+{
+#ifdef _OPENMP
+    return num_threads > 0 ? num_threads : omp_get_num_procs();
+#else
+    (void) num_threads;
+    return 1;
+#endif
+}
+
+size_t oskar_binary_compress_bound(size_t size)
+{
+    const size_t num_blocks = (size + SUB_BLOCK_SIZE - 1) / SUB_BLOCK_SIZE;
+    return HEADER_SIZE + num_blocks * (4 + lz_bound(SUB_BLOCK_SIZE));
+}
+
+size_t oskar_binary_compress(const void* data, size_t size, int data_type,
+        unsigned char* dst, unsigned char* work, int num_threads)
+{
+    int i;
+    size_t elem = 1, total = 0;
+    const int num_blocks = (int) ((size + SUB_BLOCK_SIZE - 1) / SUB_BLOCK_SIZE);
+    const size_t table_size = HEADER_SIZE + 4 * (size_t) num_blocks;
+    const size_t slot_size = lz_bound(SUB_BLOCK_SIZE);
+    if (data_type & OSKAR_DOUBLE)
+        elem = sizeof(double);
+    else if (data_type & (OSKAR_SINGLE | OSKAR_INT))
+        elem = 4;
+
+    /* Shuffle and compress each sub-block into its own slot. */
+    num_threads = get_num_threads(num_threads);
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+    for (i = 0; i < num_blocks; ++i)
+    {
+        const size_t offset = (size_t) i * SUB_BLOCK_SIZE;
+        const size_t block_size = (size - offset < SUB_BLOCK_SIZE) ?
+                size - offset : SUB_BLOCK_SIZE;
+        unsigned char* shuffled = work + offset;
+        unsigned char* slot = dst + table_size + (size_t) i * slot_size;
+        size_t stored;
+        shuffle((const unsigned char*) data + offset, block_size, elem,
+                shuffled);
+        stored = lz_compress(shuffled, block_size, slot);
+        if (stored == 0)
+        {
+            memcpy(slot, shuffled, block_size);
+            stored = block_size;
+        }
+        put_le(dst + HEADER_SIZE + 4 * (size_t) i, stored, 4);
+    }
+
+    /* Write the header, and pack the sub-blocks together. */
+    put_le(dst, size, 8);
+    put_le(dst + 8, SUB_BLOCK_SIZE, 4);
+    dst[12] = OSKAR_BINARY_COMPRESSION_SHUFFLE_LZ;
+    dst[13] = (unsigned char) elem;
+    dst[14] = dst[15] = 0;
+    total = table_size;
+    for (i = 0; i < num_blocks; ++i)
+    {
+        const size_t stored = get_le(dst + HEADER_SIZE + 4 * (size_t) i, 4);
+        memmove(dst + total, dst + table_size + (size_t) i * slot_size,
+                stored);
+        total += stored;
+    }
+    return total;
+}
+
+size_t oskar_binary_compressed_size(const unsigned char* header)
+{
+    return get_le(header, 8);
+}
+
+void oskar_binary_decompress(const unsigned char* src, size_t src_size,
+        void* data, size_t size, unsigned char* work, int num_threads,
+        int* status)
+{
+    int i, error = 0;
+    size_t *offsets, sub_block_size, elem;
+    if (*status) return;
+
+    /* Check the header. */
+    if (src_size < HEADER_SIZE || get_le(src, 8) != size ||
+            src[12] != OSKAR_BINARY_COMPRESSION_SHUFFLE_LZ ||
+            src[13] == 0 || get_le(src + 8, 4) == 0)
+    {
+        *status = OSKAR_ERR_BINARY_FORMAT_BAD;
+        return;
+    }
+    sub_block_size = get_le(src + 8, 4);
+    elem = src[13];
+    const int num_blocks = (int) ((size + sub_block_size - 1) / sub_block_size);
+    const size_t table_size = HEADER_SIZE + 4 * (size_t) num_blocks;
+    if (src_size < table_size)
+    {
+        *status = OSKAR_ERR_BINARY_FORMAT_BAD;
+        return;
+    }
+
+    /* Find the start of each sub-block. */
+    offsets = (size_t*) malloc((num_blocks + 1) * sizeof(size_t));
+    offsets[0] = table_size;
+    for (i = 0; i < num_blocks; ++i)
+        offsets[i + 1] = offsets[i] + get_le(src + HEADER_SIZE + 4 * i, 4);
+    if (offsets[num_blocks] != src_size)
+    {
+        free(offsets);
+        *status = OSKAR_ERR_BINARY_FORMAT_BAD;
+        return;
+    }
+
+    /* Decompress and unshuffle each sub-block. */
+    num_threads = get_num_threads(num_threads);
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+    for (i = 0; i < num_blocks; ++i)
+    {
+        const size_t offset = (size_t) i * sub_block_size;
+        const size_t block_size = (size - offset < sub_block_size) ?
+                size - offset : sub_block_size;
+        const size_t stored = offsets[i + 1] - offsets[i];
+        const unsigned char* in = src + offsets[i];
+        unsigned char* shuffled = work + offset;
+        if (stored != block_size)
+        {
+            if (lz_decompress(in, stored, shuffled, block_size))
+            {
+#pragma omp critical (oskar_binary_decompress)
+                error = 1;
+                continue;
+            }
+            in = shuffled;
+        }
+        unshuffle(in, block_size, elem, (unsigned char*) data + offset);
+    }
+    free(offsets);
+    if (error) *status = OSKAR_ERR_BINARY_FORMAT_BAD;
+}
+
+unsigned char* oskar_binary_work(oskar_Binary* handle, int which,
+        size_t size)
+{
+    if (handle->work_size[which] < size)
+    {
+        free(handle->work[which]);
+        handle->work[which] = (unsigned char*) malloc(size);
+        handle->work_size[which] = handle->work[which] ? size : 0;
+    }
+    return handle->work[which];
+}
+
+void oskar_binary_set_compression(oskar_Binary* handle, int codec,
+        int num_threads, int* status)
+{
+    if (*status) return;
+    if (codec != OSKAR_BINARY_COMPRESSION_NONE &&
+            codec != OSKAR_BINARY_COMPRESSION_SHUFFLE_LZ)
+    {
+        *status = OSKAR_ERR_BINARY_FORMAT_BAD;
+        return;
+    }
+    handle->compression = codec;
+    handle->num_threads = num_threads;
+}
+
+#ifdef __cplusplus
+}
+#endif
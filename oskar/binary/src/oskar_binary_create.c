@@ -35,6 +35,9 @@
 #ifndef _MSC_VER
 #include <sys/types.h>
 #endif
+#ifdef OSKAR_BINARY_HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,6 +46,7 @@ extern "C" {
 #define MIN(X,Y) ((X) < (Y) ? (X) : (Y))
 
 static void oskar_binary_resize(oskar_Binary* handle, int m);
+static void oskar_binary_map(oskar_Binary* handle);
 static void oskar_binary_read_header(FILE* stream, oskar_BinaryHeader* header,
         int* status);
 static void oskar_binary_write_header(FILE* stream, oskar_BinaryHeader* header,
@@ -62,7 +66,7 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
     int i;
 
     /* Open the file and check or write the header, depending on the mode. */
-    if (mode == 'r')
+    if (mode == 'r' || mode == 'm')
     {
         stream = fopen(filename, "rb");
         if (!stream)
@@ -128,7 +132,7 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
         oskar_BinaryTag tag;
         unsigned long crc;
         int format_version, element_size;
-        size_t block_size = 0, memcpy_size = 0;
+        size_t block_size = 0, memcpy_size = 0, skip_bytes = 0;
 
         /* Try to read a tag, and end the loop if unsuccessful. */
         if (fread(&tag, sizeof(oskar_BinaryTag), 1, stream) != 1)
@@ -137,7 +141,7 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
         /* If the bytes read are not a tag, or the reserved flag bits
          * are not zero, then return an error. */
         if (tag.magic[0] != 'T' || tag.magic[2] != 'G'
-                || (tag.flags & 0x1F) != 0)
+                || (tag.flags & 0x0F) != 0)
         {
             *status = OSKAR_ERR_BINARY_FILE_INVALID;
             break;
@@ -205,8 +209,11 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
         handle->user_index[i] = 0;
         handle->payload_offset_bytes[i] = 0;
         handle->payload_size_bytes[i] = 0;
+        handle->stored_size_bytes[i] = 0;
         handle->crc[i] = 0;
         handle->crc_header[i] = 0;
+        handle->flags[i] = tag.flags;
+        handle->crc_checked[i] = 0;
 
         /* Start computing the CRC code. */
         crc = oskar_crc_compute(handle->crc_data, &tag,
@@ -269,11 +276,29 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
         }
         handle->payload_offset_bytes[i] = cur_pos;
 
-        /* Increment stream pointer by payload size. */
+        /* If the payload is compressed, get its uncompressed size. */
+        handle->stored_size_bytes[i] = handle->payload_size_bytes[i];
+        if (tag.flags & (1 << 4))
+        {
+            unsigned char size_header[8];
+            if (handle->stored_size_bytes[i] < sizeof(size_header) ||
+                    fread(size_header, sizeof(size_header), 1, stream) != 1)
+            {
+                *status = OSKAR_ERR_BINARY_FILE_INVALID;
+                break;
+            }
+            handle->payload_size_bytes[i] =
+                    oskar_binary_compressed_size(size_header);
+            skip_bytes = handle->stored_size_bytes[i] - sizeof(size_header);
+        }
+        else
+            skip_bytes = handle->stored_size_bytes[i];
+
+        /* Increment stream pointer to the end of the payload. */
 #ifdef _MSC_VER
-        if (_fseeki64(stream, handle->payload_size_bytes[i], SEEK_CUR))
+        if (_fseeki64(stream, skip_bytes, SEEK_CUR))
 #else
-        if (fseeko(stream, (off_t) handle->payload_size_bytes[i], SEEK_CUR))
+        if (fseeko(stream, (off_t) skip_bytes, SEEK_CUR))
 #endif
         {
             *status = OSKAR_ERR_BINARY_SEEK_FAIL;
@@ -298,9 +323,38 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
         handle->num_chunks = i + 1;
     }
 
+    /* Build the hash table for tag queries. */
+    oskar_binary_index_build(handle);
+
+    /* Map the file into memory, if required. */
+    if (mode == 'm' && !*status)
+        oskar_binary_map(handle);
+
     return handle;
 }
 
+static void oskar_binary_map(oskar_Binary* handle)
+{
+#ifdef OSKAR_BINARY_HAVE_MMAP
+    void* ptr;
+    off_t size;
+    if (fseeko(handle->stream, 0, SEEK_END)) return;
+    size = ftello(handle->stream);
+    if (size <= 0) return;
+
+    /* Use a private, copy-on-write mapping, so that callers can modify
+     * data in place without affecting the file. */
+    ptr = mmap(0, (size_t) size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+            fileno(handle->stream), 0);
+    if (ptr == MAP_FAILED) return;
+    handle->map_data = (unsigned char*) ptr;
+    handle->map_size = (size_t) size;
+#else
+    /* Memory mapping is not available: fall back to stream reads. */
+    (void) handle;
+#endif
+}
+
 static void oskar_binary_resize(oskar_Binary* handle, int m)
 {
     handle->extended = (int*) realloc(handle->extended, m * sizeof(int));
@@ -315,10 +369,14 @@ static void oskar_binary_resize(oskar_Binary* handle, int m)
             handle->payload_offset_bytes, m * sizeof(int64_t));
     handle->payload_size_bytes = (size_t*) realloc(
             handle->payload_size_bytes, m * sizeof(size_t));
+    handle->stored_size_bytes = (size_t*) realloc(
+            handle->stored_size_bytes, m * sizeof(size_t));
     handle->crc = (unsigned long*) realloc(
             handle->crc, m * sizeof(unsigned long));
     handle->crc_header = (unsigned long*) realloc(
             handle->crc_header, m * sizeof(unsigned long));
+    handle->flags = (unsigned char*) realloc(handle->flags, m);
+    handle->crc_checked = (unsigned char*) realloc(handle->crc_checked, m);
 }
 
 static void oskar_binary_write_header(FILE* stream, oskar_BinaryHeader* header,
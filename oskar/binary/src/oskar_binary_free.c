@@ -29,6 +29,9 @@
 #include "binary/oskar_binary.h"
 #include "binary/private_binary.h"
 #include <stdlib.h>
+#ifdef OSKAR_BINARY_HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,6 +42,12 @@ void oskar_binary_free(oskar_Binary* handle)
     int i;
     if (!handle) return;
 
+    /* Unmap the file. */
+#ifdef OSKAR_BINARY_HAVE_MMAP
+    if (handle->map_data)
+        munmap(handle->map_data, handle->map_size);
+#endif
+
     /* Close the file. */
     if (handle->stream)
         fclose(handle->stream);
@@ -60,8 +69,15 @@ void oskar_binary_free(oskar_Binary* handle)
     free(handle->user_index);
     free(handle->payload_offset_bytes);
     free(handle->payload_size_bytes);
+    free(handle->stored_size_bytes);
+    free(handle->work[0]);
+    free(handle->work[1]);
     free(handle->crc);
     free(handle->crc_header);
+    free(handle->flags);
+    free(handle->crc_checked);
+    free(handle->hash_head);
+    free(handle->hash_next);
 
     /* Free the CRC data. */
     oskar_crc_free(handle->crc_data);
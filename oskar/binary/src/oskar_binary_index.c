@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "binary/oskar_binary.h"
+#include "binary/private_binary.h"
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static unsigned int oskar_binary_index_hash(int extended, int id_group,
+        int id_tag, int user_index)
+{
+    /* FNV-1a hash of the tag identifiers. */
+    int i;
+    unsigned int hash = 2166136261u;
+    const unsigned int key[] = {
+            (unsigned int) extended, (unsigned int) id_group,
+            (unsigned int) id_tag, (unsigned int) user_index
+    };
+    for (i = 0; i < 4; ++i)
+    {
+        int b;
+        for (b = 0; b < 4; ++b)
+        {
+            hash ^= (key[i] >> (8 * b)) & 0xFF;
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+void oskar_binary_index_build(oskar_Binary* handle)
+{
+    int i;
+    free(handle->hash_head);
+    free(handle->hash_next);
+    handle->hash_head = 0;
+    handle->hash_next = 0;
+    handle->hash_size = 0;
+    if (handle->num_chunks == 0) return;
+
+    /* Use a power-of-two number of buckets, at least twice the tag count. */
+    handle->hash_size = 16;
+    while (handle->hash_size < 2 * handle->num_chunks)
+        handle->hash_size *= 2;
+    handle->hash_head = (int*) malloc(handle->hash_size * sizeof(int));
+    handle->hash_next = (int*) malloc(handle->num_chunks * sizeof(int));
+    for (i = 0; i < handle->hash_size; ++i)
+        handle->hash_head[i] = -1;
+
+    /* Insert tags in reverse order, so that each bucket lists them in
+     * file order. This keeps the semantics of a linear search, which
+     * returns the first matching tag after the search start index. */
+    for (i = handle->num_chunks - 1; i >= 0; --i)
+    {
+        const unsigned int bucket = oskar_binary_index_hash(
+                handle->extended[i], handle->id_group[i],
+                handle->id_tag[i], handle->user_index[i]) &
+                (unsigned int) (handle->hash_size - 1);
+        handle->hash_next[i] = handle->hash_head[bucket];
+        handle->hash_head[bucket] = i;
+    }
+}
+
+int oskar_binary_index_find(const oskar_Binary* handle, int extended,
+        int data_type, int id_group, int id_tag, int user_index,
+        const char* name_group, const char* name_tag)
+{
+    int i;
+    const int start = handle->query_search_start;
+    if (handle->hash_head)
+    {
+        const unsigned int bucket = oskar_binary_index_hash(
+                extended, id_group, id_tag, user_index) &
+                (unsigned int) (handle->hash_size - 1);
+        i = handle->hash_head[bucket];
+    }
+    else
+        i = start;
+    while (i >= 0 && i < handle->num_chunks)
+    {
+        if (i >= start &&
+                handle->extended[i] == extended &&
+                ((handle->data_type[i] == data_type) || (!data_type)) &&
+                handle->id_group[i] == id_group &&
+                handle->id_tag[i] == id_tag &&
+                handle->user_index[i] == user_index &&
+                (!extended || (!strcmp(name_group, handle->name_group[i]) &&
+                        !strcmp(name_tag, handle->name_tag[i]))))
+            return i;
+        i = handle->hash_head ? handle->hash_next[i] : i + 1;
+    }
+    return -1;
+}
+
+#ifdef __cplusplus
+}
+#endif
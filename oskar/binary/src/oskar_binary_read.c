@@ -27,6 +27,7 @@
  */
 
 #include "binary/oskar_binary.h"
+#include "binary/oskar_endian.h"
 #include "binary/private_binary.h"
 #include <string.h>
 #include <stdlib.h>
@@ -39,17 +40,124 @@
 extern "C" {
 #endif
 
-void oskar_binary_read_block(oskar_Binary* handle,
-        int chunk_index, size_t data_size, void* data, int* status)
+static void oskar_binary_read_stream(oskar_Binary* handle,
+        int chunk_index, size_t size, void* data, int* status)
 {
     size_t bytes = 0, chunk_size = 1 << 29;
     char* p;
 
+    /* Copy the data out of the stream. */
+#ifdef _MSC_VER
+    if (_fseeki64(handle->stream,
+            handle->payload_offset_bytes[chunk_index], SEEK_SET) != 0)
+#else
+    if (fseeko(handle->stream,
+            (off_t) handle->payload_offset_bytes[chunk_index], SEEK_SET) != 0)
+#endif
+    {
+        *status = OSKAR_ERR_BINARY_SEEK_FAIL;
+        return;
+    }
+
+    /* Read the data in chunks of 2^29 bytes (512 MB). */
+    /* This works around a bug in some versions of fread() which are
+     * limited to reading a maximum of 2 GB at once. */
+    for (p = (char*)data, bytes = size;
+            bytes > 0; p += chunk_size)
+    {
+        if (bytes < chunk_size) chunk_size = bytes;
+        if (fread(p, 1, chunk_size, handle->stream) != chunk_size)
+        {
+            *status = OSKAR_ERR_BINARY_READ_FAIL;
+            return;
+        }
+        bytes -= chunk_size;
+    }
+}
+
+static int oskar_binary_crc_ok(const oskar_Binary* handle,
+        int chunk_index, const void* payload)
+{
+    unsigned long crc;
+    crc = handle->crc_header[chunk_index];
+    crc = oskar_crc_update(handle->crc_data, crc, payload,
+            handle->stored_size_bytes[chunk_index]);
+    return crc == handle->crc[chunk_index];
+}
+
+static void* oskar_binary_mapped_payload(oskar_Binary* handle,
+        int chunk_index, int* status)
+{
+    const size_t offset = (size_t) handle->payload_offset_bytes[chunk_index];
+    const size_t size = handle->stored_size_bytes[chunk_index];
+    unsigned char* ptr = handle->map_data + offset;
+    if (offset + size > handle->map_size)
+    {
+        *status = OSKAR_ERR_BINARY_READ_FAIL;
+        return 0;
+    }
+
+    /* Check CRC-32 code, if present, the first time the payload is used. */
+    if (handle->crc[chunk_index] && !handle->crc_checked[chunk_index])
+    {
+        if (!oskar_binary_crc_ok(handle, chunk_index, ptr))
+        {
+            *status = OSKAR_ERR_BINARY_CRC_FAIL;
+            return 0;
+        }
+        handle->crc_checked[chunk_index] = 1;
+    }
+    return ptr;
+}
+
+static void oskar_binary_read_compressed(oskar_Binary* handle,
+        int chunk_index, void* data, int* status)
+{
+    const unsigned char* src;
+    const size_t stored_size = handle->stored_size_bytes[chunk_index];
+
+    /* Get the compressed payload from the mapped file or the stream. */
+    if (handle->map_data)
+        src = (const unsigned char*) oskar_binary_mapped_payload(handle,
+                chunk_index, status);
+    else
+    {
+        unsigned char* buffer = oskar_binary_work(handle, 0, stored_size);
+        if (!buffer)
+        {
+            *status = OSKAR_ERR_BINARY_MEMORY_NOT_ALLOCATED;
+            return;
+        }
+        oskar_binary_read_stream(handle, chunk_index, stored_size,
+                buffer, status);
+        if (!*status && handle->crc[chunk_index] &&
+                !oskar_binary_crc_ok(handle, chunk_index, buffer))
+            *status = OSKAR_ERR_BINARY_CRC_FAIL;
+        src = buffer;
+    }
+    if (*status) return;
+
+    /* Decompress the payload. */
+    unsigned char* work = oskar_binary_work(handle, 1,
+            handle->payload_size_bytes[chunk_index]);
+    if (!work)
+    {
+        *status = OSKAR_ERR_BINARY_MEMORY_NOT_ALLOCATED;
+        return;
+    }
+    oskar_binary_decompress(src, stored_size, data,
+            handle->payload_size_bytes[chunk_index], work,
+            handle->num_threads, status);
+}
+
+void oskar_binary_read_block(oskar_Binary* handle,
+        int chunk_index, size_t data_size, void* data, int* status)
+{
     /* Check if safe to proceed. */
     if (*status) return;
 
     /* Check file was opened for reading. */
-    if (handle->open_mode != 'r')
+    if (handle->open_mode != 'r' && handle->open_mode != 'm')
     {
         *status = OSKAR_ERR_BINARY_NOT_OPEN_FOR_READ;
         return;
@@ -72,44 +180,71 @@ void oskar_binary_read_block(oskar_Binary* handle,
         return;
     }
 
-    /* Copy the data out of the stream. */
-#ifdef _MSC_VER
-    if (_fseeki64(handle->stream,
-            handle->payload_offset_bytes[chunk_index], SEEK_SET) != 0)
-#else
-    if (fseeko(handle->stream,
-            (off_t) handle->payload_offset_bytes[chunk_index], SEEK_SET) != 0)
-#endif
+    /* Check for a compressed payload. */
+    if (handle->flags[chunk_index] & (1 << 4))
     {
-        *status = OSKAR_ERR_BINARY_SEEK_FAIL;
+        oskar_binary_read_compressed(handle, chunk_index, data, status);
         return;
     }
 
-    /* Read the data in chunks of 2^29 bytes (512 MB). */
-    /* This works around a bug in some versions of fread() which are
-     * limited to reading a maximum of 2 GB at once. */
-    for (p = (char*)data, bytes = handle->payload_size_bytes[chunk_index];
-            bytes > 0; p += chunk_size)
+    /* Copy the data out of the mapped file, if available. */
+    if (handle->map_data)
     {
-        if (bytes < chunk_size) chunk_size = bytes;
-        if (fread(p, 1, chunk_size, handle->stream) != chunk_size)
-        {
-            *status = OSKAR_ERR_BINARY_READ_FAIL;
-            return;
-        }
-        bytes -= chunk_size;
+        const void* ptr = oskar_binary_mapped_payload(handle,
+                chunk_index, status);
+        if (!*status)
+            memcpy(data, ptr, handle->payload_size_bytes[chunk_index]);
+        return;
     }
 
+    /* Otherwise, copy the data out of the stream. */
+    oskar_binary_read_stream(handle, chunk_index,
+            handle->payload_size_bytes[chunk_index], data, status);
+    if (*status) return;
+
     /* Check CRC-32 code, if present. */
-    if (handle->crc[chunk_index])
+    if (handle->crc[chunk_index] &&
+            !oskar_binary_crc_ok(handle, chunk_index, data))
+        *status = OSKAR_ERR_BINARY_CRC_FAIL;
+}
+
+void* oskar_binary_map_block(oskar_Binary* handle, int chunk_index,
+        int* status)
+{
+    size_t align = 1;
+    if (*status) return 0;
+
+    /* Check file was opened for reading. */
+    if (handle->open_mode != 'r' && handle->open_mode != 'm')
     {
-        unsigned long crc;
-        crc = handle->crc_header[chunk_index];
-        crc = oskar_crc_update(handle->crc_data, crc, data,
-                handle->payload_size_bytes[chunk_index]);
-        if (crc != handle->crc[chunk_index])
-            *status = OSKAR_ERR_BINARY_CRC_FAIL;
+        *status = OSKAR_ERR_BINARY_NOT_OPEN_FOR_READ;
+        return 0;
+    }
+
+    /* Check index is in range. */
+    if (chunk_index < 0 || chunk_index >= handle->num_chunks)
+    {
+        *status = OSKAR_ERR_BINARY_TAG_OUT_OF_RANGE;
+        return 0;
     }
+
+    /* Check the payload can be used in place. */
+    const int type = handle->data_type[chunk_index];
+    if (!handle->map_data || handle->payload_size_bytes[chunk_index] == 0 ||
+            (handle->flags[chunk_index] & (1 << 4)))
+        return 0;
+    if (((handle->flags[chunk_index] & (1 << 5)) ? 1 : 0) !=
+            (oskar_endian() != OSKAR_LITTLE_ENDIAN ? 1 : 0))
+        return 0;
+    if (type & OSKAR_DOUBLE)
+        align = sizeof(double);
+    else if (type & OSKAR_SINGLE)
+        align = sizeof(float);
+    else if (type & OSKAR_INT)
+        align = sizeof(int);
+    if (handle->payload_offset_bytes[chunk_index] % align != 0)
+        return 0;
+    return oskar_binary_mapped_payload(handle, chunk_index, status);
 }
 
 void oskar_binary_read(oskar_Binary* handle,
@@ -120,7 +255,7 @@ void oskar_binary_read(oskar_Binary* handle,
     if (*status) return;
 
     /* Check file was opened for reading. */
-    if (handle->open_mode != 'r')
+    if (handle->open_mode != 'r' && handle->open_mode != 'm')
     {
         *status = OSKAR_ERR_BINARY_NOT_OPEN_FOR_READ;
         return;
@@ -154,7 +289,7 @@ void oskar_binary_read_ext(oskar_Binary* handle,
     if (*status) return;
 
     /* Check file was opened for reading. */
-    if (handle->open_mode != 'r')
+    if (handle->open_mode != 'r' && handle->open_mode != 'm')
     {
         *status = OSKAR_ERR_BINARY_NOT_OPEN_FOR_READ;
         return;
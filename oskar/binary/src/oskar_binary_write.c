@@ -36,6 +36,28 @@
 extern "C" {
 #endif
 
+/* Returns the payload to write, compressing it if enabled and worthwhile. */
+static const void* oskar_binary_write_payload(oskar_Binary* handle,
+        unsigned char data_type, const void* data, size_t* data_size,
+        unsigned char* flags)
+{
+    size_t compressed_size;
+    unsigned char *dst, *work;
+    if (!handle->compression || !data || *data_size < 4096 ||
+            (data_type & OSKAR_CHAR))
+        return data;
+    dst = oskar_binary_work(handle, 0,
+            oskar_binary_compress_bound(*data_size));
+    work = oskar_binary_work(handle, 1, *data_size);
+    if (!dst || !work) return data;
+    compressed_size = oskar_binary_compress(data, *data_size, data_type,
+            dst, work, handle->num_threads);
+    if (compressed_size >= *data_size) return data;
+    *data_size = compressed_size;
+    *flags |= (1 << 4); /* Set bit 4 to indicate compressed payload. */
+    return dst;
+}
+
 void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
         unsigned char id_group, unsigned char id_tag, int user_index,
         size_t data_size, const void* data, int* status)
@@ -85,6 +107,8 @@ void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
     tag.flags = 0;
     tag.flags |= (1 << 6); /* Set bit 6 to indicate CRC-32C code added. */
     tag.data_type = data_type;
+    data = oskar_binary_write_payload(handle, data_type, data, &data_size,
+            &tag.flags);
     tag.group.id = id_group;
     tag.tag.id = id_tag;
 
@@ -135,6 +159,35 @@ void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
         *status = OSKAR_ERR_BINARY_WRITE_FAIL;
 }
 
+void oskar_binary_write_padding(oskar_Binary* handle, unsigned char id_group,
+        unsigned char id_tag, int user_index, size_t alignment, int* status)
+{
+    long pos;
+    size_t offset, num_padding;
+    char* padding;
+    if (*status || alignment < 2) return;
+
+    /* Find where the next payload would start after an empty padding block:
+     * its tag and CRC code, followed by the tag of the next block. */
+    pos = ftell(handle->stream);
+    if (pos < 0)
+    {
+        *status = OSKAR_ERR_BINARY_SEEK_FAIL;
+        return;
+    }
+    offset = (size_t)pos + 2 * sizeof(oskar_BinaryTag) + 4;
+    num_padding = (alignment - offset % alignment) % alignment;
+    padding = (char*) calloc(num_padding + 1, 1);
+    if (!padding)
+    {
+        *status = OSKAR_ERR_BINARY_MEMORY_NOT_ALLOCATED;
+        return;
+    }
+    oskar_binary_write(handle, OSKAR_CHAR, id_group, id_tag, user_index,
+            num_padding, padding, status);
+    free(padding);
+}
+
 void oskar_binary_write_double(oskar_Binary* handle, unsigned char id_group,
         unsigned char id_tag, int user_index, double value, int* status)
 {
@@ -208,6 +261,8 @@ void oskar_binary_write_ext(oskar_Binary* handle, unsigned char data_type,
     tag.flags |= (1 << 7); /* Set bit 7 to indicate that tag is extended. */
     tag.flags |= (1 << 6); /* Set bit 6 to indicate CRC-32C code added. */
     tag.data_type = data_type;
+    data = oskar_binary_write_payload(handle, data_type, data, &data_size,
+            &tag.flags);
     tag.group.bytes = 1 + (unsigned char)lgroup;
     tag.tag.bytes = 1 + (unsigned char)ltag;
 
@@ -176,6 +176,212 @@ int main(void)
     oskar_binary_free(h);
     ASSERT_INT_EQ(0, status);
 
+    /* Read the arrays back from the memory-mapped file. */
+    h = oskar_binary_create(filename, 'm', &status);
+    ASSERT_INT_EQ(0, status);
+    {
+        int chunk;
+        const int* mapped_int;
+        data_double = (double*) calloc(num_elements_double, sizeof(double));
+        oskar_binary_read(h, OSKAR_DOUBLE,
+                1, 10, 987654321, size_double, &data_double[0], &status);
+        ASSERT_INT_EQ(0, status);
+        for (i = 0; i < num_elements_double; ++i)
+            ASSERT_DOUBLE_EQ(i + 1000.0, data_double[i]);
+        free(data_double);
+        chunk = oskar_binary_query(h, OSKAR_INT, 14, 5, 6, 0, &status);
+        mapped_int = (const int*) oskar_binary_map_block(h, chunk, &status);
+        ASSERT_INT_EQ(0, status);
+#ifndef _WIN32
+        if (!mapped_int)
+        {
+            printf("Assert: payload not mapped (%s:%i)\n",
+                    __FILE__, __LINE__);
+            exit(1);
+        }
+#endif
+        if (mapped_int)
+            for (i = 0; i < num_elements_int; ++i)
+                ASSERT_INT_EQ(i * 75, mapped_int[i]);
+        oskar_binary_read_int(h, 12, 0, 0, &b, &status);
+        ASSERT_INT_EQ(0, status);
+        ASSERT_INT_EQ(b1, b);
+    }
+    oskar_binary_free(h);
+
+    /* Write and query a large number of tags. */
+    {
+        const int num_tags = 5000;
+        h = oskar_binary_create(filename, 'w', &status);
+        for (i = 0; i < num_tags; ++i)
+        {
+            oskar_binary_write_int(h, (unsigned char) (i % 7),
+                    (unsigned char) (i % 3), i / 21, i, &status);
+            oskar_binary_write_ext_int(h, "group", "tag", i, -i, &status);
+        }
+        ASSERT_INT_EQ(0, status);
+        oskar_binary_free(h);
+        h = oskar_binary_create(filename, 'r', &status);
+        ASSERT_INT_EQ(2 * num_tags, oskar_binary_num_tags(h));
+        for (i = num_tags - 1; i >= 0; i -= 3)
+        {
+            oskar_binary_read_int(h, (unsigned char) (i % 7),
+                    (unsigned char) (i % 3), i / 21, &a, &status);
+            ASSERT_INT_EQ(0, status);
+            ASSERT_INT_EQ(i, a);
+            oskar_binary_read_ext_int(h, "group", "tag", i, &a, &status);
+            ASSERT_INT_EQ(0, status);
+            ASSERT_INT_EQ(-i, a);
+        }
+
+        /* Check that the search start index is respected. */
+        oskar_binary_set_query_search_start(h, 2 * num_tags - 2, &status);
+        oskar_binary_read_int(h, 0, 0, 0, &a, &status);
+        ASSERT_INT_EQ((int) OSKAR_ERR_BINARY_TAG_NOT_FOUND, status);
+        status = 0;
+        oskar_binary_read_ext_int(h, "group", "tag", num_tags - 1, &a, &status);
+        ASSERT_INT_EQ(0, status);
+        ASSERT_INT_EQ(-(num_tags - 1), a);
+        oskar_binary_free(h);
+    }
+
+    /* Write compressed arrays and read them back. */
+    {
+        const int num_smooth = 300000, num_random = 5000;
+        double* smooth = (double*) calloc(num_smooth, sizeof(double));
+        int* random = (int*) calloc(num_random, sizeof(int));
+        double* smooth_in = (double*) calloc(num_smooth, sizeof(double));
+        int* random_in = (int*) calloc(num_random, sizeof(int));
+        size_t file_size = 0;
+        FILE* stream;
+        int pass;
+        for (i = 0; i < num_smooth; ++i)
+            smooth[i] = 100.0 * (double) (i / 1000);
+        srand(1);
+        for (i = 0; i < num_random; ++i)
+            random[i] = rand();
+        h = oskar_binary_create(filename, 'w', &status);
+        oskar_binary_set_compression(h, OSKAR_BINARY_COMPRESSION_SHUFFLE_LZ,
+                2, &status);
+        ASSERT_INT_EQ(0, status);
+        oskar_binary_write(h, OSKAR_DOUBLE, 1, 2, 3,
+                num_smooth * sizeof(double), smooth, &status);
+        oskar_binary_write_ext(h, OSKAR_INT, "noise", "data", 0,
+                num_random * sizeof(int), random, &status);
+        oskar_binary_write_int(h, 4, 5, 6, a1, &status);
+        ASSERT_INT_EQ(0, status);
+        oskar_binary_free(h);
+
+        /* Check that the smooth data were compressed. */
+        stream = fopen(filename, "rb");
+        if (stream)
+        {
+            fseek(stream, 0, SEEK_END);
+            file_size = (size_t) ftell(stream);
+            fclose(stream);
+        }
+        if (file_size == 0 || file_size >= num_smooth * sizeof(double) / 4)
+        {
+            printf("Assert: file not compressed (%s:%i)\n",
+                    __FILE__, __LINE__);
+            exit(1);
+        }
+
+        /* Read the data using both normal and memory-mapped access. */
+        for (pass = 0; pass < 2; ++pass)
+        {
+            int chunk;
+            memset(smooth_in, 0, num_smooth * sizeof(double));
+            memset(random_in, 0, num_random * sizeof(int));
+            h = oskar_binary_create(filename, pass ? 'm' : 'r', &status);
+            ASSERT_INT_EQ(0, status);
+            chunk = oskar_binary_query(h, OSKAR_DOUBLE, 1, 2, 3, 0, &status);
+            ASSERT_INT_EQ(0, status);
+            ASSERT_INT_EQ((int) (num_smooth * sizeof(double)),
+                    (int) oskar_binary_tag_payload_size(h, chunk));
+            if (oskar_binary_map_block(h, chunk, &status))
+            {
+                printf("Assert: compressed payload mapped (%s:%i)\n",
+                        __FILE__, __LINE__);
+                exit(1);
+            }
+            oskar_binary_read(h, OSKAR_DOUBLE, 1, 2, 3,
+                    num_smooth * sizeof(double), smooth_in, &status);
+            ASSERT_INT_EQ(0, status);
+            for (i = 0; i < num_smooth; ++i)
+                ASSERT_DOUBLE_EQ(smooth[i], smooth_in[i]);
+            oskar_binary_read_ext(h, OSKAR_INT, "noise", "data", 0,
+                    num_random * sizeof(int), random_in, &status);
+            ASSERT_INT_EQ(0, status);
+            for (i = 0; i < num_random; ++i)
+                ASSERT_INT_EQ(random[i], random_in[i]);
+            oskar_binary_read_int(h, 4, 5, 6, &a, &status);
+            ASSERT_INT_EQ(0, status);
+            ASSERT_INT_EQ(a1, a);
+            oskar_binary_free(h);
+        }
+
+        /* Check that a corrupted compressed payload is detected. */
+        stream = fopen(filename, "r+b");
+        if (stream)
+        {
+            unsigned char byte = 0;
+            fseek(stream, 200, SEEK_SET);
+            if (fread(&byte, 1, 1, stream) == 1)
+            {
+                byte ^= 0xFF;
+                fseek(stream, 200, SEEK_SET);
+                fwrite(&byte, 1, 1, stream);
+            }
+            fclose(stream);
+        }
+        h = oskar_binary_create(filename, 'r', &status);
+        ASSERT_INT_EQ(0, status);
+        oskar_binary_read(h, OSKAR_DOUBLE, 1, 2, 3,
+                num_smooth * sizeof(double), smooth_in, &status);
+        ASSERT_INT_EQ((int) OSKAR_ERR_BINARY_CRC_FAIL, status);
+        status = 0;
+        oskar_binary_free(h);
+        free(smooth);
+        free(random);
+        free(smooth_in);
+        free(random_in);
+    }
+
+    /* Write padding to align a payload, and check it is mapped aligned. */
+    for (i = 0; i < 16; ++i)
+    {
+        char prefix[16];
+        int chunk;
+        const double* mapped_double;
+        double value = 0.0;
+        memset(prefix, 0, sizeof(prefix));
+        h = oskar_binary_create(filename, 'w', &status);
+        oskar_binary_write(h, OSKAR_CHAR, 1, 1, 0, i, prefix, &status);
+        oskar_binary_write_padding(h, 1, 2, 0, 16, &status);
+        oskar_binary_write_double(h, 1, 3, 0, 1.5, &status);
+        ASSERT_INT_EQ(0, status);
+        oskar_binary_free(h);
+        h = oskar_binary_create(filename, 'm', &status);
+        ASSERT_INT_EQ(3, oskar_binary_num_tags(h));
+        chunk = oskar_binary_query(h, OSKAR_DOUBLE, 1, 3, 0, 0, &status);
+        mapped_double = (const double*) oskar_binary_map_block(
+                h, chunk, &status);
+        ASSERT_INT_EQ(0, status);
+#ifndef _WIN32
+        if (!mapped_double || ((size_t) mapped_double) % 16 != 0)
+        {
+            printf("Assert: payload not mapped aligned (%s:%i)\n",
+                    __FILE__, __LINE__);
+            exit(1);
+        }
+#endif
+        oskar_binary_read_double(h, 1, 3, 0, &value, &status);
+        ASSERT_INT_EQ(0, status);
+        ASSERT_DOUBLE_EQ(1.5, value);
+        oskar_binary_free(h);
+    }
+
     /* Remove the file. */
     remove(filename);
 
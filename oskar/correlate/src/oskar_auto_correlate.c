@@ -6,6 +6,7 @@
 #include "correlate/define_auto_correlate.h"
 #include "correlate/define_correlate_utils.h"
 #include "correlate/oskar_auto_correlate.h"
+#include "correlate/oskar_correlate_planar_omp.h"
 #include "math/define_multiply.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_kernel_macros.h"
@@ -36,7 +37,7 @@ void oskar_auto_correlate(
         *status = OSKAR_ERR_LOCATION_MISMATCH;
         return;
     }
-    if (oskar_mem_type(jones_) != oskar_mem_type(vis))
+    if (oskar_jones_type(jones) != oskar_mem_type(vis))
     {
         *status = OSKAR_ERR_TYPE_MISMATCH;
         return;
@@ -46,7 +47,35 @@ void oskar_auto_correlate(
         *status = OSKAR_ERR_DIMENSION_MISMATCH;
         return;
     }
-    if (location == OSKAR_CPU)
+    if (oskar_jones_is_planar(jones))
+    {
+        const int matrix = oskar_mem_is_matrix(vis);
+        const int num_components = matrix ? 8 : 2;
+        const size_t stride = oskar_jones_component_stride(jones);
+        if (oskar_mem_precision(vis) == OSKAR_DOUBLE)
+        {
+            oskar_auto_correlate_planar_omp_d(num_sources, num_stations,
+                    offset_out, num_components, stride,
+                    oskar_mem_double_const(jones_, status),
+                    oskar_mem_double_const(src_flux[0], status),
+                    matrix ? oskar_mem_double_const(src_flux[1], status) : 0,
+                    matrix ? oskar_mem_double_const(src_flux[2], status) : 0,
+                    matrix ? oskar_mem_double_const(src_flux[3], status) : 0,
+                    oskar_mem_double(vis, status));
+        }
+        else
+        {
+            oskar_auto_correlate_planar_omp_f(num_sources, num_stations,
+                    offset_out, num_components, stride,
+                    oskar_mem_float_const(jones_, status),
+                    oskar_mem_float_const(src_flux[0], status),
+                    matrix ? oskar_mem_float_const(src_flux[1], status) : 0,
+                    matrix ? oskar_mem_float_const(src_flux[2], status) : 0,
+                    matrix ? oskar_mem_float_const(src_flux[3], status) : 0,
+                    oskar_mem_float(vis, status));
+        }
+    }
+    else if (location == OSKAR_CPU)
     {
         switch (oskar_mem_type(vis))
         {
@@ -93,18 +122,22 @@ void oskar_auto_correlate(
     }
     else
     {
+        static const oskar_DeviceKernel* kernel[4] = {0, 0, 0, 0};
         size_t local_size[] = {128, 1, 1}, global_size[] = {1, 1, 1};
         const char* k = 0;
+        int i = 0;
         switch (oskar_mem_type(vis))
         {
-        case OSKAR_SINGLE_COMPLEX_MATRIX: k = "acorr_float"; break;
-        case OSKAR_DOUBLE_COMPLEX_MATRIX: k = "acorr_double"; break;
-        case OSKAR_SINGLE_COMPLEX:        k = "acorr_scalar_float"; break;
-        case OSKAR_DOUBLE_COMPLEX:        k = "acorr_scalar_double"; break;
+        case OSKAR_SINGLE_COMPLEX_MATRIX: i = 0; k = "acorr_float"; break;
+        case OSKAR_DOUBLE_COMPLEX_MATRIX: i = 1; k = "acorr_double"; break;
+        case OSKAR_SINGLE_COMPLEX:   i = 2; k = "acorr_scalar_float"; break;
+        case OSKAR_DOUBLE_COMPLEX:   i = 3; k = "acorr_scalar_double"; break;
         default:
             *status = OSKAR_ERR_BAD_DATA_TYPE;
             return;
         }
+        const oskar_DeviceKernel* handle =
+                oskar_device_kernel_cached(&kernel[i], k);
         oskar_device_check_local_size(location, 0, local_size);
         global_size[0] = num_stations * local_size[0];
         const oskar_Arg args[] = {
@@ -121,8 +154,8 @@ void oskar_auto_correlate(
         const size_t arg_size_local[] = {
                 local_size[0] * oskar_mem_element_size(oskar_mem_type(vis))
         };
-        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
-                sizeof(args) / sizeof(oskar_Arg), args,
+        oskar_device_launch_kernel_handle(handle, location, 1,
+                local_size, global_size, sizeof(args) / sizeof(oskar_Arg), args,
                 1, arg_size_local, status);
     }
 }
@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "correlate/define_correlate_utils.h"
+#include "correlate/oskar_correlate_planar_omp.h"
+#include "utility/oskar_kernel_macros.h"
+
+#include <cmath>
+
+// In the planar layout, component k of Jones matrix i is at
+// (k * stride + i), so each of the eight real components is loaded from
+// its own contiguous array and the loops over sources can be vectorised.
+// Sums are accumulated in double precision, which replaces the
+// Kahan summation used by the interleaved single-precision kernels.
+
+template<typename REAL>
+struct Matrix
+{
+    REAL ar, ai, br, bi, cr, ci, dr, di;
+};
+
+template<typename REAL>
+static inline void load(Matrix<REAL>& m, const REAL* const* c, int i)
+{
+    m.ar = c[0][i]; m.ai = c[1][i]; m.br = c[2][i]; m.bi = c[3][i];
+    m.cr = c[4][i]; m.ci = c[5][i]; m.dr = c[6][i]; m.di = c[7][i];
+}
+
+// Forms M = P * B * Q^H, where B is the source brightness matrix
+// [I + Q, U + iV; U - iV, I - Q].
+template<typename REAL>
+static inline void brightness_product(Matrix<REAL>& m,
+        const Matrix<REAL>& p, const Matrix<REAL>& q,
+        const REAL I, const REAL Q, const REAL U, const REAL V)
+{
+    const REAL ba = I + Q, bd = I - Q;
+    const REAL t_ar = p.ar * ba + p.br * U + p.bi * V;
+    const REAL t_ai = p.ai * ba + p.bi * U - p.br * V;
+    const REAL t_br = p.br * bd + p.ar * U - p.ai * V;
+    const REAL t_bi = p.bi * bd + p.ar * V + p.ai * U;
+    const REAL t_cr = p.cr * ba + p.dr * U + p.di * V;
+    const REAL t_ci = p.ci * ba + p.di * U - p.dr * V;
+    const REAL t_dr = p.dr * bd + p.cr * U - p.ci * V;
+    const REAL t_di = p.di * bd + p.cr * V + p.ci * U;
+    m.ar = t_ar * q.ar + t_ai * q.ai + t_br * q.br + t_bi * q.bi;
+    m.ai = t_ai * q.ar - t_ar * q.ai + t_bi * q.br - t_br * q.bi;
+    m.br = t_ar * q.cr + t_ai * q.ci + t_br * q.dr + t_bi * q.di;
+    m.bi = t_ai * q.cr - t_ar * q.ci + t_bi * q.dr - t_br * q.di;
+    m.cr = t_cr * q.ar + t_ci * q.ai + t_dr * q.br + t_di * q.bi;
+    m.ci = t_ci * q.ar - t_cr * q.ai + t_di * q.br - t_dr * q.bi;
+    m.dr = t_cr * q.cr + t_ci * q.ci + t_dr * q.dr + t_di * q.di;
+    m.di = t_ci * q.cr - t_cr * q.ci + t_di * q.dr - t_dr * q.di;
+}
+
+template
+<
+// Compile-time parameters.
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN, bool MATRIX,
+typename REAL
+>
+void oskar_xcorr_planar_omp(
+        const int                    num_sources,
+        const int                    num_stations,
+        const int                    offset_out,
+        const size_t                 stride,
+        const REAL*   const RESTRICT jones,
+        const REAL*   const RESTRICT source_I,
+        const REAL*   const RESTRICT source_Q,
+        const REAL*   const RESTRICT source_U,
+        const REAL*   const RESTRICT source_V,
+        const REAL*   const RESTRICT source_l,
+        const REAL*   const RESTRICT source_m,
+        const REAL*   const RESTRICT source_n,
+        const REAL*   const RESTRICT source_a,
+        const REAL*   const RESTRICT source_b,
+        const REAL*   const RESTRICT source_c,
+        const REAL*   const RESTRICT station_u,
+        const REAL*   const RESTRICT station_v,
+        const REAL*   const RESTRICT station_w,
+        const REAL*   const RESTRICT station_x,
+        const REAL*   const RESTRICT station_y,
+        const REAL                   uv_min_lambda,
+        const REAL                   uv_max_lambda,
+        const REAL                   inv_wavelength,
+        const REAL                   frac_bandwidth,
+        const REAL                   time_int_sec,
+        const REAL                   gha0_rad,
+        const REAL                   dec0_rad,
+        REAL*               RESTRICT vis)
+{
+    const int num_components = MATRIX ? 8 : 2;
+
+    // Loop over stations.
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int SQ = 0; SQ < num_stations; ++SQ)
+    {
+        // Pointers to source vectors for station q.
+        const REAL* station_q[8];
+        for (int k = 0; k < num_components; ++k)
+            station_q[k] = jones + k * stride + (size_t) SQ * num_sources;
+
+        // Loop over baselines for this station.
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            REAL uv_len, uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;
+            double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+            double s4 = 0.0, s5 = 0.0, s6 = 0.0, s7 = 0.0;
+
+            // Pointers to source vectors for station p.
+            const REAL* station_p[8];
+            for (int k = 0; k < num_components; ++k)
+                station_p[k] = jones + k * stride + (size_t) SP * num_sources;
+
+            // Get common baseline values.
+            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
+                    station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],
+                    uu, vv, ww, uu2, vv2, uuvv, uv_len);
+
+            // Apply the baseline length filter.
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+
+            // Compute the deltas for time-average smearing.
+            if (TIME_SMEARING)
+                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
+                        station_y[SP], station_y[SQ], du, dv, dw);
+
+            // Sum over sources.
+            OMP_SIMD_SUM(s0, s1, s2, s3, s4, s5, s6, s7)
+            for (int i = 0; i < num_sources; ++i)
+            {
+                REAL smearing;
+                if (GAUSSIAN)
+                {
+                    const REAL t = source_a[i] * uu2 + source_b[i] * uuvv +
+                            source_c[i] * vv2;
+                    smearing = exp((REAL) -t);
+                }
+                else smearing = (REAL) 1;
+                if (BANDWIDTH_SMEARING || TIME_SMEARING)
+                {
+                    const REAL l = source_l[i];
+                    const REAL m = source_m[i];
+                    const REAL n = source_n[i] - (REAL) 1;
+                    if (BANDWIDTH_SMEARING)
+                    {
+                        const REAL t = uu * l + vv * m + ww * n;
+                        smearing *= OSKAR_SINC(REAL, t);
+                    }
+                    if (TIME_SMEARING)
+                    {
+                        const REAL t = du * l + dv * m + dw * n;
+                        smearing *= OSKAR_SINC(REAL, t);
+                    }
+                }
+                if (MATRIX)
+                {
+                    Matrix<REAL> p, q, m;
+                    load(p, station_p, i);
+                    load(q, station_q, i);
+                    brightness_product(m, p, q, source_I[i], source_Q[i],
+                            source_U[i], source_V[i]);
+                    s0 += m.ar * smearing; s1 += m.ai * smearing;
+                    s2 += m.br * smearing; s3 += m.bi * smearing;
+                    s4 += m.cr * smearing; s5 += m.ci * smearing;
+                    s6 += m.dr * smearing; s7 += m.di * smearing;
+                }
+                else
+                {
+                    const REAL pr = station_p[0][i], pi = station_p[1][i];
+                    const REAL qr = station_q[0][i], qi = station_q[1][i];
+                    smearing *= source_I[i];
+                    s0 += (pr * qr + pi * qi) * smearing;
+                    s1 += (pi * qr - pr * qi) * smearing;
+                }
+            }
+
+            // Add result to the baseline visibility.
+            const int i = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) +
+                    offset_out;
+            REAL* out = vis + (size_t) i * num_components;
+            out[0] += (REAL) s0; out[1] += (REAL) s1;
+            if (MATRIX)
+            {
+                out[2] += (REAL) s2; out[3] += (REAL) s3;
+                out[4] += (REAL) s4; out[5] += (REAL) s5;
+                out[6] += (REAL) s6; out[7] += (REAL) s7;
+            }
+        }
+    }
+}
+
+template<bool MATRIX, typename REAL>
+void oskar_acorr_planar_omp(
+        const int                    num_sources,
+        const int                    num_stations,
+        const int                    offset_out,
+        const size_t                 stride,
+        const REAL*   const RESTRICT jones,
+        const REAL*   const RESTRICT source_I,
+        const REAL*   const RESTRICT source_Q,
+        const REAL*   const RESTRICT source_U,
+        const REAL*   const RESTRICT source_V,
+        REAL*               RESTRICT vis)
+{
+    const int num_components = MATRIX ? 8 : 2;
+#pragma omp parallel for
+    for (int s = 0; s < num_stations; ++s)
+    {
+        double s0 = 0.0, s2 = 0.0, s3 = 0.0, s4 = 0.0, s5 = 0.0, s6 = 0.0;
+        const REAL* station[8];
+        for (int k = 0; k < num_components; ++k)
+            station[k] = jones + k * stride + (size_t) s * num_sources;
+        OMP_SIMD_SUM(s0, s2, s3, s4, s5, s6)
+        for (int i = 0; i < num_sources; ++i)
+        {
+            if (MATRIX)
+            {
+                // Imaginary parts of the diagonal are zero.
+                Matrix<REAL> p, m;
+                load(p, station, i);
+                brightness_product(m, p, p, source_I[i], source_Q[i],
+                        source_U[i], source_V[i]);
+                s0 += m.ar; s2 += m.br; s3 += m.bi;
+                s4 += m.cr; s5 += m.ci; s6 += m.dr;
+            }
+            else
+            {
+                const REAL pr = station[0][i], pi = station[1][i];
+                s0 += (pr * pr + pi * pi) * source_I[i];
+            }
+        }
+        REAL* out = vis + (size_t) (s + offset_out) * num_components;
+        out[0] += (REAL) s0;
+        if (MATRIX)
+        {
+            out[2] += (REAL) s2; out[3] += (REAL) s3;
+            out[4] += (REAL) s4; out[5] += (REAL) s5;
+            out[6] += (REAL) s6;
+        }
+    }
+}
+
+#define XCORR_KERNEL(BS, TS, GAUSSIAN, MATRIX, REAL)                        \
+        oskar_xcorr_planar_omp<BS, TS, GAUSSIAN, MATRIX, REAL>              \
+        (num_sources, num_stations, offset_out, stride, jones,              \
+                I, Q, U, V, l, m, n, a, b, c,                               \
+                station_u, station_v, station_w, station_x, station_y,      \
+                uv_min_lambda, uv_max_lambda, inv_wavelength,               \
+                frac_bandwidth, time_int_sec, gha0_rad, dec0_rad, vis);
+
+#define XCORR_SELECT_SMEARING(GAUSSIAN, MATRIX, REAL)                       \
+        if (frac_bandwidth == (REAL)0 && time_int_sec == (REAL)0)           \
+            XCORR_KERNEL(false, false, GAUSSIAN, MATRIX, REAL)              \
+        else if (frac_bandwidth != (REAL)0 && time_int_sec == (REAL)0)      \
+            XCORR_KERNEL(true, false, GAUSSIAN, MATRIX, REAL)               \
+        else if (frac_bandwidth == (REAL)0 && time_int_sec != (REAL)0)      \
+            XCORR_KERNEL(false, true, GAUSSIAN, MATRIX, REAL)               \
+        else if (frac_bandwidth != (REAL)0 && time_int_sec != (REAL)0)      \
+            XCORR_KERNEL(true, true, GAUSSIAN, MATRIX, REAL)
+
+#define XCORR_SELECT(REAL)                                                  \
+        const bool gaussian = (a && b && c);                                \
+        if (num_components == 8) {                                          \
+            if (gaussian) { XCORR_SELECT_SMEARING(true, true, REAL) }       \
+            else { XCORR_SELECT_SMEARING(false, true, REAL) }               \
+        } else {                                                            \
+            if (gaussian) { XCORR_SELECT_SMEARING(true, false, REAL) }      \
+            else { XCORR_SELECT_SMEARING(false, false, REAL) }              \
+        }
+
+void oskar_cross_correlate_planar_omp_f(
+        int num_sources, int num_stations, int offset_out,
+        int num_components, size_t stride, const float* jones,
+        const float* I, const float* Q, const float* U, const float* V,
+        const float* l, const float* m, const float* n,
+        const float* a, const float* b, const float* c,
+        const float* station_u, const float* station_v,
+        const float* station_w,
+        const float* station_x, const float* station_y,
+        float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
+        float frac_bandwidth, float time_int_sec, float gha0_rad,
+        float dec0_rad, float* vis)
+{
+    XCORR_SELECT(float)
+}
+
+void oskar_cross_correlate_planar_omp_d(
+        int num_sources, int num_stations, int offset_out,
+        int num_components, size_t stride, const double* jones,
+        const double* I, const double* Q, const double* U, const double* V,
+        const double* l, const double* m, const double* n,
+        const double* a, const double* b, const double* c,
+        const double* station_u, const double* station_v,
+        const double* station_w,
+        const double* station_x, const double* station_y,
+        double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
+        double frac_bandwidth, double time_int_sec, double gha0_rad,
+        double dec0_rad, double* vis)
+{
+    XCORR_SELECT(double)
+}
+
+void oskar_auto_correlate_planar_omp_f(
+        int num_sources, int num_stations, int offset_out,
+        int num_components, size_t stride, const float* jones,
+        const float* I, const float* Q, const float* U, const float* V,
+        float* vis)
+{
+    if (num_components == 8)
+        oskar_acorr_planar_omp<true, float>(num_sources, num_stations,
+                offset_out, stride, jones, I, Q, U, V, vis);
+    else
+        oskar_acorr_planar_omp<false, float>(num_sources, num_stations,
+                offset_out, stride, jones, I, Q, U, V, vis);
+}
+
+void oskar_auto_correlate_planar_omp_d(
+        int num_sources, int num_stations, int offset_out,
+        int num_components, size_t stride, const double* jones,
+        const double* I, const double* Q, const double* U, const double* V,
+        double* vis)
+{
+    if (num_components == 8)
+        oskar_acorr_planar_omp<true, double>(num_sources, num_stations,
+                offset_out, stride, jones, I, Q, U, V, vis);
+    else
+        oskar_acorr_planar_omp<false, double>(num_sources, num_stations,
+                offset_out, stride, jones, I, Q, U, V, vis);
+}
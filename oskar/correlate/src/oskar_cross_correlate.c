@@ -4,6 +4,7 @@
  */
 
 #include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_correlate_planar_omp.h"
 #include "correlate/oskar_cross_correlate_cuda.h"
 #include "correlate/oskar_cross_correlate_omp.h"
 #include "correlate/oskar_cross_correlate_scalar_cuda.h"
@@ -112,7 +113,67 @@ void oskar_cross_correlate(
     y = oskar_telescope_station_true_offset_ecef_metres_const(tel, 1);
 
     /* Select kernel. */
-    if (location == OSKAR_CPU)
+    if (oskar_jones_is_planar(jones))
+    {
+        const int matrix = oskar_type_is_matrix(jones_type);
+        const int num_components = matrix ? 8 : 2;
+        const size_t stride = oskar_jones_component_stride(jones);
+        if (base_type == OSKAR_DOUBLE)
+        {
+            oskar_cross_correlate_planar_omp_d(
+                    num_sources, num_stations, offset_out,
+                    num_components, stride, oskar_mem_double_const(J, status),
+                    oskar_mem_double_const(src_flux[0], status),
+                    matrix ? oskar_mem_double_const(src_flux[1], status) : 0,
+                    matrix ? oskar_mem_double_const(src_flux[2], status) : 0,
+                    matrix ? oskar_mem_double_const(src_flux[3], status) : 0,
+                    oskar_mem_double_const(src_dir[0], status),
+                    oskar_mem_double_const(src_dir[1], status),
+                    oskar_mem_double_const(src_dir[2], status),
+                    use_extended ?
+                            oskar_mem_double_const(src_ext[0], status) : 0,
+                    use_extended ?
+                            oskar_mem_double_const(src_ext[1], status) : 0,
+                    use_extended ?
+                            oskar_mem_double_const(src_ext[2], status) : 0,
+                    oskar_mem_double_const(station_uvw[0], status),
+                    oskar_mem_double_const(station_uvw[1], status),
+                    oskar_mem_double_const(station_uvw[2], status),
+                    oskar_mem_double_const(x, status),
+                    oskar_mem_double_const(y, status),
+                    uv_filter_min, uv_filter_max, inv_wavelength,
+                    frac_bandwidth, time_avg, gha0, dec0,
+                    oskar_mem_double(vis, status));
+        }
+        else
+        {
+            oskar_cross_correlate_planar_omp_f(
+                    num_sources, num_stations, offset_out,
+                    num_components, stride, oskar_mem_float_const(J, status),
+                    oskar_mem_float_const(src_flux[0], status),
+                    matrix ? oskar_mem_float_const(src_flux[1], status) : 0,
+                    matrix ? oskar_mem_float_const(src_flux[2], status) : 0,
+                    matrix ? oskar_mem_float_const(src_flux[3], status) : 0,
+                    oskar_mem_float_const(src_dir[0], status),
+                    oskar_mem_float_const(src_dir[1], status),
+                    oskar_mem_float_const(src_dir[2], status),
+                    use_extended ?
+                            oskar_mem_float_const(src_ext[0], status) : 0,
+                    use_extended ?
+                            oskar_mem_float_const(src_ext[1], status) : 0,
+                    use_extended ?
+                            oskar_mem_float_const(src_ext[2], status) : 0,
+                    oskar_mem_float_const(station_uvw[0], status),
+                    oskar_mem_float_const(station_uvw[1], status),
+                    oskar_mem_float_const(station_uvw[2], status),
+                    oskar_mem_float_const(x, status),
+                    oskar_mem_float_const(y, status),
+                    uv_filter_min, uv_filter_max, inv_wavelength,
+                    frac_bandwidth, time_avg, gha0, dec0,
+                    oskar_mem_float(vis, status));
+        }
+    }
+    else if (location == OSKAR_CPU)
     {
         if (use_extended)
         {
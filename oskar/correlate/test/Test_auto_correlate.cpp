@@ -8,6 +8,7 @@
 #include "utility/oskar_timer.h"
 
 #include "correlate/oskar_auto_correlate.h"
+#include "interferometer/oskar_jones.h"
 #include "utility/oskar_get_error_string.h"
 #include <cstdlib>
 
@@ -44,7 +45,8 @@ protected:
     oskar_Jones* jones;
 
 protected:
-    void create_test_data(int precision, int location, int matrix)
+    void create_test_data(int precision, int location, int matrix,
+            int planar = 0)
     {
         int status = 0, type;
 
@@ -66,6 +68,17 @@ protected:
         oskar_mem_random_range(src_flux[2], 0.1, 0.5, &status);
         oskar_mem_random_range(src_flux[3], 0.1, 0.2, &status);
         ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Copy the Jones matrices to the planar layout, if required.
+        if (planar)
+        {
+            oskar_Jones* t = oskar_jones_create_planar(type, location,
+                    num_stations, num_sources, &status);
+            oskar_jones_convert(t, jones, &status);
+            oskar_jones_free(jones, &status);
+            jones = t;
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        }
     }
 
     void destroy_test_data()
@@ -77,7 +90,8 @@ protected:
         ASSERT_EQ(0, status) << oskar_get_error_string(status);
     }
 
-    void run_test(int prec1, int prec2, int loc1, int loc2, int matrix)
+    void run_test(int prec1, int prec2, int loc1, int loc2, int matrix,
+            int planar2 = 0)
     {
         int status = 0, type;
         oskar_Mem *vis1, *vis2;
@@ -103,7 +117,7 @@ protected:
         ASSERT_EQ(0, status) << oskar_get_error_string(status);
 
         // Run second part.
-        create_test_data(prec2, loc2, matrix);
+        create_test_data(prec2, loc2, matrix, planar2);
         type = prec2 | OSKAR_COMPLEX;
         if (matrix) type |= OSKAR_MATRIX;
         vis2 = oskar_mem_create(type, loc2, num_stations, &status);
@@ -189,6 +203,25 @@ TEST_F(auto_correlate, matrix_singleCPU_doubleGPU)
 }
 #endif
 
+// Check the planar layout against the interleaved layout.
+TEST_F(auto_correlate, matrix_doubleCPU_doubleCPU_planar)
+{
+    run_test(OSKAR_DOUBLE, OSKAR_DOUBLE,
+            OSKAR_CPU, OSKAR_CPU, 1, 1);
+}
+
+TEST_F(auto_correlate, matrix_doubleCPU_singleCPU_planar)
+{
+    run_test(OSKAR_DOUBLE, OSKAR_SINGLE,
+            OSKAR_CPU, OSKAR_CPU, 1, 1);
+}
+
+TEST_F(auto_correlate, scalar_doubleCPU_doubleCPU_planar)
+{
+    run_test(OSKAR_DOUBLE, OSKAR_DOUBLE,
+            OSKAR_CPU, OSKAR_CPU, 0, 1);
+}
+
 // SCALAR VERSIONS ////////////////////////////////////////////////////////////
 
 // CPU only.
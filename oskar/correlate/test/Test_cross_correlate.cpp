@@ -8,6 +8,7 @@
 #include "utility/oskar_timer.h"
 
 #include "correlate/oskar_cross_correlate.h"
+#include "interferometer/oskar_jones.h"
 #include "utility/oskar_get_error_string.h"
 #include "math/oskar_kahan_sum.h"
 #include <cstdlib>
@@ -56,7 +57,8 @@ protected:
     oskar_Jones* jones;
 
 protected:
-    void create_test_data(int precision, int location, int matrix)
+    void create_test_data(int precision, int location, int matrix,
+            int planar = 0)
     {
         int status = 0, type;
 
@@ -111,6 +113,17 @@ protected:
         oskar_mem_random_range(src_ext[1], 0.1e-6, 0.2e-6, &status);
         oskar_mem_random_range(src_ext[2], 0.1e-6, 0.2e-6, &status);
         ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Copy the Jones matrices to the planar layout, if required.
+        if (planar)
+        {
+            oskar_Jones* t = oskar_jones_create_planar(type, location,
+                    num_stations, num_sources, &status);
+            oskar_jones_convert(t, jones, &status);
+            oskar_jones_free(jones, &status);
+            jones = t;
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        }
     }
 
     void destroy_test_data()
@@ -130,7 +143,8 @@ protected:
     }
 
     void run_test(int prec1, int prec2, int loc1, int loc2, int matrix,
-            int extended, double time_average, double freq_average)
+            int extended, double time_average, double freq_average,
+            int planar2 = 0)
     {
         int num_baselines, status = 0, type;
         oskar_Mem *vis1, *vis2;
@@ -160,7 +174,7 @@ protected:
         ASSERT_EQ(0, status) << oskar_get_error_string(status);
 
         // Run second part.
-        create_test_data(prec2, loc2, matrix);
+        create_test_data(prec2, loc2, matrix, planar2);
         num_baselines = oskar_telescope_num_baselines(tel);
         type = prec2 | OSKAR_COMPLEX;
         if (matrix) type |= OSKAR_MATRIX;
@@ -247,6 +261,38 @@ TEST_F(cross_correlate, CPU)
     }
 }
 
+// CPU only.
+// Check consistency between the interleaved and planar layouts.
+TEST_F(cross_correlate, CPU_planar)
+{
+    const int precision[] = {OSKAR_SINGLE, OSKAR_DOUBLE};
+    const int matrix_type[] = {0, 1};
+    const int source_type[] = {0, 1};
+    const double time_avg[] = {0.0, 10.0};
+    const double freq_avg[] = {0.0, 1.e4};
+    for (int i_prec = 0; i_prec < 2; ++i_prec)
+    {
+        for (int i_matrix_type = 0; i_matrix_type < 2; ++i_matrix_type)
+        {
+            for (int i_source_type = 0; i_source_type < 2; ++i_source_type)
+            {
+                for (int i_time_avg = 0; i_time_avg < 2; ++i_time_avg)
+                {
+                    for (int i_freq_avg = 0; i_freq_avg < 2; ++i_freq_avg)
+                    {
+                        run_test(OSKAR_DOUBLE, precision[i_prec],
+                                OSKAR_CPU, OSKAR_CPU,
+                                matrix_type[i_matrix_type],
+                                source_type[i_source_type],
+                                time_avg[i_time_avg],
+                                freq_avg[i_freq_avg], 1);
+                    }
+                }
+            }
+        }
+    }
+}
+
 #ifdef OSKAR_HAVE_CUDA
 // Check for consistency between CPU and CUDA versions.
 TEST_F(cross_correlate, CUDA)
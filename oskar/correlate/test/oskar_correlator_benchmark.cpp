@@ -20,7 +20,7 @@
 
 static void benchmark(int num_stations, int num_sources, int type,
         int jones_type, int location, int use_extended,
-        int use_bandwidth_smearing, int use_time_smearing,
+        int use_bandwidth_smearing, int use_time_smearing, int use_planar,
         int niter, std::vector<double>& times, const std::string& ascii_file,
         int* status);
 
@@ -37,6 +37,7 @@ int main(int argc, char** argv)
     opt.add_flag("-e", "Use Gaussian sources (default: point sources).");
     opt.add_flag("-b", "Use bandwidth smearing (default: no bandwidth smearing).");
     opt.add_flag("-t", "Use time smearing (default: no time smearing).");
+    opt.add_flag("-p", "Use planar Jones matrices (CPU only).");
     opt.add_flag("-r", "Dump raw iteration data to this file.", 1);
     opt.add_flag("-a", "Dump ASCII visibility data to this file.", 1);
     opt.add_flag("-std", "Discard values greater than this number of standard "
@@ -58,6 +59,7 @@ int main(int argc, char** argv)
     int use_extended = opt.is_set("-e") ? OSKAR_TRUE : OSKAR_FALSE;
     int use_bandwidth_smearing = opt.is_set("-b") ? OSKAR_TRUE : OSKAR_FALSE;
     int use_time_smearing = opt.is_set("-t") ? OSKAR_TRUE : OSKAR_FALSE;
+    int use_planar = opt.is_set("-p") ? OSKAR_TRUE : OSKAR_FALSE;
     std::string raw_file, ascii_file;
     if (opt.is_set("-r"))
         raw_file = opt.get_string("-r");
@@ -76,6 +78,11 @@ int main(int argc, char** argv)
         opt.error("Please select one of -g, -c or -cl");
         return EXIT_FAILURE;
     }
+    if (use_planar && location != OSKAR_CPU)
+    {
+        opt.error("Planar Jones matrices can only be used with -c");
+        return EXIT_FAILURE;
+    }
 
     if (opt.is_set("-v"))
     {
@@ -89,6 +96,8 @@ int main(int argc, char** argv)
                 "true" : "false");
         printf("- Time smearing: %s\n", (use_time_smearing) ?
                 "true" : "false");
+        printf("- Jones layout: %s\n", (use_planar) ?
+                "planar" : "interleaved");
         printf("- Number of iterations: %i\n", niter);
         if (max_std_dev > 0.0)
             printf("- Max standard deviations: %f\n", max_std_dev);
@@ -103,7 +112,7 @@ int main(int argc, char** argv)
     std::vector<double> times;
     benchmark(num_stations, num_sources, type, jones_type, location,
             use_extended, use_bandwidth_smearing, use_time_smearing,
-            niter, times, ascii_file, &status);
+            use_planar, niter, times, ascii_file, &status);
 
     // Compute total time taken.
     for (int i = 0; i < niter; ++i)
@@ -191,7 +200,7 @@ int main(int argc, char** argv)
 
 void benchmark(int num_stations, int num_sources, int type,
         int jones_type, int location, int use_extended,
-        int use_bandwidth_smearing, int use_time_smearing,
+        int use_bandwidth_smearing, int use_time_smearing, int use_planar,
         int niter, std::vector<double>& times, const std::string& ascii_file,
         int* status)
 {
@@ -230,6 +239,16 @@ void benchmark(int num_stations, int num_sources, int type,
     oskar_telescope_set_channel_bandwidth(tel, 10e6 * use_bandwidth_smearing);
     oskar_telescope_set_time_average(tel, 10 * use_time_smearing);
 
+    // Copy the Jones matrices to the planar layout if required.
+    if (use_planar)
+    {
+        oskar_Jones* planar = oskar_jones_create_planar(jones_type,
+                location, num_stations, num_sources, status);
+        oskar_jones_convert(planar, J, status);
+        oskar_jones_free(J, status);
+        J = planar;
+    }
+
     // Run benchmark.
     times.resize(niter);
     char* device_name = oskar_device_name(location, 0);
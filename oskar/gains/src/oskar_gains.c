@@ -105,7 +105,7 @@ void oskar_gains_evaluate(const oskar_Gains* h, int time_index_sim,
         /* Check output is writable by the CPU. */
         ptr_gains = gains;
         if (oskar_mem_location(gains) != OSKAR_CPU)
-            ptr_gains = temp_gains = oskar_mem_create(
+            ptr_gains = temp_gains = oskar_mem_create_uninit(
                     oskar_mem_type(gains), OSKAR_CPU, num_antennas, status);
 
         /* Write gains into diagonal matrices. */
@@ -114,6 +114,149 @@ void oskar_grid_simple_f(
         double* RESTRICT norm,
         float* RESTRICT grid);
 
+/**
+ * @brief
+ * Simple gridding of the same visibility coordinates onto several grids
+ * (double precision).
+ *
+ * @details
+ * Grids visibilities that share the same baseline coordinates, such as
+ * different polarisations of the same channel, onto several grids in one pass.
+ * The convolution kernel is evaluated only once for each visibility,
+ * and is then used for every grid.
+ *
+ * Results are identical to calling oskar_grid_simple_d() for each grid.
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] num_planes    Number of grids to update.
+ * @param[in] vis           Complex visibilities for each grid.
+ * @param[in] weight        Visibility weights for each grid.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[in,out] norm      Updated normalisation factor for each grid.
+ * @param[in,out] grids     Updated complex visibility grids.
+ */
+OSKAR_EXPORT
+void oskar_grid_simple_multi_d(
+        const int support,
+        const int oversample,
+        const double* RESTRICT conv_func,
+        const size_t num_points,
+        const double* RESTRICT uu,
+        const double* RESTRICT vv,
+        const int num_planes,
+        const double* const* vis,
+        const double* const* weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT norm,
+        double* const* grids);
+
+/**
+ * @brief
+ * Simple gridding of the same visibility coordinates onto several grids
+ * (single precision).
+ *
+ * @details
+ * Grids visibilities that share the same baseline coordinates, such as
+ * different polarisations of the same channel, onto several grids in one pass.
+ * The convolution kernel is evaluated only once for each visibility,
+ * and is then used for every grid.
+ *
+ * Results are identical to calling oskar_grid_simple_f() for each grid.
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] num_planes    Number of grids to update.
+ * @param[in] vis           Complex visibilities for each grid.
+ * @param[in] weight        Visibility weights for each grid.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[in,out] norm      Updated normalisation factor for each grid.
+ * @param[in,out] grids     Updated complex visibility grids.
+ */
+OSKAR_EXPORT
+void oskar_grid_simple_multi_f(
+        const int support,
+        const int oversample,
+        const float* RESTRICT conv_func,
+        const size_t num_points,
+        const float* RESTRICT uu,
+        const float* RESTRICT vv,
+        const int num_planes,
+        const float* const* vis,
+        const float* const* weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT norm,
+        float* const* grids);
+
+/**
+ * @brief
+ * Simple gridding of the same visibility coordinates onto several
+ * single-precision grids, accumulating in double precision.
+ *
+ * @details
+ * Grids double-precision visibilities onto grids stored in single precision,
+ * to halve the memory needed for large grids.
+ *
+ * The visibilities are sorted into square tiles of the grid, and the
+ * contributions to each tile are accumulated in a short-lived
+ * double-precision buffer, which is added to the grids once all the
+ * visibilities in the tile have been processed. Each grid cell is therefore
+ * rounded to single precision only once per call, rather than once per
+ * visibility, so the relative error in a cell compared to a double-precision
+ * grid is bounded by about 6e-8 times the number of calls that update it.
+ * For comparison, the error when gridding in single precision grows with the
+ * number of visibilities that contribute to the cell.
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] num_planes    Number of grids to update.
+ * @param[in] vis           Complex visibilities for each grid.
+ * @param[in] weight        Visibility weights for each grid.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[in,out] norm      Updated normalisation factor for each grid.
+ * @param[in,out] grids     Updated single-precision complex grids.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_grid_simple_multi_mixed(
+        const int support,
+        const int oversample,
+        const double* RESTRICT conv_func,
+        const size_t num_points,
+        const double* RESTRICT uu,
+        const double* RESTRICT vv,
+        const int num_planes,
+        const double* const* vis,
+        const double* const* weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT norm,
+        float* const* grids,
+        int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,6 +24,10 @@ extern "C" {
  * @details
  * Updates gridded weights for the supplied visibility points.
  *
+ * Large numbers of points are gridded using multiple threads, each of which
+ * owns bands of whole grid rows, so the result does not depend on the
+ * number of threads used.
+ *
  * @param[in] num_points        Number of data points.
  * @param[in] uu                Baseline uu coordinates, in wavelengths.
  * @param[in] vv                Baseline vv coordinates, in wavelengths.
@@ -71,6 +75,10 @@ void oskar_grid_weights_read_d(const size_t num_points,
  * @details
  * Updates gridded weights for the supplied visibility points.
  *
+ * Large numbers of points are gridded using multiple threads, each of which
+ * owns bands of whole grid rows, so the result does not depend on the
+ * number of threads used.
+ *
  * @param[in] num_points        Number of data points.
  * @param[in] uu                Baseline uu coordinates, in wavelengths.
  * @param[in] vv                Baseline vv coordinates, in wavelengths.
@@ -112,6 +120,172 @@ void oskar_grid_weights_read_f(const size_t num_points,
         const float cell_size_rad, const int grid_size,
         size_t* RESTRICT num_skipped, const float* RESTRICT grid);
 
+/**
+ * @brief
+ * Updates hashed gridded weights (double precision).
+ *
+ * @details
+ * Updates a sparse grid of weights, stored as an open-addressed hash table
+ * of grid cells, for the supplied visibility points.
+ *
+ * Empty slots in the table have a key of -1.
+ * Points are processed in order until a new cell would make the table more
+ * than half full. The caller should then grow the table and continue
+ * from the returned point index.
+ *
+ * @param[in] num_points        Number of data points.
+ * @param[in] uu                Baseline uu coordinates, in wavelengths.
+ * @param[in] vv                Baseline vv coordinates, in wavelengths.
+ * @param[in] weight            Input visibility weights.
+ * @param[in] cell_size_rad     Cell size, in radians.
+ * @param[in] grid_size         Side length of grid.
+ * @param[out] num_skipped      Number of points that fell outside the grid.
+ * @param[in] capacity          Number of slots in the table (a power of 2).
+ * @param[in,out] num_used      Number of slots in use.
+ * @param[in,out] keys          Grid cell index held in each slot.
+ * @param[in,out] values        Gridded weight in each slot.
+ *
+ * @return The number of points processed.
+ */
+OSKAR_EXPORT
+size_t oskar_grid_weights_hash_write_d(const size_t num_points,
+        const double* RESTRICT uu, const double* RESTRICT vv,
+        const double* RESTRICT weight, const double cell_size_rad,
+        const int grid_size, size_t* RESTRICT num_skipped,
+        const int capacity, int* RESTRICT num_used,
+        int* RESTRICT keys, double* RESTRICT values);
+
+/**
+ * @brief
+ * Re-weights visibilities using hashed gridded weights (double precision).
+ *
+ * @details
+ * Re-weights supplied visibilities using a sparse grid of weights
+ * updated by oskar_grid_weights_hash_write_d(), for uniform weighting.
+ *
+ * @param[in] num_points        Number of data points.
+ * @param[in] uu                Baseline uu coordinates, in wavelengths.
+ * @param[in] vv                Baseline vv coordinates, in wavelengths.
+ * @param[in] weight_in         Input visibility weights.
+ * @param[out] weight_out       Output visibility weights.
+ * @param[in] cell_size_rad     Cell size, in radians.
+ * @param[in] grid_size         Side length of grid.
+ * @param[out] num_skipped      Number of points that fell outside the grid.
+ * @param[in] capacity          Number of slots in the table (a power of 2).
+ * @param[in] keys              Grid cell index held in each slot.
+ * @param[in] values            Gridded weight in each slot.
+ */
+OSKAR_EXPORT
+void oskar_grid_weights_hash_read_d(const size_t num_points,
+        const double* RESTRICT uu, const double* RESTRICT vv,
+        const double* RESTRICT weight_in, double* RESTRICT weight_out,
+        const double cell_size_rad, const int grid_size,
+        size_t* RESTRICT num_skipped, const int capacity,
+        const int* RESTRICT keys, const double* RESTRICT values);
+
+/**
+ * @brief
+ * Inserts a cell into hashed gridded weights (double precision).
+ *
+ * @details
+ * Used to copy cells into a larger table. The cell must not already be
+ * present, and the table must have a free slot.
+ *
+ * @param[in] key               Grid cell index.
+ * @param[in] value             Gridded weight.
+ * @param[in] capacity          Number of slots in the table (a power of 2).
+ * @param[in,out] keys          Grid cell index held in each slot.
+ * @param[in,out] values        Gridded weight in each slot.
+ */
+OSKAR_EXPORT
+void oskar_grid_weights_hash_insert_d(const int key, const double value,
+        const int capacity, int* RESTRICT keys, double* RESTRICT values);
+
+/**
+ * @brief
+ * Updates hashed gridded weights (single precision).
+ *
+ * @details
+ * Updates a sparse grid of weights, stored as an open-addressed hash table
+ * of grid cells, for the supplied visibility points.
+ *
+ * Empty slots in the table have a key of -1.
+ * Points are processed in order until a new cell would make the table more
+ * than half full. The caller should then grow the table and continue
+ * from the returned point index.
+ *
+ * @param[in] num_points        Number of data points.
+ * @param[in] uu                Baseline uu coordinates, in wavelengths.
+ * @param[in] vv                Baseline vv coordinates, in wavelengths.
+ * @param[in] weight            Input visibility weights.
+ * @param[in] cell_size_rad     Cell size, in radians.
+ * @param[in] grid_size         Side length of grid.
+ * @param[out] num_skipped      Number of points that fell outside the grid.
+ * @param[in] capacity          Number of slots in the table (a power of 2).
+ * @param[in,out] num_used      Number of slots in use.
+ * @param[in,out] keys          Grid cell index held in each slot.
+ * @param[in,out] values        Gridded weight in each slot.
+ * @param[in,out] guard         Guard digits for gridded weights.
+ *
+ * @return The number of points processed.
+ */
+OSKAR_EXPORT
+size_t oskar_grid_weights_hash_write_f(const size_t num_points,
+        const float* RESTRICT uu, const float* RESTRICT vv,
+        const float* RESTRICT weight, const float cell_size_rad,
+        const int grid_size, size_t* RESTRICT num_skipped,
+        const int capacity, int* RESTRICT num_used,
+        int* RESTRICT keys, float* RESTRICT values, float* RESTRICT guard);
+
+/**
+ * @brief
+ * Re-weights visibilities using hashed gridded weights (single precision).
+ *
+ * @details
+ * Re-weights supplied visibilities using a sparse grid of weights
+ * updated by oskar_grid_weights_hash_write_f(), for uniform weighting.
+ *
+ * @param[in] num_points        Number of data points.
+ * @param[in] uu                Baseline uu coordinates, in wavelengths.
+ * @param[in] vv                Baseline vv coordinates, in wavelengths.
+ * @param[in] weight_in         Input visibility weights.
+ * @param[out] weight_out       Output visibility weights.
+ * @param[in] cell_size_rad     Cell size, in radians.
+ * @param[in] grid_size         Side length of grid.
+ * @param[out] num_skipped      Number of points that fell outside the grid.
+ * @param[in] capacity          Number of slots in the table (a power of 2).
+ * @param[in] keys              Grid cell index held in each slot.
+ * @param[in] values            Gridded weight in each slot.
+ */
+OSKAR_EXPORT
+void oskar_grid_weights_hash_read_f(const size_t num_points,
+        const float* RESTRICT uu, const float* RESTRICT vv,
+        const float* RESTRICT weight_in, float* RESTRICT weight_out,
+        const float cell_size_rad, const int grid_size,
+        size_t* RESTRICT num_skipped, const int capacity,
+        const int* RESTRICT keys, const float* RESTRICT values);
+
+/**
+ * @brief
+ * Inserts a cell into hashed gridded weights (single precision).
+ *
+ * @details
+ * Used to copy cells into a larger table. The cell must not already be
+ * present, and the table must have a free slot.
+ *
+ * @param[in] key               Grid cell index.
+ * @param[in] value             Gridded weight.
+ * @param[in] guard_value       Guard digits for the gridded weight.
+ * @param[in] capacity          Number of slots in the table (a power of 2).
+ * @param[in,out] keys          Grid cell index held in each slot.
+ * @param[in,out] values        Gridded weight in each slot.
+ * @param[in,out] guard         Guard digits for gridded weights.
+ */
+OSKAR_EXPORT
+void oskar_grid_weights_hash_insert_f(const int key, const float value,
+        const float guard_value, const int capacity, int* RESTRICT keys,
+        float* RESTRICT values, float* RESTRICT guard);
+
 #ifdef __cplusplus
 }
 #endif
@@ -52,6 +52,20 @@ extern "C" {
 OSKAR_EXPORT
 const char* oskar_imager_algorithm(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the maximum uv change allowed when averaging along baselines.
+ *
+ * @details
+ * Returns the fraction of a uv cell a baseline may move through while
+ * its visibilities are averaged in time before gridding.
+ * A value of zero means that no averaging is done.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+double oskar_imager_bda_max_cell_fraction(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the image cell size.
@@ -162,6 +176,18 @@ int oskar_imager_generate_w_kernels_on_gpu(const oskar_Imager* h);
 OSKAR_EXPORT
 int oskar_imager_grid_on_gpu(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the option to store grids in single precision.
+ *
+ * @details
+ * Returns the option to store grids in single precision.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+int oskar_imager_single_precision_grids(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the image side length.
@@ -285,6 +311,8 @@ int oskar_imager_plane_size(oskar_Imager* h);
  *
  * @details
  * Returns the enumerated grid data type.
+ * This is single precision when using the FFT algorithm in double precision
+ * on the host, if oskar_imager_set_single_precision_grids() has been used.
  */
 OSKAR_EXPORT
 int oskar_imager_plane_type(const oskar_Imager* h);
@@ -319,6 +347,8 @@ int oskar_imager_scale_norm_with_num_input_files(const oskar_Imager* h);
  * The \p type string can be:
  * - "FFT" to use standard gridding followed by a FFT.
  * - "W-projection" to use W-projection gridding followed by a FFT.
+ * - "W-stacking" to grid into W-layers, each followed by a FFT and
+ *   a W-phase correction in the image domain.
  * - "DFT 2D" to use a 2D Direct Fourier Transform, without gridding.
  * - "DFT 3D" to use a 3D Direct Fourier Transform, without gridding.
  *
@@ -334,6 +364,30 @@ OSKAR_EXPORT
 void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
         int* status);
 
+/**
+ * @brief
+ * Sets the maximum uv change allowed when averaging along baselines.
+ *
+ * @details
+ * Enables baseline-dependent averaging of visibility blocks before gridding.
+ * Consecutive times on each baseline are averaged together for as long as
+ * the baseline's uv coordinates stay within this fraction of a uv cell.
+ * Short baselines move slowly through the uv plane, so they are averaged
+ * over longer times than long baselines, reducing the number of
+ * visibilities to grid without smearing the uv coverage by more than
+ * the given amount.
+ *
+ * Averaging is only done for visibility blocks and OSKAR visibility files,
+ * which have a fixed number of baselines per time.
+ *
+ * The default is zero, which disables averaging.
+ *
+ * @param[in,out] h      Handle to imager.
+ * @param[in]     value  Maximum fraction of a uv cell, or zero to disable.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_bda_max_cell_fraction(oskar_Imager* h, double value);
+
 /**
  * @brief
  * Sets the image cell size.
@@ -534,6 +588,34 @@ void oskar_imager_set_grid_kernel(oskar_Imager* h, const char* type,
 OSKAR_EXPORT
 void oskar_imager_set_grid_on_gpu(oskar_Imager* h, int value);
 
+/**
+ * @brief
+ * Sets the option to store grids in single precision.
+ *
+ * @details
+ * If set, a double-precision imager using the FFT algorithm on the host
+ * stores its visibility grids in single precision, halving the memory
+ * they need. Visibilities are still gridded in double precision,
+ * into short-lived buffers for each tile of the grid, which are added to
+ * the grids after each block of visibilities has been processed.
+ * Grid cells are therefore rounded only once per block, rather than once per
+ * visibility as when imaging in single precision, and the grids are
+ * converted back to double precision before the FFT.
+ *
+ * In tests, pixels in the inner half of the image differed from those made
+ * using double-precision grids by around 1e-8 of the image peak, compared
+ * with around 1e-5 when imaging in single precision. Errors are larger
+ * towards the edges of the image, where the grid correction is largest.
+ *
+ * This option has no effect in single precision, or with other algorithms,
+ * or when gridding on a GPU.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     value      Option value (true or false).
+ */
+OSKAR_EXPORT
+void oskar_imager_set_single_precision_grids(oskar_Imager* h, int value);
+
 /**
  * @brief
  * Sets image side length.
@@ -781,7 +863,8 @@ void oskar_imager_set_vis_phase_centre(oskar_Imager* h,
  * Sets the number of W planes to use.
  *
  * @details
- * Sets the number of W planes, used only for W-projection.
+ * Sets the number of W planes, used only for W-projection,
+ * or the number of W-layers used for W-stacking.
  * A value of 0 or less means 'automatic'.
  *
  * @param[in,out] h            Handle to imager.
@@ -790,6 +873,24 @@ void oskar_imager_set_vis_phase_centre(oskar_Imager* h,
 OSKAR_EXPORT
 void oskar_imager_set_num_w_planes(oskar_Imager* h, int value);
 
+/**
+ * @brief
+ * Sets the directory used to cache W-projection kernels.
+ *
+ * @details
+ * Sets the directory used to cache W-projection kernels between runs.
+ * If set, the kernels are saved to a file in this directory, named
+ * according to the imaging parameters used to generate them.
+ * Subsequent runs using identical parameters will memory-map the file
+ * instead of regenerating the kernels.
+ * A null pointer or empty string disables the cache.
+ *
+ * @param[in,out] h            Handle to imager.
+ * @param[in] dir              Path to cache directory.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_w_kernel_cache_dir(oskar_Imager* h, const char* dir);
+
 /**
  * @brief
  * Sets the visibility weighting scheme to use.
@@ -879,6 +980,19 @@ double oskar_imager_uv_filter_min(const oskar_Imager* h);
 OSKAR_EXPORT
 const char* oskar_imager_weighting(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the directory used to cache W-projection kernels.
+ *
+ * @details
+ * Returns the directory used to cache W-projection kernels,
+ * or NULL if the cache is disabled.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+const char* oskar_imager_w_kernel_cache_dir(const oskar_Imager* h);
+
 #ifdef __cplusplus
 }
 #endif
@@ -95,6 +95,10 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
  * When using a DFT, \p plane refers to the image plane;
  * otherwise, \p plane refers to the visibility grid.
  *
+ * When using W-stacking, the visibilities are buffered for the internal
+ * plane \p i_plane and gridded when the imager is finalised,
+ * so \p plane must be NULL.
+ *
  * The supplied baseline coordinates must be in wavelengths.
  *
  * If this is called in "coordinate only" mode, then the visibility amplitudes
@@ -3,6 +3,7 @@
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
+#include <binary/oskar_binary.h>
 #include <fitsio.h>
 #include <log/oskar_log.h>
 #include <math/oskar_fft.h>
@@ -33,6 +34,17 @@ struct DeviceData
 };
 typedef struct DeviceData DeviceData;
 
+/* Visibilities staged for gridding all polarisations of a channel together. */
+struct GridPlanesTask
+{
+    struct oskar_Imager* h;
+    oskar_Mem *uu, *vv, *vis[4], *weight[4];
+    int num_planes, i_plane[4], status;
+    size_t num_vis, num_skipped;
+    double norm[4];
+};
+typedef struct GridPlanesTask GridPlanesTask;
+
 struct oskar_Imager
 {
     char* output_name[4];
@@ -48,11 +60,11 @@ struct oskar_Imager
     int algorithm, fft_on_gpu, grid_on_gpu;
     int image_size, use_stokes, support, oversample;
     int generate_w_kernels_on_gpu, set_cellsize, set_fov, weighting;
-    int num_files, scale_norm_with_num_input_files;
+    int num_files, scale_norm_with_num_input_files, single_precision_grids;
     char direction_type, kernel_type;
     char **input_files, *input_root, *output_root, *ms_column;
     double cellsize_rad, fov_deg, image_padding, im_centre_deg[2];
-    double uv_filter_min, uv_filter_max;
+    double uv_filter_min, uv_filter_max, bda_max_cell_fraction;
     double time_min_utc, time_max_utc, freq_min_hz, freq_max_hz;
 
     /* Visibility meta-data. */
@@ -64,15 +76,19 @@ struct oskar_Imager
     int init, status, i_block;
     int coords_only; /* Set if doing a first pass for uniform weighting. */
     oskar_Mutex* mutex;
+    oskar_ThreadPool* thread_pool; /* One worker for each device. */
     oskar_Log* log;
     size_t num_vis_processed;
 
     /* Scratch data. */
     oskar_Mem *uu_im, *vv_im, *ww_im, *vis_im, *weight_im, *time_im;
     oskar_Mem *uu_tmp, *vv_tmp, *ww_tmp, *stokes, *weight_tmp;
+    oskar_Mem *bda_uu, *bda_vv, *bda_ww, *bda_vis, *bda_weight, *bda_time;
     int num_planes; /* For each output channel and polarisation. */
     double *plane_norm, delta_l, delta_m, delta_n, M[9];
     oskar_Mem **planes, **weights_grids, **weights_guard;
+    oskar_Mem **weights_keys; /* Cell in each slot of hashed weights grids. */
+    int *weights_num_used; /* Slots in use in hashed weights grids. */
 
     /* DFT imager data. */
     oskar_Mem *l, *m, *n;
@@ -81,12 +97,20 @@ struct oskar_Imager
     oskar_FFT* fft;
     int grid_size;
     oskar_Mem *conv_func, *corr_func;
+    int num_grid_tasks, num_grid_tasks_pending;
+    GridPlanesTask* grid_tasks;
 
     /* W-projection imager data. */
     size_t ww_points;
     int num_w_planes;
     double w_scale, ww_min, ww_max, ww_rms;
     oskar_Mem *w_support, *w_kernels_compact, *w_kernel_start;
+    oskar_Binary* w_kernel_cache; /* Open if kernels are memory-mapped. */
+    char* w_kernel_cache_dir;
+
+    /* W-stacking imager data: visibilities buffered for each plane. */
+    oskar_Mem **ws_uu, **ws_vv, **ws_ww, **ws_vis, **ws_weight;
+    size_t *ws_num_vis;
 
     /* Memory allocated per GPU (array of DeviceData structures). */
     DeviceData* d;
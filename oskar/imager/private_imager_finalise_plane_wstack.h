@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_FINALISE_PLANE_WSTACK_H_
+#define OSKAR_IMAGER_FINALISE_PLANE_WSTACK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Makes an image from visibilities buffered for W-stacking.
+ *
+ * @details
+ * The buffered visibilities for plane \p i_plane are sorted into W-layers.
+ * Each layer is gridded with the spheroidal kernel and transformed using
+ * oskar_imager_finalise_plane(), and the W-phase correction for the
+ * centre of the layer is applied in the image domain before the result
+ * is added to the plane. Layers are processed one at a time, so only one
+ * grid is needed in addition to the plane itself.
+ *
+ * If the number of W-planes has not been set, the number of layers is
+ * chosen from the range of W and the field of view.
+ *
+ * On exit, the plane contains the normalised complex image.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in] i_plane        Internal plane index.
+ * @param[in,out] status     Status return code.
+ */
+void oskar_imager_finalise_plane_wstack(oskar_Imager* h, int i_plane,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_FINALISE_PLANE_WSTACK_H_ */
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_GRID_PLANES_H_
+#define OSKAR_IMAGER_GRID_PLANES_H_
+
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns true if planes can be gridded together on the CPU.
+ *
+ * @details
+ * Returns true if the FFT algorithm is being used with gridding on the host,
+ * so that oskar_imager_update() can stage the visibilities for all
+ * polarisations of a channel and grid them using a single task.
+ *
+ * @param[in] h              Handle to imager.
+ */
+int oskar_imager_grid_planes_enabled(const oskar_Imager* h);
+
+/**
+ * @brief
+ * Stages visibilities for one polarisation of a channel.
+ *
+ * @details
+ * Copies the supplied (already weighted) visibilities into the current
+ * task, to be gridded when oskar_imager_grid_planes_submit() is called.
+ * All planes in a task must share the same baseline coordinates:
+ * these are copied only for the first plane.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in] num_vis        Number of visibilities.
+ * @param[in] uu             Visibility uu coordinates, in wavelengths.
+ * @param[in] vv             Visibility vv coordinates, in wavelengths.
+ * @param[in] amps           Visibility complex amplitudes.
+ * @param[in] weight         Visibility weights.
+ * @param[in] i_plane        Internal plane index.
+ * @param[in,out] status     Status return code.
+ */
+void oskar_imager_grid_planes_stage(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* amps,
+        const oskar_Mem* weight, int i_plane, int* status);
+
+/**
+ * @brief
+ * Submits the current task to the imager's worker threads.
+ *
+ * @details
+ * Starts gridding the staged planes in the background, so that the next
+ * channel can be selected and staged while this one is being gridded.
+ * If all tasks are in use, this waits for them to finish first.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in,out] status     Status return code.
+ */
+void oskar_imager_grid_planes_submit(oskar_Imager* h, int* status);
+
+/**
+ * @brief
+ * Waits for all submitted tasks to finish.
+ *
+ * @details
+ * Waits for all submitted tasks to finish, and updates the plane
+ * normalisation factors and visibility counters.
+ * The first error code set by any task is returned in \p status.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in,out] status     Status return code.
+ */
+void oskar_imager_grid_planes_wait(oskar_Imager* h, int* status);
+
+/**
+ * @brief
+ * Frees memory used by tasks for gridding planes together.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in,out] status     Status return code.
+ */
+void oskar_imager_grid_planes_free(oskar_Imager* h, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_GRID_PLANES_H_ */
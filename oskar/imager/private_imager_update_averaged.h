@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_UPDATE_AVERAGED_H_
+#define OSKAR_IMAGER_UPDATE_AVERAGED_H_
+
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Updates the imager with one channel of a visibility block.
+ *
+ * @details
+ * Updates the imager with the visibilities in one channel of a block,
+ * which must be ordered by (slowest) time, baseline (fastest).
+ *
+ * If baseline-dependent averaging is enabled, consecutive times on each
+ * baseline are first averaged together, for as long as the baseline's
+ * uv coordinates stay within the set fraction of a uv cell of the first
+ * time in the average. Coordinates and time centroids are averaged,
+ * visibilities are weighted averages, and the weights are summed.
+ * Otherwise, the visibilities are passed to oskar_imager_update() unchanged.
+ *
+ * @param[in,out] h             Handle to imager.
+ * @param[in]     num_times     Number of times in the block.
+ * @param[in]     num_baselines Number of baselines in the block.
+ * @param[in]     chan          Channel index of the visibilities.
+ * @param[in]     num_pols      Number of polarisations in the visibilities.
+ * @param[in]     uu            Visibility uu coordinates, in metres.
+ * @param[in]     vv            Visibility vv coordinates, in metres.
+ * @param[in]     ww            Visibility ww coordinates, in metres.
+ * @param[in]     amps          Visibility amplitudes (may be NULL).
+ * @param[in]     weight        Visibility weights.
+ * @param[in]     time_centroid Visibility time centroids (may be NULL).
+ * @param[in,out] status        Status return code.
+ */
+void oskar_imager_update_averaged(oskar_Imager* h, int num_times,
+        int num_baselines, int chan, int num_pols, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* ww, const oskar_Mem* amps,
+        const oskar_Mem* weight, const oskar_Mem* time_centroid, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_UPDATE_AVERAGED_H_ */
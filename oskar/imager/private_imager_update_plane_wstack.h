@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_UPDATE_PLANE_WSTACK_H_
+#define OSKAR_IMAGER_UPDATE_PLANE_WSTACK_H_
+
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Buffers visibilities for W-stacking.
+ *
+ * @details
+ * Appends the supplied visibilities to the buffers for plane \p i_plane.
+ * They are gridded, one W-layer at a time, by
+ * oskar_imager_finalise_plane_wstack().
+ *
+ * Points with negative W are stored as their complex conjugate at
+ * (-u, -v, -w), which leaves the real part of the image unchanged
+ * and halves the range of W to cover.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in] num_vis        Number of visibilities.
+ * @param[in] uu             Visibility uu coordinates, in wavelengths.
+ * @param[in] vv             Visibility vv coordinates, in wavelengths.
+ * @param[in] ww             Visibility ww coordinates, in wavelengths.
+ * @param[in] amps           Visibility complex amplitudes.
+ * @param[in] weight         Visibility weights.
+ * @param[in] i_plane        Internal plane index.
+ * @param[in] plane          Must be NULL: external planes are not supported.
+ * @param[in,out] status     Status return code.
+ */
+void oskar_imager_update_plane_wstack(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, int i_plane,
+        const oskar_Mem* plane, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_UPDATE_PLANE_WSTACK_H_ */
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_W_KERNEL_CACHE_H_
+#define OSKAR_IMAGER_W_KERNEL_CACHE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Tags in the OSKAR_TAG_GROUP_W_KERNELS group of a kernel cache file. */
+enum OSKAR_W_KERNEL_CACHE_TAGS
+{
+    OSKAR_W_KERNEL_CACHE_TAG_KEY_INT       = 1,
+    OSKAR_W_KERNEL_CACHE_TAG_KEY_DOUBLE    = 2,
+    OSKAR_W_KERNEL_CACHE_TAG_SUPPORT       = 3,
+    OSKAR_W_KERNEL_CACHE_TAG_KERNEL_START  = 4,
+    OSKAR_W_KERNEL_CACHE_TAG_PADDING       = 5,
+    OSKAR_W_KERNEL_CACHE_TAG_KERNELS       = 6
+};
+
+/**
+ * @brief
+ * Loads W-projection kernels from the cache, if possible.
+ *
+ * @details
+ * Looks for a cache file in the imager's W-kernel cache directory matching
+ * the current imaging parameters and, if one is found, sets the kernel
+ * support sizes, start offsets and compacted kernels from it.
+ * The compacted kernels are memory-mapped where possible.
+ *
+ * Failure to find or read a cache file is not an error.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in] conv_size      Side length of the FFT used to make the kernels.
+ *
+ * @return True if the kernels were loaded, otherwise false.
+ */
+int oskar_imager_w_kernel_cache_load(oskar_Imager* h, int conv_size);
+
+/**
+ * @brief
+ * Saves W-projection kernels to the cache.
+ *
+ * @details
+ * Writes the current kernel support sizes, start offsets and compacted
+ * kernels to a file in the imager's W-kernel cache directory, keyed by the
+ * current imaging parameters. A warning is logged if this fails.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in] conv_size      Side length of the FFT used to make the kernels.
+ */
+void oskar_imager_w_kernel_cache_save(oskar_Imager* h, int conv_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_W_KERNEL_CACHE_H_ */
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_WEIGHTS_HASH_H_
+#define OSKAR_IMAGER_WEIGHTS_HASH_H_
+
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns the hash table keys if a weights grid is stored sparsely.
+ *
+ * @details
+ * The imager's own weights grids start as hash tables of the grid cells
+ * that have been used, and are converted to dense grids once the uv coverage
+ * fills a significant fraction of the grid. While a grid is hashed,
+ * its values and guard digits are stored by slot rather than by cell.
+ *
+ * Returns NULL if the supplied grid is stored densely, or is not one of the
+ * imager's own weights grids.
+ *
+ * @param[in] h              Handle to imager.
+ * @param[in] weights_grid   Weights grid passed to the imager.
+ * @param[in] i_plane        Internal plane index.
+ */
+const oskar_Mem* oskar_imager_weights_hash_keys(const oskar_Imager* h,
+        const oskar_Mem* weights_grid, int i_plane);
+
+/**
+ * @brief
+ * Updates the weights grid for a plane using a hash table.
+ *
+ * @details
+ * Updates the weights grid \p i_plane with the supplied points.
+ * If the grid is still empty, it is started as a hash table if it can be.
+ * The table grows as required, until it is converted to a dense grid.
+ *
+ * Returns 0 without doing anything if the grid is stored densely,
+ * in which case oskar_grid_weights_write_d() or oskar_grid_weights_write_f()
+ * should be used instead.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in] num_points     Number of points.
+ * @param[in] uu             Point uu coordinates, in wavelengths.
+ * @param[in] vv             Point vv coordinates, in wavelengths.
+ * @param[in] weight         Point weights.
+ * @param[in] i_plane        Internal plane index.
+ * @param[out] num_skipped   Number of points that fell outside the grid.
+ * @param[in,out] status     Status return code.
+ *
+ * @return The number of points processed.
+ */
+size_t oskar_imager_weights_hash_update(oskar_Imager* h, size_t num_points,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* weight,
+        int i_plane, size_t* num_skipped, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_WEIGHTS_HASH_H_ */
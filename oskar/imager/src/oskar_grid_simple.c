@@ -37,6 +37,9 @@ extern "C" {
 #define D_SUPPORT 3
 #define D_OVERSAMPLE 100
 
+/* Side length of the tiles used by oskar_grid_simple_multi_mixed(). */
+#define MIXED_TILE_SIZE 64
+
 static void oskar_grid_simple_default_d(
         const double* RESTRICT conv_func,
         const size_t num_points,
@@ -332,6 +335,356 @@ void oskar_grid_simple_f(
     }
 }
 
+void oskar_grid_simple_multi_d(
+        const int support,
+        const int oversample,
+        const double* RESTRICT conv_func,
+        const size_t num_points,
+        const double* RESTRICT uu,
+        const double* RESTRICT vv,
+        const int num_planes,
+        const double* const* vis,
+        const double* const* weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT norm,
+        double* const* grids)
+{
+    size_t i;
+    const int grid_centre = grid_size / 2;
+    const int width = 2 * support + 1;
+    const double grid_scale = grid_size * cell_size_rad;
+    double* kernel = (double*) malloc(width * width * sizeof(double));
+
+    /* Loop over visibilities. */
+    *num_skipped = 0;
+    for (i = 0; i < num_points; ++i)
+    {
+        double sum = 0.0;
+        int j, k, p;
+
+        /* Convert UV coordinates to grid coordinates. */
+        const double pos_u = -uu[i] * grid_scale;
+        const double pos_v = vv[i] * grid_scale;
+        const int grid_u = (int)round(pos_u) + grid_centre;
+        const int grid_v = (int)round(pos_v) + grid_centre;
+
+        /* Scaled distance from nearest grid point. */
+        const int off_u = (int)round((round(pos_u) - pos_u) * oversample);
+        const int off_v = (int)round((round(pos_v) - pos_v) * oversample);
+
+        /* Catch points that would lie outside the grid. */
+        if (grid_u + support >= grid_size || grid_u - support < 0 ||
+                grid_v + support >= grid_size || grid_v - support < 0)
+        {
+            *num_skipped += 1;
+            continue;
+        }
+
+        /* Evaluate the kernel once, for use with all planes. */
+        for (j = -support; j <= support; ++j)
+        {
+            double* row = &kernel[(j + support) * width + support];
+            const double c1 = conv_func[abs(off_v + j * oversample)];
+            for (k = -support; k <= support; ++k)
+            {
+                const double c = conv_func[abs(off_u + k * oversample)] * c1;
+                row[k] = c;
+                sum += c;
+            }
+        }
+
+        /* Convolve this point onto each grid. */
+        for (p = 0; p < num_planes; ++p)
+        {
+            double* RESTRICT grid = grids[p];
+            const double weight_i = weight[p][i];
+            const double v_re = weight_i * vis[p][2 * i];
+            const double v_im = weight_i * vis[p][2 * i + 1];
+            for (j = -support; j <= support; ++j)
+            {
+                size_t p1;
+                const double* row = &kernel[(j + support) * width + support];
+                p1 = grid_v + j;
+                p1 *= grid_size; /* Tested to avoid int overflow. */
+                p1 += grid_u;
+                for (k = -support; k <= support; ++k)
+                {
+                    const size_t q = (p1 + k) << 1;
+                    grid[q]     += v_re * row[k];
+                    grid[q + 1] += v_im * row[k];
+                }
+            }
+            norm[p] += sum * weight_i;
+        }
+    }
+    free(kernel);
+}
+
+
+void oskar_grid_simple_multi_f(
+        const int support,
+        const int oversample,
+        const float* RESTRICT conv_func,
+        const size_t num_points,
+        const float* RESTRICT uu,
+        const float* RESTRICT vv,
+        const int num_planes,
+        const float* const* vis,
+        const float* const* weight,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT norm,
+        float* const* grids)
+{
+    size_t i;
+    const int grid_centre = grid_size / 2;
+    const int width = 2 * support + 1;
+    const float grid_scale = grid_size * cell_size_rad;
+    float* kernel = (float*) malloc(width * width * sizeof(float));
+
+    /* Loop over visibilities. */
+    *num_skipped = 0;
+    for (i = 0; i < num_points; ++i)
+    {
+        double sum = 0.0;
+        int j, k, p;
+
+        /* Convert UV coordinates to grid coordinates. */
+        const float pos_u = -uu[i] * grid_scale;
+        const float pos_v = vv[i] * grid_scale;
+        const int grid_u = (int)roundf(pos_u) + grid_centre;
+        const int grid_v = (int)roundf(pos_v) + grid_centre;
+
+        /* Scaled distance from nearest grid point. */
+        const int off_u = (int)roundf((roundf(pos_u) - pos_u) * oversample);
+        const int off_v = (int)roundf((roundf(pos_v) - pos_v) * oversample);
+
+        /* Catch points that would lie outside the grid. */
+        if (grid_u + support >= grid_size || grid_u - support < 0 ||
+                grid_v + support >= grid_size || grid_v - support < 0)
+        {
+            *num_skipped += 1;
+            continue;
+        }
+
+        /* Evaluate the kernel once, for use with all planes. */
+        for (j = -support; j <= support; ++j)
+        {
+            float* row = &kernel[(j + support) * width + support];
+            const float c1 = conv_func[abs(off_v + j * oversample)];
+            for (k = -support; k <= support; ++k)
+            {
+                const float c = conv_func[abs(off_u + k * oversample)] * c1;
+                row[k] = c;
+                sum += c;
+            }
+        }
+
+        /* Convolve this point onto each grid. */
+        for (p = 0; p < num_planes; ++p)
+        {
+            float* RESTRICT grid = grids[p];
+            const float weight_i = weight[p][i];
+            const float v_re = weight_i * vis[p][2 * i];
+            const float v_im = weight_i * vis[p][2 * i + 1];
+            for (j = -support; j <= support; ++j)
+            {
+                size_t p1;
+                const float* row = &kernel[(j + support) * width + support];
+                p1 = grid_v + j;
+                p1 *= grid_size; /* Tested to avoid int overflow. */
+                p1 += grid_u;
+                for (k = -support; k <= support; ++k)
+                {
+                    const size_t q = (p1 + k) << 1;
+                    grid[q]     += v_re * row[k];
+                    grid[q + 1] += v_im * row[k];
+                }
+            }
+            norm[p] += sum * weight_i;
+        }
+    }
+    free(kernel);
+}
+
+
+void oskar_grid_simple_multi_mixed(
+        const int support,
+        const int oversample,
+        const double* RESTRICT conv_func,
+        const size_t num_points,
+        const double* RESTRICT uu,
+        const double* RESTRICT vv,
+        const int num_planes,
+        const double* const* vis,
+        const double* const* weight,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT norm,
+        float* const* grids,
+        int* status)
+{
+    size_t i;
+    int t;
+    const int grid_centre = grid_size / 2;
+    const int width = 2 * support + 1;
+    const int tile_width = MIXED_TILE_SIZE + 2 * support;
+    const int num_tiles_u = (grid_size + MIXED_TILE_SIZE - 1) / MIXED_TILE_SIZE;
+    const int num_tiles = num_tiles_u * num_tiles_u;
+    const size_t tile_cells = (size_t) tile_width * (size_t) tile_width;
+    const double grid_scale = grid_size * cell_size_rad;
+    double *kernel = 0, *tile = 0;
+    int* tile_index = 0;
+    size_t *order = 0, *tile_end = 0;
+    *num_skipped = 0;
+    if (*status || num_points == 0) return;
+    kernel = (double*) malloc(width * width * sizeof(double));
+    tile = (double*) malloc(num_planes * 2 * tile_cells * sizeof(double));
+    tile_index = (int*) malloc(num_points * sizeof(int));
+    order = (size_t*) malloc(num_points * sizeof(size_t));
+    tile_end = (size_t*) calloc(num_tiles + 1, sizeof(size_t));
+    if (!kernel || !tile || !tile_index || !order || !tile_end)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(kernel);
+        free(tile);
+        free(tile_index);
+        free(order);
+        free(tile_end);
+        return;
+    }
+
+    /* Find the tile containing the centre of each visibility. */
+    for (i = 0; i < num_points; ++i)
+    {
+        const int grid_u = (int)round(-uu[i] * grid_scale) + grid_centre;
+        const int grid_v = (int)round(vv[i] * grid_scale) + grid_centre;
+        tile_index[i] = -1;
+        if (grid_u + support >= grid_size || grid_u - support < 0 ||
+                grid_v + support >= grid_size || grid_v - support < 0)
+        {
+            *num_skipped += 1;
+            continue;
+        }
+        tile_index[i] = (grid_v / MIXED_TILE_SIZE) * num_tiles_u +
+                grid_u / MIXED_TILE_SIZE;
+        tile_end[tile_index[i] + 1]++;
+    }
+
+    /* Sort the visibilities by tile, keeping their order within each tile. */
+    for (t = 0; t < num_tiles; ++t) tile_end[t + 1] += tile_end[t];
+    for (i = 0; i < num_points; ++i)
+        if (tile_index[i] >= 0) order[tile_end[tile_index[i]]++] = i;
+
+    /* Accumulate each tile in double precision, then add it to the grids. */
+    for (t = 0; t < num_tiles; ++t)
+    {
+        size_t m;
+        int j, k, p, u0 = grid_size, v0 = grid_size, u1 = 0, v1 = 0;
+        const size_t start = (t == 0) ? 0 : tile_end[t - 1];
+        const size_t end = tile_end[t];
+        if (start == end) continue;
+
+        /* Find the area of the tile that is used, including the support. */
+        for (m = start; m < end; ++m)
+        {
+            i = order[m];
+            const int grid_u = (int)round(-uu[i] * grid_scale) + grid_centre;
+            const int grid_v = (int)round(vv[i] * grid_scale) + grid_centre;
+            if (grid_u < u0) u0 = grid_u;
+            if (grid_u > u1) u1 = grid_u;
+            if (grid_v < v0) v0 = grid_v;
+            if (grid_v > v1) v1 = grid_v;
+        }
+        u0 -= support; v0 -= support; u1 += support; v1 += support;
+        const int box_u = 1 + u1 - u0, box_v = 1 + v1 - v0;
+        const size_t box_cells = (size_t) box_u * (size_t) box_v;
+        for (m = 0; m < 2 * box_cells * num_planes; ++m) tile[m] = 0.0;
+
+        /* Convolve the visibilities in this tile onto the tile buffers. */
+        for (m = start; m < end; ++m)
+        {
+            double sum = 0.0;
+            i = order[m];
+
+            /* Convert UV coordinates to grid coordinates. */
+            const double pos_u = -uu[i] * grid_scale;
+            const double pos_v = vv[i] * grid_scale;
+            const int grid_u = (int)round(pos_u) + grid_centre;
+            const int grid_v = (int)round(pos_v) + grid_centre;
+
+            /* Scaled distance from nearest grid point. */
+            const int off_u = (int)round((round(pos_u) - pos_u) * oversample);
+            const int off_v = (int)round((round(pos_v) - pos_v) * oversample);
+
+            /* Evaluate the kernel once, for use with all planes. */
+            for (j = -support; j <= support; ++j)
+            {
+                double* row = &kernel[(j + support) * width + support];
+                const double c1 = conv_func[abs(off_v + j * oversample)];
+                for (k = -support; k <= support; ++k)
+                {
+                    const double c =
+                            conv_func[abs(off_u + k * oversample)] * c1;
+                    row[k] = c;
+                    sum += c;
+                }
+            }
+
+            /* Convolve this point onto each tile buffer. */
+            for (p = 0; p < num_planes; ++p)
+            {
+                double* RESTRICT buffer = &tile[2 * box_cells * p];
+                const double weight_i = weight[p][i];
+                const double v_re = weight_i * vis[p][2 * i];
+                const double v_im = weight_i * vis[p][2 * i + 1];
+                for (j = -support; j <= support; ++j)
+                {
+                    const double* row =
+                            &kernel[(j + support) * width + support];
+                    const size_t p1 = (size_t) (grid_v + j - v0) * box_u +
+                            (grid_u - u0);
+                    for (k = -support; k <= support; ++k)
+                    {
+                        const size_t q = (p1 + k) << 1;
+                        buffer[q]     += v_re * row[k];
+                        buffer[q + 1] += v_im * row[k];
+                    }
+                }
+                norm[p] += sum * weight_i;
+            }
+        }
+
+        /* Flush the tile buffers to the grids. */
+        for (p = 0; p < num_planes; ++p)
+        {
+            const double* RESTRICT buffer = &tile[2 * box_cells * p];
+            for (j = 0; j < box_v; ++j)
+            {
+                size_t p1;
+                float* RESTRICT grid = grids[p];
+                const double* RESTRICT row = &buffer[2 * (size_t) j * box_u];
+                p1 = v0 + j;
+                p1 *= grid_size; /* Tested to avoid int overflow. */
+                p1 += u0;
+                grid += (p1 << 1);
+                for (k = 0; k < 2 * box_u; ++k)
+                    grid[k] = (float) ((double) grid[k] + row[k]);
+            }
+        }
+    }
+    free(kernel);
+    free(tile);
+    free(tile_index);
+    free(order);
+    free(tile_end);
+}
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,34 +9,187 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Minimum number of points for which the grid is updated in parallel. */
+#define MIN_PARALLEL_POINTS 32768
+
+/* Number of bands of grid rows for each thread. */
+#define BANDS_PER_THREAD 4
+
+/* Marks a point that lies outside the grid. */
+#define SKIP ((size_t) -1)
+
+/* Converts UV coordinates to a grid cell index, t. */
+#define GRID_CELL(ROUND, I) \
+        const int grid_u = (int)ROUND(-uu[I] * grid_scale) + grid_centre;\
+        const int grid_v = (int)ROUND(vv[I] * grid_scale) + grid_centre;\
+        size_t t = grid_v;\
+        t *= grid_size; /* Tested to avoid int overflow. */\
+        t += grid_u;\
+        const int outside = (grid_u >= grid_size || grid_u < 0 ||\
+                grid_v >= grid_size || grid_v < 0);
+
+/* Slot at which to start looking for a cell in a hashed grid. */
+#define HASH_SLOT(KEY, CAPACITY) \
+        (int) (((unsigned int) (KEY) * 2654435761u) & \
+                (unsigned int) ((CAPACITY) - 1))
+
+/*
+ * Workspace used to update a grid in parallel.
+ *
+ * The grid is divided into bands of whole rows, and points are sorted by
+ * band. Each thread then owns whole bands, so threads never write to the same
+ * cell, and every cell is summed in the same order as it is by one thread.
+ */
+struct Bands
+{
+    int num_chunks, num_bands;
+    size_t cells_per_band, *cell, *order, *band_start;
+};
+typedef struct Bands Bands;
+
+static void bands_free(Bands* b)
+{
+    free(b->cell);
+    free(b->order);
+    free(b->band_start);
+}
+
+static int bands_init(Bands* b, size_t num_points, int grid_size)
+{
+    int num_threads = 1;
+#ifdef _OPENMP
+    if (num_points >= MIN_PARALLEL_POINTS) num_threads = omp_get_max_threads();
+#endif
+    memset(b, 0, sizeof(Bands));
+    if (num_threads < 2) return 0;
+    b->num_chunks = num_threads;
+    b->num_bands = BANDS_PER_THREAD * num_threads;
+    if (b->num_bands > grid_size) b->num_bands = grid_size;
+    b->cells_per_band = (size_t) grid_size *
+            (size_t) ((grid_size + b->num_bands - 1) / b->num_bands);
+    b->cell = (size_t*) malloc(num_points * sizeof(size_t));
+    b->order = (size_t*) malloc(num_points * sizeof(size_t));
+    b->band_start = (size_t*) malloc((b->num_bands + 1) * sizeof(size_t));
+    if (b->cell && b->order && b->band_start) return 1;
+    bands_free(b);
+    return 0;
+}
+
+/*
+ * Sorts point indices by the band that contains them, once cell indices have
+ * been found. The sort is stable, so points in each band stay in their input
+ * order. Points outside the grid are dropped.
+ */
+static void bands_sort(Bands* b, const size_t num_points)
+{
+    int i_band, c;
+    size_t offset = 0;
+    const int num_chunks = b->num_chunks, num_bands = b->num_bands;
+    const size_t chunk_size = (num_points + num_chunks - 1) / num_chunks;
+    const size_t cells_per_band = b->cells_per_band;
+    const size_t* RESTRICT cell = b->cell;
+    size_t* RESTRICT order = b->order;
+    size_t* counts = (size_t*) calloc(
+            (size_t) num_chunks * num_bands, sizeof(size_t));
+
+    /* Count the points in each band, from each chunk of the input. */
+#pragma omp parallel for private(c)
+    for (c = 0; c < num_chunks; ++c)
+    {
+        size_t i, end = (c + 1) * chunk_size;
+        size_t* count = &counts[(size_t) c * num_bands];
+        if (end > num_points) end = num_points;
+        for (i = c * chunk_size; i < end; ++i)
+            if (cell[i] != SKIP) count[cell[i] / cells_per_band]++;
+    }
+
+    /* Convert the counts to output offsets, band by band. */
+    for (i_band = 0; i_band < num_bands; ++i_band)
+    {
+        b->band_start[i_band] = offset;
+        for (c = 0; c < num_chunks; ++c)
+        {
+            const size_t n = counts[(size_t) c * num_bands + i_band];
+            counts[(size_t) c * num_bands + i_band] = offset;
+            offset += n;
+        }
+    }
+    b->band_start[num_bands] = offset;
+
+    /* Scatter the point indices. */
+#pragma omp parallel for private(c)
+    for (c = 0; c < num_chunks; ++c)
+    {
+        size_t i, end = (c + 1) * chunk_size;
+        size_t* out = &counts[(size_t) c * num_bands];
+        if (end > num_points) end = num_points;
+        for (i = c * chunk_size; i < end; ++i)
+            if (cell[i] != SKIP) order[out[cell[i] / cells_per_band]++] = i;
+    }
+    free(counts);
+}
+
 void oskar_grid_weights_write_d(const size_t num_points,
         const double* RESTRICT uu, const double* RESTRICT vv,
         const double* RESTRICT weight, const double cell_size_rad,
         const int grid_size, size_t* RESTRICT num_skipped,
         double* RESTRICT grid)
 {
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
     size_t i;
+    const size_t num = num_points;
+#endif
+    Bands b;
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
-    /* Grid the existing weights. */
+    /* Grid the existing weights, in parallel if possible. */
     *num_skipped = 0;
-    for (i = 0; i < num_points; ++i)
+    if (bands_init(&b, num_points, grid_size))
+    {
+        int i_band;
+        size_t skipped = 0, *cell = b.cell;
+        const size_t *order = b.order, *band_start = b.band_start;
+#pragma omp parallel for private(i) reduction(+:skipped)
+        for (i = 0; i < num; ++i)
+        {
+            GRID_CELL(round, i)
+            if (outside)
+            {
+                cell[i] = SKIP;
+                skipped++;
+            }
+            else cell[i] = t;
+        }
+        bands_sort(&b, num_points);
+#pragma omp parallel for private(i_band) schedule(dynamic)
+        for (i_band = 0; i_band < b.num_bands; ++i_band)
+        {
+            size_t k;
+            for (k = band_start[i_band]; k < band_start[i_band + 1]; ++k)
+                grid[cell[order[k]]] += weight[order[k]];
+        }
+        bands_free(&b);
+        *num_skipped = skipped;
+        return;
+    }
+    for (i = 0; i < num; ++i)
     {
-        /* Convert UV coordinates to grid coordinates. */
-        const int grid_u = (int)round(-uu[i] * grid_scale) + grid_centre;
-        const int grid_v = (int)round(vv[i] * grid_scale) + grid_centre;
-        size_t t = grid_v;
-        t *= grid_size; /* Tested to avoid int overflow. */
-        t += grid_u;
+        GRID_CELL(round, i)
 
         /* Catch points that would lie outside the grid. */
-        if (grid_u >= grid_size || grid_u < 0 ||
-                grid_v >= grid_size || grid_v < 0)
+        if (outside)
         {
             *num_skipped += 1;
             continue;
@@ -53,32 +206,35 @@ void oskar_grid_weights_read_d(const size_t num_points,
         const double cell_size_rad, const int grid_size,
         size_t* RESTRICT num_skipped, const double* RESTRICT grid)
 {
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
     size_t i;
+    const size_t num = num_points;
+#endif
+    size_t skipped = 0;
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
     /* Look up gridded weight density at each point location. */
-    *num_skipped = 0;
-    for (i = 0; i < num_points; ++i)
+#pragma omp parallel for private(i) reduction(+:skipped) \
+        if(num_points >= MIN_PARALLEL_POINTS)
+    for (i = 0; i < num; ++i)
     {
-        /* Convert UV coordinates to grid coordinates. */
-        const int grid_u = (int)round(-uu[i] * grid_scale) + grid_centre;
-        const int grid_v = (int)round(vv[i] * grid_scale) + grid_centre;
-        size_t t = grid_v;
-        t *= grid_size; /* Tested to avoid int overflow. */
-        t += grid_u;
+        GRID_CELL(round, i)
 
         /* Catch points that would lie outside the grid. */
-        if (grid_u >= grid_size || grid_u < 0 ||
-                grid_v >= grid_size || grid_v < 0)
+        if (outside)
         {
-            *num_skipped += 1;
+            skipped++;
             continue;
         }
 
         /* Calculate new weight based on gridded point density. */
         weight_out[i] = (grid[t] != 0.0) ? weight_in[i] / grid[t] : 0.0;
     }
+    *num_skipped = skipped;
 }
 
 void oskar_grid_weights_write_f(const size_t num_points,
@@ -87,24 +243,56 @@ void oskar_grid_weights_write_f(const size_t num_points,
         const int grid_size, size_t* RESTRICT num_skipped,
         float* RESTRICT grid, float* RESTRICT grid_guard)
 {
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
     size_t i;
+    const size_t num = num_points;
+#endif
+    Bands b;
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
-    /* Grid the existing weights. */
+    /* Grid the existing weights, in parallel if possible. */
     *num_skipped = 0;
-    for (i = 0; i < num_points; ++i)
+    if (bands_init(&b, num_points, grid_size))
+    {
+        int i_band;
+        size_t skipped = 0, *cell = b.cell;
+        const size_t *order = b.order, *band_start = b.band_start;
+#pragma omp parallel for private(i) reduction(+:skipped)
+        for (i = 0; i < num; ++i)
+        {
+            GRID_CELL(roundf, i)
+            if (outside)
+            {
+                cell[i] = SKIP;
+                skipped++;
+            }
+            else cell[i] = t;
+        }
+        bands_sort(&b, num_points);
+#pragma omp parallel for private(i_band) schedule(dynamic)
+        for (i_band = 0; i_band < b.num_bands; ++i_band)
+        {
+            size_t k;
+            for (k = band_start[i_band]; k < band_start[i_band + 1]; ++k)
+            {
+                const size_t j = order[k], t = cell[j];
+                OSKAR_KAHAN_SUM(float, grid[t], weight[j], grid_guard[t]);
+            }
+        }
+        bands_free(&b);
+        *num_skipped = skipped;
+        return;
+    }
+    for (i = 0; i < num; ++i)
     {
-        /* Convert UV coordinates to grid coordinates. */
-        const int grid_u = (int)roundf(-uu[i] * grid_scale) + grid_centre;
-        const int grid_v = (int)roundf(vv[i] * grid_scale) + grid_centre;
-        size_t t = grid_v;
-        t *= grid_size; /* Tested to avoid int overflow. */
-        t += grid_u;
+        GRID_CELL(roundf, i)
 
         /* Catch points that would lie outside the grid. */
-        if (grid_u >= grid_size || grid_u < 0 ||
-                grid_v >= grid_size || grid_v < 0)
+        if (outside)
         {
             *num_skipped += 1;
             continue;
@@ -121,32 +309,221 @@ void oskar_grid_weights_read_f(const size_t num_points,
         const float cell_size_rad, const int grid_size,
         size_t* RESTRICT num_skipped, const float* RESTRICT grid)
 {
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
     size_t i;
+    const size_t num = num_points;
+#endif
+    size_t skipped = 0;
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
     /* Look up gridded weight density at each point location. */
+#pragma omp parallel for private(i) reduction(+:skipped) \
+        if(num_points >= MIN_PARALLEL_POINTS)
+    for (i = 0; i < num; ++i)
+    {
+        GRID_CELL(roundf, i)
+
+        /* Catch points that would lie outside the grid. */
+        if (outside)
+        {
+            skipped++;
+            continue;
+        }
+
+        /* Calculate new weight based on gridded point density. */
+        weight_out[i] = (grid[t] != 0.0) ? weight_in[i] / grid[t] : 0.0;
+    }
+    *num_skipped = skipped;
+}
+
+/* Returns the slot holding the given cell, or an empty slot if absent. */
+static int hash_find(const int key, const int capacity,
+        const int* RESTRICT keys)
+{
+    int slot = HASH_SLOT(key, capacity);
+    while (keys[slot] != key && keys[slot] >= 0)
+        slot = (slot + 1) & (capacity - 1);
+    return slot;
+}
+
+size_t oskar_grid_weights_hash_write_d(const size_t num_points,
+        const double* RESTRICT uu, const double* RESTRICT vv,
+        const double* RESTRICT weight, const double cell_size_rad,
+        const int grid_size, size_t* RESTRICT num_skipped,
+        const int capacity, int* RESTRICT num_used,
+        int* RESTRICT keys, double* RESTRICT values)
+{
+    size_t i;
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+
+    /* Grid the existing weights, until the table is half full. */
     *num_skipped = 0;
     for (i = 0; i < num_points; ++i)
     {
-        /* Convert UV coordinates to grid coordinates. */
-        const int grid_u = (int)roundf(-uu[i] * grid_scale) + grid_centre;
-        const int grid_v = (int)roundf(vv[i] * grid_scale) + grid_centre;
-        size_t t = grid_v;
-        t *= grid_size; /* Tested to avoid int overflow. */
-        t += grid_u;
+        GRID_CELL(round, i)
 
         /* Catch points that would lie outside the grid. */
-        if (grid_u >= grid_size || grid_u < 0 ||
-                grid_v >= grid_size || grid_v < 0)
+        if (outside)
         {
             *num_skipped += 1;
             continue;
         }
 
+        /* Find the cell, and claim a new slot for it if needed. */
+        const int slot = hash_find((int) t, capacity, keys);
+        if (keys[slot] < 0)
+        {
+            if (2 * (*num_used + 1) > capacity) break;
+            keys[slot] = (int) t;
+            *num_used += 1;
+        }
+
+        /* Add weight to the grid. */
+        values[slot] += weight[i];
+    }
+    return i;
+}
+
+void oskar_grid_weights_hash_read_d(const size_t num_points,
+        const double* RESTRICT uu, const double* RESTRICT vv,
+        const double* RESTRICT weight_in, double* RESTRICT weight_out,
+        const double cell_size_rad, const int grid_size,
+        size_t* RESTRICT num_skipped, const int capacity,
+        const int* RESTRICT keys, const double* RESTRICT values)
+{
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
+    size_t i;
+    const size_t num = num_points;
+#endif
+    size_t skipped = 0;
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+
+    /* Look up gridded weight density at each point location. */
+#pragma omp parallel for private(i) reduction(+:skipped) \
+        if(num_points >= MIN_PARALLEL_POINTS)
+    for (i = 0; i < num; ++i)
+    {
+        GRID_CELL(round, i)
+
+        /* Catch points that would lie outside the grid. */
+        if (outside)
+        {
+            skipped++;
+            continue;
+        }
+
         /* Calculate new weight based on gridded point density. */
-        weight_out[i] = (grid[t] != 0.0) ? weight_in[i] / grid[t] : 0.0;
+        const int slot = hash_find((int) t, capacity, keys);
+        const double w = (keys[slot] < 0) ? 0.0 : values[slot];
+        weight_out[i] = (w != 0.0) ? weight_in[i] / w : 0.0;
     }
+    *num_skipped = skipped;
+}
+
+size_t oskar_grid_weights_hash_write_f(const size_t num_points,
+        const float* RESTRICT uu, const float* RESTRICT vv,
+        const float* RESTRICT weight, const float cell_size_rad,
+        const int grid_size, size_t* RESTRICT num_skipped,
+        const int capacity, int* RESTRICT num_used,
+        int* RESTRICT keys, float* RESTRICT values, float* RESTRICT guard)
+{
+    size_t i;
+    const int grid_centre = grid_size / 2;
+    const float grid_scale = grid_size * cell_size_rad;
+
+    /* Grid the existing weights, until the table is half full. */
+    *num_skipped = 0;
+    for (i = 0; i < num_points; ++i)
+    {
+        GRID_CELL(roundf, i)
+
+        /* Catch points that would lie outside the grid. */
+        if (outside)
+        {
+            *num_skipped += 1;
+            continue;
+        }
+
+        /* Find the cell, and claim a new slot for it if needed. */
+        const int slot = hash_find((int) t, capacity, keys);
+        if (keys[slot] < 0)
+        {
+            if (2 * (*num_used + 1) > capacity) break;
+            keys[slot] = (int) t;
+            *num_used += 1;
+        }
+
+        /* Add weight to the grid using Kahan summation. */
+        OSKAR_KAHAN_SUM(float, values[slot], weight[i], guard[slot]);
+    }
+    return i;
+}
+
+void oskar_grid_weights_hash_read_f(const size_t num_points,
+        const float* RESTRICT uu, const float* RESTRICT vv,
+        const float* RESTRICT weight_in, float* RESTRICT weight_out,
+        const float cell_size_rad, const int grid_size,
+        size_t* RESTRICT num_skipped, const int capacity,
+        const int* RESTRICT keys, const float* RESTRICT values)
+{
+#ifdef OSKAR_OS_WIN
+    int i;
+    const int num = (const int) num_points;
+#else
+    size_t i;
+    const size_t num = num_points;
+#endif
+    size_t skipped = 0;
+    const int grid_centre = grid_size / 2;
+    const float grid_scale = grid_size * cell_size_rad;
+
+    /* Look up gridded weight density at each point location. */
+#pragma omp parallel for private(i) reduction(+:skipped) \
+        if(num_points >= MIN_PARALLEL_POINTS)
+    for (i = 0; i < num; ++i)
+    {
+        GRID_CELL(roundf, i)
+
+        /* Catch points that would lie outside the grid. */
+        if (outside)
+        {
+            skipped++;
+            continue;
+        }
+
+        /* Calculate new weight based on gridded point density. */
+        const int slot = hash_find((int) t, capacity, keys);
+        const float w = (keys[slot] < 0) ? 0.0f : values[slot];
+        weight_out[i] = (w != 0.0f) ? weight_in[i] / w : 0.0f;
+    }
+    *num_skipped = skipped;
+}
+
+void oskar_grid_weights_hash_insert_d(const int key, const double value,
+        const int capacity, int* RESTRICT keys, double* RESTRICT values)
+{
+    const int slot = hash_find(key, capacity, keys);
+    keys[slot] = key;
+    values[slot] = value;
+}
+
+void oskar_grid_weights_hash_insert_f(const int key, const float value,
+        const float guard_value, const int capacity, int* RESTRICT keys,
+        float* RESTRICT values, float* RESTRICT guard)
+{
+    const int slot = hash_find(key, capacity, keys);
+    keys[slot] = key;
+    values[slot] = value;
+    guard[slot] = guard_value;
 }
 
 #ifdef __cplusplus
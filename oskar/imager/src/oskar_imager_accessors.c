@@ -32,6 +32,7 @@ const char* oskar_imager_algorithm(const oskar_Imager* h)
     {
     case OSKAR_ALGORITHM_FFT:    return "FFT";
     case OSKAR_ALGORITHM_WPROJ:  return "W-projection";
+    case OSKAR_ALGORITHM_WSTACK: return "W-stacking";
     case OSKAR_ALGORITHM_DFT_2D: return "DFT 2D";
     case OSKAR_ALGORITHM_DFT_3D: return "DFT 3D";
     default:                     return "";
@@ -39,6 +40,12 @@ const char* oskar_imager_algorithm(const oskar_Imager* h)
 }
 
 
+double oskar_imager_bda_max_cell_fraction(const oskar_Imager* h)
+{
+    return h->bda_max_cell_fraction;
+}
+
+
 double oskar_imager_cellsize(const oskar_Imager* h)
 {
     return (h->cellsize_rad * (180.0 / M_PI)) * 3600.0;
@@ -119,6 +126,12 @@ const char* oskar_imager_image_type(const oskar_Imager* h)
 }
 
 
+const char* oskar_imager_w_kernel_cache_dir(const oskar_Imager* h)
+{
+    return h->w_kernel_cache_dir;
+}
+
+
 char* const* oskar_imager_input_files(const oskar_Imager* h)
 {
     return h->input_files;
@@ -186,6 +199,11 @@ int oskar_imager_plane_type(const oskar_Imager* h)
     case OSKAR_ALGORITHM_DFT_2D:
     case OSKAR_ALGORITHM_DFT_3D:
         return h->imager_prec;
+    case OSKAR_ALGORITHM_FFT:
+        if (h->single_precision_grids && h->imager_prec == OSKAR_DOUBLE &&
+                (!h->grid_on_gpu || h->num_gpus == 0))
+            return OSKAR_SINGLE_COMPLEX;
+        return h->imager_prec | OSKAR_COMPLEX;
     default:
         return h->imager_prec | OSKAR_COMPLEX;
     }
@@ -216,6 +234,14 @@ void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
         h->support = 3;
         h->oversample = 100;
     }
+    else if (!strncmp(type, "W-S", 3) || !strncmp(type, "W-s", 3) ||
+            !strncmp(type, "w-s", 3))
+    {
+        h->algorithm = OSKAR_ALGORITHM_WSTACK;
+        h->kernel_type = 'S';
+        h->support = 3;
+        h->oversample = 100;
+    }
     else if (!strncmp(type, "W", 1) || !strncmp(type, "w", 1))
     {
         h->algorithm = OSKAR_ALGORITHM_WPROJ;
@@ -235,6 +261,12 @@ void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
 }
 
 
+void oskar_imager_set_bda_max_cell_fraction(oskar_Imager* h, double value)
+{
+    h->bda_max_cell_fraction = value;
+}
+
+
 void oskar_imager_set_cellsize(oskar_Imager* h, double cellsize_arcsec)
 {
     h->set_cellsize = 1;
@@ -499,6 +531,8 @@ void oskar_imager_set_num_devices(oskar_Imager* h, int value)
 {
     int status = 0;
     oskar_imager_free_device_data(h, &status);
+    oskar_thread_pool_free(h->thread_pool);
+    h->thread_pool = 0;
     if (value < 1)
         value = (h->num_gpus == 0) ? oskar_get_num_procs() : h->num_gpus;
     if (value < 1) value = 1;
@@ -535,6 +569,12 @@ void oskar_imager_set_scale_norm_with_num_input_files(oskar_Imager* h,
 }
 
 
+void oskar_imager_set_single_precision_grids(oskar_Imager* h, int value)
+{
+    h->single_precision_grids = value;
+}
+
+
 void oskar_imager_set_size(oskar_Imager* h, int size, int* status)
 {
     if (*status) return;
@@ -691,6 +731,20 @@ void oskar_imager_set_num_w_planes(oskar_Imager* h, int value)
 }
 
 
+void oskar_imager_set_w_kernel_cache_dir(oskar_Imager* h, const char* dir)
+{
+    int len = 0;
+    free(h->w_kernel_cache_dir);
+    h->w_kernel_cache_dir = 0;
+    if (dir) len = (int) strlen(dir);
+    if (len > 0)
+    {
+        h->w_kernel_cache_dir = (char*) calloc(1 + len, 1);
+        strcpy(h->w_kernel_cache_dir, dir);
+    }
+}
+
+
 void oskar_imager_set_weighting(oskar_Imager* h, const char* type, int* status)
 {
     if (*status || !type) return;
@@ -704,6 +758,12 @@ void oskar_imager_set_weighting(oskar_Imager* h, const char* type, int* status)
 }
 
 
+int oskar_imager_single_precision_grids(const oskar_Imager* h)
+{
+    return h->single_precision_grids;
+}
+
+
 int oskar_imager_size(const oskar_Imager* h)
 {
     return h->image_size;
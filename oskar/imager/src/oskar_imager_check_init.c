@@ -29,12 +29,17 @@ void oskar_imager_check_init(oskar_Imager* h, int* status)
                 calloc(h->num_planes, sizeof(oskar_Mem*));
         h->weights_guard = (oskar_Mem**)
                 calloc(h->num_planes, sizeof(oskar_Mem*));
+        h->weights_keys = (oskar_Mem**)
+                calloc(h->num_planes, sizeof(oskar_Mem*));
+        h->weights_num_used = (int*) calloc(h->num_planes, sizeof(int));
         for (i = 0; i < h->num_planes; ++i)
         {
             h->weights_grids[i] = oskar_mem_create(h->imager_prec,
                     OSKAR_CPU, 0, status);
             h->weights_guard[i] = oskar_mem_create(h->imager_prec,
                     OSKAR_CPU, 0, status);
+            h->weights_keys[i] = oskar_mem_create(OSKAR_INT,
+                    OSKAR_CPU, 0, status);
         }
     }
 
@@ -55,6 +60,11 @@ void oskar_imager_check_init(oskar_Imager* h, int* status)
     case OSKAR_ALGORITHM_WPROJ:
         oskar_imager_init_wproj(h, status);
         break;
+    case OSKAR_ALGORITHM_WSTACK:
+        /* W-layers are gridded on the host when the imager is finalised. */
+        h->grid_on_gpu = 0;
+        oskar_imager_init_fft(h, status);
+        break;
     default:
         *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
     }
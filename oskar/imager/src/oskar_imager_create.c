@@ -75,6 +75,12 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     h->weight_im   = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->weight_tmp  = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->time_im     = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->bda_uu      = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->bda_vv      = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->bda_ww      = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->bda_vis     = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, 0, status);
+    h->bda_weight  = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->bda_time    = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
 
     /* Check data type. */
     if (imager_precision != OSKAR_SINGLE && imager_precision != OSKAR_DOUBLE)
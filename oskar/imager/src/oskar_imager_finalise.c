@@ -32,6 +32,7 @@
 #include "imager/oskar_grid_correction.h"
 #include "imager/oskar_grid_functions_pillbox.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
+#include "imager/private_imager_finalise_plane_wstack.h"
 #include "imager/private_imager_free_device_data.h"
 #include "math/oskar_fft.h"
 #include "math/oskar_fftphase.h"
@@ -40,6 +41,7 @@
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_get_memory_usage.h"
 #include "utility/oskar_timer.h"
+#include "utility/oskar_trace.h"
 
 #include <fitsio.h>
 #include <math.h>
@@ -122,7 +124,9 @@ void oskar_imager_finalise(oskar_Imager* h,
         oskar_mem_free(temp, status);
     }
 
-    /* Copy grids to output grid planes if given. */
+    /* Copy grids to output grid planes if given.
+     * There is no single grid per plane when using W-stacking. */
+    if (h->algorithm == OSKAR_ALGORITHM_WSTACK) num_output_grids = 0;
     for (i = 0; (i < h->num_planes) && (i < num_output_grids); ++i)
     {
         oskar_Mem *plane = h->planes[i];
@@ -142,39 +146,59 @@ void oskar_imager_finalise(oskar_Imager* h,
     const size_t num_pix = (size_t)h->image_size * (size_t)h->image_size;
     if (h->fits_file[0] || output_images)
     {
-        /* Finalise all the planes. */
+        /* Finalise each plane in turn, and copy or write out the image. */
         for (i = 0; i < h->num_planes; ++i)
         {
-            oskar_Mem *plane = h->planes[i];
+            oskar_Mem *plane = h->planes[i], *temp = 0;
             if (h->grid_on_gpu && h->num_gpus > 0 && !(
                     h->algorithm == OSKAR_ALGORITHM_DFT_2D ||
                     h->algorithm == OSKAR_ALGORITHM_DFT_3D))
                 plane = h->d[0].planes[i];
-            oskar_imager_finalise_plane(h, plane, h->plane_norm[i], status);
-            if (plane != h->planes[i])
+
+            /* Convert a single-precision grid into a temporary buffer
+             * for the FFT, so only one plane at a time is held in
+             * double precision. The grid itself is left unchanged. */
+            if (oskar_mem_precision(plane) != h->imager_prec)
+            {
+                oskar_timer_resume(h->tmr_grid_finalise);
+                temp = oskar_mem_convert_precision(plane,
+                        h->imager_prec, status);
+                plane = temp;
+                oskar_timer_pause(h->tmr_grid_finalise);
+            }
+            if (h->algorithm == OSKAR_ALGORITHM_WSTACK)
+                oskar_imager_finalise_plane_wstack(h, i, status);
+            else
+                oskar_imager_finalise_plane(h, plane, h->plane_norm[i],
+                        status);
+            if (!temp && plane != h->planes[i])
+            {
                 oskar_mem_copy(h->planes[i], plane, status);
-            oskar_imager_trim_image(h, h->planes[i],
+                plane = h->planes[i];
+            }
+            oskar_imager_trim_image(h, plane,
                     oskar_imager_plane_size(h), h->image_size, status);
-        }
 
-        /* Copy images to output image planes if given. */
-        for (i = 0; (i < h->num_planes) && (i < num_output_images); ++i)
-        {
-            if (!(output_images[i]))
-                output_images[i] = oskar_mem_create(h->imager_prec,
-                        OSKAR_CPU, num_pix, status);
-            oskar_mem_ensure(output_images[i], num_pix, status);
-            memcpy(oskar_mem_void(output_images[i]),
-                    oskar_mem_void_const(h->planes[i]),
-                    num_pix * oskar_mem_element_size(h->imager_prec));
-        }
+            /* Copy image to output image plane if given. */
+            if (i < num_output_images && !*status)
+            {
+                if (!(output_images[i]))
+                    output_images[i] = oskar_mem_create(h->imager_prec,
+                            OSKAR_CPU, num_pix, status);
+                oskar_mem_ensure(output_images[i], num_pix, status);
+                memcpy(oskar_mem_void(output_images[i]),
+                        oskar_mem_void_const(plane),
+                        num_pix * oskar_mem_element_size(h->imager_prec));
+            }
 
-        /* Write to files if required. */
-        oskar_timer_resume(h->tmr_write);
-        for (c = 0, i = 0; c < h->num_im_channels; ++c)
-            for (p = 0; p < h->num_im_pols; ++p, ++i)
-                write_plane(h, h->planes[i], c, p, status);
-        oskar_timer_pause(h->tmr_write);
+            /* Write to file if required. */
+            oskar_timer_resume(h->tmr_write);
+            c = i / h->num_im_pols;
+            p = i % h->num_im_pols;
+            write_plane(h, plane, c, p, status);
+            oskar_timer_pause(h->tmr_write);
+            oskar_mem_free(temp, status);
+        }
     }
 
     /* Record memory usage. */
@@ -235,7 +259,7 @@ void oskar_imager_finalise(oskar_Imager* h,
             oskar_log_value(h->log, 'M', 0,
                     "Visibilities processed", "%lu",
                     (unsigned long) (h->num_vis_processed));
-        if (h->num_w_planes > 0)
+        if (h->num_w_planes > 0 && h->algorithm == OSKAR_ALGORITHM_WPROJ)
             oskar_log_value(h->log, 'M', 0,
                     "W-projection planes", "%d", h->num_w_planes);
         if (h->fov_deg > 0.1)
@@ -355,7 +379,7 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
     {
         oskar_Mem* corr_func = 0;
         corr_func = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, size, status);
-        if (h->algorithm != OSKAR_ALGORITHM_FFT)
+        if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
             oskar_grid_correction_function_spheroidal(size, h->oversample,
                     oskar_mem_double(corr_func, status));
         else
@@ -435,8 +459,11 @@ void write_plane(oskar_Imager* h, oskar_Mem* plane,
     firstpix[1] = 1;
     firstpix[2] = 1 + c;
     const int num_pixels = h->image_size * h->image_size;
+    const double t0 = oskar_trace_time();
     fits_write_pix(h->fits_file[p], datatype, firstpix, num_pixels,
             oskar_mem_void(plane), status);
+    oskar_trace_add("io", "fits_write_pix", t0, -1, "bytes",
+            num_pixels * oskar_mem_element_size(oskar_mem_type(plane)));
 }
 
 
@@ -54,6 +54,12 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     oskar_mem_free(h->weight_im, status);
     oskar_mem_free(h->weight_tmp, status);
     oskar_mem_free(h->time_im, status);
+    oskar_mem_free(h->bda_uu, status);
+    oskar_mem_free(h->bda_vv, status);
+    oskar_mem_free(h->bda_ww, status);
+    oskar_mem_free(h->bda_vis, status);
+    oskar_mem_free(h->bda_weight, status);
+    oskar_mem_free(h->bda_time, status);
     oskar_timer_free(h->tmr_grid_finalise);
     oskar_timer_free(h->tmr_grid_update);
     oskar_timer_free(h->tmr_init);
@@ -67,6 +73,7 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     oskar_timer_free(h->tmr_coord_scan);
     oskar_timer_free(h->tmr_weights_grid);
     oskar_timer_free(h->tmr_weights_lookup);
+    oskar_thread_pool_free(h->thread_pool);
     oskar_mutex_free(h->mutex);
     oskar_log_free(h->log);
     oskar_imager_free_device_data(h, status);
@@ -75,6 +82,7 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     free(h->input_files);
     free(h->input_root);
     free(h->output_root);
+    free(h->w_kernel_cache_dir);
     free(h->ms_column);
     free(h->gpu_ids);
     free(h->d);
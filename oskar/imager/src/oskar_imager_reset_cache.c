@@ -6,6 +6,7 @@
 #include "imager/private_imager.h"
 #include "imager/oskar_imager_reset_cache.h"
 #include "imager/private_imager_free_device_data.h"
+#include "imager/private_imager_grid_planes.h"
 #include "log/oskar_log.h"
 #include "math/oskar_fft.h"
 #include <fitsio.h>
@@ -30,6 +31,7 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     h->num_im_channels = 0;
 
     /* Clear FFT caches. */
+    oskar_imager_grid_planes_free(h, status);
     oskar_fft_free(h->fft); h->fft = 0;
     oskar_mem_free(h->corr_func, status); h->corr_func = 0;
 
@@ -41,6 +43,7 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     oskar_mem_free(h->w_support, status); h->w_support = 0;
     oskar_mem_free(h->w_kernels_compact, status); h->w_kernels_compact = 0;
     oskar_mem_free(h->w_kernel_start, status); h->w_kernel_start = 0;
+    oskar_binary_free(h->w_kernel_cache); h->w_kernel_cache = 0;
 
     /* Free the image planes. */
     if (h->planes)
@@ -49,15 +52,35 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     free(h->planes); h->planes = 0;
     free(h->plane_norm); h->plane_norm = 0;
 
+    /* Free any buffered W-stacking data. */
+    if (h->ws_num_vis)
+        for (i = 0; i < h->num_planes; ++i)
+        {
+            oskar_mem_free(h->ws_uu[i], status);
+            oskar_mem_free(h->ws_vv[i], status);
+            oskar_mem_free(h->ws_ww[i], status);
+            oskar_mem_free(h->ws_vis[i], status);
+            oskar_mem_free(h->ws_weight[i], status);
+        }
+    free(h->ws_uu); h->ws_uu = 0;
+    free(h->ws_vv); h->ws_vv = 0;
+    free(h->ws_ww); h->ws_ww = 0;
+    free(h->ws_vis); h->ws_vis = 0;
+    free(h->ws_weight); h->ws_weight = 0;
+    free(h->ws_num_vis); h->ws_num_vis = 0;
+
     /* Free the weights grids if they exist. */
     if (h->weights_grids)
         for (i = 0; i < h->num_planes; ++i)
         {
             oskar_mem_free(h->weights_grids[i], status);
             oskar_mem_free(h->weights_guard[i], status);
+            oskar_mem_free(h->weights_keys[i], status);
         }
     free(h->weights_grids); h->weights_grids = 0;
     free(h->weights_guard); h->weights_guard = 0;
+    free(h->weights_keys); h->weights_keys = 0;
+    free(h->weights_num_used); h->weights_num_used = 0;
 
     /* Collapse temp arrays. */
     oskar_mem_realloc(h->uu_im, 0, status);
@@ -70,6 +93,12 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     oskar_mem_realloc(h->weight_im, 0, status);
     oskar_mem_realloc(h->weight_tmp, 0, status);
     oskar_mem_realloc(h->time_im, 0, status);
+    oskar_mem_realloc(h->bda_uu, 0, status);
+    oskar_mem_realloc(h->bda_vv, 0, status);
+    oskar_mem_realloc(h->bda_ww, 0, status);
+    oskar_mem_realloc(h->bda_vis, 0, status);
+    oskar_mem_realloc(h->bda_weight, 0, status);
+    oskar_mem_realloc(h->bda_time, 0, status);
     oskar_mem_free(h->stokes, status); h->stokes = 0;
 
     /* Close any open FITS files. */
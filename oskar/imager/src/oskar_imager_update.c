@@ -10,13 +10,17 @@
 #include "imager/private_imager_create_fits_files.h"
 #include "imager/private_imager_filter_time.h"
 #include "imager/private_imager_filter_uv.h"
+#include "imager/private_imager_grid_planes.h"
 #include "imager/private_imager_set_num_planes.h"
 #include "imager/private_imager_select_data.h"
+#include "imager/private_imager_update_averaged.h"
 #include "imager/private_imager_update_plane_dft.h"
 #include "imager/private_imager_update_plane_fft.h"
 #include "imager/private_imager_update_plane_wproj.h"
+#include "imager/private_imager_update_plane_wstack.h"
 #include "imager/private_imager_weight_radial.h"
 #include "imager/private_imager_weight_uniform.h"
+#include "imager/private_imager_weights_hash.h"
 #include "log/oskar_log.h"
 #include "utility/oskar_device.h"
 
@@ -31,8 +35,8 @@ extern "C" {
 static void oskar_imager_allocate_planes(oskar_Imager* h, int *status);
 static void oskar_imager_update_weights_grid(oskar_Imager* h,
         size_t num_points, const oskar_Mem* uu, const oskar_Mem* vv,
-        const oskar_Mem* ww, const oskar_Mem* weight, oskar_Mem* weights_grid,
-        oskar_Mem* weights_guard, int* status);
+        const oskar_Mem* ww, const oskar_Mem* weight, int i_plane,
+        oskar_Mem* weights_grid, oskar_Mem* weights_guard, int* status);
 
 void oskar_imager_update_from_block(oskar_Imager* h,
         const oskar_VisHeader* hdr, oskar_VisBlock* block,
@@ -71,7 +75,7 @@ void oskar_imager_update_from_block(oskar_Imager* h,
     if (!weight)
     {
         size_t num_weights = num_rows * num_pols;
-        weight = oskar_mem_create(oskar_mem_precision(
+        weight = oskar_mem_create_uninit(oskar_mem_precision(
                 oskar_vis_block_cross_correlations_const(block)),
                 OSKAR_CPU, num_weights, status);
         oskar_mem_set_value_real(weight, 1.0, 0, num_weights, status);
@@ -79,7 +83,7 @@ void oskar_imager_update_from_block(oskar_Imager* h,
     }
 
     /* Fill in the time centroid values. */
-    time_centroid = oskar_mem_create(OSKAR_DOUBLE,
+    time_centroid = oskar_mem_create_uninit(OSKAR_DOUBLE,
             OSKAR_CPU, num_rows, status);
     for (t = 0; t < num_times; ++t)
         oskar_mem_set_value_real(time_centroid,
@@ -93,7 +97,7 @@ void oskar_imager_update_from_block(oskar_Imager* h,
     /* Update the imager with the data. */
     if (!h->coords_only)
     {
-        oskar_Mem* scratch = oskar_mem_create(oskar_mem_type(
+        oskar_Mem* scratch = oskar_mem_create_uninit(oskar_mem_type(
                 oskar_vis_block_cross_correlations_const(block)),
                 OSKAR_CPU, num_rows, status);
         for (c = 0; c < num_channels; ++c)
@@ -114,8 +118,8 @@ void oskar_imager_update_from_block(oskar_Imager* h,
                             num_baselines, status);
                 }
                 oskar_timer_pause(h->tmr_copy_convert);
-                oskar_imager_update(h, num_rows,
-                        start_chan + c, start_chan + c, num_pols,
+                oskar_imager_update_averaged(h, num_times, num_baselines,
+                        start_chan + c, num_pols,
                         oskar_vis_block_baseline_uu_metres_const(block),
                         oskar_vis_block_baseline_vv_metres_const(block),
                         oskar_vis_block_baseline_ww_metres_const(block),
@@ -134,8 +138,8 @@ void oskar_imager_update_from_block(oskar_Imager* h,
             if (freq_hz >= h->freq_min_hz &&
                     (freq_hz <= h->freq_max_hz || h->freq_max_hz == 0.0))
             {
-                oskar_imager_update(h, num_rows,
-                        start_chan + c, start_chan + c, num_pols,
+                oskar_imager_update_averaged(h, num_times, num_baselines,
+                        start_chan + c, num_pols,
                         oskar_vis_block_baseline_uu_metres_const(block),
                         oskar_vis_block_baseline_vv_metres_const(block),
                         oskar_vis_block_baseline_ww_metres_const(block),
@@ -261,12 +265,49 @@ static void oskar_imager_sort_by_abs_w(size_t num_vis,
 }
 #endif
 
+static const oskar_Mem* apply_weighting(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* weight,
+        int i_plane, const oskar_Mem* weights_grid, int* status)
+{
+    size_t num_skipped = 0;
+    const oskar_Mem* weight_out = weight;
+    switch (h->weighting)
+    {
+    case OSKAR_WEIGHTING_NATURAL:
+        /* Nothing to do. */
+        break;
+    case OSKAR_WEIGHTING_RADIAL:
+        oskar_timer_resume(h->tmr_weights_lookup);
+        oskar_imager_weight_radial(num_vis, uu, vv, weight, h->weight_tmp,
+                status);
+        oskar_timer_pause(h->tmr_weights_lookup);
+        weight_out = h->weight_tmp;
+        break;
+    case OSKAR_WEIGHTING_UNIFORM:
+        oskar_timer_resume(h->tmr_weights_lookup);
+        oskar_imager_weight_uniform(num_vis, uu, vv, weight, h->weight_tmp,
+                h->cellsize_rad, oskar_imager_plane_size(h), weights_grid,
+                oskar_imager_weights_hash_keys(h, weights_grid, i_plane),
+                &num_skipped, status);
+        oskar_timer_pause(h->tmr_weights_lookup);
+        weight_out = h->weight_tmp;
+        break;
+    default:
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+        break;
+    }
+    if (num_skipped > 0)
+        oskar_log_warning(h->log, "Skipped %lu visibility weights.",
+                (unsigned long) num_skipped);
+    return weight_out;
+}
+
 void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         int end_chan, int num_pols, const oskar_Mem* uu, const oskar_Mem* vv,
         const oskar_Mem* ww, const oskar_Mem* amps, const oskar_Mem* weight,
         const oskar_Mem* time_centroid, int* status)
 {
-    int c, p, i_plane;
+    int c, p, i_plane, grid_planes;
     size_t max_num_vis;
     oskar_Mem *tu = 0, *tv = 0, *tw = 0, *ta = 0, *th = 0;
     const oskar_Mem *u_in, *v_in, *w_in, *amp_in = 0, *weight_in;
@@ -362,7 +403,11 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         oskar_mem_ensure(h->ww_tmp, max_num_vis, status);
     }
 
-    /* Loop over each image plane being made. */
+    /* Loop over each image plane being made.
+     * When gridding on the host with the FFT algorithm, all polarisations
+     * of a channel are gridded together, while the next channel is
+     * being selected. */
+    grid_planes = oskar_imager_grid_planes_enabled(h);
     for (c = 0; c < h->num_im_channels; ++c)
     {
         for (p = 0; p < h->num_im_pols; ++p)
@@ -421,10 +466,37 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
 
             /* Update this image plane with the visibilities. */
             i_plane = h->num_im_pols * c + p;
-            oskar_imager_update_plane(h, num_vis, h->uu_im, h->vv_im,
-                    h->ww_im, (h->coords_only ? 0 : h->vis_im), h->weight_im,
-                    i_plane, 0, 0, h->weights_grids[i_plane], status);
+            if (grid_planes)
+            {
+                /* Stage the plane to grid with the others in this channel. */
+                const oskar_Mem* weight_ptr = apply_weighting(h, num_vis,
+                        h->uu_im, h->vv_im, h->weight_im, i_plane,
+                        h->weights_grids[i_plane], status);
+                oskar_timer_resume(h->tmr_grid_update);
+                oskar_imager_grid_planes_stage(h, num_vis, h->uu_im, h->vv_im,
+                        h->vis_im, weight_ptr, i_plane, status);
+                oskar_timer_pause(h->tmr_grid_update);
+            }
+            else
+                oskar_imager_update_plane(h, num_vis, h->uu_im, h->vv_im,
+                        h->ww_im, (h->coords_only ? 0 : h->vis_im),
+                        h->weight_im, i_plane, 0, 0,
+                        h->weights_grids[i_plane], status);
         }
+
+        /* Grid all polarisations of this channel in the background. */
+        if (grid_planes)
+        {
+            oskar_timer_resume(h->tmr_grid_update);
+            oskar_imager_grid_planes_submit(h, status);
+            oskar_timer_pause(h->tmr_grid_update);
+        }
+    }
+    if (grid_planes)
+    {
+        oskar_timer_resume(h->tmr_grid_update);
+        oskar_imager_grid_planes_wait(h, status);
+        oskar_timer_pause(h->tmr_grid_update);
     }
 
     oskar_mem_free(tu, status);
@@ -480,7 +552,7 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
     if (h->coords_only)
     {
         oskar_imager_update_weights_grid(h, num_vis, pu, pv, pw, ph,
-                weights_grid, h->weights_guard[i_plane], status);
+                i_plane, weights_grid, h->weights_guard[i_plane], status);
     }
     else
     {
@@ -501,36 +573,10 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
         oskar_imager_check_init(h, status);
 
         /* Re-weight visibilities if required. */
-        switch (h->weighting)
-        {
-        case OSKAR_WEIGHTING_NATURAL:
-            /* Nothing to do. */
-            break;
-        case OSKAR_WEIGHTING_RADIAL:
-            oskar_timer_resume(h->tmr_weights_lookup);
-            oskar_imager_weight_radial(num_vis, pu, pv, ph, h->weight_tmp,
-                    status);
-            oskar_timer_pause(h->tmr_weights_lookup);
-            ph = h->weight_tmp;
-            break;
-        case OSKAR_WEIGHTING_UNIFORM:
-            oskar_timer_resume(h->tmr_weights_lookup);
-            oskar_imager_weight_uniform(num_vis, pu, pv, ph, h->weight_tmp,
-                    h->cellsize_rad, oskar_imager_plane_size(h), weights_grid,
-                    &num_skipped, status);
-            oskar_timer_pause(h->tmr_weights_lookup);
-            ph = h->weight_tmp;
-            break;
-        default:
-            *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
-            break;
-        }
-        if (num_skipped > 0)
-            oskar_log_warning(h->log, "Skipped %lu visibility weights.",
-                    (unsigned long) num_skipped);
+        ph = apply_weighting(h, num_vis, pu, pv, ph, i_plane,
+                weights_grid, status);
 
         /* Update the supplied plane with the supplied visibilities. */
-        num_skipped = 0;
         if (!plane_norm_ptr && h->plane_norm)
             plane_norm_ptr = &(h->plane_norm[i_plane]);
         oskar_timer_resume(h->tmr_grid_update);
@@ -549,6 +595,10 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
             oskar_imager_update_plane_wproj(h, num_vis, pu, pv, pw, pa, ph,
                     i_plane, plane, plane_norm_ptr, &num_skipped, status);
             break;
+        case OSKAR_ALGORITHM_WSTACK:
+            oskar_imager_update_plane_wstack(h, num_vis, pu, pv, pw, pa, ph,
+                    i_plane, plane, status);
+            break;
         default:
             *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
             break;
@@ -571,7 +621,7 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
 
 void oskar_imager_update_weights_grid(oskar_Imager* h, size_t num_points,
         const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
-        const oskar_Mem* weight, oskar_Mem* weights_grid,
+        const oskar_Mem* weight, int i_plane, oskar_Mem* weights_grid,
         oskar_Mem* weights_guard, int* status)
 {
     if (*status) return;
@@ -579,36 +629,43 @@ void oskar_imager_update_weights_grid(oskar_Imager* h, size_t num_points,
     /* Update the weights grid. */
     if (h->weighting == OSKAR_WEIGHTING_UNIFORM)
     {
-        size_t num_cells, num_skipped = 0;
+        size_t num_cells, num_skipped = 0, num_skipped_dense = 0, start = 0;
+        oskar_timer_resume(h->tmr_weights_grid);
 
-        /* Resize the grid of weights if needed. */
+        /* Use a sparse hashed grid while the uv coverage allows it. */
+        if (h->weights_grids && weights_grid == h->weights_grids[i_plane])
+            start = oskar_imager_weights_hash_update(h, num_points,
+                    uu, vv, weight, i_plane, &num_skipped, status);
+
+        /* Grid any remaining points, resizing the grid of weights if needed. */
         const int grid_size = oskar_imager_plane_size(h);
         num_cells = (size_t) grid_size * (size_t) grid_size;
-        oskar_mem_ensure(weights_grid, num_cells, status);
-        if (*status) return;
-
-        oskar_timer_resume(h->tmr_weights_grid);
-        if (oskar_mem_precision(weights_grid) == OSKAR_DOUBLE)
+        if (start < num_points)
+            oskar_mem_ensure(weights_grid, num_cells, status);
+        if (start < num_points && !*status)
         {
-            oskar_grid_weights_write_d(num_points,
-                    oskar_mem_double_const(uu, status),
-                    oskar_mem_double_const(vv, status),
-                    oskar_mem_double_const(weight, status),
-                    h->cellsize_rad, grid_size, &num_skipped,
-                    oskar_mem_double(weights_grid, status));
-        }
-        else
-        {
-            oskar_mem_ensure(weights_guard, num_cells, status);
-            if (*status) return;
-            oskar_grid_weights_write_f(num_points,
-                    oskar_mem_float_const(uu, status),
-                    oskar_mem_float_const(vv, status),
-                    oskar_mem_float_const(weight, status),
-                    (float) (h->cellsize_rad), grid_size, &num_skipped,
-                    oskar_mem_float(weights_grid, status),
-                    oskar_mem_float(weights_guard, status));
+            if (oskar_mem_precision(weights_grid) == OSKAR_DOUBLE)
+                oskar_grid_weights_write_d(num_points - start,
+                        oskar_mem_double_const(uu, status) + start,
+                        oskar_mem_double_const(vv, status) + start,
+                        oskar_mem_double_const(weight, status) + start,
+                        h->cellsize_rad, grid_size, &num_skipped_dense,
+                        oskar_mem_double(weights_grid, status));
+            else
+            {
+                oskar_mem_ensure(weights_guard, num_cells, status);
+                if (!*status)
+                    oskar_grid_weights_write_f(num_points - start,
+                            oskar_mem_float_const(uu, status) + start,
+                            oskar_mem_float_const(vv, status) + start,
+                            oskar_mem_float_const(weight, status) + start,
+                            (float) (h->cellsize_rad), grid_size,
+                            &num_skipped_dense,
+                            oskar_mem_float(weights_grid, status),
+                            oskar_mem_float(weights_guard, status));
+            }
         }
+        num_skipped += num_skipped_dense;
         if (num_skipped > 0)
             oskar_log_warning(h->log, "Skipped %lu visibility weights.",
                     (unsigned long) num_skipped);
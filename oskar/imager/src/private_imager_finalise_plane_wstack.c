@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/oskar_grid_simple.h"
+#include "imager/private_imager_finalise_plane_wstack.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_timer.h"
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static int get_num_layers(oskar_Imager* h, double w_min, double w_max);
+
+static void add_w_corrected_layer_d(int size, double delta, double w_layer,
+        const double* RESTRICT layer, double* RESTRICT plane);
+
+static void add_w_corrected_layer_f(int size, double delta, double w_layer,
+        const float* RESTRICT layer, float* RESTRICT plane);
+
+static void sort_by_layer_d(size_t num_vis, const int* layer_index,
+        size_t* next, const oskar_Mem* const* in, oskar_Mem** out);
+
+static void sort_by_layer_f(size_t num_vis, const int* layer_index,
+        size_t* next, const oskar_Mem* const* in, oskar_Mem** out);
+
+
+void oskar_imager_finalise_plane_wstack(oskar_Imager* h, int i_plane,
+        int* status)
+{
+    int i, num_layers = 0, *layer_index = 0;
+    size_t j, num_skipped = 0, *offset = 0, *next = 0;
+    double norm = 0.0, w_min = DBL_MAX, w_max = 0.0, w_inc = 0.0;
+    oskar_Mem *sorted[4], *layer = 0;
+    const oskar_Mem* buffered[4];
+    if (*status) return;
+
+    /* Clear the plane, which will hold the image. */
+    oskar_Mem* plane = h->planes[i_plane];
+    oskar_mem_clear_contents(plane, status);
+    const size_t num_vis = h->ws_num_vis ? h->ws_num_vis[i_plane] : 0;
+    if (num_vis == 0 || *status) return;
+
+    /* Get the range of W, and the W-layer for each visibility.
+     * W is not negative, as the points were flipped when buffered. */
+    const int prec = h->imager_prec;
+    oskar_timer_resume(h->tmr_grid_update);
+    layer_index = (int*) calloc(num_vis, sizeof(int));
+    if (!layer_index)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        oskar_timer_pause(h->tmr_grid_update);
+        return;
+    }
+    if (prec == OSKAR_DOUBLE)
+    {
+        const double* ww = oskar_mem_double_const(h->ws_ww[i_plane], status);
+        for (j = 0; j < num_vis; ++j)
+        {
+            if (ww[j] < w_min) w_min = ww[j];
+            if (ww[j] > w_max) w_max = ww[j];
+        }
+        num_layers = get_num_layers(h, w_min, w_max);
+        w_inc = (w_max - w_min) / num_layers;
+        if (w_inc > 0.0)
+            for (j = 0; j < num_vis; ++j)
+                layer_index[j] = (int) ((ww[j] - w_min) / w_inc);
+    }
+    else
+    {
+        const float* ww = oskar_mem_float_const(h->ws_ww[i_plane], status);
+        for (j = 0; j < num_vis; ++j)
+        {
+            if (ww[j] < w_min) w_min = ww[j];
+            if (ww[j] > w_max) w_max = ww[j];
+        }
+        num_layers = get_num_layers(h, w_min, w_max);
+        w_inc = (w_max - w_min) / num_layers;
+        if (w_inc > 0.0)
+            for (j = 0; j < num_vis; ++j)
+                layer_index[j] = (int) ((ww[j] - w_min) / w_inc);
+    }
+
+    /* Count the visibilities in each layer, to get the start offsets. */
+    offset = (size_t*) calloc(num_layers + 1, sizeof(size_t));
+    next = (size_t*) malloc(num_layers * sizeof(size_t));
+    if (!offset || !next)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(layer_index);
+        free(offset);
+        free(next);
+        oskar_timer_pause(h->tmr_grid_update);
+        return;
+    }
+    for (j = 0; j < num_vis; ++j)
+    {
+        if (layer_index[j] >= num_layers) layer_index[j] = num_layers - 1;
+        offset[layer_index[j] + 1]++;
+    }
+    for (i = 0; i < num_layers; ++i) offset[i + 1] += offset[i];
+    memcpy(next, offset, num_layers * sizeof(size_t));
+
+    /* Sort the buffered visibilities by layer, then release the buffers. */
+    buffered[0] = h->ws_uu[i_plane];
+    buffered[1] = h->ws_vv[i_plane];
+    buffered[2] = h->ws_vis[i_plane];
+    buffered[3] = h->ws_weight[i_plane];
+    for (i = 0; i < 4; ++i)
+        sorted[i] = oskar_mem_create(oskar_mem_type(buffered[i]),
+                OSKAR_CPU, num_vis, status);
+    if (!*status)
+    {
+        if (prec == OSKAR_DOUBLE)
+            sort_by_layer_d(num_vis, layer_index, next, buffered, sorted);
+        else
+            sort_by_layer_f(num_vis, layer_index, next, buffered, sorted);
+    }
+    free(layer_index);
+    free(next);
+    oskar_mem_realloc(h->ws_uu[i_plane], 0, status);
+    oskar_mem_realloc(h->ws_vv[i_plane], 0, status);
+    oskar_mem_realloc(h->ws_ww[i_plane], 0, status);
+    oskar_mem_realloc(h->ws_vis[i_plane], 0, status);
+    oskar_mem_realloc(h->ws_weight[i_plane], 0, status);
+    h->ws_num_vis[i_plane] = 0;
+    oskar_timer_pause(h->tmr_grid_update);
+    oskar_log_message(h->log, 'M', 1, "Using %d W-layer(s) for plane %d.",
+            num_layers, i_plane);
+
+    /* Grid, transform and correct each layer in turn,
+     * so that only one grid is needed at once. */
+    const int size = oskar_imager_plane_size(h);
+    const double delta = sin(h->cellsize_rad);
+    layer = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            (size_t) size * (size_t) size, status);
+    for (i = 0; i < num_layers; ++i)
+    {
+        size_t layer_skipped = 0;
+        const size_t start = offset[i];
+        const size_t num_points = offset[i + 1] - start;
+        const double w_layer = w_min + (i + 0.5) * w_inc;
+        if (*status) break;
+        if (num_points == 0) continue;
+        oskar_mem_clear_contents(layer, status);
+        oskar_timer_resume(h->tmr_grid_update);
+        if (prec == OSKAR_DOUBLE)
+            oskar_grid_simple_d(h->support, h->oversample,
+                    oskar_mem_double_const(h->conv_func, status), num_points,
+                    oskar_mem_double_const(sorted[0], status) + start,
+                    oskar_mem_double_const(sorted[1], status) + start,
+                    oskar_mem_double_const(sorted[2], status) + 2 * start,
+                    oskar_mem_double_const(sorted[3], status) + start,
+                    h->cellsize_rad, size, &layer_skipped, &norm,
+                    oskar_mem_double(layer, status));
+        else
+            oskar_grid_simple_f(h->support, h->oversample,
+                    oskar_mem_float_const(h->conv_func, status), num_points,
+                    oskar_mem_float_const(sorted[0], status) + start,
+                    oskar_mem_float_const(sorted[1], status) + start,
+                    oskar_mem_float_const(sorted[2], status) + 2 * start,
+                    oskar_mem_float_const(sorted[3], status) + start,
+                    (float) (h->cellsize_rad), size, &layer_skipped, &norm,
+                    oskar_mem_float(layer, status));
+        oskar_timer_pause(h->tmr_grid_update);
+        num_skipped += layer_skipped;
+
+        /* Transform the layer without normalisation. */
+        oskar_imager_finalise_plane(h, layer, 0.0, status);
+        if (*status) break;
+
+        /* Apply the W-phase correction for the layer, and accumulate. */
+        oskar_timer_resume(h->tmr_grid_finalise);
+        if (prec == OSKAR_DOUBLE)
+            add_w_corrected_layer_d(size, delta, w_layer,
+                    oskar_mem_double_const(layer, status),
+                    oskar_mem_double(plane, status));
+        else
+            add_w_corrected_layer_f(size, delta, w_layer,
+                    oskar_mem_float_const(layer, status),
+                    oskar_mem_float(plane, status));
+        oskar_timer_pause(h->tmr_grid_finalise);
+    }
+    if (num_skipped > 0)
+        oskar_log_warning(h->log, "Skipped %lu visibility points.",
+                (unsigned long) num_skipped);
+
+    /* Apply normalisation, adjusted as for the other algorithms. */
+    if (h->scale_norm_with_num_input_files) norm /= h->num_files;
+    h->plane_norm[i_plane] = norm;
+    if (norm > 0.0 || norm < 0.0)
+        oskar_mem_scale_real(plane, 1.0 / norm,
+                0, oskar_mem_length(plane), status);
+
+    /* Clean up. */
+    free(offset);
+    for (i = 0; i < 4; ++i) oskar_mem_free(sorted[i], status);
+    oskar_mem_free(layer, status);
+}
+
+
+static int get_num_layers(oskar_Imager* h, double w_min, double w_max)
+{
+    double one_minus_n = 1.0;
+    if (h->num_w_planes > 0) return h->num_w_planes;
+
+    /* Use enough layers to keep the phase error small at the corners. */
+    const double l_max = (oskar_imager_plane_size(h) / 2) *
+            sin(h->cellsize_rad);
+    const double r2 = 2.0 * l_max * l_max;
+    if (r2 < 1.0) one_minus_n = 1.0 - sqrt(1.0 - r2);
+    return 1 + (int) (2.0 * M_PI * (w_max - w_min) * one_minus_n);
+}
+
+
+static void add_w_corrected_layer_d(int size, double delta, double w_layer,
+        const double* RESTRICT layer, double* RESTRICT plane)
+{
+    int iy;
+#pragma omp parallel for
+    for (iy = 0; iy < size; ++iy)
+    {
+        int ix;
+        const double m = (iy - size / 2) * delta;
+        for (ix = 0; ix < size; ++ix)
+        {
+            double c = 1.0, s = 0.0;
+            const double l = (ix - size / 2) * delta;
+            const double r2 = l * l + m * m;
+            const size_t p = ((size_t) iy * size + ix) << 1;
+            if (r2 < 1.0)
+            {
+                const double phase = 2.0 * M_PI * w_layer *
+                        (1.0 - sqrt(1.0 - r2));
+                c = cos(phase);
+                s = sin(phase);
+            }
+            plane[p]     += layer[p] * c - layer[p + 1] * s;
+            plane[p + 1] += layer[p] * s + layer[p + 1] * c;
+        }
+    }
+}
+
+
+static void add_w_corrected_layer_f(int size, double delta, double w_layer,
+        const float* RESTRICT layer, float* RESTRICT plane)
+{
+    int iy;
+#pragma omp parallel for
+    for (iy = 0; iy < size; ++iy)
+    {
+        int ix;
+        const double m = (iy - size / 2) * delta;
+        for (ix = 0; ix < size; ++ix)
+        {
+            float c = 1.0f, s = 0.0f;
+            const double l = (ix - size / 2) * delta;
+            const double r2 = l * l + m * m;
+            const size_t p = ((size_t) iy * size + ix) << 1;
+            if (r2 < 1.0)
+            {
+                const double phase = 2.0 * M_PI * w_layer *
+                        (1.0 - sqrt(1.0 - r2));
+                c = (float) cos(phase);
+                s = (float) sin(phase);
+            }
+            plane[p]     += layer[p] * c - layer[p + 1] * s;
+            plane[p + 1] += layer[p] * s + layer[p + 1] * c;
+        }
+    }
+}
+
+
+static void sort_by_layer_d(size_t num_vis, const int* layer_index,
+        size_t* next, const oskar_Mem* const* in, oskar_Mem** out)
+{
+    size_t j;
+    const double *uu_in = (const double*) oskar_mem_void_const(in[0]);
+    const double *vv_in = (const double*) oskar_mem_void_const(in[1]);
+    const double *vis_in = (const double*) oskar_mem_void_const(in[2]);
+    const double *wt_in = (const double*) oskar_mem_void_const(in[3]);
+    double *uu_out = (double*) oskar_mem_void(out[0]);
+    double *vv_out = (double*) oskar_mem_void(out[1]);
+    double *vis_out = (double*) oskar_mem_void(out[2]);
+    double *wt_out = (double*) oskar_mem_void(out[3]);
+    for (j = 0; j < num_vis; ++j)
+    {
+        const size_t p = next[layer_index[j]]++;
+        uu_out[p] = uu_in[j];
+        vv_out[p] = vv_in[j];
+        vis_out[2 * p]     = vis_in[2 * j];
+        vis_out[2 * p + 1] = vis_in[2 * j + 1];
+        wt_out[p] = wt_in[j];
+    }
+}
+
+
+static void sort_by_layer_f(size_t num_vis, const int* layer_index,
+        size_t* next, const oskar_Mem* const* in, oskar_Mem** out)
+{
+    size_t j;
+    const float *uu_in = (const float*) oskar_mem_void_const(in[0]);
+    const float *vv_in = (const float*) oskar_mem_void_const(in[1]);
+    const float *vis_in = (const float*) oskar_mem_void_const(in[2]);
+    const float *wt_in = (const float*) oskar_mem_void_const(in[3]);
+    float *uu_out = (float*) oskar_mem_void(out[0]);
+    float *vv_out = (float*) oskar_mem_void(out[1]);
+    float *vis_out = (float*) oskar_mem_void(out[2]);
+    float *wt_out = (float*) oskar_mem_void(out[3]);
+    for (j = 0; j < num_vis; ++j)
+    {
+        const size_t p = next[layer_index[j]]++;
+        uu_out[p] = uu_in[j];
+        vv_out[p] = vv_in[j];
+        vis_out[2 * p]     = vis_in[2 * j];
+        vis_out[2 * p + 1] = vis_in[2 * j + 1];
+        wt_out[p] = wt_in[j];
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/oskar_grid_simple.h"
+#include "imager/private_imager_grid_planes.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void* run_task(void* arg);
+
+int oskar_imager_grid_planes_enabled(const oskar_Imager* h)
+{
+    return (h->algorithm == OSKAR_ALGORITHM_FFT && !h->coords_only &&
+            (!h->grid_on_gpu || h->num_gpus == 0));
+}
+
+void oskar_imager_grid_planes_stage(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* amps,
+        const oskar_Mem* weight, int i_plane, int* status)
+{
+    int i;
+    GridPlanesTask* task;
+    if (*status || num_vis == 0) return;
+    if (!h->planes)
+    {
+        *status = OSKAR_ERR_MEMORY_NOT_ALLOCATED;
+        return;
+    }
+
+    /* Create the tasks if required: one for each worker thread. */
+    if (!h->thread_pool)
+        h->thread_pool = oskar_thread_pool_create(h->num_devices);
+    if (!h->grid_tasks)
+    {
+        const int prec = h->imager_prec;
+        h->num_grid_tasks = oskar_thread_pool_num_threads(h->thread_pool);
+        h->num_grid_tasks_pending = 0;
+        h->grid_tasks = (GridPlanesTask*) calloc(h->num_grid_tasks,
+                sizeof(GridPlanesTask));
+        if (!h->grid_tasks)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        for (i = 0; i < h->num_grid_tasks; ++i)
+        {
+            int p;
+            task = &h->grid_tasks[i];
+            task->h = h;
+            task->uu = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+            task->vv = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+            for (p = 0; p < 4; ++p)
+            {
+                task->vis[p] = oskar_mem_create(prec | OSKAR_COMPLEX,
+                        OSKAR_CPU, 0, status);
+                task->weight[p] = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+            }
+        }
+    }
+
+    /* Check the image plane. */
+    oskar_Mem* plane = h->planes[i_plane];
+    if (oskar_mem_location(plane) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_precision(plane) != h->imager_prec &&
+            oskar_mem_type(plane) != oskar_imager_plane_type(h))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    const int grid_size = oskar_imager_plane_size(h);
+    const size_t num_cells = ((size_t) grid_size) * ((size_t) grid_size);
+    oskar_mem_ensure(plane, num_cells, status);
+
+    /* Copy the coordinates for the first plane only. */
+    task = &h->grid_tasks[h->num_grid_tasks_pending];
+    if (task->num_planes == 0)
+    {
+        task->num_vis = num_vis;
+        oskar_mem_ensure(task->uu, num_vis, status);
+        oskar_mem_ensure(task->vv, num_vis, status);
+        oskar_mem_copy_contents(task->uu, uu, 0, 0, num_vis, status);
+        oskar_mem_copy_contents(task->vv, vv, 0, 0, num_vis, status);
+    }
+    else if (task->num_vis != num_vis || task->num_planes >= 4)
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+    if (*status) return;
+
+    /* Copy the visibilities and weights. */
+    const int p = task->num_planes;
+    oskar_mem_ensure(task->vis[p], num_vis, status);
+    oskar_mem_ensure(task->weight[p], num_vis, status);
+    oskar_mem_copy_contents(task->vis[p], amps, 0, 0, num_vis, status);
+    oskar_mem_copy_contents(task->weight[p], weight, 0, 0, num_vis, status);
+    if (*status) return;
+    task->i_plane[p] = i_plane;
+    task->norm[p] = 0.0;
+    task->num_planes++;
+}
+
+void oskar_imager_grid_planes_submit(oskar_Imager* h, int* status)
+{
+    GridPlanesTask* task;
+    if (*status || !h->grid_tasks) return;
+    task = &h->grid_tasks[h->num_grid_tasks_pending];
+    if (task->num_planes == 0) return;
+    oskar_thread_pool_submit(h->thread_pool, run_task, (void*)task);
+    h->num_grid_tasks_pending++;
+    if (h->num_grid_tasks_pending == h->num_grid_tasks)
+        oskar_imager_grid_planes_wait(h, status);
+}
+
+void oskar_imager_grid_planes_wait(oskar_Imager* h, int* status)
+{
+    int i, p;
+    size_t num_skipped = 0;
+    if (!h->grid_tasks || h->num_grid_tasks_pending == 0) return;
+    oskar_thread_pool_wait(h->thread_pool);
+    for (i = 0; i < h->num_grid_tasks_pending; ++i)
+    {
+        GridPlanesTask* task = &h->grid_tasks[i];
+        if (task->status && !*status) *status = task->status;
+        task->status = 0;
+        for (p = 0; p < task->num_planes; ++p)
+            h->plane_norm[task->i_plane[p]] += task->norm[p];
+        h->num_vis_processed +=
+                task->num_planes * (task->num_vis - task->num_skipped);
+        num_skipped += task->num_planes * task->num_skipped;
+        task->num_planes = 0;
+    }
+    h->num_grid_tasks_pending = 0;
+    if (num_skipped > 0 && !*status)
+        oskar_log_warning(h->log, "Skipped %lu visibility points.",
+                (unsigned long) num_skipped);
+}
+
+void oskar_imager_grid_planes_free(oskar_Imager* h, int* status)
+{
+    int i, p;
+    if (!h->grid_tasks) return;
+    h->num_grid_tasks_pending = 0;
+    oskar_thread_pool_wait(h->thread_pool);
+    for (i = 0; i < h->num_grid_tasks; ++i)
+    {
+        GridPlanesTask* task = &h->grid_tasks[i];
+        oskar_mem_free(task->uu, status);
+        oskar_mem_free(task->vv, status);
+        for (p = 0; p < 4; ++p)
+        {
+            oskar_mem_free(task->vis[p], status);
+            oskar_mem_free(task->weight[p], status);
+        }
+    }
+    free(h->grid_tasks);
+    h->grid_tasks = 0;
+    h->num_grid_tasks = 0;
+}
+
+static void* run_task(void* arg)
+{
+    int p, status = 0;
+    GridPlanesTask* task = (GridPlanesTask*) arg;
+    oskar_Imager* h = task->h;
+    const int grid_size = oskar_imager_plane_size(h);
+    if (h->imager_prec == OSKAR_DOUBLE &&
+            oskar_mem_precision(h->planes[task->i_plane[0]]) == OSKAR_SINGLE)
+    {
+        /* Single-precision grids: accumulate in double precision. */
+        const double* vis[4];
+        const double* weight[4];
+        float* grids[4];
+        for (p = 0; p < task->num_planes; ++p)
+        {
+            vis[p] = oskar_mem_double_const(task->vis[p], &status);
+            weight[p] = oskar_mem_double_const(task->weight[p], &status);
+            grids[p] = oskar_mem_float(h->planes[task->i_plane[p]], &status);
+        }
+        oskar_grid_simple_multi_mixed(h->support, h->oversample,
+                oskar_mem_double_const(h->conv_func, &status), task->num_vis,
+                oskar_mem_double_const(task->uu, &status),
+                oskar_mem_double_const(task->vv, &status),
+                task->num_planes, vis, weight, h->cellsize_rad,
+                grid_size, &task->num_skipped, task->norm, grids, &status);
+    }
+    else if (h->imager_prec == OSKAR_DOUBLE)
+    {
+        const double* vis[4];
+        const double* weight[4];
+        double* grids[4];
+        for (p = 0; p < task->num_planes; ++p)
+        {
+            vis[p] = oskar_mem_double_const(task->vis[p], &status);
+            weight[p] = oskar_mem_double_const(task->weight[p], &status);
+            grids[p] = oskar_mem_double(h->planes[task->i_plane[p]], &status);
+        }
+        oskar_grid_simple_multi_d(h->support, h->oversample,
+                oskar_mem_double_const(h->conv_func, &status), task->num_vis,
+                oskar_mem_double_const(task->uu, &status),
+                oskar_mem_double_const(task->vv, &status),
+                task->num_planes, vis, weight, h->cellsize_rad,
+                grid_size, &task->num_skipped, task->norm, grids);
+    }
+    else
+    {
+        const float* vis[4];
+        const float* weight[4];
+        float* grids[4];
+        for (p = 0; p < task->num_planes; ++p)
+        {
+            vis[p] = oskar_mem_float_const(task->vis[p], &status);
+            weight[p] = oskar_mem_float_const(task->weight[p], &status);
+            grids[p] = oskar_mem_float(h->planes[task->i_plane[p]], &status);
+        }
+        oskar_grid_simple_multi_f(h->support, h->oversample,
+                oskar_mem_float_const(h->conv_func, &status), task->num_vis,
+                oskar_mem_float_const(task->uu, &status),
+                oskar_mem_float_const(task->vv, &status),
+                task->num_planes, vis, weight, (float) (h->cellsize_rad),
+                grid_size, &task->num_skipped, task->norm, grids);
+    }
+    task->status = status;
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
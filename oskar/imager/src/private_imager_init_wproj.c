@@ -32,10 +32,12 @@
 #include "imager/private_imager_composite_nearest_even.h"
 #include "imager/private_imager_generate_w_phase_screen.h"
 #include "imager/private_imager_init_wproj.h"
+#include "imager/private_imager_w_kernel_cache.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
 #include "math/oskar_cmath.h"
 #include "math/oskar_fft.h"
 #include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_get_num_procs.h"
 #include "utility/oskar_device.h"
 
 #include <stdlib.h>
@@ -54,10 +56,22 @@ extern "C" {
 static void oskar_imager_evaluate_w_kernel_params(const oskar_Imager* h,
         int* num_w_planes, double* w_scale);
 
+static void oskar_imager_generate_w_kernels(oskar_Imager* h, int conv_size,
+        int* status);
+
+static int oskar_imager_evaluate_w_kernel_conv_size(const oskar_Imager* h,
+        int num_w_planes);
+
 static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
-        int num_w_planes, double w_scale,
+        int num_w_planes, double w_scale, int conv_size,
         size_t* conv_size_half, double* norm_factor, int* status);
 
+static void oskar_imager_evaluate_w_kernel_plane(int iw, int conv_size,
+        int inner, double sampling, double w_scale, const oskar_Mem* taper,
+        oskar_FFT* fft, oskar_Mem* screen, oskar_Mem* screen_host,
+        size_t conv_size_half, oskar_Mem* kernel_cube, double* max_val,
+        int* status);
+
 static oskar_Mem* oskar_imager_evaluate_w_kernel_support_sizes(
         int num_w_planes, int oversample, size_t conv_size_half,
         const oskar_Mem* kernel_cube, double norm_factor, int* status);
@@ -81,55 +95,29 @@ static void oskar_imager_rearrange_kernels(int num_w_planes,
  */
 void oskar_imager_init_wproj(oskar_Imager* h, int* status)
 {
-    size_t conv_size_half = 0;
-    double norm_factor = 1.;
-    oskar_Mem *kernel_cube = 0;
-    const int save_kernels = 0;
     if (*status) return;
 
     /* Evaluate number of w-projection planes, and w-scale. */
     oskar_imager_evaluate_w_kernel_params(h, &h->num_w_planes, &h->w_scale);
+    const int conv_size = oskar_imager_evaluate_w_kernel_conv_size(h,
+            h->num_w_planes);
 
-    /* Evaluate unnormalised kernels. */
-    kernel_cube = oskar_imager_evaluate_w_kernel_cube(h, h->num_w_planes,
-            h->w_scale, &conv_size_half, &norm_factor, status);
-
-    /* Evaluate the support size of each kernel. */
+    /* Free any existing kernels. */
     oskar_mem_free(h->w_support, status);
-    h->w_support = oskar_imager_evaluate_w_kernel_support_sizes(
-            h->num_w_planes, h->oversample, conv_size_half,
-            kernel_cube, norm_factor, status);
+    oskar_mem_free(h->w_kernels_compact, status);
+    oskar_mem_free(h->w_kernel_start, status);
+    oskar_binary_free(h->w_kernel_cache);
+    h->w_support = h->w_kernels_compact = h->w_kernel_start = 0;
+    h->w_kernel_cache = 0;
 
-#if 0
-    /* Print kernel support sizes. */
+    /* Generate the kernels, unless they can be loaded from the cache. */
+    if (!oskar_imager_w_kernel_cache_load(h, conv_size))
     {
-        int i;
-        for (i = 0; i < h->num_w_planes; ++i)
-        {
-            const int* supp = oskar_mem_int_const(h->w_support, status);
-            printf("Plane %d, support: %d\n", i, supp[i]);
-        }
+        oskar_imager_generate_w_kernels(h, conv_size, status);
+        if (!*status)
+            oskar_imager_w_kernel_cache_save(h, conv_size);
     }
-#endif
-
-    /* Normalise the kernel cube. */
-    oskar_imager_normalise_kernel_cube(h->w_support, h->oversample,
-            conv_size_half, kernel_cube, status);
-    if (save_kernels)
-        oskar_imager_trim_and_save_kernel_cube(h, h->num_w_planes,
-                h->w_support, &conv_size_half, kernel_cube, status);
-
-    /* Rearrange and compact the kernels. */
-    oskar_mem_free(h->w_kernels_compact, status);
-    oskar_mem_free(h->w_kernel_start, status);
-    h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
-            h->num_w_planes, status);
-    h->w_kernels_compact = oskar_mem_create(h->imager_prec| OSKAR_COMPLEX,
-            OSKAR_CPU, 0, status);
-    oskar_imager_rearrange_kernels(h->num_w_planes, h->w_support,
-            h->oversample, conv_size_half, kernel_cube, h->w_kernels_compact,
-            oskar_mem_int(h->w_kernel_start, status), status);
-    oskar_mem_free(kernel_cube, status);
+    if (*status) return;
 
     /* Record data about the kernels. */
     oskar_log_message(h->log, 'M', 0, "Baseline W values (wavelengths)");
@@ -171,11 +159,62 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
 
         /* No longer need kernels in host memory. */
         oskar_mem_free(h->w_kernels_compact, status);
+        oskar_binary_free(h->w_kernel_cache);
         h->w_kernels_compact = 0;
+        h->w_kernel_cache = 0;
     }
 }
 
 
+static void oskar_imager_generate_w_kernels(oskar_Imager* h, int conv_size,
+        int* status)
+{
+    size_t conv_size_half = 0;
+    double norm_factor = 1.;
+    oskar_Mem *kernel_cube = 0;
+    const int save_kernels = 0;
+    if (*status) return;
+
+    /* Evaluate unnormalised kernels. */
+    kernel_cube = oskar_imager_evaluate_w_kernel_cube(h, h->num_w_planes,
+            h->w_scale, conv_size, &conv_size_half, &norm_factor, status);
+
+    /* Evaluate the support size of each kernel. */
+    h->w_support = oskar_imager_evaluate_w_kernel_support_sizes(
+            h->num_w_planes, h->oversample, conv_size_half,
+            kernel_cube, norm_factor, status);
+
+#if 0
+    /* Print kernel support sizes. */
+    {
+        int i;
+        for (i = 0; i < h->num_w_planes; ++i)
+        {
+            const int* supp = oskar_mem_int_const(h->w_support, status);
+            printf("Plane %d, support: %d\n", i, supp[i]);
+        }
+    }
+#endif
+
+    /* Normalise the kernel cube. */
+    oskar_imager_normalise_kernel_cube(h->w_support, h->oversample,
+            conv_size_half, kernel_cube, status);
+    if (save_kernels)
+        oskar_imager_trim_and_save_kernel_cube(h, h->num_w_planes,
+                h->w_support, &conv_size_half, kernel_cube, status);
+
+    /* Rearrange and compact the kernels. */
+    h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
+            h->num_w_planes, status);
+    h->w_kernels_compact = oskar_mem_create(h->imager_prec| OSKAR_COMPLEX,
+            OSKAR_CPU, 0, status);
+    oskar_imager_rearrange_kernels(h->num_w_planes, h->w_support,
+            h->oversample, conv_size_half, kernel_cube, h->w_kernels_compact,
+            oskar_mem_int(h->w_kernel_start, status), status);
+    oskar_mem_free(kernel_cube, status);
+}
+
+
 static void oskar_imager_evaluate_w_kernel_params(const oskar_Imager* h,
         int* num_w_planes, double* w_scale)
 {
@@ -199,28 +238,30 @@ static void oskar_imager_evaluate_w_kernel_params(const oskar_Imager* h,
 }
 
 
-static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
-        int num_w_planes, double w_scale,
-        size_t* conv_size_half, double* norm_factor, int* status)
+static int oskar_imager_evaluate_w_kernel_conv_size(const oskar_Imager* h,
+        int num_w_planes)
 {
     size_t max_mem_bytes;
-    oskar_FFT* fft = 0;
-    oskar_Mem *screen = 0, *screen_gpu = 0, *screen_ptr = 0;
-    oskar_Mem *taper = 0, *taper_gpu = 0, *taper_ptr = 0;
-    oskar_Mem *kernel_cube = 0;
-    char *ptr_out, *ptr_in;
-    double *maxes, max_val = -INT_MAX, sampling;
-    int i;
-    if (*status) return 0;
-
-    /* Calculate convolution kernel size. */
     const size_t max_bytes_per_plane = 64 * 1024 * 1024; /* 64 MB/plane */
     max_mem_bytes = oskar_get_total_physical_memory();
     max_mem_bytes = MIN(max_mem_bytes, max_bytes_per_plane * num_w_planes);
     const double max_conv_size = sqrt(max_mem_bytes / (16. * num_w_planes));
     const int nearest = oskar_imager_composite_nearest_even(
             2 * (int)(max_conv_size / 2.0), 0, 0);
-    const int conv_size = MIN((int)(h->image_size * h->image_padding),nearest);
+    return MIN((int)(h->image_size * h->image_padding), nearest);
+}
+
+
+static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
+        int num_w_planes, double w_scale, int conv_size,
+        size_t* conv_size_half, double* norm_factor, int* status)
+{
+    oskar_Mem *taper = 0, *kernel_cube = 0;
+    double *maxes, max_val = -INT_MAX, sampling;
+    int i;
+    if (*status) return 0;
+
+    /* Get convolution kernel size. */
     *conv_size_half = conv_size / 2 - 1;
     const size_t kernel_plane_size = (*conv_size_half) * (*conv_size_half);
 
@@ -233,7 +274,6 @@ static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
     /* Generate 1D spheroidal tapering function to cover the inner region. */
     const int prec = h->imager_prec;
     taper = oskar_mem_create(prec, OSKAR_CPU, (size_t) inner, status);
-    taper_ptr = taper;
     if (prec == OSKAR_DOUBLE)
     {
         double* t = (double*) oskar_mem_void(taper);
@@ -257,71 +297,69 @@ static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
     kernel_cube = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
             ((size_t) num_w_planes) * kernel_plane_size, status);
 
-    /* Create scratch arrays and FFT plan for the phase screens. */
-    screen = oskar_mem_create(prec | OSKAR_COMPLEX,
-            OSKAR_CPU, conv_size * conv_size, status);
-    screen_ptr = screen;
-    const int fft_loc = (h->generate_w_kernels_on_gpu && h->num_gpus > 0) ?
-            h->dev_loc : OSKAR_CPU;
-    if (fft_loc != OSKAR_CPU)
-    {
-        oskar_device_set(h->dev_loc, h->gpu_ids[0], status);
-        screen_gpu = oskar_mem_create(prec | OSKAR_COMPLEX,
-                h->dev_loc, conv_size * conv_size, status);
-        taper_gpu = oskar_mem_create_copy(taper, h->dev_loc, status);
-        screen_ptr = screen_gpu;
-        taper_ptr = taper_gpu;
-    }
-    fft = oskar_fft_create(h->imager_prec, fft_loc,
-            2, conv_size, 0, status);
-    oskar_fft_set_ensure_consistent_norm(fft, 0);
-
-    /* Evaluate kernels. */
-    ptr_in = oskar_mem_char(screen);
-    const size_t element_size = 2 * oskar_mem_element_size(prec);
-    const size_t copy_len = (*conv_size_half) * element_size;
+    /* Evaluate kernels. The FFT is only available on CUDA devices,
+     * so use the CPU otherwise. */
     maxes = (double*) calloc(num_w_planes, sizeof(double));
-    for (i = 0; i < num_w_planes; ++i)
+    const int fft_loc = (h->generate_w_kernels_on_gpu && h->num_gpus > 0 &&
+            h->dev_loc == OSKAR_GPU) ? h->dev_loc : OSKAR_CPU;
+    if (fft_loc == OSKAR_CPU)
     {
-        size_t iy, in = 0, out = 0, offset;
-
-        /* Generate the tapered phase screen. */
-        oskar_imager_generate_w_phase_screen(i, conv_size, inner,
-                sampling, w_scale, taper_ptr, screen_ptr, status);
-
-        /* Perform the FFT to get the kernel. No shifts are required. */
-        oskar_fft_exec(fft, screen_ptr, status);
-        if (screen_ptr != screen)
-            oskar_mem_copy(screen, screen_ptr, status);
-        if (*status) break;
-
-        /* Get the maximum (from the first element). */
-        if (prec == OSKAR_DOUBLE)
+        /* Evaluate several W-planes at once, using a phase screen and
+         * FFT plan for each thread, as far as memory allows.
+         * Otherwise, evaluate one at a time using a multi-threaded FFT. */
+        const size_t screen_bytes = (size_t) conv_size * (size_t) conv_size *
+                2 * oskar_mem_element_size(prec);
+        const size_t max_threads =
+                oskar_get_free_physical_memory() / (2 * screen_bytes);
+        int num_threads = oskar_get_num_procs();
+        if (num_threads > num_w_planes) num_threads = num_w_planes;
+        if ((size_t) num_threads > max_threads) num_threads = (int) max_threads;
+        if (num_threads < 1) num_threads = 1;
+#pragma omp parallel num_threads(num_threads)
         {
-            const double* t = (const double*) oskar_mem_void_const(screen);
-            maxes[i] = sqrt(t[0]*t[0] + t[1]*t[1]);
-        }
-        else
-        {
-            const float* t = (const float*) oskar_mem_void_const(screen);
-            maxes[i] = sqrt(t[0]*t[0] + t[1]*t[1]);
-        }
-
-        /* Save only the first quarter of the kernel; the rest is redundant. */
-        offset = kernel_plane_size * element_size * (size_t) i;
-        ptr_out = oskar_mem_char(kernel_cube) + offset;
-        for (iy = 0; iy < *conv_size_half; ++iy)
-        {
-            memcpy(ptr_out + out, ptr_in + in, copy_len);
-            in += element_size * (size_t) conv_size;
-            out += copy_len;
+            int thread_status = *status;
+            oskar_Mem* screen = oskar_mem_create(prec | OSKAR_COMPLEX,
+                    OSKAR_CPU, conv_size * conv_size, &thread_status);
+            oskar_FFT* fft = oskar_fft_create(prec, OSKAR_CPU,
+                    2, conv_size, 0, &thread_status);
+            oskar_fft_set_ensure_consistent_norm(fft, 0);
+            if (num_threads > 1) oskar_fft_set_num_threads(fft, 1);
+#pragma omp for schedule(dynamic)
+            for (i = 0; i < num_w_planes; ++i)
+                oskar_imager_evaluate_w_kernel_plane(i, conv_size, inner,
+                        sampling, w_scale, taper, fft, screen, screen,
+                        *conv_size_half, kernel_cube, &maxes[i],
+                        &thread_status);
+            oskar_fft_free(fft);
+            oskar_mem_free(screen, &thread_status);
+            if (thread_status)
+            {
+#pragma omp critical (w_kernel_status)
+                *status = thread_status;
+            }
         }
     }
-    oskar_fft_free(fft);
-    oskar_mem_free(screen, status);
-    oskar_mem_free(screen_gpu, status);
+    else
+    {
+        oskar_device_set(h->dev_loc, h->gpu_ids[0], status);
+        oskar_Mem* screen = oskar_mem_create(prec | OSKAR_COMPLEX,
+                OSKAR_CPU, conv_size * conv_size, status);
+        oskar_Mem* screen_gpu = oskar_mem_create(prec | OSKAR_COMPLEX,
+                fft_loc, conv_size * conv_size, status);
+        oskar_Mem* taper_gpu = oskar_mem_create_copy(taper, fft_loc, status);
+        oskar_FFT* fft = oskar_fft_create(prec, fft_loc,
+                2, conv_size, 0, status);
+        oskar_fft_set_ensure_consistent_norm(fft, 0);
+        for (i = 0; i < num_w_planes; ++i)
+            oskar_imager_evaluate_w_kernel_plane(i, conv_size, inner,
+                    sampling, w_scale, taper_gpu, fft, screen_gpu, screen,
+                    *conv_size_half, kernel_cube, &maxes[i], status);
+        oskar_fft_free(fft);
+        oskar_mem_free(screen, status);
+        oskar_mem_free(screen_gpu, status);
+        oskar_mem_free(taper_gpu, status);
+    }
     oskar_mem_free(taper, status);
-    oskar_mem_free(taper_gpu, status);
 
     /* Get scaling factor needed for normalisation. */
     for (i = 0; i < num_w_planes; ++i) max_val = MAX(max_val, maxes[i]);
@@ -331,6 +369,53 @@ static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
 }
 
 
+static void oskar_imager_evaluate_w_kernel_plane(int iw, int conv_size,
+        int inner, double sampling, double w_scale, const oskar_Mem* taper,
+        oskar_FFT* fft, oskar_Mem* screen, oskar_Mem* screen_host,
+        size_t conv_size_half, oskar_Mem* kernel_cube, double* max_val,
+        int* status)
+{
+    size_t iy, in = 0, out = 0;
+    if (*status) return;
+
+    /* Generate the tapered phase screen. */
+    oskar_imager_generate_w_phase_screen(iw, conv_size, inner,
+            sampling, w_scale, taper, screen, status);
+
+    /* Perform the FFT to get the kernel. No shifts are required. */
+    oskar_fft_exec(fft, screen, status);
+    if (screen_host != screen)
+        oskar_mem_copy(screen_host, screen, status);
+    if (*status) return;
+
+    /* Get the maximum (from the first element). */
+    const int prec = oskar_mem_precision(screen_host);
+    if (prec == OSKAR_DOUBLE)
+    {
+        const double* t = (const double*) oskar_mem_void_const(screen_host);
+        *max_val = sqrt(t[0]*t[0] + t[1]*t[1]);
+    }
+    else
+    {
+        const float* t = (const float*) oskar_mem_void_const(screen_host);
+        *max_val = sqrt(t[0]*t[0] + t[1]*t[1]);
+    }
+
+    /* Save only the first quarter of the kernel; the rest is redundant. */
+    const size_t element_size = 2 * oskar_mem_element_size(prec);
+    const size_t copy_len = conv_size_half * element_size;
+    const char* ptr_in = oskar_mem_char_const(screen_host);
+    char* ptr_out = oskar_mem_char(kernel_cube) +
+            conv_size_half * conv_size_half * element_size * (size_t) iw;
+    for (iy = 0; iy < conv_size_half; ++iy)
+    {
+        memcpy(ptr_out + out, ptr_in + in, copy_len);
+        in += element_size * (size_t) conv_size;
+        out += copy_len;
+    }
+}
+
+
 static oskar_Mem* oskar_imager_evaluate_w_kernel_support_sizes(
         int num_w_planes, int oversample, size_t conv_size_half,
         const oskar_Mem* kernel_cube, double norm_factor, int* status)
@@ -343,10 +428,11 @@ static oskar_Mem* oskar_imager_evaluate_w_kernel_support_sizes(
     const double threshold = 1e-3 / norm_factor;
     const int prec = oskar_mem_precision(kernel_cube);
     const int conv_size = ((int) conv_size_half + 1) * 2;
+    if (*status) return w_support;
+#pragma omp parallel for
     for (i = 0; i < num_w_planes; ++i)
     {
         int found = 0, j = 0;
-        if (*status) break;
         const size_t start = conv_size_half * conv_size_half * (size_t) i;
         if (prec == OSKAR_DOUBLE)
         {
@@ -502,8 +588,35 @@ static void oskar_imager_normalise_kernel_cube(const oskar_Mem* support,
                 sum += p[2 * (abs(ix) * oversample +
                         conv_size_half * (abs(iy) * oversample))];
     }
-    oskar_mem_scale_real(kernel_cube, 1.0 / sum,
-            0, oskar_mem_length(kernel_cube), status);
+
+    /* Scale all the kernels, one plane per thread. */
+    const size_t plane_values = 2 * conv_size_half * conv_size_half;
+    const int num_planes = (int) (oskar_mem_length(kernel_cube) /
+            (conv_size_half * conv_size_half));
+    if (oskar_mem_precision(kernel_cube) == OSKAR_DOUBLE)
+    {
+        double *RESTRICT p = oskar_mem_double(kernel_cube, status);
+        const double scale = 1.0 / sum;
+#pragma omp parallel for
+        for (iy = 0; iy < num_planes; ++iy)
+        {
+            size_t k;
+            double *RESTRICT plane = p + plane_values * (size_t) iy;
+            for (k = 0; k < plane_values; ++k) plane[k] *= scale;
+        }
+    }
+    else
+    {
+        float *RESTRICT p = oskar_mem_float(kernel_cube, status);
+        const float scale = (float) (1.0 / sum);
+#pragma omp parallel for
+        for (iy = 0; iy < num_planes; ++iy)
+        {
+            size_t k;
+            float *RESTRICT plane = p + plane_values * (size_t) iy;
+            for (k = 0; k < plane_values; ++k) plane[k] *= scale;
+        }
+    }
 }
 
 
@@ -512,7 +625,7 @@ static void oskar_imager_rearrange_kernels(int num_w_planes,
         const oskar_Mem* kernels_in, oskar_Mem* kernels_out,
         int* rearranged_kernel_start, int* status)
 {
-    int w, j, k, off_u, off_v;
+    int w;
     size_t rearranged_size = 0;
     float2*  out_f;
     double2* out_d;
@@ -536,9 +649,13 @@ static void oskar_imager_rearrange_kernels(int num_w_planes,
     /* oskar_mem_set_value_real(kernels_out, 1e9, 0, 0, status); */
     out_f = (float2*)  oskar_mem_void(kernels_out);
     out_d = (double2*) oskar_mem_void(kernels_out);
+    if (*status) return;
 
+    /* Each kernel is written to its own region, so do them in parallel. */
+#pragma omp parallel for schedule(dynamic)
     for (w = 0; w < num_w_planes; w++)
     {
+        int j, k, off_u, off_v;
         const int w_support = supp[w];
         const size_t conv_len = 2 * (size_t)(supp[w]) + 1;
         const size_t width = ((size_t)oversample_h * conv_len + 1) * conv_len;
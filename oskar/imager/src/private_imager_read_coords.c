@@ -6,6 +6,7 @@
 #include "imager/private_imager.h"
 #include "imager/private_imager_read_coords.h"
 #include "imager/oskar_imager.h"
+#include "imager/private_imager_update_averaged.h"
 #include "binary/oskar_binary.h"
 #include "convert/oskar_convert_station_uvw_to_baseline_uvw.h"
 #include "math/oskar_cmath.h"
@@ -205,7 +206,6 @@ void oskar_imager_read_coords_vis(oskar_Imager* h, const char* filename,
         const int start_chan   = dim_start_and_size[1];
         const int num_times    = dim_start_and_size[2];
         const int num_channels = dim_start_and_size[3];
-        const size_t num_rows  = num_times * num_baselines;
 
         /* Fill in the time centroid values. */
         for (t = 0; t < num_times; ++t)
@@ -254,8 +254,8 @@ void oskar_imager_read_coords_vis(oskar_Imager* h, const char* filename,
             if (freq_hz >= h->freq_min_hz &&
                     (freq_hz <= h->freq_max_hz || h->freq_max_hz == 0.0))
             {
-                oskar_imager_update(h, num_rows,
-                        start_chan + c, start_chan + c, num_pols,
+                oskar_imager_update_averaged(h, num_times, num_baselines,
+                        start_chan + c, num_pols,
                         uu, vv, ww, 0, weight, time_centroid, status);
             }
         }
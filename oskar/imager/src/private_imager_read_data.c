@@ -6,6 +6,7 @@
 #include "imager/private_imager.h"
 #include "imager/private_imager_read_data.h"
 #include "imager/oskar_imager.h"
+#include "imager/private_imager_update_averaged.h"
 #include "binary/oskar_binary.h"
 #include "math/oskar_cmath.h"
 #include "mem/oskar_binary_read_mem.h"
@@ -159,7 +160,7 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
 
     /* Read the header. */
     oskar_log_message(h->log, 'M', 0, "Opening '%s'", filename);
-    vis_file = oskar_binary_create(filename, 'r', status);
+    vis_file = oskar_binary_create(filename, 'm', status);
     hdr = oskar_vis_header_read(vis_file, status);
     if (*status)
     {
@@ -211,7 +212,6 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
         const int start_chan   = oskar_vis_block_start_channel_index(block);
         const int num_times    = oskar_vis_block_num_times(block);
         const int num_channels = oskar_vis_block_num_channels(block);
-        const size_t num_rows  = num_times * num_baselines;
 
         /* Fill in the time centroid values. */
         for (t = 0; t < num_times; ++t)
@@ -239,8 +239,8 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
                             num_baselines, status);
                 }
                 oskar_timer_pause(h->tmr_copy_convert);
-                oskar_imager_update(h, num_rows,
-                        start_chan + c, start_chan + c, num_pols,
+                oskar_imager_update_averaged(h, num_times, num_baselines,
+                        start_chan + c, num_pols,
                         oskar_vis_block_baseline_uu_metres_const(block),
                         oskar_vis_block_baseline_vv_metres_const(block),
                         oskar_vis_block_baseline_ww_metres_const(block),
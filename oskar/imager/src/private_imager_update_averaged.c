@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_update_averaged.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define C0 299792458.0
+
+static const double* get_double(const oskar_Mem* in, oskar_Mem** tmp,
+        int* status)
+{
+    if (!in) return 0;
+    if (oskar_mem_precision(in) != OSKAR_DOUBLE)
+    {
+        *tmp = oskar_mem_convert_precision(in, OSKAR_DOUBLE, status);
+        in = *tmp;
+    }
+    return (const double*) oskar_mem_void_const(in);
+}
+
+void oskar_imager_update_averaged(oskar_Imager* h, int num_times,
+        int num_baselines, int chan, int num_pols, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* ww, const oskar_Mem* amps,
+        const oskar_Mem* weight, const oskar_Mem* time_centroid, int* status)
+{
+    int b;
+    size_t num_out = 0, *num_avg = 0;
+    oskar_Mem *tu = 0, *tv = 0, *tw = 0, *ta = 0, *th = 0;
+    const size_t num_rows = (size_t) num_times * (size_t) num_baselines;
+    if (*status) return;
+
+    /* Pass the data straight through if not averaging. */
+    if (h->bda_max_cell_fraction <= 0.0 || h->cellsize_rad <= 0.0 ||
+            num_times < 2)
+    {
+        oskar_imager_update(h, num_rows, chan, chan, num_pols,
+                uu, vv, ww, amps, weight, time_centroid, status);
+        return;
+    }
+
+    /* Find the largest allowed change in uv, in metres. */
+    const double freq_hz = h->vis_freq_start_hz + chan * h->freq_inc_hz;
+    const double uv_cell = 1.0 / (oskar_imager_plane_size(h) * h->cellsize_rad);
+    const double max_uv = h->bda_max_cell_fraction * uv_cell * C0 / freq_hz;
+    const double max_uv2 = max_uv * max_uv;
+
+    /* Get the input data in double precision. */
+    oskar_timer_resume(h->tmr_copy_convert);
+    const double* uu_ = get_double(uu, &tu, status);
+    const double* vv_ = get_double(vv, &tv, status);
+    const double* ww_ = get_double(ww, &tw, status);
+    const double* amp_ = get_double(amps, &ta, status);
+    const double* wt_ = get_double(weight, &th, status);
+    const double* time_ = time_centroid ?
+            oskar_mem_double_const(time_centroid, status) : 0;
+
+    /* Ensure output arrays are large enough. */
+    if (amps)
+    {
+        const int amp_type = OSKAR_DOUBLE | OSKAR_COMPLEX |
+                (oskar_mem_is_matrix(amps) ? OSKAR_MATRIX : 0);
+        if (oskar_mem_type(h->bda_vis) != amp_type)
+        {
+            oskar_mem_free(h->bda_vis, status);
+            h->bda_vis = oskar_mem_create(amp_type, OSKAR_CPU, 0, status);
+        }
+        oskar_mem_ensure(h->bda_vis, num_rows, status);
+    }
+    oskar_mem_ensure(h->bda_uu, num_rows, status);
+    oskar_mem_ensure(h->bda_vv, num_rows, status);
+    oskar_mem_ensure(h->bda_ww, num_rows, status);
+    oskar_mem_ensure(h->bda_weight, num_rows * num_pols, status);
+    oskar_mem_ensure(h->bda_time, num_rows, status);
+    num_avg = (size_t*) calloc(num_baselines, sizeof(size_t));
+    if (!num_avg) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    if (*status)
+    {
+        free(num_avg);
+        oskar_mem_free(tu, status);
+        oskar_mem_free(tv, status);
+        oskar_mem_free(tw, status);
+        oskar_mem_free(ta, status);
+        oskar_mem_free(th, status);
+        oskar_timer_pause(h->tmr_copy_convert);
+        return;
+    }
+    double* uu_o = oskar_mem_double(h->bda_uu, status);
+    double* vv_o = oskar_mem_double(h->bda_vv, status);
+    double* ww_o = oskar_mem_double(h->bda_ww, status);
+    double* wt_o = oskar_mem_double(h->bda_weight, status);
+    double* time_o = oskar_mem_double(h->bda_time, status);
+    double* amp_o = amps ? (double*) oskar_mem_void(h->bda_vis) : 0;
+
+    /* Average along each baseline. Baseline b writes its averages
+     * starting at output row b * num_times. */
+#pragma omp parallel for private(b)
+    for (b = 0; b < num_baselines; ++b)
+    {
+        int t = 0, j, p;
+        size_t o = (size_t) b * num_times;
+        while (t < num_times)
+        {
+            const size_t r0 = (size_t) t * num_baselines + b;
+            double su = 0.0, sv = 0.0, sw = 0.0, st = 0.0;
+            int n = 0;
+            for (p = 0; p < num_pols; ++p)
+            {
+                wt_o[o * num_pols + p] = 0.0;
+                if (amp_o)
+                {
+                    amp_o[2 * (o * num_pols + p)] = 0.0;
+                    amp_o[2 * (o * num_pols + p) + 1] = 0.0;
+                }
+            }
+            for (; t < num_times; ++t, ++n)
+            {
+                const size_t r = (size_t) t * num_baselines + b;
+                const double du = uu_[r] - uu_[r0], dv = vv_[r] - vv_[r0];
+                if (du * du + dv * dv > max_uv2) break;
+                su += uu_[r];
+                sv += vv_[r];
+                sw += ww_[r];
+                if (time_) st += time_[r];
+                for (p = 0; p < num_pols; ++p)
+                {
+                    const double w = wt_[r * num_pols + p];
+                    wt_o[o * num_pols + p] += w;
+                    if (!amp_o) continue;
+                    j = 2 * p;
+                    amp_o[2 * o * num_pols + j] +=
+                            w * amp_[2 * r * num_pols + j];
+                    amp_o[2 * o * num_pols + j + 1] +=
+                            w * amp_[2 * r * num_pols + j + 1];
+                }
+            }
+
+            /* Finish the average. */
+            uu_o[o] = su / n;
+            vv_o[o] = sv / n;
+            ww_o[o] = sw / n;
+            time_o[o] = st / n;
+            for (p = 0; p < num_pols && amp_o; ++p)
+            {
+                const double w = wt_o[o * num_pols + p];
+                const double scale = (w != 0.0) ? 1.0 / w : 0.0;
+                amp_o[2 * (o * num_pols + p)] *= scale;
+                amp_o[2 * (o * num_pols + p) + 1] *= scale;
+            }
+            o++;
+        }
+        num_avg[b] = o - (size_t) b * num_times;
+    }
+
+    /* Close up the gaps between baselines. */
+    for (b = 0; b < num_baselines; ++b)
+    {
+        const size_t src = (size_t) b * num_times, n = num_avg[b];
+        if (src != num_out)
+        {
+            memmove(uu_o + num_out, uu_o + src, n * sizeof(double));
+            memmove(vv_o + num_out, vv_o + src, n * sizeof(double));
+            memmove(ww_o + num_out, ww_o + src, n * sizeof(double));
+            memmove(time_o + num_out, time_o + src, n * sizeof(double));
+            memmove(wt_o + num_out * num_pols, wt_o + src * num_pols,
+                    n * num_pols * sizeof(double));
+            if (amp_o)
+                memmove(amp_o + 2 * num_out * num_pols,
+                        amp_o + 2 * src * num_pols,
+                        2 * n * num_pols * sizeof(double));
+        }
+        num_out += n;
+    }
+    oskar_timer_pause(h->tmr_copy_convert);
+
+    /* Update the imager with the averaged data. */
+    oskar_imager_update(h, num_out, chan, chan, num_pols,
+            h->bda_uu, h->bda_vv, h->bda_ww, amps ? h->bda_vis : 0,
+            h->bda_weight, time_centroid ? h->bda_time : 0, status);
+    free(num_avg);
+    oskar_mem_free(tu, status);
+    oskar_mem_free(tv, status);
+    oskar_mem_free(tw, status);
+    oskar_mem_free(ta, status);
+    oskar_mem_free(th, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -62,7 +62,6 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
 {
     size_t i, num_pixels;
     oskar_Mem* plane_ptr;
-    oskar_Thread** threads = 0;
     ThreadArgs* args = 0;
     if (*status) return;
 
@@ -87,9 +86,8 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
     oskar_mem_ensure(plane_ptr, num_pixels, status);
     if (*status) return;
 
-    /* Set up worker threads. */
+    /* Set up a task for each device. */
     const size_t num_threads = (size_t) (h->num_devices);
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
     {
@@ -107,18 +105,13 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
     /* Set status code. */
     h->status = *status;
 
-    /* Start the worker threads. */
+    /* Run the tasks using the imager's worker threads, and wait for them. */
     h->i_block = 0;
+    if (!h->thread_pool)
+        h->thread_pool = oskar_thread_pool_create(h->num_devices);
     for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
-
-    /* Wait for worker threads to finish. */
-    for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
-    }
-    free(threads);
+        oskar_thread_pool_submit(h->thread_pool, run_blocks, (void*)&args[i]);
+    oskar_thread_pool_wait(h->thread_pool);
     free(args);
 
     /* Get status code. */
@@ -80,7 +80,9 @@ void oskar_imager_update_plane_fft(oskar_Imager* h, size_t num_vis,
             *status = OSKAR_ERR_LOCATION_MISMATCH;
             return;
         }
-        if (oskar_mem_precision(plane_ptr) != h->imager_prec)
+        const int plane_prec = oskar_mem_precision(plane_ptr);
+        if (plane_prec != h->imager_prec && !(plane_prec == OSKAR_SINGLE &&
+                h->imager_prec == OSKAR_DOUBLE))
         {
             *status = OSKAR_ERR_TYPE_MISMATCH;
             return;
@@ -89,7 +91,20 @@ void oskar_imager_update_plane_fft(oskar_Imager* h, size_t num_vis,
         const size_t num_cells = ((size_t) grid_size) * ((size_t) grid_size);
         oskar_mem_ensure(plane_ptr, num_cells, status);
         if (*status) return;
-        if (h->imager_prec == OSKAR_DOUBLE)
+        if (plane_prec != h->imager_prec)
+        {
+            /* Single-precision grid: accumulate in double precision. */
+            const double* vis = oskar_mem_double_const(amps, status);
+            const double* wt = oskar_mem_double_const(weight, status);
+            float* grid = oskar_mem_float(plane_ptr, status);
+            oskar_grid_simple_multi_mixed(h->support, h->oversample,
+                    oskar_mem_double_const(h->conv_func, status), num_vis,
+                    oskar_mem_double_const(uu, status),
+                    oskar_mem_double_const(vv, status),
+                    1, &vis, &wt, h->cellsize_rad,
+                    grid_size, num_skipped, plane_norm, &grid, status);
+        }
+        else if (h->imager_prec == OSKAR_DOUBLE)
             oskar_grid_simple_d(h->support, h->oversample,
                     oskar_mem_double_const(h->conv_func, status), num_vis,
                     oskar_mem_double_const(uu, status),
@@ -113,12 +128,10 @@ void oskar_imager_update_plane_fft(oskar_Imager* h, size_t num_vis,
     else
     {
         int i;
-        oskar_Thread** threads = 0;
         ThreadArgs* args = 0;
 
-        /* Set up worker threads. */
+        /* Set up a task for each GPU. */
         const int num_threads = h->num_gpus;
-        threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
         args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
         for (i = 0; i < num_threads; ++i)
         {
@@ -136,19 +149,20 @@ void oskar_imager_update_plane_fft(oskar_Imager* h, size_t num_vis,
         /* Set status code. */
         h->status = *status;
 
-        /* Start the worker threads. */
+        /* Run the tasks using the imager's worker threads. */
+        if (!h->thread_pool)
+            h->thread_pool = oskar_thread_pool_create(h->num_devices);
         for (i = 0; i < num_threads; ++i)
-            threads[i] = oskar_thread_create(run_subset, (void*)&args[i], 0);
+            oskar_thread_pool_submit(h->thread_pool,
+                    run_subset, (void*)&args[i]);
 
-        /* Wait for worker threads to finish. */
+        /* Wait for the tasks to finish. */
+        oskar_thread_pool_wait(h->thread_pool);
         for (i = 0; i < num_threads; ++i)
         {
-            oskar_thread_join(threads[i]);
-            oskar_thread_free(threads[i]);
             *plane_norm += args[i].plane_norm;
             *num_skipped += args[i].num_skipped;
         }
-        free(threads);
         free(args);
 
         /* Get status code. */
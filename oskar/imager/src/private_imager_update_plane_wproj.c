@@ -121,12 +121,10 @@ void oskar_imager_update_plane_wproj(oskar_Imager* h, size_t num_vis,
     else
     {
         int i;
-        oskar_Thread** threads = 0;
         ThreadArgs* args = 0;
 
-        /* Set up worker threads. */
+        /* Set up a task for each GPU. */
         const int num_threads = h->num_gpus;
-        threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
         args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
         for (i = 0; i < num_threads; ++i)
         {
@@ -145,19 +143,20 @@ void oskar_imager_update_plane_wproj(oskar_Imager* h, size_t num_vis,
         /* Set status code. */
         h->status = *status;
 
-        /* Start the worker threads. */
+        /* Run the tasks using the imager's worker threads. */
+        if (!h->thread_pool)
+            h->thread_pool = oskar_thread_pool_create(h->num_devices);
         for (i = 0; i < num_threads; ++i)
-            threads[i] = oskar_thread_create(run_subset, (void*)&args[i], 0);
+            oskar_thread_pool_submit(h->thread_pool,
+                    run_subset, (void*)&args[i]);
 
-        /* Wait for worker threads to finish. */
+        /* Wait for the tasks to finish. */
+        oskar_thread_pool_wait(h->thread_pool);
         for (i = 0; i < num_threads; ++i)
         {
-            oskar_thread_join(threads[i]);
-            oskar_thread_free(threads[i]);
             *plane_norm += args[i].plane_norm;
             *num_skipped += args[i].num_skipped;
         }
-        free(threads);
         free(args);
 
         /* Get status code. */
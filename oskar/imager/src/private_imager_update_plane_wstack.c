@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_update_plane_wstack.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLIP_NEGATIVE_W(FP) {\
+    FP *uu_ = (FP*) oskar_mem_void(h->ws_uu[i_plane]);\
+    FP *vv_ = (FP*) oskar_mem_void(h->ws_vv[i_plane]);\
+    FP *ww_ = (FP*) oskar_mem_void(h->ws_ww[i_plane]);\
+    FP *vis_ = (FP*) oskar_mem_void(h->ws_vis[i_plane]);\
+    for (i = start; i < start + num_vis; ++i) {\
+        if (ww_[i] >= (FP) 0) continue;\
+        uu_[i] = -uu_[i];\
+        vv_[i] = -vv_[i];\
+        ww_[i] = -ww_[i];\
+        vis_[2 * i + 1] = -vis_[2 * i + 1];\
+    }\
+    }
+
+void oskar_imager_update_plane_wstack(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, int i_plane,
+        const oskar_Mem* plane, int* status)
+{
+    int j;
+    size_t i;
+    if (*status) return;
+    if (plane)
+    {
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+        return;
+    }
+    if (i_plane < 0 || i_plane >= h->num_planes)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+
+    /* Create the buffers if required. */
+    const int prec = h->imager_prec;
+    if (!h->ws_num_vis)
+    {
+        const int num_planes = h->num_planes;
+        h->ws_num_vis = (size_t*) calloc(num_planes, sizeof(size_t));
+        h->ws_uu = (oskar_Mem**) calloc(num_planes, sizeof(oskar_Mem*));
+        h->ws_vv = (oskar_Mem**) calloc(num_planes, sizeof(oskar_Mem*));
+        h->ws_ww = (oskar_Mem**) calloc(num_planes, sizeof(oskar_Mem*));
+        h->ws_vis = (oskar_Mem**) calloc(num_planes, sizeof(oskar_Mem*));
+        h->ws_weight = (oskar_Mem**) calloc(num_planes, sizeof(oskar_Mem*));
+        if (!h->ws_num_vis || !h->ws_uu || !h->ws_vv || !h->ws_ww ||
+                !h->ws_vis || !h->ws_weight)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            free(h->ws_uu); h->ws_uu = 0;
+            free(h->ws_vv); h->ws_vv = 0;
+            free(h->ws_ww); h->ws_ww = 0;
+            free(h->ws_vis); h->ws_vis = 0;
+            free(h->ws_weight); h->ws_weight = 0;
+            free(h->ws_num_vis); h->ws_num_vis = 0;
+            return;
+        }
+        for (j = 0; j < num_planes; ++j)
+        {
+            h->ws_uu[j] = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+            h->ws_vv[j] = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+            h->ws_ww[j] = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+            h->ws_vis[j] = oskar_mem_create(prec | OSKAR_COMPLEX,
+                    OSKAR_CPU, 0, status);
+            h->ws_weight[j] = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+        }
+    }
+
+    /* Grow the buffers geometrically, to limit the number of copies. */
+    const size_t start = h->ws_num_vis[i_plane];
+    const size_t required = start + num_vis;
+    if (required > oskar_mem_length(h->ws_uu[i_plane]))
+    {
+        size_t capacity = 2 * oskar_mem_length(h->ws_uu[i_plane]);
+        if (capacity < required) capacity = required;
+        oskar_mem_realloc(h->ws_uu[i_plane], capacity, status);
+        oskar_mem_realloc(h->ws_vv[i_plane], capacity, status);
+        oskar_mem_realloc(h->ws_ww[i_plane], capacity, status);
+        oskar_mem_realloc(h->ws_vis[i_plane], capacity, status);
+        oskar_mem_realloc(h->ws_weight[i_plane], capacity, status);
+    }
+
+    /* Append the visibilities, flipping any with negative W. */
+    oskar_mem_copy_contents(h->ws_uu[i_plane], uu, start, 0, num_vis, status);
+    oskar_mem_copy_contents(h->ws_vv[i_plane], vv, start, 0, num_vis, status);
+    oskar_mem_copy_contents(h->ws_ww[i_plane], ww, start, 0, num_vis, status);
+    oskar_mem_copy_contents(h->ws_vis[i_plane], amps,
+            start, 0, num_vis, status);
+    oskar_mem_copy_contents(h->ws_weight[i_plane], weight,
+            start, 0, num_vis, status);
+    if (*status) return;
+    if (prec == OSKAR_DOUBLE)
+        FLIP_NEGATIVE_W(double)
+    else
+        FLIP_NEGATIVE_W(float)
+    h->ws_num_vis[i_plane] = required;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_w_kernel_cache.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_file_exists.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Increment this if the kernel generation or file layout changes. */
+#define CACHE_VERSION 1
+
+#define NUM_KEY_INT 7
+#define NUM_KEY_DOUBLE 4
+
+#define KERNEL_ALIGNMENT 16
+
+static void get_key(oskar_Imager* h, int conv_size,
+        int* key_int, double* key_double)
+{
+    key_int[0] = CACHE_VERSION;
+    key_int[1] = h->imager_prec;
+    key_int[2] = h->image_size;
+    key_int[3] = oskar_imager_plane_size(h);
+    key_int[4] = h->oversample;
+    key_int[5] = h->num_w_planes;
+    key_int[6] = conv_size;
+    key_double[0] = h->cellsize_rad;
+    key_double[1] = h->fov_deg;
+    key_double[2] = h->image_padding;
+    key_double[3] = h->w_scale;
+}
+
+static char* get_filename(const char* dir,
+        const int* key_int, const double* key_double)
+{
+    /* 64-bit FNV-1a hash of the key. The key itself is stored in the file
+     * and checked when loading, so a hash collision is harmless. */
+    size_t i, buffer_size;
+    unsigned long long hash = 14695981039346656037ull;
+    const unsigned char* p = (const unsigned char*) key_int;
+    for (i = 0; i < NUM_KEY_INT * sizeof(int); ++i)
+    {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    p = (const unsigned char*) key_double;
+    for (i = 0; i < NUM_KEY_DOUBLE * sizeof(double); ++i)
+    {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    buffer_size = strlen(dir) + 64;
+    char* filename = (char*) calloc(buffer_size, 1);
+    sprintf(filename, "%s/oskar_w_kernels_%08x%08x.bin", dir,
+            (unsigned int) (hash >> 32), (unsigned int) (hash & 0xFFFFFFFFu));
+    return filename;
+}
+
+int oskar_imager_w_kernel_cache_load(oskar_Imager* h, int conv_size)
+{
+    int status = 0, chunk_index = 0;
+    int key_int[NUM_KEY_INT], key_int_file[NUM_KEY_INT];
+    double key_double[NUM_KEY_DOUBLE], key_double_file[NUM_KEY_DOUBLE];
+    size_t bytes = 0;
+    void* ptr = 0;
+    oskar_Binary* f = 0;
+    if (!h->w_kernel_cache_dir) return 0;
+    get_key(h, conv_size, key_int, key_double);
+    char* filename = get_filename(h->w_kernel_cache_dir, key_int, key_double);
+    if (!oskar_file_exists(filename))
+    {
+        free(filename);
+        return 0;
+    }
+
+    /* Check the key in the file matches exactly. */
+    f = oskar_binary_create(filename, 'm', &status);
+    oskar_binary_read(f, OSKAR_INT, OSKAR_TAG_GROUP_W_KERNELS,
+            OSKAR_W_KERNEL_CACHE_TAG_KEY_INT, 0,
+            sizeof(key_int_file), key_int_file, &status);
+    oskar_binary_read(f, OSKAR_DOUBLE, OSKAR_TAG_GROUP_W_KERNELS,
+            OSKAR_W_KERNEL_CACHE_TAG_KEY_DOUBLE, 0,
+            sizeof(key_double_file), key_double_file, &status);
+    if (!status && (memcmp(key_int, key_int_file, sizeof(key_int)) ||
+            memcmp(key_double, key_double_file, sizeof(key_double))))
+        status = OSKAR_ERR_INVALID_ARGUMENT;
+
+    /* Read the support sizes and kernel start offsets. */
+    const int type = h->imager_prec | OSKAR_COMPLEX;
+    h->w_support = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    oskar_binary_read_mem(f, h->w_support, OSKAR_TAG_GROUP_W_KERNELS,
+            OSKAR_W_KERNEL_CACHE_TAG_SUPPORT, 0, &status);
+    oskar_binary_read_mem(f, h->w_kernel_start, OSKAR_TAG_GROUP_W_KERNELS,
+            OSKAR_W_KERNEL_CACHE_TAG_KERNEL_START, 0, &status);
+    if (!status && (
+            (int) oskar_mem_length(h->w_support) != h->num_w_planes ||
+            (int) oskar_mem_length(h->w_kernel_start) != h->num_w_planes))
+        status = OSKAR_ERR_DIMENSION_MISMATCH;
+
+    /* Use the kernels in place if possible, otherwise read them. */
+    chunk_index = oskar_binary_query(f, (unsigned char) type,
+            OSKAR_TAG_GROUP_W_KERNELS, OSKAR_W_KERNEL_CACHE_TAG_KERNELS, 0,
+            &bytes, &status);
+    const size_t num_elements = bytes / oskar_mem_element_size(type);
+    ptr = oskar_binary_map_block(f, chunk_index, &status);
+    if (ptr)
+    {
+        h->w_kernels_compact = oskar_mem_create_alias_from_raw(ptr,
+                type, OSKAR_CPU, num_elements, &status);
+        h->w_kernel_cache = f;
+    }
+    else
+    {
+        h->w_kernels_compact = oskar_mem_create(type, OSKAR_CPU,
+                num_elements, &status);
+        oskar_binary_read_block(f, chunk_index, bytes,
+                oskar_mem_void(h->w_kernels_compact), &status);
+    }
+
+    /* Clean up if anything went wrong. */
+    if (status)
+    {
+        oskar_mem_free(h->w_support, &status);
+        oskar_mem_free(h->w_kernel_start, &status);
+        oskar_mem_free(h->w_kernels_compact, &status);
+        h->w_support = h->w_kernel_start = h->w_kernels_compact = 0;
+        h->w_kernel_cache = 0;
+    }
+
+    /* Keep the file open only while the kernels are mapped from it. */
+    if (!h->w_kernel_cache) oskar_binary_free(f);
+    if (status)
+    {
+        free(filename);
+        return 0;
+    }
+    oskar_log_message(h->log, 'M', 0, "Loaded W-kernels from cache file %s",
+            filename);
+    free(filename);
+    return 1;
+}
+
+void oskar_imager_w_kernel_cache_save(oskar_Imager* h, int conv_size)
+{
+    int status = 0, key_int[NUM_KEY_INT];
+    double key_double[NUM_KEY_DOUBLE];
+    if (!h->w_kernel_cache_dir || !h->w_kernels_compact) return;
+    get_key(h, conv_size, key_int, key_double);
+    char* filename = get_filename(h->w_kernel_cache_dir, key_int, key_double);
+    char* temp_name = (char*) calloc(strlen(filename) + 5, 1);
+    sprintf(temp_name, "%s.tmp", filename);
+
+    /* Write the key, support sizes and kernel start offsets. */
+    if (!oskar_dir_exists(h->w_kernel_cache_dir))
+        oskar_dir_mkpath(h->w_kernel_cache_dir);
+    oskar_Binary* f = oskar_binary_create(temp_name, 'w', &status);
+    oskar_binary_write(f, OSKAR_INT, OSKAR_TAG_GROUP_W_KERNELS,
+            OSKAR_W_KERNEL_CACHE_TAG_KEY_INT, 0,
+            sizeof(key_int), key_int, &status);
+    oskar_binary_write(f, OSKAR_DOUBLE, OSKAR_TAG_GROUP_W_KERNELS,
+            OSKAR_W_KERNEL_CACHE_TAG_KEY_DOUBLE, 0,
+            sizeof(key_double), key_double, &status);
+    oskar_binary_write_mem(f, h->w_support, OSKAR_TAG_GROUP_W_KERNELS,
+            OSKAR_W_KERNEL_CACHE_TAG_SUPPORT, 0, 0, &status);
+    oskar_binary_write_mem(f, h->w_kernel_start, OSKAR_TAG_GROUP_W_KERNELS,
+            OSKAR_W_KERNEL_CACHE_TAG_KERNEL_START, 0, 0, &status);
+
+    /* Pad so that the kernels are aligned in the file,
+     * allowing them to be memory-mapped when the file is loaded. */
+    oskar_binary_write_padding(f, OSKAR_TAG_GROUP_W_KERNELS,
+            OSKAR_W_KERNEL_CACHE_TAG_PADDING, 0, KERNEL_ALIGNMENT, &status);
+    oskar_binary_write_mem(f, h->w_kernels_compact, OSKAR_TAG_GROUP_W_KERNELS,
+            OSKAR_W_KERNEL_CACHE_TAG_KERNELS, 0, 0, &status);
+    oskar_binary_free(f);
+
+    /* Move the file into place only when it is complete. */
+    if (!status)
+    {
+        remove(filename);
+        if (rename(temp_name, filename))
+            status = OSKAR_ERR_FILE_IO;
+    }
+    if (status)
+    {
+        remove(temp_name);
+        oskar_log_warning(h->log,
+                "Unable to write W-kernel cache file %s (code %d).",
+                filename, status);
+    }
+    else
+        oskar_log_message(h->log, 'M', 0, "Saved W-kernels to cache file %s",
+                filename);
+    free(temp_name);
+    free(filename);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -38,7 +38,7 @@ extern "C" {
 void oskar_imager_weight_uniform(size_t num_points, const oskar_Mem* uu,
         const oskar_Mem* vv, const oskar_Mem* weight_in, oskar_Mem* weight_out,
         double cell_size_rad, int grid_size, const oskar_Mem* weight_grid,
-        size_t* num_skipped, int* status)
+        const oskar_Mem* weight_keys, size_t* num_skipped, int* status)
 {
     /* Check the grid exists. */
     if (!weight_grid || !oskar_mem_allocated(weight_grid))
@@ -51,8 +51,30 @@ void oskar_imager_weight_uniform(size_t num_points, const oskar_Mem* uu,
     oskar_mem_realloc(weight_out, num_points, status);
     if (*status) return;
 
-    /* Calculate new weights from the grid. */
-    if (oskar_mem_precision(weight_out) == OSKAR_DOUBLE)
+    /* Calculate new weights from the grid, which may be hashed. */
+    if (weight_keys)
+    {
+        const int capacity = (int) oskar_mem_length(weight_keys);
+        if (oskar_mem_precision(weight_out) == OSKAR_DOUBLE)
+            oskar_grid_weights_hash_read_d(num_points,
+                    oskar_mem_double_const(uu, status),
+                    oskar_mem_double_const(vv, status),
+                    oskar_mem_double_const(weight_in, status),
+                    oskar_mem_double(weight_out, status),
+                    cell_size_rad, grid_size, num_skipped, capacity,
+                    oskar_mem_int_const(weight_keys, status),
+                    oskar_mem_double_const(weight_grid, status));
+        else
+            oskar_grid_weights_hash_read_f(num_points,
+                    oskar_mem_float_const(uu, status),
+                    oskar_mem_float_const(vv, status),
+                    oskar_mem_float_const(weight_in, status),
+                    oskar_mem_float(weight_out, status),
+                    cell_size_rad, grid_size, num_skipped, capacity,
+                    oskar_mem_int_const(weight_keys, status),
+                    oskar_mem_float_const(weight_grid, status));
+    }
+    else if (oskar_mem_precision(weight_out) == OSKAR_DOUBLE)
         oskar_grid_weights_read_d(num_points,
                 oskar_mem_double_const(uu, status),
                 oskar_mem_double_const(vv, status),
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/oskar_grid_weights.h"
+#include "imager/private_imager_weights_hash.h"
+
+#include <limits.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Initial number of slots in a hash table. */
+#define HASH_MIN_CAPACITY 1024
+
+/* Use a dense grid once more than 1 / HASH_MAX_FRACTION cells are used. */
+#define HASH_MAX_FRACTION 16
+
+static size_t num_cells(oskar_Imager* h)
+{
+    const size_t grid_size = (size_t) oskar_imager_plane_size(h);
+    return grid_size * grid_size;
+}
+
+/* Moves the cells in the hash table into a new table, or a dense grid. */
+static void rehash(oskar_Imager* h, int i_plane, int capacity, int* status)
+{
+    int j;
+    const int is_dbl = (h->imager_prec == OSKAR_DOUBLE);
+    oskar_Mem *keys = h->weights_keys[i_plane];
+    oskar_Mem *values = h->weights_grids[i_plane];
+    oskar_Mem *guard = h->weights_guard[i_plane];
+    const int old_capacity = (int) oskar_mem_length(keys);
+    oskar_Mem* old_keys = oskar_mem_create_copy(keys, OSKAR_CPU, status);
+    oskar_Mem* old_values = oskar_mem_create_copy(values, OSKAR_CPU, status);
+    oskar_Mem* old_guard = oskar_mem_create_copy(guard, OSKAR_CPU, status);
+    const size_t new_length = capacity > 0 ? (size_t) capacity : num_cells(h);
+    oskar_mem_realloc(keys, capacity > 0 ? capacity : 0, status);
+    oskar_mem_realloc(values, new_length, status);
+    oskar_mem_clear_contents(values, status);
+    if (!is_dbl)
+    {
+        oskar_mem_realloc(guard, new_length, status);
+        oskar_mem_clear_contents(guard, status);
+    }
+
+    /* Empty slots have a key of -1. */
+    if (!*status && capacity > 0)
+        memset(oskar_mem_void(keys), 0xFF, capacity * sizeof(int));
+    const int* k = (const int*) oskar_mem_void_const(old_keys);
+    for (j = 0; j < old_capacity && !*status; ++j)
+    {
+        if (k[j] < 0) continue;
+        if (is_dbl)
+        {
+            const double v = ((const double*)
+                    oskar_mem_void_const(old_values))[j];
+            if (capacity > 0)
+                oskar_grid_weights_hash_insert_d(k[j], v, capacity,
+                        (int*) oskar_mem_void(keys),
+                        (double*) oskar_mem_void(values));
+            else
+                ((double*) oskar_mem_void(values))[k[j]] = v;
+        }
+        else
+        {
+            const float v = ((const float*)
+                    oskar_mem_void_const(old_values))[j];
+            const float g = ((const float*)
+                    oskar_mem_void_const(old_guard))[j];
+            if (capacity > 0)
+                oskar_grid_weights_hash_insert_f(k[j], v, g, capacity,
+                        (int*) oskar_mem_void(keys),
+                        (float*) oskar_mem_void(values),
+                        (float*) oskar_mem_void(guard));
+            else
+            {
+                ((float*) oskar_mem_void(values))[k[j]] = v;
+                ((float*) oskar_mem_void(guard))[k[j]] = g;
+            }
+        }
+    }
+
+    oskar_mem_free(old_keys, status);
+    oskar_mem_free(old_values, status);
+    oskar_mem_free(old_guard, status);
+}
+
+const oskar_Mem* oskar_imager_weights_hash_keys(const oskar_Imager* h,
+        const oskar_Mem* weights_grid, int i_plane)
+{
+    if (!h->weights_keys || i_plane < 0 || i_plane >= h->num_planes ||
+            weights_grid != h->weights_grids[i_plane] ||
+            oskar_mem_length(h->weights_keys[i_plane]) == 0)
+        return 0;
+    return h->weights_keys[i_plane];
+}
+
+size_t oskar_imager_weights_hash_update(oskar_Imager* h, size_t num_points,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* weight,
+        int i_plane, size_t* num_skipped, int* status)
+{
+    size_t start = 0;
+    int* num_used;
+    *num_skipped = 0;
+    if (*status || !h->weights_keys) return 0;
+    const int grid_size = oskar_imager_plane_size(h);
+    const size_t max_used = num_cells(h) / HASH_MAX_FRACTION;
+
+    /* Start an empty grid as a hash table, if cell indices fit in an int. */
+    oskar_Mem* keys = h->weights_keys[i_plane];
+    if (oskar_mem_length(keys) == 0)
+    {
+        if (oskar_mem_length(h->weights_grids[i_plane]) > 0 ||
+                num_cells(h) > (size_t) INT_MAX ||
+                max_used < HASH_MIN_CAPACITY / 2)
+            return 0;
+        rehash(h, i_plane, HASH_MIN_CAPACITY, status);
+    }
+
+    /* Add points to the table, growing it or making it dense when full. */
+    num_used = &h->weights_num_used[i_plane];
+    while (start < num_points && !*status)
+    {
+        size_t skipped = 0;
+        const int capacity = (int) oskar_mem_length(keys);
+        if (h->imager_prec == OSKAR_DOUBLE)
+            start += oskar_grid_weights_hash_write_d(num_points - start,
+                    oskar_mem_double_const(uu, status) + start,
+                    oskar_mem_double_const(vv, status) + start,
+                    oskar_mem_double_const(weight, status) + start,
+                    h->cellsize_rad, grid_size, &skipped, capacity, num_used,
+                    oskar_mem_int(keys, status),
+                    oskar_mem_double(h->weights_grids[i_plane], status));
+        else
+            start += oskar_grid_weights_hash_write_f(num_points - start,
+                    oskar_mem_float_const(uu, status) + start,
+                    oskar_mem_float_const(vv, status) + start,
+                    oskar_mem_float_const(weight, status) + start,
+                    (float) (h->cellsize_rad), grid_size, &skipped,
+                    capacity, num_used, oskar_mem_int(keys, status),
+                    oskar_mem_float(h->weights_grids[i_plane], status),
+                    oskar_mem_float(h->weights_guard[i_plane], status));
+        *num_skipped += skipped;
+        if (start == num_points) break;
+        if ((size_t) (*num_used) >= max_used)
+        {
+            rehash(h, i_plane, 0, status);
+            return start;
+        }
+        rehash(h, i_plane, 2 * capacity, status);
+    }
+    if ((size_t) (*num_used) > max_used)
+        rehash(h, i_plane, 0, status);
+    return start;
+}
+
+#ifdef __cplusplus
+}
+#endif
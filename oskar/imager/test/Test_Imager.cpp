@@ -5,8 +5,13 @@
 
 #include <gtest/gtest.h>
 #include "imager/oskar_imager.h"
+#include "math/oskar_cmath.h"
 #include "vis/oskar_vis_header.h"
 #include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_block_station_to_baseline_coords.h"
+#include "utility/oskar_dir.h"
+
+#include <cstdlib>
 
 #define WRITE_FITS 1
 
@@ -93,3 +98,434 @@ TEST(imager, update_from_block)
     oskar_mem_free(image, &status);
     oskar_mem_free(grid, &status);
 }
+
+static oskar_Mem* make_wproj_image(const char* cache_dir, int size,
+        const oskar_VisHeader* hdr, oskar_VisBlock* block, int* status)
+{
+    oskar_Imager* im = oskar_imager_create(OSKAR_DOUBLE, status);
+    oskar_imager_set_algorithm(im, "W-projection", status);
+    oskar_imager_set_fov(im, 4.0);
+    oskar_imager_set_size(im, size, status);
+    oskar_imager_set_num_w_planes(im, 16);
+    oskar_imager_set_w_kernel_cache_dir(im, cache_dir);
+    oskar_imager_update_from_block(im, hdr, block, status);
+    oskar_Mem* image = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            size * size, status);
+    oskar_imager_finalise(im, 1, &image, 0, 0, status);
+    oskar_imager_free(im, status);
+    return image;
+}
+
+TEST(imager, w_kernel_cache)
+{
+    int status = 0, num_items = 0;
+    char** items = 0;
+    const int size = 256;
+    const char* cache_dir = "temp_test_w_kernel_cache";
+
+    // Create visibility data with non-zero W coordinates.
+    const int num_times = 2, num_channels = 1, num_stations = 32;
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX,
+            OSKAR_DOUBLE, num_times, num_times, num_channels, num_channels,
+            num_stations, 0, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_VisBlock* block = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    oskar_Mem* vis = oskar_vis_block_cross_correlations(block);
+    oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(block, 0),
+            0, 1, 2, 3, 500.0, &status);
+    oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(block, 1),
+            4, 5, 6, 7, 500.0, &status);
+    oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(block, 2),
+            8, 9, 10, 11, 100.0, &status);
+    oskar_mem_set_value_real(vis, 1.0, 0, oskar_mem_length(vis), &status);
+    ASSERT_EQ(0, status);
+
+    // Make images without the cache, then twice with it.
+    oskar_dir_remove(cache_dir);
+    oskar_Mem* image0 = make_wproj_image(0, size, hdr, block, &status);
+    oskar_Mem* image1 = make_wproj_image(cache_dir, size, hdr, block, &status);
+    ASSERT_EQ(0, status);
+    oskar_dir_items(cache_dir, "*.bin", 1, 0, &num_items, &items);
+    EXPECT_EQ(1, num_items);
+    oskar_Mem* image2 = make_wproj_image(cache_dir, size, hdr, block, &status);
+    ASSERT_EQ(0, status);
+
+    // Check the images are the same.
+    const double* p0 = oskar_mem_double_const(image0, &status);
+    const double* p1 = oskar_mem_double_const(image1, &status);
+    const double* p2 = oskar_mem_double_const(image2, &status);
+    for (int i = 0; i < size * size; ++i)
+    {
+        ASSERT_EQ(p0[i], p1[i]);
+        ASSERT_EQ(p0[i], p2[i]);
+    }
+
+    // Clean up.
+    for (int i = 0; i < num_items; ++i) free(items[i]);
+    free(items);
+    oskar_dir_remove(cache_dir);
+    oskar_vis_block_free(block, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_mem_free(image0, &status);
+    oskar_mem_free(image1, &status);
+    oskar_mem_free(image2, &status);
+}
+
+static oskar_Mem* make_image(const char* algorithm, int prec, int size,
+        double fov_deg, int num_w_planes, const oskar_VisHeader* hdr,
+        oskar_VisBlock* block, int* status)
+{
+    oskar_Imager* im = oskar_imager_create(prec, status);
+    oskar_imager_set_algorithm(im, algorithm, status);
+    oskar_imager_set_fov(im, fov_deg);
+    oskar_imager_set_size(im, size, status);
+    oskar_imager_set_num_w_planes(im, num_w_planes);
+    oskar_imager_update_from_block(im, hdr, block, status);
+    oskar_Mem* image = oskar_mem_create(prec, OSKAR_CPU, size * size, status);
+    oskar_imager_finalise(im, 1, &image, 0, 0, status);
+    oskar_imager_free(im, status);
+    return image;
+}
+
+static double max_abs_diff(const oskar_Mem* a, const oskar_Mem* b)
+{
+    int status = 0;
+    double max_diff = 0.0;
+    oskar_Mem* a_d = oskar_mem_convert_precision(a, OSKAR_DOUBLE, &status);
+    oskar_Mem* b_d = oskar_mem_convert_precision(b, OSKAR_DOUBLE, &status);
+    const double* pa = oskar_mem_double_const(a_d, &status);
+    const double* pb = oskar_mem_double_const(b_d, &status);
+    for (size_t i = 0; i < oskar_mem_length(a); ++i)
+    {
+        const double diff = fabs(pa[i] - pb[i]);
+        if (diff > max_diff) max_diff = diff;
+    }
+    oskar_mem_free(a_d, &status);
+    oskar_mem_free(b_d, &status);
+    return max_diff;
+}
+
+TEST(imager, w_stacking_vs_dft_3d)
+{
+    int status = 0;
+    const int size = 128;
+    const double fov_deg = 40.0, freq_hz = 100e6;
+
+    // Create visibility data for a point source far from the phase centre.
+    const int num_times = 2, num_channels = 1, num_stations = 32;
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX,
+            OSKAR_DOUBLE, num_times, num_times, num_channels, num_channels,
+            num_stations, 0, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, freq_hz);
+    oskar_VisBlock* block = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    oskar_Mem* u = oskar_vis_block_station_uvw_metres(block, 0);
+    oskar_Mem* v = oskar_vis_block_station_uvw_metres(block, 1);
+    oskar_Mem* w = oskar_vis_block_station_uvw_metres(block, 2);
+    oskar_mem_random_gaussian(u, 0, 1, 2, 3, 40.0, &status);
+    oskar_mem_random_gaussian(v, 4, 5, 6, 7, 40.0, &status);
+    oskar_mem_random_gaussian(w, 8, 9, 10, 11, 100.0, &status);
+    oskar_vis_block_station_to_baseline_coords(block, &status);
+    u = oskar_vis_block_baseline_uvw_metres(block, 0);
+    v = oskar_vis_block_baseline_uvw_metres(block, 1);
+    w = oskar_vis_block_baseline_uvw_metres(block, 2);
+    oskar_Mem* vis = oskar_vis_block_cross_correlations(block);
+    const double l0 = 0.2, m0 = -0.15, n0 = sqrt(1.0 - l0 * l0 - m0 * m0);
+    const double wavenumber = 2.0 * M_PI * freq_hz / 299792458.0;
+    const double* pu = oskar_mem_double_const(u, &status);
+    const double* pv = oskar_mem_double_const(v, &status);
+    const double* pw = oskar_mem_double_const(w, &status);
+    double2* pvis = oskar_mem_double2(vis, &status);
+    for (size_t i = 0; i < oskar_mem_length(vis); ++i)
+    {
+        const double phase = wavenumber *
+                (pu[i] * l0 + pv[i] * m0 + pw[i] * (n0 - 1.0));
+        pvis[i].x = cos(phase);
+        pvis[i].y = sin(phase);
+    }
+    ASSERT_EQ(0, status);
+
+    // Make the reference image, and images with and without W-stacking.
+    oskar_Mem* image_dft = make_image("DFT 3D", OSKAR_DOUBLE, size, fov_deg,
+            0, hdr, block, &status);
+    oskar_Mem* image_fft = make_image("FFT", OSKAR_DOUBLE, size, fov_deg,
+            0, hdr, block, &status);
+    oskar_Mem* image_ws_d = make_image("W-stacking", OSKAR_DOUBLE, size,
+            fov_deg, 0, hdr, block, &status);
+    oskar_Mem* image_ws_f = make_image("W-stacking", OSKAR_SINGLE, size,
+            fov_deg, 0, hdr, block, &status);
+    ASSERT_EQ(0, status);
+
+    // W-stacking should correct the distortion seen in the FFT image,
+    // leaving only the (small) gridding errors.
+    EXPECT_GT(max_abs_diff(image_fft, image_dft), 0.5);
+    EXPECT_LT(max_abs_diff(image_ws_d, image_dft), 0.1);
+    EXPECT_LT(max_abs_diff(image_ws_f, image_dft), 0.1);
+
+    // Clean up.
+    oskar_vis_block_free(block, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_mem_free(image_dft, &status);
+    oskar_mem_free(image_fft, &status);
+    oskar_mem_free(image_ws_d, &status);
+    oskar_mem_free(image_ws_f, &status);
+}
+
+static oskar_Mem* make_bda_image(double fraction, int size, double fov_deg,
+        const oskar_VisHeader* hdr, oskar_VisBlock* block, int* status)
+{
+    oskar_Imager* im = oskar_imager_create(OSKAR_DOUBLE, status);
+    oskar_imager_set_fov(im, fov_deg);
+    oskar_imager_set_size(im, size, status);
+    oskar_imager_set_bda_max_cell_fraction(im, fraction);
+    oskar_imager_update_from_block(im, hdr, block, status);
+    oskar_Mem* image = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            size * size, status);
+    oskar_imager_finalise(im, 1, &image, 0, 0, status);
+    oskar_imager_free(im, status);
+    return image;
+}
+
+TEST(imager, baseline_dependent_averaging)
+{
+    int status = 0;
+    const int size = 128;
+    const double fov_deg = 2.0, freq_hz = 100e6, d_angle = 0.02;
+
+    // Create station coordinates that rotate slowly with time.
+    const int num_times = 32, num_channels = 1, num_stations = 32;
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX,
+            OSKAR_DOUBLE, num_times, num_times, num_channels, num_channels,
+            num_stations, 0, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, freq_hz);
+    oskar_VisBlock* block = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    oskar_Mem* x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_stations, &status);
+    oskar_Mem* y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_stations, &status);
+    oskar_mem_random_gaussian(x, 0, 1, 2, 3, 500.0, &status);
+    oskar_mem_random_gaussian(y, 4, 5, 6, 7, 500.0, &status);
+    ASSERT_EQ(0, status);
+    const double* px = oskar_mem_double_const(x, &status);
+    const double* py = oskar_mem_double_const(y, &status);
+    double* su = oskar_mem_double(
+            oskar_vis_block_station_uvw_metres(block, 0), &status);
+    double* sv = oskar_mem_double(
+            oskar_vis_block_station_uvw_metres(block, 1), &status);
+    double* sw = oskar_mem_double(
+            oskar_vis_block_station_uvw_metres(block, 2), &status);
+    for (int t = 0; t < num_times; ++t)
+    {
+        const double c = cos(t * d_angle), s = sin(t * d_angle);
+        for (int i = 0; i < num_stations; ++i)
+        {
+            su[t * num_stations + i] = c * px[i] - s * py[i];
+            sv[t * num_stations + i] = s * px[i] + c * py[i];
+            sw[t * num_stations + i] = 0.0;
+        }
+    }
+    oskar_vis_block_station_to_baseline_coords(block, &status);
+
+    // Add a point source away from the phase centre.
+    const double* pu = oskar_mem_double_const(
+            oskar_vis_block_baseline_uvw_metres(block, 0), &status);
+    const double* pv = oskar_mem_double_const(
+            oskar_vis_block_baseline_uvw_metres(block, 1), &status);
+    oskar_Mem* vis = oskar_vis_block_cross_correlations(block);
+    double2* pvis = oskar_mem_double2(vis, &status);
+    const double l0 = 0.003, m0 = -0.002;
+    const double wavenumber = 2.0 * M_PI * freq_hz / 299792458.0;
+    for (size_t i = 0; i < oskar_mem_length(vis); ++i)
+    {
+        const double phase = wavenumber * (pu[i] * l0 + pv[i] * m0);
+        pvis[i].x = cos(phase);
+        pvis[i].y = sin(phase);
+    }
+    ASSERT_EQ(0, status);
+
+    // Make images with and without averaging.
+    oskar_Mem* image0 = make_bda_image(0.0, size, fov_deg, hdr, block,
+            &status);
+    oskar_Mem* image1 = make_bda_image(0.2, size, fov_deg, hdr, block,
+            &status);
+    ASSERT_EQ(0, status);
+
+    // Averaging within a small fraction of a cell should change the image
+    // only slightly.
+    const double diff = max_abs_diff(image0, image1);
+    EXPECT_GT(diff, 0.0);
+    EXPECT_LT(diff, 0.01);
+
+    // Clean up.
+    oskar_vis_block_free(block, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(image0, &status);
+    oskar_mem_free(image1, &status);
+}
+
+static double max_abs_diff_inner(const oskar_Mem* a, const oskar_Mem* b,
+        int size)
+{
+    int status = 0;
+    double max_diff = 0.0;
+    oskar_Mem* a_d = oskar_mem_convert_precision(a, OSKAR_DOUBLE, &status);
+    oskar_Mem* b_d = oskar_mem_convert_precision(b, OSKAR_DOUBLE, &status);
+    const double* pa = oskar_mem_double_const(a_d, &status);
+    const double* pb = oskar_mem_double_const(b_d, &status);
+    for (int y = size / 4; y < 3 * size / 4; ++y)
+    {
+        for (int x = size / 4; x < 3 * size / 4; ++x)
+        {
+            const double diff = fabs(pa[y * size + x] - pb[y * size + x]);
+            if (diff > max_diff) max_diff = diff;
+        }
+    }
+    oskar_mem_free(a_d, &status);
+    oskar_mem_free(b_d, &status);
+    return max_diff;
+}
+
+static void make_fft_images(int single_precision_grids, int size,
+        const char* image_type, int channel_snapshots,
+        const oskar_VisHeader* hdr, oskar_VisBlock* block,
+        int num_images, oskar_Mem** images, int* status)
+{
+    oskar_Imager* im = oskar_imager_create(OSKAR_DOUBLE, status);
+    oskar_imager_set_fov(im, 4.0);
+    oskar_imager_set_size(im, size, status);
+    oskar_imager_set_image_type(im, image_type, status);
+    oskar_imager_set_channel_snapshots(im, channel_snapshots);
+    oskar_imager_set_single_precision_grids(im, single_precision_grids);
+    EXPECT_EQ(single_precision_grids ? OSKAR_SINGLE_COMPLEX :
+            OSKAR_DOUBLE_COMPLEX, oskar_imager_plane_type(im));
+    oskar_imager_update_from_block(im, hdr, block, status);
+    EXPECT_EQ(num_images, oskar_imager_num_image_planes(im));
+    for (int i = 0; i < num_images; ++i)
+        images[i] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                size * size, status);
+    oskar_imager_finalise(im, num_images, images, 0, 0, status);
+    oskar_imager_free(im, status);
+}
+
+static oskar_Mem* make_fft_image(int single_precision_grids, int size,
+        const oskar_VisHeader* hdr, oskar_VisBlock* block, int* status)
+{
+    oskar_Mem* image = 0;
+    make_fft_images(single_precision_grids, size, "I", 0, hdr, block,
+            1, &image, status);
+    return image;
+}
+
+TEST(imager, single_precision_grids)
+{
+    int status = 0;
+    const int size = 256;
+
+    // Create visibility data.
+    const int num_times = 4, num_channels = 2, num_stations = 64;
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_DOUBLE, num_times, num_times, num_channels, num_channels,
+            num_stations, 0, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_VisBlock* block = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(block, 0),
+            0, 1, 2, 3, 500.0, &status);
+    oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(block, 1),
+            4, 5, 6, 7, 500.0, &status);
+    oskar_mem_random_uniform(oskar_vis_block_cross_correlations(block),
+            8, 9, 10, 11, &status);
+    ASSERT_EQ(0, status);
+
+    // Make images with double-precision grids, single-precision grids,
+    // and in single precision.
+    oskar_Mem* image_d = make_fft_image(0, size, hdr, block, &status);
+    oskar_Mem* image_s = make_fft_image(1, size, hdr, block, &status);
+    oskar_Mem* image_f = make_image("FFT", OSKAR_SINGLE, size, 4.0, 0,
+            hdr, block, &status);
+    ASSERT_EQ(0, status);
+    double max_abs = 0.0;
+    const double* p = oskar_mem_double_const(image_d, &status);
+    for (int i = 0; i < size * size; ++i)
+        if (fabs(p[i]) > max_abs) max_abs = fabs(p[i]);
+
+    // Rounding the grids to single precision only once per block should
+    // give errors far smaller than imaging in single precision.
+    // (Errors at the edges of the image are amplified by the grid correction,
+    // so only the inner half is checked.)
+    const double err_s = max_abs_diff_inner(image_d, image_s, size);
+    const double err_f = max_abs_diff_inner(image_d, image_f, size);
+    EXPECT_GT(max_abs, 0.0);
+    EXPECT_LT(err_s, 1e-7 * max_abs);
+    EXPECT_LT(err_s * 100.0, err_f);
+
+    // Clean up.
+    oskar_vis_block_free(block, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_mem_free(image_d, &status);
+    oskar_mem_free(image_s, &status);
+    oskar_mem_free(image_f, &status);
+}
+
+TEST(imager, single_precision_grids_multiple_planes)
+{
+    int status = 0;
+    const int size = 128;
+
+    // Create visibility data.
+    const int num_times = 2, num_channels = 2, num_stations = 32;
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_DOUBLE, num_times, num_times, num_channels, num_channels,
+            num_stations, 0, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_VisBlock* block = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(block, 0),
+            0, 1, 2, 3, 500.0, &status);
+    oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(block, 1),
+            4, 5, 6, 7, 500.0, &status);
+    oskar_mem_random_uniform(oskar_vis_block_cross_correlations(block),
+            8, 9, 10, 11, &status);
+    ASSERT_EQ(0, status);
+
+    // Make all four linear polarisations for each channel, with
+    // double-precision and single-precision grids. Each plane is converted
+    // and finalised separately, so check they all match.
+    const int num_planes = 4 * num_channels;
+    oskar_Mem *image_d[num_planes], *image_s[num_planes];
+    make_fft_images(0, size, "LINEAR", 1, hdr, block,
+            num_planes, image_d, &status);
+    make_fft_images(1, size, "LINEAR", 1, hdr, block,
+            num_planes, image_s, &status);
+    ASSERT_EQ(0, status);
+    for (int i = 0; i < num_planes; ++i)
+    {
+        double max_abs = 0.0;
+        const double* p = oskar_mem_double_const(image_d[i], &status);
+        for (int j = 0; j < size * size; ++j)
+            if (fabs(p[j]) > max_abs) max_abs = fabs(p[j]);
+        EXPECT_GT(max_abs, 0.0) << "Plane " << i;
+        EXPECT_LT(max_abs_diff_inner(image_d[i], image_s[i], size),
+                1e-7 * max_abs) << "Plane " << i;
+        if (i > 0)
+        {
+            EXPECT_GT(max_abs_diff_inner(image_d[i], image_d[0], size),
+                    1e-3 * max_abs) << "Plane " << i;
+        }
+    }
+
+    // Clean up.
+    oskar_vis_block_free(block, &status);
+    oskar_vis_header_free(hdr, &status);
+    for (int i = 0; i < num_planes; ++i)
+    {
+        oskar_mem_free(image_d[i], &status);
+        oskar_mem_free(image_s[i], &status);
+    }
+}
@@ -27,7 +27,17 @@
  */
 
 #include <gtest/gtest.h>
+#include "imager/oskar_grid_simple.h"
+#include "imager/oskar_grid_weights.h"
 #include "imager/oskar_imager.h"
+#include "math/oskar_kahan_sum.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // #define WRITE_FITS 1
 #ifdef WRITE_FITS
@@ -110,3 +120,328 @@ TEST(imager, grid_sum)
     oskar_mem_free(weight, &status);
     oskar_mem_free(grid, &status);
 }
+
+static void check_grid_simple_multi(int support, int oversample)
+{
+    int status = 0, type = OSKAR_DOUBLE, num_planes = 4, grid_size = 256;
+    const size_t num_cells = (size_t) grid_size * grid_size;
+    const int num_vis = 5000;
+    const double cell_size_rad = 4.0e-5;
+
+    // Create a smooth convolution function.
+    oskar_Mem* conv = oskar_mem_create(type, OSKAR_CPU,
+            oversample * (support + 1), &status);
+    double* c = oskar_mem_double(conv, &status);
+    for (int i = 0; i < oversample * (support + 1); ++i)
+        c[i] = exp(-(double)i / oversample);
+
+    // Create visibility data, with different amplitudes and weights
+    // for each plane.
+    oskar_Mem* uu = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 5000.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 5000.0, &status);
+    oskar_Mem *vis[4], *weight[4], *grid[4], *grid_multi[4];
+    const double* vis_ptr[4];
+    const double* weight_ptr[4];
+    double* grid_ptr[4];
+    double norm[4], norm_multi[4];
+    for (int p = 0; p < num_planes; ++p)
+    {
+        vis[p] = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+                num_vis, &status);
+        weight[p] = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+        grid[p] = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+                num_cells, &status);
+        grid_multi[p] = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+                num_cells, &status);
+        oskar_mem_random_uniform(vis[p], p, 1, 2, 3, &status);
+        oskar_mem_random_uniform(weight[p], p, 4, 5, 6, &status);
+        oskar_mem_clear_contents(grid[p], &status);
+        oskar_mem_clear_contents(grid_multi[p], &status);
+        vis_ptr[p] = oskar_mem_double_const(vis[p], &status);
+        weight_ptr[p] = oskar_mem_double_const(weight[p], &status);
+        grid_ptr[p] = oskar_mem_double(grid_multi[p], &status);
+        norm[p] = norm_multi[p] = 0.0;
+    }
+    ASSERT_EQ(0, status);
+
+    // Grid each plane separately, and then all planes together.
+    size_t num_skipped = 0, num_skipped_multi = 0;
+    for (int p = 0; p < num_planes; ++p)
+        oskar_grid_simple_d(support, oversample, c, num_vis,
+                oskar_mem_double_const(uu, &status),
+                oskar_mem_double_const(vv, &status),
+                vis_ptr[p], weight_ptr[p], cell_size_rad, grid_size,
+                &num_skipped, &norm[p], oskar_mem_double(grid[p], &status));
+    oskar_grid_simple_multi_d(support, oversample, c, num_vis,
+            oskar_mem_double_const(uu, &status),
+            oskar_mem_double_const(vv, &status),
+            num_planes, vis_ptr, weight_ptr, cell_size_rad, grid_size,
+            &num_skipped_multi, norm_multi, grid_ptr);
+    ASSERT_GT(num_skipped, 0u);
+    ASSERT_EQ(num_skipped, num_skipped_multi);
+
+    // Check the results are identical.
+    for (int p = 0; p < num_planes; ++p)
+    {
+        ASSERT_DOUBLE_EQ(norm[p], norm_multi[p]);
+        const double* a = oskar_mem_double_const(grid[p], &status);
+        const double* b = oskar_mem_double_const(grid_multi[p], &status);
+        for (size_t i = 0; i < 2 * num_cells; ++i)
+            ASSERT_DOUBLE_EQ(a[i], b[i]);
+    }
+
+    // Clean up.
+    for (int p = 0; p < num_planes; ++p)
+    {
+        oskar_mem_free(vis[p], &status);
+        oskar_mem_free(weight[p], &status);
+        oskar_mem_free(grid[p], &status);
+        oskar_mem_free(grid_multi[p], &status);
+    }
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(conv, &status);
+}
+
+TEST(imager, grid_simple_multi)
+{
+    check_grid_simple_multi(3, 100);
+    check_grid_simple_multi(2, 7);
+}
+
+TEST(imager, grid_simple_multi_mixed)
+{
+    int status = 0, num_planes = 2, grid_size = 256;
+    const int support = 3, oversample = 100;
+    const size_t num_cells = (size_t) grid_size * grid_size;
+    const int num_vis = 200000, num_calls = 4;
+    const double cell_size_rad = 4.0e-5;
+
+    // Create a smooth convolution function.
+    std::vector<double> conv_d(oversample * (support + 1));
+    std::vector<float> conv_f(conv_d.size());
+    for (size_t i = 0; i < conv_d.size(); ++i)
+    {
+        conv_d[i] = exp(-(double)i / oversample);
+        conv_f[i] = (float) conv_d[i];
+    }
+
+    // Create visibility data concentrated near the centre of the grid,
+    // so that many visibilities contribute to each cell.
+    oskar_Mem* uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 2000.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 2000.0, &status);
+    oskar_Mem* uu_f = oskar_mem_convert_precision(uu, OSKAR_SINGLE, &status);
+    oskar_Mem* vv_f = oskar_mem_convert_precision(vv, OSKAR_SINGLE, &status);
+    oskar_Mem *vis[2], *weight[2], *vis_f[2], *weight_f[2];
+    std::vector<double> grid_d[2];
+    std::vector<float> grid_f[2], grid_m[2];
+    double norm_d[2], norm_f[2], norm_m[2];
+    for (int p = 0; p < num_planes; ++p)
+    {
+        vis[p] = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+                num_vis, &status);
+        weight[p] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                num_vis, &status);
+        oskar_mem_random_uniform(vis[p], p, 1, 2, 3, &status);
+        oskar_mem_random_uniform(weight[p], p, 4, 5, 6, &status);
+        vis_f[p] = oskar_mem_convert_precision(vis[p], OSKAR_SINGLE, &status);
+        weight_f[p] = oskar_mem_convert_precision(weight[p], OSKAR_SINGLE,
+                &status);
+        grid_d[p].assign(2 * num_cells, 0.0);
+        grid_f[p].assign(2 * num_cells, 0.0f);
+        grid_m[p].assign(2 * num_cells, 0.0f);
+        norm_d[p] = norm_f[p] = norm_m[p] = 0.0;
+    }
+    ASSERT_EQ(0, status);
+
+    // Grid the visibilities in several calls, in double precision,
+    // in single precision, and using single-precision grids.
+    const int num_per_call = num_vis / num_calls;
+    size_t num_skipped = 0, num_skipped_m = 0;
+    for (int i = 0; i < num_calls; ++i)
+    {
+        const size_t start = (size_t) i * num_per_call;
+        const double* vis_d_ptr[2];
+        const double* weight_d_ptr[2];
+        const float* vis_f_ptr[2];
+        const float* weight_f_ptr[2];
+        double* grid_d_ptr[2];
+        float* grid_f_ptr[2];
+        float* grid_m_ptr[2];
+        for (int p = 0; p < num_planes; ++p)
+        {
+            vis_d_ptr[p] = oskar_mem_double_const(vis[p], &status) + 2 * start;
+            weight_d_ptr[p] = oskar_mem_double_const(weight[p], &status) +
+                    start;
+            vis_f_ptr[p] = oskar_mem_float_const(vis_f[p], &status) +
+                    2 * start;
+            weight_f_ptr[p] = oskar_mem_float_const(weight_f[p], &status) +
+                    start;
+            grid_d_ptr[p] = &grid_d[p][0];
+            grid_f_ptr[p] = &grid_f[p][0];
+            grid_m_ptr[p] = &grid_m[p][0];
+        }
+        oskar_grid_simple_multi_d(support, oversample, &conv_d[0],
+                num_per_call, oskar_mem_double_const(uu, &status) + start,
+                oskar_mem_double_const(vv, &status) + start, num_planes,
+                vis_d_ptr, weight_d_ptr, cell_size_rad, grid_size,
+                &num_skipped, norm_d, grid_d_ptr);
+        oskar_grid_simple_multi_f(support, oversample, &conv_f[0],
+                num_per_call, oskar_mem_float_const(uu_f, &status) + start,
+                oskar_mem_float_const(vv_f, &status) + start, num_planes,
+                vis_f_ptr, weight_f_ptr, (float) cell_size_rad, grid_size,
+                &num_skipped, norm_f, grid_f_ptr);
+        oskar_grid_simple_multi_mixed(support, oversample, &conv_d[0],
+                num_per_call, oskar_mem_double_const(uu, &status) + start,
+                oskar_mem_double_const(vv, &status) + start, num_planes,
+                vis_d_ptr, weight_d_ptr, cell_size_rad, grid_size,
+                &num_skipped_m, norm_m, grid_m_ptr, &status);
+        ASSERT_EQ(num_skipped, num_skipped_m);
+    }
+    ASSERT_EQ(0, status);
+
+    // Check the single-precision grids are much closer to the
+    // double-precision grids than when gridding in single precision.
+    for (int p = 0; p < num_planes; ++p)
+    {
+        double max_abs = 0.0, max_err_f = 0.0, max_err_m = 0.0;
+        for (size_t i = 0; i < 2 * num_cells; ++i)
+        {
+            const double err_f = fabs(grid_f[p][i] - grid_d[p][i]);
+            const double err_m = fabs(grid_m[p][i] - grid_d[p][i]);
+            if (fabs(grid_d[p][i]) > max_abs) max_abs = fabs(grid_d[p][i]);
+            if (err_f > max_err_f) max_err_f = err_f;
+            if (err_m > max_err_m) max_err_m = err_m;
+        }
+        EXPECT_NEAR(norm_d[p], norm_m[p], 1e-12 * norm_d[p]);
+        EXPECT_LT(max_err_m, 2.5e-7 * max_abs);
+        EXPECT_LT(max_err_m * 100.0, max_err_f);
+    }
+
+    // Clean up.
+    for (int p = 0; p < num_planes; ++p)
+    {
+        oskar_mem_free(vis[p], &status);
+        oskar_mem_free(weight[p], &status);
+        oskar_mem_free(vis_f[p], &status);
+        oskar_mem_free(weight_f[p], &status);
+    }
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(uu_f, &status);
+    oskar_mem_free(vv_f, &status);
+}
+
+TEST(imager, grid_weights)
+{
+    const int grid_size = 256, num_points = 100000;
+    const double cell_size_rad = 4.0 / (3600.0 * 180.0 / M_PI);
+    const int num_cells = grid_size * grid_size;
+    std::vector<double> uu(num_points), vv(num_points), w(num_points);
+    std::vector<float> uu_f(num_points), vv_f(num_points), w_f(num_points);
+    srand(3);
+    for (int i = 0; i < num_points; ++i)
+    {
+        // Half of the points are clustered, and some are off the grid.
+        const double s = (i % 2) ? 80000.0 : 4000.0;
+        uu[i] = s * ((double)rand() / RAND_MAX - 0.5);
+        vv[i] = s * ((double)rand() / RAND_MAX - 0.5);
+        w[i] = 0.5 + (double)rand() / RAND_MAX;
+        uu_f[i] = (float) uu[i];
+        vv_f[i] = (float) vv[i];
+        w_f[i] = (float) w[i];
+    }
+
+    // Use several threads, to check the grid does not depend on them.
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(4);
+#endif
+
+    // Check the dense grids match a serial reference exactly.
+    size_t num_skipped = 0, num_skipped_ref = 0;
+    std::vector<double> grid(num_cells, 0.0), grid_ref(num_cells, 0.0);
+    std::vector<float> grid_f(num_cells, 0.f), guard_f(num_cells, 0.f);
+    std::vector<float> grid_f_ref(num_cells, 0.f), guard_f_ref(num_cells, 0.f);
+    const double grid_scale = grid_size * cell_size_rad;
+    const float grid_scale_f = grid_size * (float) cell_size_rad;
+    for (int i = 0; i < num_points; ++i)
+    {
+        int u = (int)round(-uu[i] * grid_scale) + grid_size / 2;
+        int v = (int)round(vv[i] * grid_scale) + grid_size / 2;
+        if (u < 0 || u >= grid_size || v < 0 || v >= grid_size)
+        {
+            num_skipped_ref++;
+            continue;
+        }
+        grid_ref[v * grid_size + u] += w[i];
+        u = (int)roundf(-uu_f[i] * grid_scale_f) + grid_size / 2;
+        v = (int)roundf(vv_f[i] * grid_scale_f) + grid_size / 2;
+        const int t = v * grid_size + u;
+        OSKAR_KAHAN_SUM(float, grid_f_ref[t], w_f[i], guard_f_ref[t]);
+    }
+    ASSERT_GT(num_skipped_ref, 0u);
+    oskar_grid_weights_write_d(num_points, &uu[0], &vv[0], &w[0],
+            cell_size_rad, grid_size, &num_skipped, &grid[0]);
+    ASSERT_EQ(num_skipped_ref, num_skipped);
+    oskar_grid_weights_write_f(num_points, &uu_f[0], &vv_f[0], &w_f[0],
+            (float) cell_size_rad, grid_size, &num_skipped,
+            &grid_f[0], &guard_f[0]);
+    ASSERT_EQ(num_skipped_ref, num_skipped);
+    for (int i = 0; i < num_cells; ++i)
+    {
+        ASSERT_EQ(grid_ref[i], grid[i]);
+        ASSERT_EQ(grid_f_ref[i], grid_f[i]);
+    }
+
+    // Fill a hash table, growing it when it is half full.
+    int capacity = 64, num_used = 0;
+    size_t start = 0;
+    std::vector<int> keys(capacity, -1);
+    std::vector<double> values(capacity, 0.0);
+    while (start < (size_t) num_points)
+    {
+        start += oskar_grid_weights_hash_write_d(num_points - start,
+                &uu[start], &vv[start], &w[start], cell_size_rad, grid_size,
+                &num_skipped, capacity, &num_used, &keys[0], &values[0]);
+        if (start == (size_t) num_points) break;
+        std::vector<int> new_keys(2 * capacity, -1);
+        std::vector<double> new_values(2 * capacity, 0.0);
+        for (int j = 0; j < capacity; ++j)
+            if (keys[j] >= 0)
+                oskar_grid_weights_hash_insert_d(keys[j], values[j],
+                        2 * capacity, &new_keys[0], &new_values[0]);
+        capacity *= 2;
+        keys.swap(new_keys);
+        values.swap(new_values);
+    }
+    ASSERT_LE(2 * num_used, capacity);
+    int num_used_ref = 0;
+    for (int i = 0; i < num_cells; ++i)
+        if (grid_ref[i] != 0.0) num_used_ref++;
+    ASSERT_EQ(num_used_ref, num_used);
+    for (int j = 0; j < capacity; ++j)
+    {
+        if (keys[j] < 0) continue;
+        ASSERT_EQ(grid_ref[keys[j]], values[j]);
+    }
+
+    // Check the re-weighted points are the same from both grids.
+    std::vector<double> out(num_points, 0.0), out_hash(num_points, 0.0);
+    oskar_grid_weights_read_d(num_points, &uu[0], &vv[0], &w[0], &out[0],
+            cell_size_rad, grid_size, &num_skipped, &grid[0]);
+    ASSERT_EQ(num_skipped_ref, num_skipped);
+    oskar_grid_weights_hash_read_d(num_points, &uu[0], &vv[0], &w[0],
+            &out_hash[0], cell_size_rad, grid_size, &num_skipped,
+            capacity, &keys[0], &values[0]);
+    ASSERT_EQ(num_skipped_ref, num_skipped);
+    for (int i = 0; i < num_points; ++i)
+        ASSERT_EQ(out[i], out_hash[i]);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_dft_c2r.h"
+#include "math/oskar_evaluate_image_lmn_grid.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+// Direct evaluation of the DFT imager kernel, using the maths library.
+template<typename FP>
+static void dft_c2r_reference(int num_in, FP wavenumber, const FP* x_in,
+        const FP* y_in, const FP* z_in, const FP* data_in,
+        const FP* weight_in, int num_out, const FP* x_out, const FP* y_out,
+        const FP* z_out, FP* output)
+{
+    for (int j = 0; j < num_out; ++j)
+    {
+        FP out = (FP) 0;
+        const FP xo = wavenumber * x_out[j];
+        const FP yo = wavenumber * y_out[j];
+        const FP zo = z_out ? wavenumber * z_out[j] : (FP) 0;
+        for (int i = 0; i < num_in; ++i)
+        {
+            FP t = xo * x_in[i] + yo * y_in[i];
+            if (z_out) t += zo * z_in[i];
+            const FP re = cos(-t), im = sin(-t);
+            out += weight_in[i] * (data_in[2*i] * re - data_in[2*i + 1] * im);
+        }
+        output[j] = out;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_dft_imager_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-s", "Image side length.", 1, "", true);
+    opt.add_flag("-nvis", "Number of visibilities.", 1, "", true);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-3d", "Use the 3D DFT (default: 2D)");
+    opt.add_flag("-n", "Number of iterations", 1, "1", false);
+    opt.add_flag("-v", "Display verbose output.", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0;
+    const int side = opt.get_int("-s");
+    const int num_vis = opt.get_int("-nvis");
+    const int prec = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    const int is_3d = opt.is_set("-3d");
+    const int niter = opt.get_int("-n");
+    const int num_pixels = side * side;
+    const double wavenumber = 2.0 * M_PI;
+
+    // Create a pixel grid and random visibility data.
+    oskar_Mem *l = oskar_mem_create(prec, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem *m = oskar_mem_create(prec, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem *n = oskar_mem_create(prec, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem *uu = oskar_mem_create(prec, OSKAR_CPU, num_vis, &status);
+    oskar_Mem *vv = oskar_mem_create(prec, OSKAR_CPU, num_vis, &status);
+    oskar_Mem *ww = oskar_mem_create(prec, OSKAR_CPU, num_vis, &status);
+    oskar_Mem *amp = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_vis, &status);
+    oskar_Mem *weight = oskar_mem_create(prec, OSKAR_CPU, num_vis, &status);
+    oskar_Mem *image = oskar_mem_create(prec, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem *ref = oskar_mem_create(prec, OSKAR_CPU, num_pixels, &status);
+    oskar_evaluate_image_lmn_grid(side, side, 2.0 * M_PI / 180.0,
+            2.0 * M_PI / 180.0, 0, l, m, n, &status);
+    oskar_mem_add_real(n, -1.0, &status);
+    oskar_mem_random_range(uu, -5000.0, 5000.0, &status);
+    oskar_mem_random_range(vv, -5000.0, 5000.0, &status);
+    oskar_mem_random_range(ww, -500.0, 500.0, &status);
+    oskar_mem_random_range(amp, -1.0, 1.0, &status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_vis, &status);
+
+    // Time the imager kernel.
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(timer);
+    for (int i = 0; i < niter; ++i)
+        oskar_dft_c2r(num_vis, wavenumber, uu, vv, ww, amp, weight,
+                num_pixels, l, m, is_3d ? n : 0, image, &status);
+    const double time_dft = oskar_timer_elapsed(timer) / niter;
+
+    // Time the direct evaluation, once only.
+    oskar_timer_start(timer);
+    if (prec == OSKAR_DOUBLE)
+        dft_c2r_reference<double>(num_vis, wavenumber,
+                oskar_mem_double_const(uu, &status),
+                oskar_mem_double_const(vv, &status),
+                oskar_mem_double_const(ww, &status),
+                oskar_mem_double_const(amp, &status),
+                oskar_mem_double_const(weight, &status), num_pixels,
+                oskar_mem_double_const(l, &status),
+                oskar_mem_double_const(m, &status),
+                is_3d ? oskar_mem_double_const(n, &status) : 0,
+                oskar_mem_double(ref, &status));
+    else
+        dft_c2r_reference<float>(num_vis, (float) wavenumber,
+                oskar_mem_float_const(uu, &status),
+                oskar_mem_float_const(vv, &status),
+                oskar_mem_float_const(ww, &status),
+                oskar_mem_float_const(amp, &status),
+                oskar_mem_float_const(weight, &status), num_pixels,
+                oskar_mem_float_const(l, &status),
+                oskar_mem_float_const(m, &status),
+                is_3d ? oskar_mem_float_const(n, &status) : 0,
+                oskar_mem_float(ref, &status));
+    const double time_ref = oskar_timer_elapsed(timer);
+
+    // Check for errors.
+    if (status)
+    {
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+
+    // Find the maximum difference from the direct evaluation.
+    double max_diff = 0.0;
+    for (int i = 0; i < num_pixels; ++i)
+    {
+        double diff;
+        if (prec == OSKAR_DOUBLE)
+            diff = oskar_mem_double(image, &status)[i] -
+                    oskar_mem_double(ref, &status)[i];
+        else
+            diff = oskar_mem_float(image, &status)[i] -
+                    oskar_mem_float(ref, &status)[i];
+        if (fabs(diff) > max_diff) max_diff = fabs(diff);
+    }
+
+    // Print results.
+    if (opt.is_set("-v"))
+    {
+        printf("- Image size: %i x %i\n", side, side);
+        printf("- Number of visibilities: %i\n", num_vis);
+        printf("- Precision: %s\n", (prec == OSKAR_SINGLE) ?
+                "single" : "double");
+        printf("- DFT type: %s\n", is_3d ? "3D" : "2D");
+        printf("==> DFT took %.4f sec (direct: %.4f sec)\n",
+                time_dft, time_ref);
+        printf("==> Speed-up over direct evaluation: %.2f\n",
+                time_ref / time_dft);
+        printf("==> Maximum difference: %.3e\n", max_diff);
+    }
+    else
+    {
+        printf("%f %f %e\n", time_dft, time_ref, max_diff);
+    }
+
+    // Free memory.
+    oskar_timer_free(timer);
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    oskar_mem_free(n, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(amp, &status);
+    oskar_mem_free(weight, &status);
+    oskar_mem_free(image, &status);
+    oskar_mem_free(ref, &status);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+/* Copyright (c) 2021, The OSKAR Developers. See LICENSE file. */
+
+/* M = T[I], where T holds C real values per element (2 or 8).
+ * A scalar is loaded as a diagonal matrix. */
+#define OSKAR_JONES_CHAIN_LOAD(FP, M, C, T, I) {\
+        const int j__ = (C) * (I);\
+        M.a.x = T[j__]; M.a.y = T[j__ + 1];\
+        if ((C) == 8) {\
+            M.b.x = T[j__ + 2]; M.b.y = T[j__ + 3];\
+            M.c.x = T[j__ + 4]; M.c.y = T[j__ + 5];\
+            M.d.x = T[j__ + 6]; M.d.y = T[j__ + 7];\
+        } else {\
+            M.b.x = M.b.y = M.c.x = M.c.y = (FP)0;\
+            M.d = M.a;\
+        }}\
+
+/* M = T[I] * M, or M unchanged if C is 0. */
+#define OSKAR_JONES_CHAIN_MUL(FP, FP2, FP4c, M, C, T, I) {\
+        if ((C) == 8) {\
+            FP4c m__, r__;\
+            OSKAR_JONES_CHAIN_LOAD(FP, m__, 8, T, I)\
+            OSKAR_MUL_COMPLEX_MATRIX(r__, m__, M)\
+            M = r__;\
+        } else if ((C) == 2) {\
+            FP2 s__;\
+            s__.x = T[2 * (I)]; s__.y = T[2 * (I) + 1];\
+            OSKAR_MUL_COMPLEX_MATRIX_COMPLEX_SCALAR_IN_PLACE(FP2, M, s__)\
+        }}\
+
+/* Evaluates G * T0 * T1 * T2 * T3 for each station and source, keeping
+ * the partial product in registers. Each c* argument gives the number of
+ * real values per element of the corresponding array (8 for a matrix,
+ * 2 for a scalar, or 0 if the term is not used). Unused terms must come
+ * first, as the product is accumulated from the right, starting with T3.
+ * The gains are indexed by station only. */
+#define OSKAR_JONES_CHAIN(NAME, FP, FP2, FP4c) KERNEL(NAME) (\
+        const int        num_sources,\
+        const int        num_stations,\
+        const int        c0,\
+        GLOBAL_IN(FP,    t0),\
+        const int        c1,\
+        GLOBAL_IN(FP,    t1),\
+        const int        c2,\
+        GLOBAL_IN(FP,    t2),\
+        const int        c3,\
+        GLOBAL_IN(FP,    t3),\
+        const int        c_gains,\
+        GLOBAL_IN(FP,    gains),\
+        const int        c_out,\
+        GLOBAL_OUT(FP,   out))\
+{\
+    KERNEL_LOOP_Y(int, i_station, 0, num_stations)\
+    FP4c g;\
+    if (c_gains) {\
+        OSKAR_JONES_CHAIN_LOAD(FP, g, c_gains, gains, i_station)\
+    }\
+    KERNEL_LOOP_PAR_X(int, i_source, 0, num_sources)\
+    const int i = num_sources * i_station + i_source;\
+    FP4c m;\
+    OSKAR_JONES_CHAIN_LOAD(FP, m, c3, t3, i)\
+    OSKAR_JONES_CHAIN_MUL(FP, FP2, FP4c, m, c2, t2, i)\
+    OSKAR_JONES_CHAIN_MUL(FP, FP2, FP4c, m, c1, t1, i)\
+    OSKAR_JONES_CHAIN_MUL(FP, FP2, FP4c, m, c0, t0, i)\
+    if (c_gains == 8) {\
+        FP4c r;\
+        OSKAR_MUL_COMPLEX_MATRIX(r, g, m)\
+        m = r;\
+    } else if (c_gains == 2) {\
+        OSKAR_MUL_COMPLEX_MATRIX_COMPLEX_SCALAR_IN_PLACE(FP2, m, g.a)\
+    }\
+    const int j = c_out * i;\
+    out[j] = m.a.x; out[j + 1] = m.a.y;\
+    if (c_out == 8) {\
+        out[j + 2] = m.b.x; out[j + 3] = m.b.y;\
+        out[j + 4] = m.c.x; out[j + 5] = m.c.y;\
+        out[j + 6] = m.d.x; out[j + 7] = m.d.y;\
+    }\
+    KERNEL_LOOP_END\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
@@ -46,6 +46,10 @@ OSKAR_EXPORT
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_compress_vis_file(oskar_Interferometer* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_correlation_type(oskar_Interferometer* h,
         const char* type, int* status);
@@ -65,14 +69,56 @@ OSKAR_EXPORT
 void oskar_interferometer_set_ignore_w_components(oskar_Interferometer* h,
         int value);
 
+/**
+ * @brief
+ * Sets the maximum number of sources processed
+ * concurrently on each compute device.
+ *
+ * @details
+ * Sets the maximum number of sources processed
+ * concurrently on each compute device.
+ * If \p value is zero or negative, the number of sources per chunk is chosen
+ * automatically from the available host and device memory when the
+ * simulator is initialised.
+ *
+ * @param[in] value  Maximum number, or <= 0 to choose automatically.
+ */
 OSKAR_EXPORT
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
         int value);
 
+/**
+ * @brief
+ * Sets the maximum number of channels held in each
+ * visibility block.
+ *
+ * @details
+ * Sets the maximum number of channels held in each
+ * visibility block.
+ * If \p value is zero or negative, the number of channels per block is chosen
+ * automatically from the available host and device memory when the
+ * simulator is initialised.
+ *
+ * @param[in] value  Maximum number, or <= 0 to choose automatically.
+ */
 OSKAR_EXPORT
 void oskar_interferometer_set_max_channels_per_block(oskar_Interferometer* h,
         int value);
 
+/**
+ * @brief
+ * Sets the maximum number of time samples held in each
+ * visibility block.
+ *
+ * @details
+ * Sets the maximum number of time samples held in each
+ * visibility block.
+ * If \p value is zero or negative, the number of time samples per block is chosen
+ * automatically from the available host and device memory when the
+ * simulator is initialised.
+ *
+ * @param[in] value  Maximum number, or <= 0 to choose automatically.
+ */
 OSKAR_EXPORT
 void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
         int value);
@@ -80,6 +126,62 @@ void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
 OSKAR_EXPORT
 void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value);
 
+/**
+ * @brief
+ * Sets whether CPU devices are pinned to NUMA nodes.
+ *
+ * @details
+ * If set, the thread for each CPU device is pinned to one NUMA node,
+ * and the device's buffers are allocated by that thread, so that they are
+ * placed on the same node. CPU devices are divided evenly between nodes.
+ * Pinned threads do not reuse cached blocks from the host memory pool
+ * (see oskar_mem_pool.h), as those may be on another node.
+ *
+ * @param[in,out] h          Handle to simulator.
+ * @param[in] value          If true, pin CPU devices to NUMA nodes.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_numa_pinning(oskar_Interferometer* h,
+        int value);
+
+/**
+ * @brief
+ * Sets whether CPU devices correlate planar Jones matrices.
+ *
+ * @details
+ * If set, CPU devices copy the combined Jones matrices into the planar
+ * layout (see oskar_jones_create_planar()) before applying station gains
+ * and correlating, so that the sums over sources can be vectorised.
+ * This needs one extra Jones matrix block per CPU device.
+ * GPU devices are not affected.
+ *
+ * @param[in,out] h          Handle to simulator.
+ * @param[in] value          If true, use planar Jones matrices on CPUs.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_planar_jones(oskar_Interferometer* h,
+        int value);
+
+/**
+ * @brief
+ * Sets whether OpenCL devices prefetch the next sky chunk.
+ *
+ * @details
+ * If set, each OpenCL device copies the next sky model chunk into a spare
+ * buffer on its transfer queue while the current chunk is processed.
+ * This needs one extra sky chunk per OpenCL device.
+ * Other devices are not affected.
+ *
+ * This is off by default, as it has not yet been validated
+ * on an OpenCL runtime.
+ *
+ * @param[in,out] h          Handle to simulator.
+ * @param[in] value          If true, prefetch sky chunks on OpenCL devices.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_prefetch_sky(oskar_Interferometer* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_observation_frequency(oskar_Interferometer* h,
         double start_hz, double inc_hz, int num_channels);
@@ -28,6 +28,8 @@ typedef struct oskar_Jones oskar_Jones;
 
 #include <interferometer/oskar_jones_accessors.h>
 #include <interferometer/oskar_jones_apply_station_gains.h>
+#include <interferometer/oskar_jones_chain.h>
+#include <interferometer/oskar_jones_convert.h>
 #include <interferometer/oskar_jones_create.h>
 #include <interferometer/oskar_jones_create_copy.h>
 #include <interferometer/oskar_jones_free.h>
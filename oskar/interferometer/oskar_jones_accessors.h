@@ -60,6 +60,39 @@ int oskar_jones_num_stations(const oskar_Jones* jones);
 OSKAR_EXPORT
 int oskar_jones_type(const oskar_Jones* jones);
 
+/**
+ * @brief
+ * Returns true if the Jones matrix block uses the planar layout.
+ *
+ * @details
+ * Returns true if the Jones matrix block was created using
+ * oskar_jones_create_planar(), so that each real-valued component
+ * of the matrices is held in a separate array.
+ *
+ * @param[in]     jones  Pointer to data structure.
+ *
+ * @return True if the layout is planar.
+ */
+OSKAR_EXPORT
+int oskar_jones_is_planar(const oskar_Jones* jones);
+
+/**
+ * @brief
+ * Returns the distance between components in a planar Jones matrix block.
+ *
+ * @details
+ * Returns the number of real values between the start of consecutive
+ * components in a planar Jones matrix block.
+ * This is set by the capacity of the block, and does not change when
+ * the block is resized.
+ *
+ * @param[in]     jones  Pointer to data structure.
+ *
+ * @return The number of real values between components.
+ */
+OSKAR_EXPORT
+size_t oskar_jones_component_stride(const oskar_Jones* jones);
+
 /**
  * @brief
  * Returns the enumerated location of the Jones matrix block.
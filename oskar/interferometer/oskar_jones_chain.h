@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_JONES_CHAIN_H_
+#define OSKAR_JONES_CHAIN_H_
+
+/**
+ * @file oskar_jones_chain.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+/* Maximum number of per-source terms in a Jones chain. */
+#define OSKAR_JONES_CHAIN_MAX_TERMS 4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Multiplies a chain of Jones terms in a single pass.
+ *
+ * @details
+ * Evaluates J = G * T[0] * T[1] * ... * T[num_terms - 1] for every
+ * station and source, where G is an optional set of station gains.
+ * The product for each element is formed in registers, so each input is
+ * read only once and the output written only once, instead of making a
+ * pass over memory for every pairwise join.
+ *
+ * Each term may be a complex scalar or a complex matrix, but the output
+ * must be a matrix if any of the inputs are. All inputs must have the same
+ * dimensions, precision and location as the output, and must use the
+ * interleaved (not planar) layout. The output must not be one of the terms.
+ *
+ * @param[out] out       Output Jones matrices.
+ * @param[in] num_terms  Number of terms in the chain
+ *                       (1 to OSKAR_JONES_CHAIN_MAX_TERMS).
+ * @param[in] terms      Array of pointers to the Jones terms.
+ * @param[in] gains      Optional station gains, one per station, or NULL.
+ * @param[in,out] status Status return code.
+ */
+OSKAR_EXPORT
+void oskar_jones_chain(oskar_Jones* out, int num_terms,
+        const oskar_Jones* const* terms, const oskar_Mem* gains,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
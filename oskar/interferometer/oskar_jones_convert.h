@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_JONES_CONVERT_H_
+#define OSKAR_JONES_CONVERT_H_
+
+/**
+ * @file oskar_jones_convert.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Copies Jones matrices between blocks with different layouts.
+ *
+ * @details
+ * Copies the contents of one Jones matrix block into another,
+ * converting between the interleaved and planar layouts as required.
+ * The blocks may be in different memory locations.
+ *
+ * The destination is resized to the dimensions of the source,
+ * which must fit within its existing capacity, and the data types of
+ * both blocks must be the same.
+ *
+ * @param[in,out] dst    Destination Jones matrix block.
+ * @param[in]     src    Source Jones matrix block.
+ * @param[in,out] status Status return code.
+ */
+OSKAR_EXPORT
+void oskar_jones_convert(oskar_Jones* dst, const oskar_Jones* src,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
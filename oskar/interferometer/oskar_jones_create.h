@@ -62,6 +62,43 @@ OSKAR_EXPORT
 oskar_Jones* oskar_jones_create(int type, int location, int num_stations,
         int num_sources, int* status);
 
+/**
+ * @brief
+ * Creates and initialises a Jones matrix structure with a planar layout.
+ *
+ * @details
+ * This function creates a Jones matrix data structure in which each
+ * real-valued component of the matrices is held in its own contiguous
+ * array, rather than interleaving the components of each matrix.
+ * This allows the CPU kernels that use the matrices to be vectorised.
+ *
+ * For a matrix type, the eight components are stored in the order
+ * a.re, a.im, b.re, b.im, c.re, c.im, d.re, d.im;
+ * for a scalar type, the two components are stored in the order re, im.
+ * Component \p k of the matrix at index \p i (where
+ * i = num_sources * station + source) is at element
+ * (k * stride + i) of the real-valued array returned by oskar_jones_mem(),
+ * where the stride is given by oskar_jones_component_stride().
+ *
+ * The planar layout is only available in CPU memory. Functions that fill
+ * a Jones matrix block require the interleaved layout, so data should be
+ * converted using oskar_jones_convert() before use in a planar block.
+ *
+ * The data structure must be deallocated using oskar_jones_free() when it is
+ * no longer required.
+ *
+ * @param[in] type          Enumerated (complex) data type of the matrices.
+ * @param[in] location      Enumerated memory location (must be OSKAR_CPU).
+ * @param[in] num_stations  Number of elements in the station dimension.
+ * @param[in] num_sources   Number of elements in the source dimension.
+ * @param[in,out]  status   Status return code.
+ *
+ * @return A handle to the new data structure.
+ */
+OSKAR_EXPORT
+oskar_Jones* oskar_jones_create_planar(int type, int location,
+        int num_stations, int num_sources, int* status);
+
 #ifdef __cplusplus
 }
 #endif
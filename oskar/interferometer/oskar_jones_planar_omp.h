@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_JONES_PLANAR_OMP_H_
+#define OSKAR_JONES_PLANAR_OMP_H_
+
+/**
+ * @file oskar_jones_planar_omp.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Copies interleaved complex values into separate component arrays
+ * (single precision).
+ *
+ * @details
+ * Copies \p num_elements complex scalars (\p num_components = 2) or
+ * complex matrices (\p num_components = 8) from an interleaved array into
+ * separate arrays, with component \p k of element \p i written to
+ * out[k * stride + i].
+ *
+ * @param[in] num_elements    Number of scalars or matrices to copy.
+ * @param[in] num_components  Number of real values per element (2 or 8).
+ * @param[in] in              Interleaved input values.
+ * @param[in] stride          Number of values between output components.
+ * @param[out] out            Planar output values.
+ */
+OSKAR_EXPORT
+void oskar_jones_to_planar_omp_f(int num_elements, int num_components,
+        const float* in, size_t stride, float* out);
+
+/**
+ * @brief
+ * Copies interleaved complex values into separate component arrays
+ * (double precision).
+ *
+ * @details
+ * Copies \p num_elements complex scalars (\p num_components = 2) or
+ * complex matrices (\p num_components = 8) from an interleaved array into
+ * separate arrays, with component \p k of element \p i written to
+ * out[k * stride + i].
+ *
+ * @param[in] num_elements    Number of scalars or matrices to copy.
+ * @param[in] num_components  Number of real values per element (2 or 8).
+ * @param[in] in              Interleaved input values.
+ * @param[in] stride          Number of values between output components.
+ * @param[out] out            Planar output values.
+ */
+OSKAR_EXPORT
+void oskar_jones_to_planar_omp_d(int num_elements, int num_components,
+        const double* in, size_t stride, double* out);
+
+/**
+ * @brief
+ * Copies separate component arrays into interleaved complex values
+ * (single precision).
+ *
+ * @details
+ * This is the inverse of oskar_jones_to_planar_omp_f().
+ *
+ * @param[in] num_elements    Number of scalars or matrices to copy.
+ * @param[in] num_components  Number of real values per element (2 or 8).
+ * @param[in] stride          Number of values between input components.
+ * @param[in] in              Planar input values.
+ * @param[out] out            Interleaved output values.
+ */
+OSKAR_EXPORT
+void oskar_jones_from_planar_omp_f(int num_elements, int num_components,
+        size_t stride, const float* in, float* out);
+
+/**
+ * @brief
+ * Copies separate component arrays into interleaved complex values
+ * (double precision).
+ *
+ * @details
+ * This is the inverse of oskar_jones_to_planar_omp_d().
+ *
+ * @param[in] num_elements    Number of scalars or matrices to copy.
+ * @param[in] num_components  Number of real values per element (2 or 8).
+ * @param[in] stride          Number of values between input components.
+ * @param[in] in              Planar input values.
+ * @param[out] out            Interleaved output values.
+ */
+OSKAR_EXPORT
+void oskar_jones_from_planar_omp_d(int num_elements, int num_components,
+        size_t stride, const double* in, double* out);
+
+/**
+ * @brief
+ * Multiplies planar Jones matrices element-wise (single precision).
+ *
+ * @details
+ * Forms J3 = J1 * J2 for each of \p num_elements elements, where each
+ * input may be a complex scalar (2 components) or a complex matrix
+ * (8 components). The output has 8 components if either input is a matrix.
+ * The output may be the same array as either input.
+ *
+ * @param[in] num_elements  Number of elements to multiply.
+ * @param[in] comp1         Number of components in J1 (2 or 8).
+ * @param[in] stride1       Component stride of J1.
+ * @param[in] j1            Planar values of J1.
+ * @param[in] comp2         Number of components in J2 (2 or 8).
+ * @param[in] stride2       Component stride of J2.
+ * @param[in] j2            Planar values of J2.
+ * @param[in] stride3       Component stride of J3.
+ * @param[out] j3           Planar values of J3.
+ */
+OSKAR_EXPORT
+void oskar_jones_join_planar_omp_f(int num_elements,
+        int comp1, size_t stride1, const float* j1,
+        int comp2, size_t stride2, const float* j2,
+        size_t stride3, float* j3);
+
+/**
+ * @brief
+ * Multiplies planar Jones matrices element-wise (double precision).
+ *
+ * @details
+ * Forms J3 = J1 * J2 for each of \p num_elements elements, where each
+ * input may be a complex scalar (2 components) or a complex matrix
+ * (8 components). The output has 8 components if either input is a matrix.
+ * The output may be the same array as either input.
+ *
+ * @param[in] num_elements  Number of elements to multiply.
+ * @param[in] comp1         Number of components in J1 (2 or 8).
+ * @param[in] stride1       Component stride of J1.
+ * @param[in] j1            Planar values of J1.
+ * @param[in] comp2         Number of components in J2 (2 or 8).
+ * @param[in] stride2       Component stride of J2.
+ * @param[in] j2            Planar values of J2.
+ * @param[in] stride3       Component stride of J3.
+ * @param[out] j3           Planar values of J3.
+ */
+OSKAR_EXPORT
+void oskar_jones_join_planar_omp_d(int num_elements,
+        int comp1, size_t stride1, const double* j1,
+        int comp2, size_t stride2, const double* j2,
+        size_t stride3, double* j3);
+
+/**
+ * @brief
+ * Applies station gains to planar Jones matrices (single precision).
+ *
+ * @details
+ * Pre-multiplies the Jones matrices for each station by the
+ * (interleaved) gain for that station.
+ *
+ * @param[in] num_sources     Number of sources.
+ * @param[in] num_stations    Number of stations.
+ * @param[in] num_components  Number of components (2 or 8).
+ * @param[in] gains           Interleaved station gains.
+ * @param[in] stride          Component stride of the Jones matrices.
+ * @param[in,out] jones       Planar Jones matrices.
+ */
+OSKAR_EXPORT
+void oskar_jones_apply_station_gains_planar_omp_f(int num_sources,
+        int num_stations, int num_components, const float* gains,
+        size_t stride, float* jones);
+
+/**
+ * @brief
+ * Applies station gains to planar Jones matrices (double precision).
+ *
+ * @details
+ * Pre-multiplies the Jones matrices for each station by the
+ * (interleaved) gain for that station.
+ *
+ * @param[in] num_sources     Number of sources.
+ * @param[in] num_stations    Number of stations.
+ * @param[in] num_components  Number of components (2 or 8).
+ * @param[in] gains           Interleaved station gains.
+ * @param[in] stride          Component stride of the Jones matrices.
+ * @param[in,out] jones       Planar Jones matrices.
+ */
+OSKAR_EXPORT
+void oskar_jones_apply_station_gains_planar_omp_d(int num_sources,
+        int num_stations, int num_components, const double* gains,
+        size_t stride, double* jones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
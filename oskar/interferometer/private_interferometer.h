@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2020, The OSKAR Developers.
+ * Copyright (c) 2011-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -30,8 +30,13 @@ struct DeviceData
     oskar_Mem *lmn[3], *uvw[3];
     oskar_Sky* chunk;           /* The unmodified sky chunk being processed. */
     oskar_Sky* chunk_clip;      /* Copy of the chunk after horizon clipping. */
+    oskar_Sky* chunk_next;      /* Next sky chunk, if prefetching. */
+    int next_chunk_index;       /* Index of the prefetched chunk, or -1. */
+    struct _cl_event* chunk_event; /* Completes when prefetch is done. */
+    double last_progress;       /* Time of the last progress message. */
     oskar_Telescope* tel;       /* Telescope model, created as a copy. */
     oskar_Jones *J, *R, *E, *K;
+    oskar_Jones *J_planar;      /* Planar copy of J (CPU only), or NULL. */
     oskar_Mem *gains;
     oskar_StationWork* station_work;
 
@@ -53,8 +58,10 @@ struct oskar_Interferometer
     int prec, num_devices, num_gpus_avail, dev_loc, num_gpus, *gpu_ids;
     int num_channels, num_time_steps;
     int max_sources_per_chunk, max_times_per_block, max_channels_per_block;
+    int auto_sources_per_chunk, auto_times_per_block, auto_channels_per_block;
     int apply_horizon_clip, force_polarised_ms, zero_failed_gaussians;
-    int coords_only, ignore_w_components;
+    int coords_only, ignore_w_components, compress_vis_file, numa_pinning;
+    int planar_jones, prefetch_sky;
     double freq_start_hz, freq_inc_hz, time_start_mjd_utc, time_inc_sec;
     double source_min_jy, source_max_jy;
     char correlation_type, *vis_name, *ms_name, *settings_path;
@@ -75,6 +82,7 @@ struct oskar_Interferometer
     oskar_MeasurementSet* ms;
     oskar_Binary* vis;
     oskar_Mem *temp;
+    oskar_Mem *ms_vis, *ms_uvw[3]; /* Block reordered for Measurement Set. */
     oskar_Timer* tmr_sim;   /* The total time for the simulation. */
     oskar_Timer* tmr_write; /* The time spent writing vis blocks. */
 
@@ -37,6 +37,8 @@ struct oskar_Jones
     int num_sources;  /* Fastest varying dimension. */
     int cap_stations; /* Slowest varying dimension. */
     int cap_sources;  /* Fastest varying dimension. */
+    int type;         /* Enumerated (complex) data type of the matrices. */
+    int planar;       /* If set, data are stored as separate components. */
     oskar_Mem* data;  /* Matrix data. */
 };
 
@@ -90,17 +90,16 @@ void oskar_evaluate_jones_K(oskar_Jones* K, int num_sources,
     {
         size_t local_size[] = {JONES_K_SOURCE, JONES_K_STATION, 1};
         size_t global_size[] = {1, 1, 1};
+        static const oskar_DeviceKernel* kernel[2] = {0, 0};
         const int is_dbl = (type == OSKAR_DOUBLE_COMPLEX);
-        const char* k = 0;
-        if (type == OSKAR_SINGLE_COMPLEX)
-            k = "evaluate_jones_K_float";
-        else if (type == OSKAR_DOUBLE_COMPLEX)
-            k = "evaluate_jones_K_double";
-        else
+        if (type != OSKAR_SINGLE_COMPLEX && type != OSKAR_DOUBLE_COMPLEX)
         {
             *status = OSKAR_ERR_BAD_DATA_TYPE;
             return;
         }
+        const oskar_DeviceKernel* handle = oskar_device_kernel_cached(
+                &kernel[is_dbl], is_dbl ?
+                        "evaluate_jones_K_double" : "evaluate_jones_K_float");
         if (oskar_device_is_cpu(location))
             local_size[1] = 1;
         oskar_device_check_local_size(location, 0, local_size);
@@ -131,7 +130,8 @@ void oskar_evaluate_jones_K(oskar_Jones* K, int num_sources,
                 {INT_SZ, &ignore_w_components},
                 {PTR_SZ, oskar_mem_buffer(oskar_jones_mem(K))}
         };
-        oskar_device_launch_kernel(k, location, 2, local_size, global_size,
+        oskar_device_launch_kernel_handle(handle, location, 2,
+                local_size, global_size,
                 sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
     }
 }
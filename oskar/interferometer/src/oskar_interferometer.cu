@@ -2,6 +2,7 @@
 
 #include "math/define_multiply.h"
 #include "interferometer/define_jones_apply_station_gains.h"
+#include "interferometer/define_jones_chain.h"
 #include "interferometer/define_evaluate_jones_K.h"
 #include "interferometer/define_evaluate_jones_R.h"
 #include "utility/oskar_cuda_registrar.h"
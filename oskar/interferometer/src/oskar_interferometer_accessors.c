@@ -72,6 +72,12 @@ void oskar_interferometer_set_correlation_type(oskar_Interferometer* h,
     else *status = OSKAR_ERR_INVALID_ARGUMENT;
 }
 
+void oskar_interferometer_set_compress_vis_file(oskar_Interferometer* h,
+        int value)
+{
+    h->compress_vis_file = value;
+}
+
 void oskar_interferometer_set_force_polarised_ms(oskar_Interferometer* h,
         int value)
 {
@@ -132,18 +138,28 @@ void oskar_interferometer_set_ignore_w_components(oskar_Interferometer* h,
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
         int value)
 {
-    h->max_sources_per_chunk = value;
+    /* Values <= 0 are sized by the memory planner in check_init. */
+    h->auto_sources_per_chunk = (value <= 0);
+    h->max_sources_per_chunk = (value > 0) ? value : 16384;
 }
 
 void oskar_interferometer_set_max_channels_per_block(oskar_Interferometer* h,
         int value)
 {
+    h->auto_channels_per_block = (value <= 0);
+    if (value <= 0)
+        value = (h->num_channels > 0 && h->num_channels < 8) ?
+                h->num_channels : 8;
     h->max_channels_per_block = value;
 }
 
 void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
         int value)
 {
+    h->auto_times_per_block = (value <= 0);
+    if (value <= 0)
+        value = (h->num_time_steps > 0 && h->num_time_steps < 8) ?
+                h->num_time_steps : 8;
     h->max_times_per_block = value;
 }
 
@@ -159,13 +175,40 @@ void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value)
     memset(h->d, 0, h->num_devices * sizeof(DeviceData));
 }
 
+void oskar_interferometer_set_numa_pinning(oskar_Interferometer* h,
+        int value)
+{
+    int status = 0;
+    if (h->numa_pinning == value) return;
+    oskar_interferometer_free_device_data(h, &status);
+    h->numa_pinning = value;
+}
+
+void oskar_interferometer_set_planar_jones(oskar_Interferometer* h,
+        int value)
+{
+    int status = 0;
+    if (h->planar_jones == value) return;
+    oskar_interferometer_free_device_data(h, &status);
+    h->planar_jones = value;
+}
+
+void oskar_interferometer_set_prefetch_sky(oskar_Interferometer* h,
+        int value)
+{
+    int status = 0;
+    if (h->prefetch_sky == value) return;
+    oskar_interferometer_free_device_data(h, &status);
+    h->prefetch_sky = value;
+}
+
 void oskar_interferometer_set_observation_frequency(oskar_Interferometer* h,
         double start_hz, double inc_hz, int num_channels)
 {
     h->freq_start_hz = start_hz;
     h->freq_inc_hz = inc_hz;
     h->num_channels = num_channels;
-    if (h->max_channels_per_block <= 0)
+    if (h->auto_channels_per_block || h->max_channels_per_block <= 0)
         h->max_channels_per_block = (num_channels < 8) ? num_channels : 8;
 }
 
@@ -175,7 +218,7 @@ void oskar_interferometer_set_observation_time(oskar_Interferometer* h,
     h->time_start_mjd_utc = time_start_mjd_utc;
     h->time_inc_sec = inc_sec;
     h->num_time_steps = num_time_steps;
-    if (h->max_times_per_block <= 0)
+    if (h->auto_times_per_block || h->max_times_per_block <= 0)
         h->max_times_per_block = (num_time_steps < 8) ? num_time_steps : 8;
 }
 
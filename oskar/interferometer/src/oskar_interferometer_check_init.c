@@ -3,6 +3,7 @@
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
+#include <limits.h>
 #include <stdlib.h>
 
 #include "interferometer/private_interferometer.h"
@@ -10,11 +11,20 @@
 #include "math/oskar_cmath.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_numa.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Fractions of free host and device memory that the planner may use. */
+#define PLAN_HOST_FRACTION 0.5
+#define PLAN_DEVICE_FRACTION 0.8
+
+/* Number of real-valued columns in a sky model. */
+#define PLAN_SKY_COLUMNS 18
+
+static void plan_memory(oskar_Interferometer* h, int* status);
 static void set_up_device_data(oskar_Interferometer* h, int* status);
 static void set_up_vis_header(oskar_Interferometer* h, int* status);
 
@@ -30,9 +40,13 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
         return;
     }
 
-    /* Create the visibility header if required. */
+    /* Size the blocks and chunks, and create the visibility header,
+     * if required. */
     if (!h->header)
+    {
+        plan_memory(h, status);
         set_up_vis_header(h, status);
+    }
 
     /* Calculate source parameters if required. */
     if (!h->init_sky)
@@ -81,6 +95,213 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
 
 
 
+static double plan_block_bytes(int num_times, int num_channels,
+        size_t bytes_per_sample, size_t bytes_per_time)
+{
+    return (double)num_times *
+            ((double)num_channels * bytes_per_sample + bytes_per_time);
+}
+
+
+/* Chooses the largest block and chunk sizes that fit in memory, for
+ * any of these that were not set explicitly, and reports the plan.
+ * Estimates cover the arrays allocated in init_device(); the telescope
+ * model copies are small by comparison, and are covered by the margin
+ * left by PLAN_HOST_FRACTION and PLAN_DEVICE_FRACTION. */
+static void plan_memory(oskar_Interferometer* h, int* status)
+{
+    int i, num_corr = 0, vis_type;
+    size_t host_free = 0, host_total = 0, host_max = 0;
+    size_t dev_free = 0, dev_max = 0;
+    const double mib = 1024.0 * 1024.0;
+    if (*status) return;
+
+    /* Get dimensions.
+     * Devices are expanded to the number of GPUs in set_up_device_data. */
+    const int num_gpus = h->num_gpus;
+    const int num_devices =
+            (h->num_devices > num_gpus) ? h->num_devices : num_gpus;
+    const int num_cpu = num_devices - num_gpus;
+    const int num_stations = oskar_telescope_num_stations(h->tel);
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    const int num_times = h->num_time_steps > 0 ? h->num_time_steps : 1;
+    const int num_channels = h->num_channels > 0 ? h->num_channels : 1;
+    vis_type = h->prec | OSKAR_COMPLEX;
+    if (oskar_telescope_pol_mode(h->tel) == OSKAR_POL_MODE_FULL)
+        vis_type |= OSKAR_MATRIX;
+    if (h->correlation_type == 'C' || h->correlation_type == 'B')
+        num_corr += num_baselines;
+    if (h->correlation_type == 'A' || h->correlation_type == 'B')
+        num_corr += num_stations;
+
+    /* Bytes in a visibility block, per sample and per time for coordinates.
+     * Each device holds one block, plus two on the host for double
+     * buffering, and the output writer needs up to two more. */
+    const size_t real_size = oskar_mem_element_size(h->prec);
+    const size_t vis_size = oskar_mem_element_size(vis_type);
+    const size_t bytes_per_sample = (size_t)num_corr * vis_size;
+    const size_t bytes_per_time =
+            3 * (size_t)(num_baselines + num_stations) * real_size;
+    const int host_blocks = 2 * num_devices + num_cpu + 2;
+
+    /* Bytes per source in a chunk, on each device:
+     * the J, E, (R) and K Jones matrices, source direction cosines,
+     * the sky model chunk and its clipped copy, and station work buffers.
+     * OpenCL devices may hold an extra chunk for prefetching, and CPU devices
+     * may hold a planar copy of the J Jones matrices. */
+    const size_t per_source_common = (size_t)num_stations *
+            ((oskar_type_is_matrix(vis_type) ? 3 : 2) * vis_size +
+                    2 * real_size) + 3 * real_size +
+            oskar_station_work_bytes_per_point(vis_type,
+                    oskar_telescope_max_station_depth(h->tel));
+    const size_t per_source_cpu =
+            per_source_common + 2 * PLAN_SKY_COLUMNS * real_size +
+            (h->planar_jones ? (size_t)num_stations * vis_size : 0);
+    const size_t per_source_gpu = per_source_common +
+            ((h->dev_loc & OSKAR_CL) && h->prefetch_sky ? 3 : 2) *
+            PLAN_SKY_COLUMNS * real_size;
+
+    /* Get the free memory on the host and on the GPUs. */
+    oskar_device_mem_info(OSKAR_CPU, 0, &host_free, &host_total, &host_max);
+    for (i = 0; i < num_gpus; ++i)
+    {
+        size_t mem_free = 0, mem_total = 0, max_alloc = 0;
+        oskar_device_mem_info(h->dev_loc, h->gpu_ids[i],
+                &mem_free, &mem_total, &max_alloc);
+        if (i == 0 || mem_free < dev_free) dev_free = mem_free;
+        if (i == 0 || max_alloc < dev_max) dev_max = max_alloc;
+    }
+    const double host_budget = PLAN_HOST_FRACTION * host_free;
+    const double dev_budget = PLAN_DEVICE_FRACTION * dev_free;
+    const int use_host = host_free > 0;
+    const int use_dev = num_gpus > 0 && dev_free > 0;
+    if (!use_host)
+        oskar_log_warning(h->log, "Unable to determine free memory: "
+                "using default block and chunk sizes.");
+
+    /* Choose the block size.
+     * Start from the whole observation, and halve the larger dimension
+     * until the blocks fit in half of the budget, leaving the rest for the
+     * sky chunks. At least two blocks are used where possible,
+     * so that file writes overlap with computation. */
+    int max_times = h->max_times_per_block;
+    int max_chans = h->max_channels_per_block;
+    if (use_host && h->auto_times_per_block) max_times = num_times;
+    if (use_host && h->auto_channels_per_block) max_chans = num_channels;
+    while (use_host)
+    {
+        const double block = plan_block_bytes(max_times, max_chans,
+                bytes_per_sample, bytes_per_time);
+        const int num_blocks = ((num_times + max_times - 1) / max_times) *
+                ((num_channels + max_chans - 1) / max_chans);
+        const int fits = (host_blocks * block <= 0.5 * host_budget) &&
+                (!use_dev || block <= 0.5 * dev_budget);
+        const int can_halve_t = h->auto_times_per_block && max_times > 1;
+        const int can_halve_c = h->auto_channels_per_block && max_chans > 1;
+        if (fits && num_blocks >= 2) break;
+        if (can_halve_t && (max_times >= max_chans || !can_halve_c))
+            max_times = (max_times + 1) / 2;
+        else if (can_halve_c)
+            max_chans = (max_chans + 1) / 2;
+        else break;
+    }
+    const double block = plan_block_bytes(max_times, max_chans,
+            bytes_per_sample, bytes_per_time);
+
+    /* Choose the chunk size from the memory left on each device. */
+    int max_sources = h->max_sources_per_chunk;
+    if (use_host && h->auto_sources_per_chunk)
+    {
+        double limit = (double) INT_MAX;
+        if (num_cpu > 0)
+        {
+            const double n = (host_budget - host_blocks * block) /
+                    ((double)num_cpu * per_source_cpu);
+            if (n < limit) limit = n;
+        }
+        if (use_dev)
+        {
+            const double n = (dev_budget - block) / per_source_gpu;
+            const double n_alloc = (double)dev_max /
+                    ((double)num_stations * vis_size);
+            if (n < limit) limit = n;
+            if (n_alloc < limit) limit = n_alloc;
+        }
+        if (h->num_sources_total > 0 && h->num_sources_total < limit)
+            limit = h->num_sources_total;
+        else if (h->num_sources_total <= 0 &&
+                h->max_sources_per_chunk < limit)
+            limit = h->max_sources_per_chunk;
+
+        /* Make enough work units (times x chunks) to keep all devices
+         * busy, and even up the chunk sizes. */
+        max_sources = (limit < 1.0) ? 1 : (int) limit;
+        if (h->num_sources_total > 0)
+        {
+            const int times_per_block =
+                    (max_times < num_times) ? max_times : num_times;
+            const int min_chunks = (2 * num_devices + times_per_block - 1) /
+                    times_per_block;
+            int num_chunks = (h->num_sources_total + max_sources - 1) /
+                    max_sources;
+            if (num_chunks < min_chunks) num_chunks = min_chunks;
+            if (num_chunks > h->num_sources_total)
+                num_chunks = h->num_sources_total;
+            max_sources = (h->num_sources_total + num_chunks - 1) /
+                    num_chunks;
+        }
+        if (limit < 1.0)
+            oskar_log_warning(h->log, "There may not be enough memory "
+                    "to hold one source per chunk.");
+    }
+
+    /* Split the sky model again if the chunk size has changed. */
+    if (max_sources != h->max_sources_per_chunk && h->num_sky_chunks > 0)
+    {
+        int num_chunks = 0;
+        oskar_Sky** chunks = 0;
+        for (i = 0; i < h->num_sky_chunks; ++i)
+            oskar_sky_append_to_set(&num_chunks, &chunks, max_sources,
+                    h->sky_chunks[i], status);
+        for (i = 0; i < h->num_sky_chunks; ++i)
+            oskar_sky_free(h->sky_chunks[i], status);
+        free(h->sky_chunks);
+        h->sky_chunks = chunks;
+        h->num_sky_chunks = num_chunks;
+    }
+    h->max_sources_per_chunk = max_sources;
+    h->max_times_per_block = max_times;
+    h->max_channels_per_block = max_chans;
+
+    /* Report the plan. */
+    const double dev_bytes = block + (double)max_sources * per_source_gpu;
+    const double host_bytes = host_blocks * block +
+            (double)num_cpu * max_sources * per_source_cpu;
+    oskar_log_section(h->log, 'M', "Memory plan");
+    oskar_log_value(h->log, 'M', 0, "Sources per chunk", "%d%s",
+            max_sources, h->auto_sources_per_chunk ? " (auto)" : "");
+    oskar_log_value(h->log, 'M', 0, "Num. sky chunks", "%d",
+            h->num_sky_chunks);
+    oskar_log_value(h->log, 'M', 0, "Time samples per block", "%d%s",
+            max_times, h->auto_times_per_block ? " (auto)" : "");
+    oskar_log_value(h->log, 'M', 0, "Channels per block", "%d%s",
+            max_chans, h->auto_channels_per_block ? " (auto)" : "");
+    oskar_log_value(h->log, 'M', 0, "Num. visibility blocks", "%d",
+            ((num_times + max_times - 1) / max_times) *
+            ((num_channels + max_chans - 1) / max_chans));
+    if (num_gpus > 0)
+        oskar_log_value(h->log, 'M', 0, "Est. memory per GPU",
+                "%.1f MiB (%.1f MiB free)", dev_bytes / mib, dev_free / mib);
+    oskar_log_value(h->log, 'M', 0, "Est. host memory",
+            "%.1f MiB (%.1f MiB free)", host_bytes / mib, host_free / mib);
+    if ((use_host && host_bytes > host_budget) ||
+            (use_dev && dev_bytes > dev_budget))
+        oskar_log_warning(h->log, "Estimated memory use exceeds the "
+                "planning budget. Reduce the chunk or block sizes "
+                "if the simulation runs out of memory.");
+}
+
+
 static void set_up_vis_header(oskar_Interferometer* h, int* status)
 {
     int i, j, vis_type;
@@ -181,6 +402,7 @@ static void* init_device(void* arg)
         vistype |= OSKAR_MATRIX;
 
     d->previous_chunk_index = -1;
+    d->next_chunk_index = -1;
 
     /* Select the device. */
     if (i < h->num_gpus)
@@ -230,6 +452,9 @@ static void* init_device(void* arg)
         d->lmn[2] = oskar_mem_create(h->prec, dev_loc, 1 + num_src, status);
         d->chunk = oskar_sky_create(h->prec, dev_loc, num_src, status);
         d->chunk_clip = oskar_sky_create(h->prec, dev_loc, num_src, status);
+        if ((dev_loc & OSKAR_CL) && h->prefetch_sky)
+            d->chunk_next = oskar_sky_create(h->prec, dev_loc, num_src,
+                    status);
         d->tel = oskar_telescope_create_copy(h->tel, dev_loc, status);
         d->J = oskar_jones_create(vistype, dev_loc, num_stations, num_src,
                 status);
@@ -239,6 +464,9 @@ static void* init_device(void* arg)
                 status);
         d->K = oskar_jones_create(complx, dev_loc, num_stations, num_src,
                 status);
+        if (h->planar_jones && dev_loc == OSKAR_CPU)
+            d->J_planar = oskar_jones_create_planar(vistype, dev_loc,
+                    num_stations, num_src, status);
         d->gains = oskar_mem_create(vistype, dev_loc, num_stations, status);
         d->station_work = oskar_station_work_create(h->prec, dev_loc, status);
         oskar_station_work_set_tec_screen_common_params(d->station_work,
@@ -266,19 +494,26 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
     if (h->num_devices < h->num_gpus)
         oskar_interferometer_set_num_devices(h, h->num_gpus);
 
-    /* Set up devices in parallel. */
+    /* Set up devices in parallel.
+     * If pinned, CPU device buffers are first touched on their NUMA node. */
     const int num_devices = h->num_devices;
+    const int num_cpu = num_devices - h->num_gpus;
+    if (h->numa_pinning && !h->d[0].tmr_compute)
+        oskar_device_log_numa(h->num_gpus, num_cpu, h->log);
     threads = (oskar_Thread**) calloc(num_devices, sizeof(oskar_Thread*));
     args = (ThreadArgs*) calloc(num_devices, sizeof(ThreadArgs));
     for (i = 0; i < num_devices; ++i)
     {
+        const int node = (h->numa_pinning && i >= h->num_gpus) ?
+                oskar_numa_node_for_device(i - h->num_gpus, num_cpu) : -1;
         if (h->d[i].tmr_compute) init = 0;
         args[i].h = h;
         args[i].d = &h->d[i];
         args[i].num_threads = num_devices;
         args[i].thread_id = i;
         args[i].status = status;
-        threads[i] = oskar_thread_create(init_device, (void*)&args[i], 0);
+        threads[i] = oskar_thread_create_on_node(init_device,
+                (void*)&args[i], 0, node);
     }
     for (i = 0; i < num_devices; ++i)
     {
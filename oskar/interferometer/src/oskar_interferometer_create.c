@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2020, The OSKAR Developers.
+ * Copyright (c) 2011-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -22,6 +22,11 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     h->tmr_sim   = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_write = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->temp      = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+    h->ms_vis    = oskar_mem_create(precision | OSKAR_COMPLEX, OSKAR_CPU, 0,
+            status);
+    h->ms_uvw[0] = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+    h->ms_uvw[1] = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+    h->ms_uvw[2] = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->mutex     = oskar_mutex_create();
     h->barrier   = oskar_barrier_create(0);
     h->log       = oskar_log_create(OSKAR_LOG_MESSAGE, OSKAR_LOG_WARNING);
@@ -31,13 +36,14 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     h->num_gpus_avail = oskar_device_count(0, &h->dev_loc);
 
     /* Set sensible defaults. */
-    h->max_sources_per_chunk = 16384;
+    oskar_interferometer_set_max_sources_per_chunk(h, 0);
     oskar_interferometer_set_gpus(h, -1, 0, status);
     oskar_interferometer_set_num_devices(h, -1);
     oskar_interferometer_set_correlation_type(h, "Cross-correlations", status);
     oskar_interferometer_set_horizon_clip(h, 1);
     oskar_interferometer_set_source_flux_range(h, -DBL_MAX, DBL_MAX);
-    oskar_interferometer_set_max_times_per_block(h, 8);
+    oskar_interferometer_set_max_times_per_block(h, 0);
+    oskar_interferometer_set_max_channels_per_block(h, 0);
     return h;
 }
 
@@ -28,6 +28,7 @@
 
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
+#include "utility/oskar_trace.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_get_memory_usage.h"
@@ -114,6 +115,15 @@ void oskar_interferometer_finalise(oskar_Interferometer* h, int* status)
                 oskar_get_error_string(*status));
     }
 
+    /* Write the trace file, if enabled. */
+    if (oskar_trace_enabled())
+    {
+        int trace_status = 0;
+        oskar_trace_write(&trace_status);
+        if (trace_status)
+            oskar_log_warning(h->log, "Unable to write trace file.");
+    }
+
     /* Reset cache. */
     oskar_interferometer_reset_cache(h, status);
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2020, The OSKAR Developers.
+ * Copyright (c) 2011-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -23,6 +23,9 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
         oskar_sky_free(h->sky_chunks[i], status);
     oskar_telescope_free(h->tel, status);
     oskar_mem_free(h->temp, status);
+    oskar_mem_free(h->ms_vis, status);
+    for (i = 0; i < 3; ++i)
+        oskar_mem_free(h->ms_uvw[i], status);
     oskar_timer_free(h->tmr_sim);
     oskar_timer_free(h->tmr_write);
     oskar_mutex_free(h->mutex);
@@ -65,12 +68,15 @@ void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
         oskar_mem_free(d->uvw[2], status);
         oskar_sky_free(d->chunk, status);
         oskar_sky_free(d->chunk_clip, status);
+        oskar_device_events_release(1, &d->chunk_event);
+        oskar_sky_free(d->chunk_next, status);
         oskar_telescope_free(d->tel, status);
         oskar_station_work_free(d->station_work, status);
         oskar_jones_free(d->J, status);
         oskar_jones_free(d->E, status);
         oskar_jones_free(d->K, status);
         oskar_jones_free(d->R, status);
+        oskar_jones_free(d->J_planar, status);
         oskar_mem_free(d->gains, status);
         memset(d, 0, sizeof(DeviceData));
     }
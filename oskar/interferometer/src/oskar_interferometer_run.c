@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2020, The OSKAR Developers.
+ * Copyright (c) 2011-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -7,6 +7,7 @@
 
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
+#include "utility/oskar_numa.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -119,10 +120,25 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         args[i].status = status;
     }
 
+    /* Buffer log entries from the worker threads, so they do not
+     * serialise on terminal and file output. */
+    const int log_was_async = oskar_log_async(h->log);
+    oskar_log_set_async(h->log, 1);
+
     /* Start the worker threads. */
     oskar_interferometer_reset_work_unit_index(h);
+    /* If required, pin CPU devices to the same NUMA nodes used in
+     * oskar_interferometer_check_init(). Thread 0 is not pinned. */
     for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+    {
+        int node = -1;
+        const int i_cpu = i - 1 - h->num_gpus;
+        if (h->numa_pinning && i_cpu >= 0)
+            node = oskar_numa_node_for_device(i_cpu,
+                    h->num_devices - h->num_gpus);
+        threads[i] = oskar_thread_create_on_node(run_blocks,
+                (void*)&args[i], 0, node);
+    }
 
     /* Wait for worker threads to finish. */
     for (i = 0; i < num_threads; ++i)
@@ -132,6 +148,7 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
     }
     free(threads);
     free(args);
+    oskar_log_set_async(h->log, log_was_async);
 
     /* Finalise. */
     oskar_interferometer_finalise(h, status);
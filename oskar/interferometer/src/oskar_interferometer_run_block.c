@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2020, The OSKAR Developers.
+ * Copyright (c) 2011-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -100,7 +100,33 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         if (i_chunk != d->previous_chunk_index)
         {
             oskar_timer_resume(d->tmr_copy);
-            oskar_sky_copy(d->chunk, h->sky_chunks[i_chunk], status);
+            if (d->chunk_next && i_chunk == d->next_chunk_index)
+            {
+                /* Use the prefetched chunk. */
+                oskar_Sky* t = d->chunk;
+                oskar_device_events_enqueue_wait(1, &d->chunk_event, status);
+                d->chunk = d->chunk_next;
+                d->chunk_next = t;
+            }
+            else
+            {
+                oskar_sky_copy(d->chunk, h->sky_chunks[i_chunk], status);
+            }
+
+            /* Start copying the following chunk while this one is used.
+             * Wait until kernels have finished with the old chunk first. */
+            d->next_chunk_index = -1;
+            if (d->chunk_next && i_chunk + 1 < total_chunks)
+            {
+                struct _cl_event* done = 0;
+                oskar_device_event_record(h->dev_loc, &done, status);
+                oskar_device_events_release(1, &d->chunk_event);
+                oskar_sky_copy_async(d->chunk_next,
+                        h->sky_chunks[i_chunk + 1], 1, &done,
+                        &d->chunk_event, status);
+                oskar_device_events_release(1, &done);
+                d->next_chunk_index = i_chunk + 1;
+            }
             oskar_timer_pause(d->tmr_copy);
         }
         sky = h->apply_horizon_clip ? d->chunk_clip : d->chunk;
@@ -122,14 +148,13 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         {
             if (*status) break;
             const int sim_chan_idx = chan_index_start + i_channel;
-            oskar_mutex_lock(h->mutex);
-            oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
-                    "Chunk %*i/%i, Channel %*i/%i [Device %i, %i sources]",
+            oskar_log_progress(h->log, 'S', 1, &d->last_progress,
+                    "Time %*i/%i, Chunk %*i/%i, Channel %*i/%i "
+                    "[Device %i, %i sources]",
                     disp_width(total_times), sim_time_idx + 1, total_times,
                     disp_width(total_chunks), i_chunk + 1, total_chunks,
                     disp_width(total_chans), sim_chan_idx + 1, total_chans,
                     device_id, oskar_sky_num_sources(sky));
-            oskar_mutex_unlock(h->mutex);
             sim_baselines(h, d, sky, i_channel, i_time,
                     sim_chan_idx, sim_time_idx, status);
         }
@@ -216,6 +241,8 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     if (d->R)
         oskar_jones_set_size(d->R, num_stations, num_src, status);
     oskar_jones_set_size(d->J, num_stations, num_src, status);
+    if (d->J_planar)
+        oskar_jones_set_size(d->J_planar, num_stations, num_src, status);
     oskar_jones_set_size(d->E, num_stations, num_src, status);
     oskar_jones_set_size(d->K, num_stations, num_src, status);
 
@@ -231,7 +258,7 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
             d->tel, time_index_sim, gast_rad, freq, d->station_work, status);
     oskar_timer_pause(d->tmr_E);
 
-    /* Evaluate parallactic angle (Jones R: matrix), and join with Jones E.
+    /* Evaluate parallactic angle (Jones R: matrix).
      * TODO Move this into station beam evaluation instead. */
     if (d->R)
     {
@@ -241,9 +268,6 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
                 oskar_sky_dec_rad_const(sky),
                 d->tel, gast_rad, status);
         oskar_timer_pause(d->tmr_E);
-        oskar_timer_resume(d->tmr_join);
-        oskar_jones_join(d->R, d->E, d->R, status);
-        oskar_timer_pause(d->tmr_join);
     }
 
     /* Evaluate interferometer phase (Jones K: scalar). */
@@ -254,27 +278,41 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
             h->ignore_w_components, status);
     oskar_timer_pause(d->tmr_K);
 
-    /* Multiply Jones matrix chain to get a single block. */
-    oskar_timer_resume(d->tmr_join);
-    oskar_jones_join(d->J, d->K, d->R ? d->R : d->E, status);
-    oskar_timer_pause(d->tmr_join);
-
-    /* Check whether gain model exists.
-     * If so, evaluate gains and apply them. */
+    /* Evaluate station gains (Jones G), if a gain model exists. */
+    const oskar_Mem* gains = 0;
     if (oskar_gains_defined(oskar_telescope_gains(d->tel)))
     {
         oskar_gains_evaluate(oskar_telescope_gains(d->tel),
                 time_index_sim, freq, d->gains, status);
-        oskar_jones_apply_station_gains(d->J, d->gains, status);
+        gains = d->gains;
     }
 
+    /* Multiply the Jones chain G * K * E * R in a single pass. */
+    int num_terms = 0;
+    const oskar_Jones* terms[OSKAR_JONES_CHAIN_MAX_TERMS];
+    terms[num_terms++] = d->K;
+    terms[num_terms++] = d->E;
+    if (d->R) terms[num_terms++] = d->R;
+    oskar_timer_resume(d->tmr_join);
+    oskar_jones_chain(d->J, num_terms, terms, gains, status);
+
+    /* The Jones terms are evaluated in the interleaved layout,
+     * so copy the result if the planar layout is used for correlation. */
+    oskar_Jones* J = d->J;
+    if (d->J_planar)
+    {
+        oskar_jones_convert(d->J_planar, d->J, status);
+        J = d->J_planar;
+    }
+    oskar_timer_pause(d->tmr_join);
+
     /* Calculate output offset. */
     const int offset = num_chans_block * time_index_block + channel_index_block;
     oskar_timer_resume(d->tmr_correlate);
 
     /* Auto-correlate for this time and channel. */
     if (oskar_vis_block_has_auto_correlations(d->vis_block))
-        oskar_auto_correlate(num_src, d->J, src_flux, num_stations * offset,
+        oskar_auto_correlate(num_src, J, src_flux, num_stations * offset,
                 oskar_vis_block_auto_correlations(d->vis_block), status);
 
     /* Cross-correlate for this time and channel. */
@@ -287,7 +325,7 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
             oskar_sky_gaussian_c_const(sky)
         };
         oskar_cross_correlate(
-                source_type, num_src, d->J,
+                source_type, num_src, J,
                 src_flux, lmn, src_extended,
                 d->tel, uvw,
                 gast_rad, freq, num_baselines * offset,
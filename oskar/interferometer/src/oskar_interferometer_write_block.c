@@ -7,6 +7,7 @@
 #include "interferometer/oskar_interferometer.h"
 #include "vis/oskar_vis_block_write_ms.h"
 #include "vis/oskar_vis_header_write_ms.h"
+#include "utility/oskar_trace.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,11 +22,32 @@ void oskar_interferometer_write_block(oskar_Interferometer* h,
     if (h->ms_name && !h->ms)
         h->ms = oskar_vis_header_write_ms(h->header, h->ms_name,
                 h->force_polarised_ms, status);
-    if (h->ms) oskar_vis_block_write_ms(block, h->header, h->ms, status);
+    if (h->ms)
+    {
+        /* Reorder the block using all available cores, then write it. */
+        oskar_vis_block_reorder_ms(block, (int) oskar_ms_num_pols(h->ms), 0,
+                h->ms_vis, h->ms_uvw[0], h->ms_uvw[1], h->ms_uvw[2], status);
+        const double t0 = oskar_trace_time();
+        oskar_vis_block_write_ms_reordered(block, h->header, h->ms,
+                h->ms_vis, h->ms_uvw[0], h->ms_uvw[1], h->ms_uvw[2], status);
+        oskar_trace_add("io", "write_ms", t0, -1, "bytes",
+                oskar_mem_length(h->ms_vis) *
+                oskar_mem_element_size(oskar_mem_type(h->ms_vis)));
+    }
 #endif
     if (h->vis_name && !h->vis)
+    {
         h->vis = oskar_vis_header_write(h->header, h->vis_name, status);
-    if (h->vis) oskar_vis_block_write(block, h->vis, block_index, status);
+        if (h->vis && h->compress_vis_file)
+            oskar_binary_set_compression(h->vis,
+                    OSKAR_BINARY_COMPRESSION_SHUFFLE_LZ, 0, status);
+    }
+    if (h->vis)
+    {
+        const double t0 = oskar_trace_time();
+        oskar_vis_block_write(block, h->vis, block_index, status);
+        oskar_trace_add("io", "write_vis", t0, -1, 0, 0);
+    }
     oskar_timer_pause(h->tmr_write);
 }
 
@@ -24,7 +24,17 @@ int oskar_jones_num_stations(const oskar_Jones* jones)
 
 int oskar_jones_type(const oskar_Jones* jones)
 {
-    return oskar_mem_type(jones->data);
+    return jones->type;
+}
+
+int oskar_jones_is_planar(const oskar_Jones* jones)
+{
+    return jones->planar;
+}
+
+size_t oskar_jones_component_stride(const oskar_Jones* jones)
+{
+    return (size_t) jones->cap_stations * (size_t) jones->cap_sources;
 }
 
 int oskar_jones_mem_location(const oskar_Jones* jones)
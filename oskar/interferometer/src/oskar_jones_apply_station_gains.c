@@ -7,6 +7,7 @@
 #include "interferometer/define_jones_apply_station_gains.h"
 #include "interferometer/private_jones.h"
 #include "interferometer/oskar_jones.h"
+#include "interferometer/oskar_jones_planar_omp.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_kernel_macros.h"
 #include "utility/oskar_vector_types.h"
@@ -35,7 +36,36 @@ void oskar_jones_apply_station_gains(oskar_Jones* jones,
         return;
     }
     mem = oskar_jones_mem(jones);
-    if (location == OSKAR_CPU)
+    if (oskar_jones_is_planar(jones))
+    {
+        const size_t stride = oskar_jones_component_stride(jones);
+        const int num_components = oskar_type_is_matrix(type) ? 8 : 2;
+        if (location != OSKAR_CPU)
+        {
+            *status = OSKAR_ERR_LOCATION_MISMATCH;
+            return;
+        }
+        if (type != oskar_jones_type(jones))
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        if (oskar_type_precision(type) == OSKAR_DOUBLE)
+        {
+            oskar_jones_apply_station_gains_planar_omp_d(
+                    num_sources, num_stations, num_components,
+                    oskar_mem_double_const(gains, status), stride,
+                    oskar_mem_double(mem, status));
+        }
+        else
+        {
+            oskar_jones_apply_station_gains_planar_omp_f(
+                    num_sources, num_stations, num_components,
+                    oskar_mem_float_const(gains, status), stride,
+                    oskar_mem_float(mem, status));
+        }
+    }
+    else if (location == OSKAR_CPU)
     {
         switch (type)
         {
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "math/define_multiply.h"
+#include "interferometer/define_jones_chain.h"
+#include "interferometer/private_jones.h"
+#include "interferometer/oskar_jones.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OSKAR_JONES_CHAIN(jones_chain_float, float, float2, float4c)
+OSKAR_JONES_CHAIN(jones_chain_double, double, double2, double4c)
+
+void oskar_jones_chain(oskar_Jones* out, int num_terms,
+        const oskar_Jones* const* terms, const oskar_Mem* gains,
+        int* status)
+{
+    int i, c[OSKAR_JONES_CHAIN_MAX_TERMS], c_gains = 0;
+    const oskar_Mem* t[OSKAR_JONES_CHAIN_MAX_TERMS];
+    if (*status) return;
+    if (num_terms < 1 || num_terms > OSKAR_JONES_CHAIN_MAX_TERMS)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    const int num_sources = out->num_sources;
+    const int num_stations = out->num_stations;
+    const int location = oskar_mem_location(out->data);
+    const int prec = oskar_type_precision(out->type);
+    const int c_out = oskar_type_is_matrix(out->type) ? 8 : 2;
+    int is_matrix = 0;
+
+    /* Check the terms. These are packed into the last slots, as the
+     * kernel accumulates the product from the right. Unused slots are
+     * given the last term's data, which is never read. */
+    const int first = OSKAR_JONES_CHAIN_MAX_TERMS - num_terms;
+    for (i = 0; i < OSKAR_JONES_CHAIN_MAX_TERMS; ++i)
+    {
+        const oskar_Jones* term = terms[i < first ? num_terms - 1 : i - first];
+        if (term == out)
+        {
+            *status = OSKAR_ERR_INVALID_ARGUMENT;
+            return;
+        }
+        if (term->num_sources != num_sources ||
+                term->num_stations != num_stations)
+        {
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            return;
+        }
+        if (oskar_mem_location(term->data) != location)
+        {
+            *status = OSKAR_ERR_LOCATION_MISMATCH;
+            return;
+        }
+        if (oskar_type_precision(term->type) != prec || term->planar)
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        c[i] = (i < first) ? 0 : (oskar_type_is_matrix(term->type) ? 8 : 2);
+        if (c[i] == 8) is_matrix = 1;
+        t[i] = term->data;
+    }
+
+    /* Check the gains. */
+    if (gains)
+    {
+        if ((int) oskar_mem_length(gains) < num_stations)
+        {
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            return;
+        }
+        if (oskar_mem_location(gains) != location)
+        {
+            *status = OSKAR_ERR_LOCATION_MISMATCH;
+            return;
+        }
+        if (oskar_mem_precision(gains) != prec ||
+                !oskar_mem_is_complex(gains))
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        c_gains = oskar_mem_is_matrix(gains) ? 8 : 2;
+        if (c_gains == 8) is_matrix = 1;
+    }
+    if (out->planar || (is_matrix && c_out != 8))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Evaluate the chain. */
+    if (location == OSKAR_CPU)
+    {
+        if (prec == OSKAR_DOUBLE)
+            jones_chain_double(num_sources, num_stations,
+                    c[0], oskar_mem_double_const(t[0], status),
+                    c[1], oskar_mem_double_const(t[1], status),
+                    c[2], oskar_mem_double_const(t[2], status),
+                    c[3], oskar_mem_double_const(t[3], status),
+                    c_gains, gains ? oskar_mem_double_const(gains, status) : 0,
+                    c_out, oskar_mem_double(out->data, status));
+        else
+            jones_chain_float(num_sources, num_stations,
+                    c[0], oskar_mem_float_const(t[0], status),
+                    c[1], oskar_mem_float_const(t[1], status),
+                    c[2], oskar_mem_float_const(t[2], status),
+                    c[3], oskar_mem_float_const(t[3], status),
+                    c_gains, gains ? oskar_mem_float_const(gains, status) : 0,
+                    c_out, oskar_mem_float(out->data, status));
+    }
+    else
+    {
+        size_t local_size[] = {64, 4, 1}, global_size[] = {1, 1, 1};
+        const char* k = (prec == OSKAR_DOUBLE) ?
+                "jones_chain_double" : "jones_chain_float";
+        if (!gains) gains = t[OSKAR_JONES_CHAIN_MAX_TERMS - 1];
+        oskar_device_check_local_size(location, 0, local_size);
+        oskar_device_check_local_size(location, 1, local_size);
+        global_size[0] = oskar_device_global_size(
+                (size_t) num_sources, local_size[0]);
+        global_size[1] = oskar_device_global_size(
+                (size_t) num_stations, local_size[1]);
+        const oskar_Arg args[] = {
+                {INT_SZ, &num_sources},
+                {INT_SZ, &num_stations},
+                {INT_SZ, &c[0]},
+                {PTR_SZ, oskar_mem_buffer_const(t[0])},
+                {INT_SZ, &c[1]},
+                {PTR_SZ, oskar_mem_buffer_const(t[1])},
+                {INT_SZ, &c[2]},
+                {PTR_SZ, oskar_mem_buffer_const(t[2])},
+                {INT_SZ, &c[3]},
+                {PTR_SZ, oskar_mem_buffer_const(t[3])},
+                {INT_SZ, &c_gains},
+                {PTR_SZ, oskar_mem_buffer_const(gains)},
+                {INT_SZ, &c_out},
+                {PTR_SZ, oskar_mem_buffer(out->data)}
+        };
+        oskar_device_launch_kernel(k, location, 2, local_size, global_size,
+                sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "interferometer/private_jones.h"
+#include "interferometer/oskar_jones.h"
+#include "interferometer/oskar_jones_planar_omp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_jones_convert(oskar_Jones* dst, const oskar_Jones* src,
+        int* status)
+{
+    int k;
+    oskar_Mem* temp = 0;
+    if (*status) return;
+    if (dst->type != src->type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    oskar_jones_set_size(dst, src->num_stations, src->num_sources, status);
+    if (*status) return;
+    const int num_elements = src->num_stations * src->num_sources;
+    const int num_components = oskar_type_is_matrix(src->type) ? 8 : 2;
+    const int prec = oskar_type_precision(src->type);
+    const size_t src_stride = oskar_jones_component_stride(src);
+    const size_t dst_stride = oskar_jones_component_stride(dst);
+    if (!src->planar && !dst->planar)
+    {
+        oskar_mem_copy_contents(dst->data, src->data,
+                0, 0, num_elements, status);
+    }
+    else if (src->planar && dst->planar)
+    {
+        for (k = 0; k < num_components; ++k)
+        {
+            oskar_mem_copy_contents(dst->data, src->data,
+                    k * dst_stride, k * src_stride, num_elements, status);
+        }
+    }
+    else if (dst->planar)
+    {
+        /* Interleaved to planar: the source may need copying to the host. */
+        const oskar_Mem* in = src->data;
+        if (oskar_mem_location(src->data) != OSKAR_CPU)
+        {
+            temp = oskar_mem_create_copy(src->data, OSKAR_CPU, status);
+            in = temp;
+        }
+        if (*status)
+        {
+            oskar_mem_free(temp, status);
+            return;
+        }
+        if (prec == OSKAR_DOUBLE)
+        {
+            oskar_jones_to_planar_omp_d(num_elements, num_components,
+                    (const double*) oskar_mem_void_const(in), dst_stride,
+                    oskar_mem_double(dst->data, status));
+        }
+        else
+        {
+            oskar_jones_to_planar_omp_f(num_elements, num_components,
+                    (const float*) oskar_mem_void_const(in), dst_stride,
+                    oskar_mem_float(dst->data, status));
+        }
+    }
+    else
+    {
+        /* Planar to interleaved: the destination may not be on the host. */
+        oskar_Mem* out = dst->data;
+        if (oskar_mem_location(dst->data) != OSKAR_CPU)
+        {
+            temp = oskar_mem_create(dst->type, OSKAR_CPU,
+                    num_elements, status);
+            out = temp;
+        }
+        if (*status)
+        {
+            oskar_mem_free(temp, status);
+            return;
+        }
+        if (prec == OSKAR_DOUBLE)
+        {
+            oskar_jones_from_planar_omp_d(num_elements, num_components,
+                    src_stride, oskar_mem_double_const(src->data, status),
+                    (double*) oskar_mem_void(out));
+        }
+        else
+        {
+            oskar_jones_from_planar_omp_f(num_elements, num_components,
+                    src_stride, oskar_mem_float_const(src->data, status),
+                    (float*) oskar_mem_void(out));
+        }
+        if (temp)
+        {
+            oskar_mem_copy_contents(dst->data, temp,
+                    0, 0, num_elements, status);
+        }
+    }
+    oskar_mem_free(temp, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
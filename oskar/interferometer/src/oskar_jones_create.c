@@ -13,8 +13,8 @@
 extern "C" {
 #endif
 
-oskar_Jones* oskar_jones_create(int type, int location, int num_stations,
-        int num_sources, int* status)
+static oskar_Jones* jones_create(int type, int location, int num_stations,
+        int num_sources, int planar, int* status)
 {
     oskar_Jones* jones;
     const int base_type = oskar_type_precision(type);
@@ -29,11 +29,40 @@ oskar_Jones* oskar_jones_create(int type, int location, int num_stations,
     jones->num_sources = num_sources;
     jones->cap_stations = num_stations;
     jones->cap_sources = num_sources;
-    jones->data = oskar_mem_create(type, location,
-            num_stations * num_sources, status);
+    jones->type = type;
+    jones->planar = planar;
+    if (planar)
+    {
+        /* Each real-valued component is stored as a separate array. */
+        const size_t num_components = oskar_type_is_matrix(type) ? 8 : 2;
+        jones->data = oskar_mem_create(base_type, location,
+                num_components * num_stations * num_sources, status);
+    }
+    else
+    {
+        jones->data = oskar_mem_create(type, location,
+                num_stations * num_sources, status);
+    }
     return jones;
 }
 
+oskar_Jones* oskar_jones_create(int type, int location, int num_stations,
+        int num_sources, int* status)
+{
+    return jones_create(type, location, num_stations, num_sources, 0, status);
+}
+
+oskar_Jones* oskar_jones_create_planar(int type, int location,
+        int num_stations, int num_sources, int* status)
+{
+    if (location != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return 0;
+    }
+    return jones_create(type, location, num_stations, num_sources, 1, status);
+}
+
 #ifdef __cplusplus
 }
 #endif
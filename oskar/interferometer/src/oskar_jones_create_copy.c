@@ -42,9 +42,17 @@ oskar_Jones* oskar_jones_create_copy(const oskar_Jones* src, int location,
     if (*status) return 0;
 
     /* Create the new structure. */
-    jones = oskar_jones_create(oskar_jones_type(src), location,
-            oskar_jones_num_stations(src), oskar_jones_num_sources(src),
-            status);
+    if (src->planar)
+    {
+        jones = oskar_jones_create_planar(src->type, location,
+                src->num_stations, src->num_sources, status);
+    }
+    else
+    {
+        jones = oskar_jones_create(src->type, location,
+                src->num_stations, src->num_sources, status);
+    }
+    if (!jones) return 0;
 
     /* Copy the existing data to the new structure. */
     jones->num_stations = src->num_stations;
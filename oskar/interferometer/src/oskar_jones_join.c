@@ -28,6 +28,7 @@
 
 #include "interferometer/private_jones.h"
 #include "interferometer/oskar_jones.h"
+#include "interferometer/oskar_jones_planar_omp.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -53,8 +54,43 @@ void oskar_jones_join(oskar_Jones* j3, oskar_Jones* j1, const oskar_Jones* j2,
     if (n_stations1 != n_stations2 || n_stations1 != n_stations3)
         *status = OSKAR_ERR_DIMENSION_MISMATCH;
 
+    if (*status) return;
+
     /* Multiply the array elements. */
     const size_t num_elements = n_sources1 * n_stations1;
+    if (j1->planar || j2->planar || j3->planar)
+    {
+        const int prec = oskar_type_precision(j1->type);
+        const int comp1 = oskar_type_is_matrix(j1->type) ? 8 : 2;
+        const int comp2 = oskar_type_is_matrix(j2->type) ? 8 : 2;
+        const int comp3 = oskar_type_is_matrix(j3->type) ? 8 : 2;
+        if (!j1->planar || !j2->planar || !j3->planar ||
+                oskar_type_precision(j2->type) != prec ||
+                oskar_type_precision(j3->type) != prec ||
+                comp3 != (comp1 > comp2 ? comp1 : comp2))
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        const size_t s1 = oskar_jones_component_stride(j1);
+        const size_t s2 = oskar_jones_component_stride(j2);
+        const size_t s3 = oskar_jones_component_stride(j3);
+        if (prec == OSKAR_DOUBLE)
+        {
+            oskar_jones_join_planar_omp_d((int) num_elements,
+                    comp1, s1, oskar_mem_double_const(j1->data, status),
+                    comp2, s2, oskar_mem_double_const(j2->data, status),
+                    s3, oskar_mem_double(j3->data, status));
+        }
+        else
+        {
+            oskar_jones_join_planar_omp_f((int) num_elements,
+                    comp1, s1, oskar_mem_float_const(j1->data, status),
+                    comp2, s2, oskar_mem_float_const(j2->data, status),
+                    s3, oskar_mem_float(j3->data, status));
+        }
+        return;
+    }
     oskar_mem_multiply(j3->data, j1->data, j2->data,
             0, 0, 0, num_elements, status);
 }
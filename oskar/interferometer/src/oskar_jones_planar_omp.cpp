@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "interferometer/oskar_jones_planar_omp.h"
+#include "utility/oskar_kernel_macros.h"
+
+// In the planar layout, component k of element i is at (k * stride + i).
+// The loops below all run over the element index, with each component
+// accessed through its own pointer, so the compiler can vectorise them.
+
+template<typename REAL>
+static void to_planar(int num_elements, int num_components,
+        const REAL* RESTRICT in, size_t stride, REAL* RESTRICT out)
+{
+    for (int k = 0; k < num_components; ++k)
+    {
+        REAL* RESTRICT o = out + k * stride;
+        const REAL* RESTRICT p = in + k;
+        OMP_SIMD
+        for (int i = 0; i < num_elements; ++i)
+            o[i] = p[(size_t) i * num_components];
+    }
+}
+
+template<typename REAL>
+static void from_planar(int num_elements, int num_components,
+        size_t stride, const REAL* RESTRICT in, REAL* RESTRICT out)
+{
+    for (int k = 0; k < num_components; ++k)
+    {
+        const REAL* RESTRICT p = in + k * stride;
+        REAL* RESTRICT o = out + k;
+        OMP_SIMD
+        for (int i = 0; i < num_elements; ++i)
+            o[(size_t) i * num_components] = p[i];
+    }
+}
+
+// Output may alias either input, so these pointers are not restricted.
+// Every component of an element is read before any is written.
+template<typename REAL>
+static void join_mm(int n, size_t s1, const REAL* j1, size_t s2,
+        const REAL* j2, size_t s3, REAL* j3)
+{
+    const REAL *a_r = j1,          *a_i = j1 + s1;
+    const REAL *b_r = j1 + 2 * s1, *b_i = j1 + 3 * s1;
+    const REAL *c_r = j1 + 4 * s1, *c_i = j1 + 5 * s1;
+    const REAL *d_r = j1 + 6 * s1, *d_i = j1 + 7 * s1;
+    const REAL *e_r = j2,          *e_i = j2 + s2;
+    const REAL *f_r = j2 + 2 * s2, *f_i = j2 + 3 * s2;
+    const REAL *g_r = j2 + 4 * s2, *g_i = j2 + 5 * s2;
+    const REAL *h_r = j2 + 6 * s2, *h_i = j2 + 7 * s2;
+    REAL *oa_r = j3,          *oa_i = j3 + s3;
+    REAL *ob_r = j3 + 2 * s3, *ob_i = j3 + 3 * s3;
+    REAL *oc_r = j3 + 4 * s3, *oc_i = j3 + 5 * s3;
+    REAL *od_r = j3 + 6 * s3, *od_i = j3 + 7 * s3;
+    OMP_SIMD
+    for (int i = 0; i < n; ++i)
+    {
+        // [a b] [e f]   [ae + bg  af + bh]
+        // [c d] [g h] = [ce + dg  cf + dh]
+        const REAL ar = a_r[i], ai = a_i[i], br = b_r[i], bi = b_i[i];
+        const REAL cr = c_r[i], ci = c_i[i], dr = d_r[i], di = d_i[i];
+        const REAL er = e_r[i], ei = e_i[i], fr = f_r[i], fi = f_i[i];
+        const REAL gr = g_r[i], gi = g_i[i], hr = h_r[i], hi = h_i[i];
+        oa_r[i] = ar * er - ai * ei + br * gr - bi * gi;
+        oa_i[i] = ar * ei + ai * er + br * gi + bi * gr;
+        ob_r[i] = ar * fr - ai * fi + br * hr - bi * hi;
+        ob_i[i] = ar * fi + ai * fr + br * hi + bi * hr;
+        oc_r[i] = cr * er - ci * ei + dr * gr - di * gi;
+        oc_i[i] = cr * ei + ci * er + dr * gi + di * gr;
+        od_r[i] = cr * fr - ci * fi + dr * hr - di * hi;
+        od_i[i] = cr * fi + ci * fr + dr * hi + di * hr;
+    }
+}
+
+// Multiplies every component of matrix (or scalar) M by scalar S.
+template<typename REAL>
+static void join_ms(int n, int num_components, size_t s_m, const REAL* m,
+        size_t s_s, const REAL* s, size_t s3, REAL* j3)
+{
+    const REAL *s_r = s, *s_i = s + s_s;
+    for (int k = 0; k < num_components; k += 2)
+    {
+        const REAL *m_r = m + k * s_m, *m_i = m + (k + 1) * s_m;
+        REAL *o_r = j3 + k * s3, *o_i = j3 + (k + 1) * s3;
+        OMP_SIMD
+        for (int i = 0; i < n; ++i)
+        {
+            const REAL xr = m_r[i], xi = m_i[i], yr = s_r[i], yi = s_i[i];
+            o_r[i] = xr * yr - xi * yi;
+            o_i[i] = xr * yi + xi * yr;
+        }
+    }
+}
+
+template<typename REAL>
+static void join(int n, int comp1, size_t stride1, const REAL* j1,
+        int comp2, size_t stride2, const REAL* j2, size_t stride3, REAL* j3)
+{
+    if (comp1 == 8 && comp2 == 8)
+        join_mm(n, stride1, j1, stride2, j2, stride3, j3);
+    else if (comp2 == 2)
+    {
+        // Scalars commute with matrices, so this covers M * S and S * S.
+        join_ms(n, comp1, stride1, j1, stride2, j2, stride3, j3);
+    }
+    else
+        join(n, comp2, stride2, j2, comp1, stride1, j1, stride3, j3);
+}
+
+template<typename REAL>
+static void apply_gains(int num_sources, int num_stations,
+        int num_components, const REAL* RESTRICT gains, size_t stride,
+        REAL* RESTRICT jones)
+{
+    for (int s = 0; s < num_stations; ++s)
+    {
+        const size_t o = (size_t) s * num_sources;
+        if (num_components == 2)
+        {
+            const REAL gr = gains[2 * s], gi = gains[2 * s + 1];
+            REAL* RESTRICT j_r = jones + o;
+            REAL* RESTRICT j_i = jones + stride + o;
+            OMP_SIMD
+            for (int i = 0; i < num_sources; ++i)
+            {
+                const REAL xr = j_r[i], xi = j_i[i];
+                j_r[i] = gr * xr - gi * xi;
+                j_i[i] = gr * xi + gi * xr;
+            }
+            continue;
+        }
+
+        // [ga gb] [a b]   [ga a + gb c  ga b + gb d]
+        // [gc gd] [c d] = [gc a + gd c  gc b + gd d]
+        const REAL* g = gains + 8 * s;
+        const REAL ga_r = g[0], ga_i = g[1], gb_r = g[2], gb_i = g[3];
+        const REAL gc_r = g[4], gc_i = g[5], gd_r = g[6], gd_i = g[7];
+        REAL* RESTRICT a_r = jones + o;
+        REAL* RESTRICT a_i = jones + stride + o;
+        REAL* RESTRICT b_r = jones + 2 * stride + o;
+        REAL* RESTRICT b_i = jones + 3 * stride + o;
+        REAL* RESTRICT c_r = jones + 4 * stride + o;
+        REAL* RESTRICT c_i = jones + 5 * stride + o;
+        REAL* RESTRICT d_r = jones + 6 * stride + o;
+        REAL* RESTRICT d_i = jones + 7 * stride + o;
+        OMP_SIMD
+        for (int i = 0; i < num_sources; ++i)
+        {
+            const REAL ar = a_r[i], ai = a_i[i], br = b_r[i], bi = b_i[i];
+            const REAL cr = c_r[i], ci = c_i[i], dr = d_r[i], di = d_i[i];
+            a_r[i] = ga_r * ar - ga_i * ai + gb_r * cr - gb_i * ci;
+            a_i[i] = ga_r * ai + ga_i * ar + gb_r * ci + gb_i * cr;
+            b_r[i] = ga_r * br - ga_i * bi + gb_r * dr - gb_i * di;
+            b_i[i] = ga_r * bi + ga_i * br + gb_r * di + gb_i * dr;
+            c_r[i] = gc_r * ar - gc_i * ai + gd_r * cr - gd_i * ci;
+            c_i[i] = gc_r * ai + gc_i * ar + gd_r * ci + gd_i * cr;
+            d_r[i] = gc_r * br - gc_i * bi + gd_r * dr - gd_i * di;
+            d_i[i] = gc_r * bi + gc_i * br + gd_r * di + gd_i * dr;
+        }
+    }
+}
+
+void oskar_jones_to_planar_omp_f(int num_elements, int num_components,
+        const float* in, size_t stride, float* out)
+{
+    to_planar(num_elements, num_components, in, stride, out);
+}
+
+void oskar_jones_to_planar_omp_d(int num_elements, int num_components,
+        const double* in, size_t stride, double* out)
+{
+    to_planar(num_elements, num_components, in, stride, out);
+}
+
+void oskar_jones_from_planar_omp_f(int num_elements, int num_components,
+        size_t stride, const float* in, float* out)
+{
+    from_planar(num_elements, num_components, stride, in, out);
+}
+
+void oskar_jones_from_planar_omp_d(int num_elements, int num_components,
+        size_t stride, const double* in, double* out)
+{
+    from_planar(num_elements, num_components, stride, in, out);
+}
+
+void oskar_jones_join_planar_omp_f(int num_elements,
+        int comp1, size_t stride1, const float* j1,
+        int comp2, size_t stride2, const float* j2,
+        size_t stride3, float* j3)
+{
+    join(num_elements, comp1, stride1, j1, comp2, stride2, j2, stride3, j3);
+}
+
+void oskar_jones_join_planar_omp_d(int num_elements,
+        int comp1, size_t stride1, const double* j1,
+        int comp2, size_t stride2, const double* j2,
+        size_t stride3, double* j3)
+{
+    join(num_elements, comp1, stride1, j1, comp2, stride2, j2, stride3, j3);
+}
+
+void oskar_jones_apply_station_gains_planar_omp_f(int num_sources,
+        int num_stations, int num_components, const float* gains,
+        size_t stride, float* jones)
+{
+    apply_gains(num_sources, num_stations, num_components,
+            gains, stride, jones);
+}
+
+void oskar_jones_apply_station_gains_planar_omp_d(int num_sources,
+        int num_stations, int num_components, const double* gains,
+        size_t stride, double* jones)
+{
+    apply_gains(num_sources, num_stations, num_components,
+            gains, stride, jones);
+}
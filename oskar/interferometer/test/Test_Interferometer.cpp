@@ -0,0 +1,395 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "convert/oskar_convert_mjd_to_gast_fast.h"
+#include "correlate/oskar_cross_correlate.h"
+#include "interferometer/oskar_evaluate_jones_E.h"
+#include "interferometer/oskar_evaluate_jones_K.h"
+#include "interferometer/oskar_evaluate_jones_R.h"
+#include "interferometer/oskar_interferometer.h"
+#include "interferometer/oskar_jones.h"
+#include "interferometer/private_interferometer.h"
+#include "log/oskar_log.h"
+#include "math/oskar_cmath.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cfloat>
+#include <climits>
+#include <cstdio>
+
+static const double start_mjd = 59000.0;
+static const double inc_sec = 60.0;
+static const double freq_hz = 100e6;
+static const double lat_rad = -50.0 * M_PI / 180.0;
+
+static oskar_Telescope* create_telescope(int precision, int* status)
+{
+    const double coords_enu[][2] = {
+            {0, 0}, {-605.1565, 146.9829}, {-64.79, -577.8771},
+            {-878.9322, -123.8241}, {-237.3169, -340.6209},
+            {407.1441, 198.459}, {139.1693, -888.4022},
+            {345.5998, 890.5183}
+    };
+    const int num_stations = sizeof(coords_enu) / sizeof(double[2]);
+    oskar_Telescope* tel = oskar_telescope_create(precision, OSKAR_CPU,
+            num_stations, status);
+    oskar_Mem* x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations,
+            status);
+    oskar_Mem* y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations,
+            status);
+    oskar_Mem* zero = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations,
+            status);
+    oskar_mem_clear_contents(zero, status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_mem_set_element_real(x, i, coords_enu[i][0], status);
+        oskar_mem_set_element_real(y, i, coords_enu[i][1], status);
+    }
+    oskar_telescope_set_station_coords_enu(tel, 0.0, lat_rad, 0.0,
+            num_stations, x, y, zero, zero, zero, zero, status);
+    oskar_Station* station = oskar_telescope_station(tel, 0);
+    oskar_station_resize(station, 1, status);
+    oskar_station_resize_element_types(station, 1, status);
+    oskar_element_set_element_type(oskar_station_element(station, 0),
+            "Dipole", status);
+    oskar_telescope_duplicate_first_station(tel, status);
+    oskar_telescope_set_station_ids(tel);
+
+    // Point at the zenith in the middle of the first time step,
+    // and disable bandwidth and time smearing.
+    const double gast = oskar_convert_mjd_to_gast_fast(
+            start_mjd + 0.5 * inc_sec / 86400.0);
+    oskar_telescope_set_phase_centre(tel, OSKAR_COORDS_RADEC, gast, lat_rad);
+    oskar_telescope_set_channel_bandwidth(tel, 0.0);
+    oskar_telescope_set_time_average(tel, 0.0);
+    oskar_telescope_analyse(tel, status);
+    oskar_mem_free(x, status);
+    oskar_mem_free(y, status);
+    oskar_mem_free(zero, status);
+    return tel;
+}
+
+static oskar_Sky* create_sky(int precision, int num_sources,
+        const oskar_Telescope* tel, int* status)
+{
+    const double ra0 = oskar_telescope_phase_centre_longitude_rad(tel);
+    const double dec0 = oskar_telescope_phase_centre_latitude_rad(tel);
+    oskar_Sky* sky = oskar_sky_create(precision, OSKAR_CPU, num_sources,
+            status);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        const double r = (1.0 + 0.5 * (i % 4)) * M_PI / 180.0;
+        const double t = 2.0 * M_PI * i / num_sources;
+        oskar_sky_set_source(sky, i, ra0 + r * cos(t), dec0 + r * sin(t),
+                1.0 + 0.1 * i, 0.3, -0.2, 0.1, 0.0, 0.0, 0.0,
+                0.0, 0.0, 0.0, status);
+    }
+    return sky;
+}
+
+static oskar_Interferometer* create_interferometer(int precision,
+        const oskar_Telescope* tel, const oskar_Sky* sky, int num_times,
+        int* status)
+{
+    oskar_Interferometer* h = oskar_interferometer_create(precision, status);
+    oskar_log_set_file_priority(oskar_interferometer_log(h), OSKAR_LOG_NONE);
+    oskar_log_set_term_priority(oskar_interferometer_log(h),
+            OSKAR_LOG_WARNING);
+    oskar_interferometer_set_gpus(h, 0, 0, status);
+    oskar_interferometer_set_horizon_clip(h, 0);
+    oskar_interferometer_set_observation_time(h, start_mjd, inc_sec,
+            num_times);
+    oskar_interferometer_set_observation_frequency(h, freq_hz, 1e6, 1);
+    oskar_interferometer_set_telescope_model(h, tel, status);
+    oskar_interferometer_set_sky_model(h, sky, status);
+    return h;
+}
+
+static void run_all_blocks(oskar_Interferometer* h, oskar_Mem* vis,
+        int* status)
+{
+    // Run each block on every device in turn, as oskar_interferometer_run()
+    // does, and append the cross-correlations to the output array.
+    oskar_interferometer_check_init(h, status);
+    const int num_blocks = oskar_interferometer_num_vis_blocks(h);
+    const int num_devices = oskar_interferometer_num_devices(h);
+    oskar_mem_realloc(vis, 0, status);
+    for (int b = 0; b < num_blocks; ++b)
+    {
+        for (int d = 0; d < num_devices; ++d)
+            oskar_interferometer_run_block(h, b, d, status);
+        oskar_VisBlock* block = oskar_interferometer_finalise_block(h, b,
+                status);
+        oskar_interferometer_reset_work_unit_index(h);
+        if (*status) return;
+        const oskar_Mem* xc = oskar_vis_block_cross_correlations_const(block);
+        const size_t offset = oskar_mem_length(vis);
+        const size_t length = oskar_mem_length(xc);
+        oskar_mem_realloc(vis, offset + length, status);
+        oskar_mem_copy_contents(vis, xc, offset, 0, length, status);
+    }
+}
+
+TEST(Interferometer, memory_plan_auto)
+{
+    // Check the block and chunk sizes chosen automatically.
+    int status = 0;
+    const int prec = OSKAR_DOUBLE, num_times = 8, num_sources = 37;
+    oskar_Telescope* tel = create_telescope(prec, &status);
+    oskar_Sky* sky = create_sky(prec, num_sources, tel, &status);
+    oskar_Interferometer* h = create_interferometer(prec, tel, sky,
+            num_times, &status);
+    oskar_interferometer_set_num_devices(h, 3);
+    oskar_interferometer_check_init(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // At least two blocks should be used, so that file writes can overlap
+    // with computation.
+    EXPECT_GE(oskar_interferometer_num_vis_blocks(h), 2);
+    EXPECT_EQ(oskar_interferometer_num_vis_blocks(h),
+            (num_times + h->max_times_per_block - 1) /
+            h->max_times_per_block);
+
+    // The sky model should have been split again into chunks of even size,
+    // enough to give each device a work unit, without losing any sources.
+    ASSERT_GE(h->num_sky_chunks, 2);
+    int total = 0, min_size = INT_MAX, max_size = 0;
+    const double* flux = oskar_mem_double_const(oskar_sky_I_const(sky),
+            &status);
+    for (int i = 0; i < h->num_sky_chunks; ++i)
+    {
+        const oskar_Sky* chunk = h->sky_chunks[i];
+        const int n = oskar_sky_num_sources(chunk);
+        const double* chunk_flux = oskar_mem_double_const(
+                oskar_sky_I_const(chunk), &status);
+        EXPECT_LE(n, h->max_sources_per_chunk);
+        for (int j = 0; j < n; ++j)
+            EXPECT_EQ(flux[total + j], chunk_flux[j]);
+        if (n < min_size) min_size = n;
+        if (n > max_size) max_size = n;
+        total += n;
+    }
+    EXPECT_EQ(num_sources, total);
+    EXPECT_LE(max_size - min_size, 1);
+
+    oskar_interferometer_free(h, &status);
+    oskar_sky_free(sky, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(Interferometer, memory_plan_matches_explicit)
+{
+    // Check that the visibilities do not depend on whether the block and
+    // chunk sizes were chosen automatically or set explicitly.
+    int status = 0;
+    const int prec = OSKAR_DOUBLE, num_times = 8, num_sources = 37;
+    oskar_Telescope* tel = create_telescope(prec, &status);
+    oskar_Sky* sky = create_sky(prec, num_sources, tel, &status);
+    oskar_Mem* vis_auto = oskar_mem_create(
+            prec | OSKAR_COMPLEX | OSKAR_MATRIX, OSKAR_CPU, 0, &status);
+    oskar_Mem* vis_set = oskar_mem_create(
+            prec | OSKAR_COMPLEX | OSKAR_MATRIX, OSKAR_CPU, 0, &status);
+
+    // Automatic sizes.
+    oskar_Interferometer* h = create_interferometer(prec, tel, sky,
+            num_times, &status);
+    oskar_interferometer_set_num_devices(h, 3);
+    run_all_blocks(h, vis_auto, &status);
+    oskar_interferometer_free(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Explicit sizes, which do not divide the dimensions exactly.
+    h = create_interferometer(prec, tel, sky, num_times, &status);
+    oskar_interferometer_set_num_devices(h, 1);
+    oskar_interferometer_set_max_times_per_block(h, 3);
+    oskar_interferometer_set_max_channels_per_block(h, 1);
+    oskar_interferometer_set_max_sources_per_chunk(h, 10);
+    oskar_interferometer_set_sky_model(h, sky, &status);
+    run_all_blocks(h, vis_set, &status);
+    EXPECT_EQ(3, oskar_interferometer_num_vis_blocks(h));
+    EXPECT_EQ(4, h->num_sky_chunks);
+    oskar_interferometer_free(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare.
+    const int num_stations = oskar_telescope_num_stations(tel);
+    ASSERT_EQ((size_t) (num_times * num_stations * (num_stations - 1) / 2),
+            oskar_mem_length(vis_auto));
+    ASSERT_EQ(oskar_mem_length(vis_set), oskar_mem_length(vis_auto));
+    double min_rel_error, max_rel_error, avg_rel_error, std_rel_error;
+    oskar_mem_evaluate_relative_error(vis_auto, vis_set,
+            &min_rel_error, &max_rel_error, &avg_rel_error, &std_rel_error,
+            &status);
+    EXPECT_LT(max_rel_error, 1e-10);
+    EXPECT_LT(avg_rel_error, 1e-12);
+
+    oskar_mem_free(vis_auto, &status);
+    oskar_mem_free(vis_set, &status);
+    oskar_sky_free(sky, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(Interferometer, polarised_jones_order)
+{
+    // Check that the visibilities from the simulator match those formed
+    // from pairwise joins of the Jones terms, G * K * (E * R).
+    int status = 0;
+    const int prec = OSKAR_DOUBLE;
+    oskar_Telescope* tel = create_telescope(prec, &status);
+    oskar_Sky* sky = create_sky(prec, 12, tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(OSKAR_POL_MODE_FULL, oskar_telescope_pol_mode(tel));
+
+    // Run the simulator for a single time and channel.
+    oskar_Interferometer* h = create_interferometer(prec, tel, sky, 1,
+            &status);
+    oskar_interferometer_set_num_devices(h, 1);
+    oskar_interferometer_check_init(h, &status);
+    oskar_interferometer_run_block(h, 0, 0, &status);
+    oskar_VisBlock* block = oskar_interferometer_finalise_block(h, 0,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Form the reference visibilities.
+    const int num_sources = oskar_sky_num_sources(sky);
+    const int num_stations = oskar_telescope_num_stations(tel);
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    const int matrix = prec | OSKAR_COMPLEX | OSKAR_MATRIX;
+    const double dt_days = inc_sec / 86400.0;
+    const double gast = oskar_convert_mjd_to_gast_fast(
+            start_mjd + 0.5 * dt_days);
+    oskar_sky_evaluate_relative_directions(sky,
+            oskar_telescope_phase_centre_longitude_rad(tel),
+            oskar_telescope_phase_centre_latitude_rad(tel), &status);
+    oskar_Mem* uvw[3];
+    for (int i = 0; i < 3; ++i)
+        uvw[i] = oskar_mem_create(prec, OSKAR_CPU, num_stations, &status);
+    oskar_telescope_uvw(tel, 1, 0, 1, start_mjd, dt_days, 0,
+            uvw[0], uvw[1], uvw[2], 0, 0, 0, &status);
+    const oskar_Mem* const lmn[] = {
+            oskar_sky_l_const(sky),
+            oskar_sky_m_const(sky),
+            oskar_sky_n_const(sky)
+    };
+    const oskar_Mem* const flux[] = {
+            oskar_sky_I_const(sky),
+            oskar_sky_Q_const(sky),
+            oskar_sky_U_const(sky),
+            oskar_sky_V_const(sky)
+    };
+    const oskar_Mem* const ext[] = {
+            oskar_sky_gaussian_a_const(sky),
+            oskar_sky_gaussian_b_const(sky),
+            oskar_sky_gaussian_c_const(sky)
+    };
+    oskar_Jones* E = oskar_jones_create(matrix, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* R = oskar_jones_create(matrix, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* K = oskar_jones_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* J = oskar_jones_create(matrix, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_StationWork* work = oskar_station_work_create(prec, OSKAR_CPU,
+            &status);
+    oskar_evaluate_jones_E(E, OSKAR_COORDS_REL_DIR, num_sources, lmn,
+            oskar_telescope_phase_centre_longitude_rad(tel),
+            oskar_telescope_phase_centre_latitude_rad(tel),
+            tel, 0, gast, freq_hz, work, &status);
+    oskar_evaluate_jones_R(R, num_sources, oskar_sky_ra_rad_const(sky),
+            oskar_sky_dec_rad_const(sky), tel, gast, &status);
+    oskar_evaluate_jones_K(K, num_sources, lmn[0], lmn[1], lmn[2],
+            uvw[0], uvw[1], uvw[2], freq_hz, flux[0], -DBL_MAX, DBL_MAX,
+            0, &status);
+    oskar_jones_join(R, E, R, &status);
+    oskar_jones_join(J, K, R, &status);
+    oskar_Mem* ref = oskar_mem_create(matrix, OSKAR_CPU, num_baselines,
+            &status);
+    oskar_mem_clear_contents(ref, &status);
+    oskar_cross_correlate(oskar_sky_use_extended(sky), num_sources, J,
+            flux, lmn, ext, tel, uvw, gast, freq_hz, 0, ref, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare.
+    double min_rel_error, max_rel_error, avg_rel_error, std_rel_error;
+    oskar_mem_evaluate_relative_error(
+            oskar_vis_block_cross_correlations(block), ref,
+            &min_rel_error, &max_rel_error, &avg_rel_error, &std_rel_error,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(max_rel_error, 1e-10);
+    EXPECT_LT(avg_rel_error, 1e-12);
+
+    for (int i = 0; i < 3; ++i)
+        oskar_mem_free(uvw[i], &status);
+    oskar_mem_free(ref, &status);
+    oskar_jones_free(E, &status);
+    oskar_jones_free(R, &status);
+    oskar_jones_free(K, &status);
+    oskar_jones_free(J, &status);
+    oskar_station_work_free(work, &status);
+    oskar_interferometer_free(h, &status);
+    oskar_sky_free(sky, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+#ifdef OSKAR_HAVE_OPENCL
+TEST(Interferometer, prefetch_sky_opencl)
+{
+    // Check that prefetching sky chunks on an OpenCL device does not
+    // change the visibilities.
+    int status = 0, location = 0, gpu_id = 0;
+    const int prec = OSKAR_SINGLE, num_times = 4, num_sources = 37;
+    oskar_device_set_require_double_precision(0);
+    if (oskar_device_count("OpenCL", &location) < 1)
+    {
+        printf("No OpenCL devices found: skipping test.\n");
+        return;
+    }
+    oskar_Telescope* tel = create_telescope(prec, &status);
+    oskar_Sky* sky = create_sky(prec, num_sources, tel, &status);
+    oskar_Mem* vis[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        vis[i] = oskar_mem_create(prec | OSKAR_COMPLEX | OSKAR_MATRIX,
+                OSKAR_CPU, 0, &status);
+        oskar_Interferometer* h = create_interferometer(prec, tel, sky,
+                num_times, &status);
+        ASSERT_EQ(OSKAR_CL, h->dev_loc) << "Default device is not OpenCL.";
+        oskar_interferometer_set_gpus(h, 1, &gpu_id, &status);
+        oskar_interferometer_set_num_devices(h, 1);
+        oskar_interferometer_set_max_times_per_block(h, 2);
+        oskar_interferometer_set_max_sources_per_chunk(h, 8);
+        oskar_interferometer_set_prefetch_sky(h, i);
+        oskar_interferometer_set_sky_model(h, sky, &status);
+        run_all_blocks(h, vis[i], &status);
+        EXPECT_EQ(5, h->num_sky_chunks);
+        oskar_interferometer_free(h, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    // Compare.
+    ASSERT_EQ(oskar_mem_length(vis[0]), oskar_mem_length(vis[1]));
+    ASSERT_GT(oskar_mem_length(vis[0]), 0u);
+    double min_rel_error, max_rel_error, avg_rel_error, std_rel_error;
+    oskar_mem_evaluate_relative_error(vis[1], vis[0],
+            &min_rel_error, &max_rel_error, &avg_rel_error, &std_rel_error,
+            &status);
+    EXPECT_LT(max_rel_error, 1e-6);
+    oskar_mem_free(vis[0], &status);
+    oskar_mem_free(vis[1], &status);
+    oskar_sky_free(sky, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+#endif
@@ -891,3 +891,342 @@ TEST(Jones, set_ones_doubleCPU)
     test_ones(OSKAR_DOUBLE, OSKAR_CPU);
 }
 
+
+// Planar layout. /////////////////////////////////////////////////////////////
+
+static oskar_Jones* to_planar(const oskar_Jones* in, int* status)
+{
+    oskar_Jones* out = oskar_jones_create_planar(oskar_jones_type(in),
+            OSKAR_CPU, oskar_jones_num_stations(in),
+            oskar_jones_num_sources(in), status);
+    oskar_jones_convert(out, in, status);
+    return out;
+}
+
+static void t_join_planar(int out_type, int in_type1, int in_type2,
+        int in_place)
+{
+    int status = 0;
+    oskar_Jones *in1, *in2, *out, *in1_p, *in2_p, *out_p, *result;
+
+    // Join the interleaved matrices.
+    in1 = oskar_jones_create(in_type1, CPU, stations, sources, &status);
+    in2 = oskar_jones_create(in_type2, CPU, stations, sources, &status);
+    srand(2);
+    oskar_mem_random_range(oskar_jones_mem(in1), 1.0, 2.0, &status);
+    oskar_mem_random_range(oskar_jones_mem(in2), 1.0, 2.0, &status);
+    in1_p = to_planar(in1, &status);
+    in2_p = to_planar(in2, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_TRUE(oskar_jones_is_planar(in1_p));
+    EXPECT_EQ(in_type1, oskar_jones_type(in1_p));
+    out = in_place ? in1 : oskar_jones_create(out_type, CPU,
+            stations, sources, &status);
+    oskar_jones_join(out, in1, in2, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Join the planar matrices, and convert the result back.
+    out_p = in_place ? in1_p : oskar_jones_create_planar(out_type, CPU,
+            stations, sources, &status);
+    oskar_jones_join(out_p, in1_p, in2_p, &status);
+    result = oskar_jones_create(out_type, CPU, stations, sources, &status);
+    oskar_jones_convert(result, out_p, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    check_values(oskar_jones_mem(result), oskar_jones_mem(out));
+
+    // Mixing layouts is an error.
+    oskar_jones_join(out_p, in1, in2_p, &status);
+    EXPECT_EQ((int) OSKAR_ERR_TYPE_MISMATCH, status);
+    status = 0;
+
+    // Free memory.
+    if (!in_place)
+    {
+        oskar_jones_free(out, &status);
+        oskar_jones_free(out_p, &status);
+    }
+    oskar_jones_free(in1, &status);
+    oskar_jones_free(in2, &status);
+    oskar_jones_free(in1_p, &status);
+    oskar_jones_free(in2_p, &status);
+    oskar_jones_free(result, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+static void t_gains_planar(int type)
+{
+    int status = 0;
+    oskar_Jones* jones = oskar_jones_create(type, CPU, stations, sources,
+            &status);
+    oskar_Mem* gains = oskar_mem_create(type, CPU, stations, &status);
+    srand(2);
+    oskar_mem_random_range(oskar_jones_mem(jones), 1.0, 2.0, &status);
+    oskar_mem_random_range(gains, 1.0, 2.0, &status);
+    oskar_Jones* jones_p = to_planar(jones, &status);
+    oskar_jones_apply_station_gains(jones, gains, &status);
+    oskar_jones_apply_station_gains(jones_p, gains, &status);
+    oskar_Jones* result = oskar_jones_create(type, CPU, stations, sources,
+            &status);
+    oskar_jones_convert(result, jones_p, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    check_values(oskar_jones_mem(result), oskar_jones_mem(jones));
+    oskar_jones_free(jones, &status);
+    oskar_jones_free(jones_p, &status);
+    oskar_jones_free(result, &status);
+    oskar_mem_free(gains, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(Jones, planar_join)
+{
+    t_join_planar(SC, SC, SC, 0);
+    t_join_planar(SCM, SCM, SC, 0);
+    t_join_planar(SCM, SC, SCM, 0);
+    t_join_planar(SCM, SCM, SCM, 0);
+    t_join_planar(DC, DC, DC, 0);
+    t_join_planar(DCM, DCM, DC, 0);
+    t_join_planar(DCM, DC, DCM, 0);
+    t_join_planar(DCM, DCM, DCM, 0);
+}
+
+TEST(Jones, planar_join_in_place)
+{
+    t_join_planar(SCM, SCM, SC, 1);
+    t_join_planar(SCM, SCM, SCM, 1);
+    t_join_planar(DC, DC, DC, 1);
+    t_join_planar(DCM, DCM, DCM, 1);
+}
+
+TEST(Jones, planar_apply_station_gains)
+{
+    t_gains_planar(SC);
+    t_gains_planar(SCM);
+    t_gains_planar(DC);
+    t_gains_planar(DCM);
+}
+
+TEST(Jones, planar_convert)
+{
+    int status = 0;
+    oskar_Jones* jones = oskar_jones_create(DCM, CPU, stations, sources,
+            &status);
+    srand(2);
+    oskar_mem_random_range(oskar_jones_mem(jones), 1.0, 2.0, &status);
+    oskar_Jones* jones_p = to_planar(jones, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the layout of the planar copy.
+    const size_t stride = oskar_jones_component_stride(jones_p);
+    const double* p = oskar_mem_double_const(oskar_jones_mem(jones_p),
+            &status);
+    const double4c* j = oskar_mem_double4c_const(oskar_jones_mem(jones),
+            &status);
+    for (int i = 0; i < stations * sources; ++i)
+    {
+        EXPECT_EQ(j[i].a.x, p[i]);
+        EXPECT_EQ(j[i].a.y, p[i + stride]);
+        EXPECT_EQ(j[i].b.x, p[i + 2 * stride]);
+        EXPECT_EQ(j[i].c.y, p[i + 5 * stride]);
+        EXPECT_EQ(j[i].d.y, p[i + 7 * stride]);
+    }
+
+    // Check a copy of the planar block.
+    oskar_Jones* copy = oskar_jones_create_copy(jones_p, CPU, &status);
+    EXPECT_TRUE(oskar_jones_is_planar(copy));
+    oskar_Jones* result = oskar_jones_create(DCM, CPU, stations, sources,
+            &status);
+    oskar_jones_convert(result, copy, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    check_values(oskar_jones_mem(result), oskar_jones_mem(jones));
+
+    // Planar blocks can only be created in CPU memory.
+    oskar_Jones* bad = oskar_jones_create_planar(DCM, OSKAR_GPU,
+            stations, sources, &status);
+    EXPECT_EQ((int) OSKAR_ERR_BAD_LOCATION, status);
+    EXPECT_TRUE(bad == 0);
+    status = 0;
+    oskar_jones_free(jones, &status);
+    oskar_jones_free(jones_p, &status);
+    oskar_jones_free(copy, &status);
+    oskar_jones_free(result, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+static void t_chain(int precision, int location, int e_matrix, int use_r,
+        int use_gains)
+{
+    int status = 0;
+    oskar_Jones *R = 0, *R_d = 0;
+    oskar_Mem *G = 0, *G_d = 0;
+    const int scalar = precision | OSKAR_COMPLEX;
+    const int matrix = scalar | OSKAR_MATRIX;
+    const int out_type = (e_matrix || use_r) ? matrix : scalar;
+
+    // Create and fill the terms.
+    srand(3);
+    oskar_Jones* K = oskar_jones_create(scalar, CPU, stations, sources,
+            &status);
+    oskar_Jones* E = oskar_jones_create(e_matrix ? matrix : scalar, CPU,
+            stations, sources, &status);
+    oskar_mem_random_range(oskar_jones_mem(K), 1.0, 2.0, &status);
+    oskar_mem_random_range(oskar_jones_mem(E), 1.0, 2.0, &status);
+    if (use_r)
+    {
+        R = oskar_jones_create(matrix, CPU, stations, sources, &status);
+        oskar_mem_random_range(oskar_jones_mem(R), 1.0, 2.0, &status);
+    }
+    if (use_gains)
+    {
+        G = oskar_mem_create(out_type, CPU, stations, &status);
+        oskar_mem_random_range(G, 1.0, 2.0, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Form the reference result from pairwise joins,
+    // in the order used previously by the simulator: K * (E * R).
+    oskar_Jones* ref = oskar_jones_create(out_type, CPU, stations, sources,
+            &status);
+    if (use_r)
+    {
+        oskar_Jones* ER = oskar_jones_create(matrix, CPU, stations, sources,
+                &status);
+        oskar_jones_join(ER, E, R, &status);
+        oskar_jones_join(ref, K, ER, &status);
+        oskar_jones_free(ER, &status);
+    }
+    else
+        oskar_jones_join(ref, K, E, &status);
+    if (use_gains)
+        oskar_jones_apply_station_gains(ref, G, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Evaluate the chain in one pass.
+    int num_terms = 0;
+    const oskar_Jones* terms[OSKAR_JONES_CHAIN_MAX_TERMS];
+    oskar_Jones* K_d = oskar_jones_create_copy(K, location, &status);
+    oskar_Jones* E_d = oskar_jones_create_copy(E, location, &status);
+    terms[num_terms++] = K_d;
+    terms[num_terms++] = E_d;
+    if (use_r)
+    {
+        R_d = oskar_jones_create_copy(R, location, &status);
+        terms[num_terms++] = R_d;
+    }
+    if (use_gains)
+        G_d = oskar_mem_create_copy(G, location, &status);
+    oskar_Jones* out = oskar_jones_create(out_type, location,
+            stations, sources, &status);
+    oskar_jones_chain(out, num_terms, terms, G_d, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_Jones* out_cpu = oskar_jones_create_copy(out, CPU, &status);
+    check_values(oskar_jones_mem(out_cpu), oskar_jones_mem(ref));
+
+    oskar_jones_free(K, &status);
+    oskar_jones_free(E, &status);
+    oskar_jones_free(R, &status);
+    oskar_mem_free(G, &status);
+    oskar_jones_free(K_d, &status);
+    oskar_jones_free(E_d, &status);
+    oskar_jones_free(R_d, &status);
+    oskar_mem_free(G_d, &status);
+    oskar_jones_free(ref, &status);
+    oskar_jones_free(out, &status);
+    oskar_jones_free(out_cpu, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(Jones, chain_CPU)
+{
+    const int prec[] = {OSKAR_SINGLE, OSKAR_DOUBLE};
+    for (int i = 0; i < 2; ++i)
+    {
+        t_chain(prec[i], CPU, 0, 0, 0);
+        t_chain(prec[i], CPU, 0, 0, 1);
+        t_chain(prec[i], CPU, 1, 0, 0);
+        t_chain(prec[i], CPU, 1, 0, 1);
+        t_chain(prec[i], CPU, 1, 1, 0);
+        t_chain(prec[i], CPU, 1, 1, 1);
+    }
+}
+
+#ifdef OSKAR_HAVE_OPENCL
+TEST(Jones, chain_CL)
+{
+    const int prec[] = {OSKAR_SINGLE, OSKAR_DOUBLE};
+    for (int i = 0; i < 2; ++i)
+    {
+        t_chain(prec[i], CL, 0, 0, 1);
+        t_chain(prec[i], CL, 1, 0, 1);
+        t_chain(prec[i], CL, 1, 1, 1);
+    }
+}
+#endif
+
+#ifdef OSKAR_HAVE_CUDA
+TEST(Jones, chain_GPU)
+{
+    const int prec[] = {OSKAR_SINGLE, OSKAR_DOUBLE};
+    for (int i = 0; i < 2; ++i)
+    {
+        t_chain(prec[i], GPU, 0, 0, 1);
+        t_chain(prec[i], GPU, 1, 0, 1);
+        t_chain(prec[i], GPU, 1, 1, 1);
+    }
+}
+#endif
+
+TEST(Jones, chain_errors)
+{
+    int status = 0;
+    oskar_Jones* s = oskar_jones_create(DC, CPU, stations, sources, &status);
+    oskar_Jones* m = oskar_jones_create(DCM, CPU, stations, sources, &status);
+    oskar_Jones* f = oskar_jones_create(SC, CPU, stations, sources, &status);
+    oskar_Jones* p = oskar_jones_create_planar(DC, CPU, stations, sources,
+            &status);
+    oskar_Jones* small = oskar_jones_create(DC, CPU, stations, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const oskar_Jones* terms[] = {s, s, s, s, s};
+
+    // Wrong number of terms.
+    oskar_jones_chain(m, 0, terms, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_INVALID_ARGUMENT, status);
+    status = 0;
+    oskar_jones_chain(m, OSKAR_JONES_CHAIN_MAX_TERMS + 1, terms, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_INVALID_ARGUMENT, status);
+    status = 0;
+
+    // Output used as an input.
+    oskar_jones_chain(s, 2, terms, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_INVALID_ARGUMENT, status);
+    status = 0;
+
+    // Matrix input with scalar output.
+    const oskar_Jones* mixed[] = {f, s};
+    const oskar_Jones* matrix_term[] = {m};
+    oskar_jones_chain(s, 1, matrix_term, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_TYPE_MISMATCH, status);
+    status = 0;
+
+    // Mixed precision.
+    oskar_jones_chain(m, 2, mixed, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_TYPE_MISMATCH, status);
+    status = 0;
+
+    // Planar input.
+    const oskar_Jones* planar_term[] = {p};
+    oskar_jones_chain(m, 1, planar_term, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_TYPE_MISMATCH, status);
+    status = 0;
+
+    // Dimension mismatch.
+    const oskar_Jones* small_term[] = {small};
+    oskar_jones_chain(m, 1, small_term, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_DIMENSION_MISMATCH, status);
+    status = 0;
+
+    oskar_jones_free(s, &status);
+    oskar_jones_free(m, &status);
+    oskar_jones_free(f, &status);
+    oskar_jones_free(p, &status);
+    oskar_jones_free(small, &status);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "interferometer/oskar_evaluate_jones_K.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Launches small K-Jones evaluations repeatedly, from one or more threads,
+// to measure the per-launch overhead rather than the kernel itself.
+static double run(int prec, int location, int num_sources, int num_stations,
+        int niter, int* status)
+{
+    double elapsed = 0.0;
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+#pragma omp parallel
+    {
+        int thread_status = 0;
+        if (location != OSKAR_CPU)
+            oskar_device_set(location, 0, &thread_status);
+        oskar_Jones* K = oskar_jones_create(prec | OSKAR_COMPLEX, location,
+                num_stations, num_sources, &thread_status);
+        oskar_Mem *lmn[3], *uvw[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            lmn[i] = oskar_mem_create(prec, location, num_sources,
+                    &thread_status);
+            uvw[i] = oskar_mem_create(prec, location, num_stations,
+                    &thread_status);
+            oskar_mem_clear_contents(lmn[i], &thread_status);
+            oskar_mem_clear_contents(uvw[i], &thread_status);
+        }
+        oskar_Mem* flux = oskar_mem_create(prec, location, num_sources,
+                &thread_status);
+        oskar_mem_set_value_real(flux, 1.0, 0, num_sources, &thread_status);
+#pragma omp barrier
+#pragma omp master
+        oskar_timer_start(timer);
+        for (int i = 0; i < niter; ++i)
+            oskar_evaluate_jones_K(K, num_sources, lmn[0], lmn[1], lmn[2],
+                    uvw[0], uvw[1], uvw[2], 100e6, flux, 0.0, 1e9, 0,
+                    &thread_status);
+
+        // Copying the result back waits for all launches to finish.
+        oskar_Mem* result = oskar_mem_create_copy(oskar_jones_mem(K),
+                OSKAR_CPU, &thread_status);
+        oskar_mem_free(result, &thread_status);
+#pragma omp barrier
+#pragma omp master
+        elapsed = oskar_timer_elapsed(timer);
+        for (int i = 0; i < 3; ++i)
+        {
+            oskar_mem_free(lmn[i], &thread_status);
+            oskar_mem_free(uvw[i], &thread_status);
+        }
+        oskar_mem_free(flux, &thread_status);
+        oskar_jones_free(K, &thread_status);
+#pragma omp critical
+        if (thread_status && !*status) *status = thread_status;
+    }
+    oskar_timer_free(timer);
+    return elapsed;
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_evaluate_jones_K_benchmark",
+            OSKAR_VERSION_STR);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-g", "Run on the GPU");
+    opt.add_flag("-cl", "Run using OpenCL");
+    opt.add_flag("-nsrc", "Number of sources.", 1, "64", false);
+    opt.add_flag("-nst", "Number of stations.", 1, "16", false);
+    opt.add_flag("-nthreads", "Number of launching threads.", 1, "1", false);
+    opt.add_flag("-n", "Number of launches per thread.", 1, "10000", false);
+    opt.add_flag("-v", "Display verbose output.", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0, location = OSKAR_CPU;
+    const int prec = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    const int num_sources = opt.get_int("-nsrc");
+    const int num_stations = opt.get_int("-nst");
+    const int num_threads = opt.get_int("-nthreads");
+    const int niter = opt.get_int("-n");
+    if (opt.is_set("-g")) location = OSKAR_GPU;
+    if (opt.is_set("-cl")) location = OSKAR_CL;
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads > 0 ? num_threads : 1);
+#endif
+
+    // Time looking up a kernel by name, as done for every launch by name.
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    const oskar_DeviceKernel* handle = 0;
+    oskar_timer_start(timer);
+    for (int i = 0; i < niter; ++i)
+        handle = oskar_device_kernel("evaluate_jones_K_double");
+    const double time_lookup = oskar_timer_elapsed(timer) / niter;
+    oskar_timer_free(timer);
+
+    // Time the launches, once to warm up and once for real.
+    (void) run(prec, location, num_sources, num_stations, 1, &status);
+    const double time_run = run(prec, location, num_sources, num_stations,
+            niter, &status);
+    const double time_launch = time_run / niter;
+
+    // Check for errors.
+    if (status || !handle)
+    {
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+
+    // Print results.
+    if (opt.is_set("-v"))
+    {
+        printf("- Sources x stations: %i x %i\n", num_sources, num_stations);
+        printf("- Precision: %s\n", (prec == OSKAR_SINGLE) ?
+                "single" : "double");
+        printf("- Location: %s\n", location == OSKAR_GPU ? "GPU" :
+                (location == OSKAR_CL ? "OpenCL" : "CPU"));
+        printf("- Launching threads: %i\n", num_threads);
+        printf("==> Kernel lookup by name took %.3f us\n", time_lookup * 1e6);
+        printf("==> Each launch took %.3f us (all threads)\n",
+                time_launch * 1e6);
+    }
+    else
+    {
+        printf("%e %e\n", time_lookup, time_launch);
+    }
+    oskar_device_reset_all();
+    return EXIT_SUCCESS;
+}
@@ -51,6 +51,8 @@ typedef struct oskar_Log oskar_Log;
 
 #define OSKAR_LOG_DEFAULT_PRIORITY    3  /* 3 = OSKAR_LOG_STATUS (or code 'S') */
 #define OSKAR_LOG_DEFAULT_VALUE_WIDTH 40 /* Default width for value log entries */
+/* Default minimum interval between progress entries, in seconds */
+#define OSKAR_LOG_DEFAULT_PROGRESS_INTERVAL 1.0
 
 enum OSKAR_LOG_SPECIAL_DEPTH {
     OSKAR_LOG_NO_LIST_MARKER = -1,
@@ -181,6 +183,28 @@ OSKAR_EXPORT
 void oskar_log_message(oskar_Log* log, char priority, int depth,
         const char* format, ...);
 
+/**
+ * @brief Writes a rate-limited progress message to the log.
+ *
+ * @details
+ * This function writes a message log entry in the same way as
+ * oskar_log_message(), but only if the progress interval set using
+ * oskar_log_set_progress_interval() has elapsed since the last entry
+ * written using the same \p last_time.
+ *
+ * Each caller should keep its own \p last_time, initialised to zero,
+ * so that no shared state needs to be updated when a message is skipped.
+ * If \p last_time is NULL, the message is always written.
+ *
+ * @param[in]     priority  Priority of log entry.
+ * @param[in]     depth     Level of nesting of log entry.
+ * @param[in,out] last_time Time of the last progress entry from this caller.
+ * @param[in]     format    Format string for printf().
+ */
+OSKAR_EXPORT
+void oskar_log_progress(oskar_Log* log, char priority, int depth,
+        double* last_time, const char* format, ...);
+
 /**
  * @brief Writes a section-level message to the log.
  *
@@ -247,6 +271,29 @@ void oskar_log_value(oskar_Log* log, char priority, int depth,
 OSKAR_EXPORT
 void oskar_log_warning(oskar_Log* log, const char* format, ...);
 
+/**
+ * @brief Returns true if the log is in asynchronous mode.
+ */
+OSKAR_EXPORT
+int oskar_log_async(const oskar_Log* log);
+
+/**
+ * @brief Enables or disables asynchronous logging.
+ *
+ * @details
+ * In asynchronous mode, each thread formats its log entries into its own
+ * ring buffer without taking any locks, and a background thread writes
+ * them to the terminal and log file in time order.
+ * Use this while a number of worker threads are writing to the log.
+ *
+ * Disabling asynchronous mode writes out all pending entries.
+ * This function must not be called while other threads are using the log.
+ *
+ * @param[in] value If true, enable asynchronous mode.
+ */
+OSKAR_EXPORT
+void oskar_log_set_async(oskar_Log* log, int value);
+
 OSKAR_EXPORT
 void oskar_log_set_keep_file(oskar_Log* log, int value);
 
@@ -266,6 +313,14 @@ void oskar_log_set_file_priority(oskar_Log* log, int value);
 OSKAR_EXPORT
 void oskar_log_set_term_priority(oskar_Log* log, int value);
 
+/**
+ * @brief Sets the minimum interval between progress messages.
+ *
+ * @param[in] value Interval in seconds. If zero, all progress is written.
+ */
+OSKAR_EXPORT
+void oskar_log_set_progress_interval(oskar_Log* log, double value);
+
 OSKAR_EXPORT
 void oskar_log_set_value_width(oskar_Log* log, int value);
 
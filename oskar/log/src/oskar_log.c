@@ -26,10 +26,16 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* For nanosleep(). */
+#endif
+
 #include "log/oskar_log.h"
 #include "utility/oskar_lock_file.h"
+#include "utility/oskar_thread.h"
 #include "oskar_version.h"
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -39,6 +45,7 @@
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #else
+#include <pthread.h>
 #include <sys/time.h>
 #include <unistd.h>
 #endif
@@ -49,6 +56,61 @@ extern "C" {
 
 #define WRITE_TIMESTAMP 0
 
+/* Size of each buffered entry, and number of entries per thread. */
+#define LOG_ENTRY_SIZE 256
+#define LOG_RING_SIZE 256 /* Must be a power of 2. */
+#define LOG_DRAIN_INTERVAL_MS 10
+
+#ifdef OSKAR_OS_WIN
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+/* Ring buffer indices are only written by one thread each, so only need
+ * ordered loads and stores. (x86 and x64 loads and stores are already
+ * ordered, so MSVC only needs a compiler barrier.) */
+#if defined(__GNUC__) || defined(__clang__)
+#define LOAD_ACQUIRE(X) __atomic_load_n(&(X), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(X, V) __atomic_store_n(&(X), (V), __ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define LOAD_ACQUIRE(X) (_ReadWriteBarrier(), (X))
+#define STORE_RELEASE(X, V) { _ReadWriteBarrier(); (X) = (V); }
+#else
+#define LOAD_ACQUIRE(X) (X)
+#define STORE_RELEASE(X, V) (X) = (V)
+#endif
+
+/* Serialises output, initialisation and ring registration.
+ * This is separate from any lock used by callers. */
+#ifdef OSKAR_OS_WIN
+static SRWLOCK log_lock = SRWLOCK_INIT;
+#define LOG_LOCK AcquireSRWLockExclusive(&log_lock)
+#define LOG_UNLOCK ReleaseSRWLockExclusive(&log_lock)
+#else
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+#define LOG_LOCK pthread_mutex_lock(&log_lock)
+#define LOG_UNLOCK pthread_mutex_unlock(&log_lock)
+#endif
+
+typedef struct
+{
+    char text[LOG_ENTRY_SIZE];        /* Formatted entry. */
+    double time;                      /* Timestamp, for ordering. */
+    int to_term, to_file, is_error;   /* Destinations. */
+} LogEntry;
+
+/* Single-producer, single-consumer ring of entries for one thread.
+ * The head is only written by the owning thread, and the tail only by
+ * whichever thread is draining the rings (with the log lock held). */
+typedef struct
+{
+    size_t head, tail;
+    const void* owner;                /* Identifies the owning thread. */
+    LogEntry entries[LOG_RING_SIZE];
+} LogRing;
+
 struct oskar_Log
 {
     int init;                         /* Initialisation flag. */
@@ -59,6 +121,12 @@ struct oskar_Log
     FILE* file;                       /* Log file handle. */
     double timestamp_start;           /* Timestamp of log creation. */
     char name[120];                   /* Log file pathname. */
+    double progress_interval;         /* Minimum time between progress. */
+    int async, stop;                  /* Asynchronous mode flags. */
+    size_t async_id;                  /* Unique ID of asynchronous session. */
+    int num_rings;                    /* Number of per-thread rings. */
+    LogRing** rings;                  /* Per-thread rings. */
+    oskar_Thread* drainer;            /* Thread writing buffered entries. */
 };
 
 #ifndef OSKAR_LOG_TYPEDEF_
@@ -67,13 +135,16 @@ typedef struct oskar_Log oskar_Log;
 #endif /* OSKAR_LOG_TYPEDEF_ */
 
 
-static void init_log(oskar_Log* log);
-static void print_entry(oskar_Log* log, FILE* stream, char priority, char code,
-        int depth, const char* prefix, const char* format, va_list args);
+static void check_init(oskar_Log* log);
+static void write_header(oskar_Log* log);
+static size_t format_entry(const oskar_Log* log, char* buf, size_t size,
+        char priority, char code, int depth, const char* prefix,
+        const char* format, va_list* args);
 static int log_priority_level(char code);
 static char get_entry_code(char priority);
-static void write_log(oskar_Log* log, int to_file, char priority, char code,
-        int depth, const char* prefix, const char* format, va_list args);
+static void write_log(oskar_Log* log, char priority, char code,
+        int depth, const char* prefix, const char* format, va_list* args);
+static void drain_rings(oskar_Log* log);
 
 /* Root logger. */
 static oskar_Log log_ = {
@@ -85,9 +156,23 @@ static oskar_Log log_ = {
         0, /* Write standard headers. */
         0, /* File pointer. */
         0.0, /* Timestamp start. */
-        {0} /* File name. */
+        {0}, /* File name. */
+        OSKAR_LOG_DEFAULT_PROGRESS_INTERVAL, /* Progress interval. */
+        0, 0, /* Asynchronous mode flags. */
+        0, /* Asynchronous session ID. */
+        0, /* Number of rings. */
+        0, /* Rings. */
+        0 /* Drain thread. */
 };
 
+/* Counter used to give each asynchronous session a unique ID. */
+static size_t async_counter_ = 0;
+
+/* This thread's ring, and the log and session it belongs to. */
+static THREAD_LOCAL LogRing* ring_ = 0;
+static THREAD_LOCAL const oskar_Log* ring_log_ = 0;
+static THREAD_LOCAL size_t ring_id_ = 0;
+
 #if __STDC_VERSION__ >= 199901L || (defined(__cplusplus) && __cplusplus >= 201103L)
 #define SNPRINTF(BUF, SIZE, FMT, ...) snprintf(BUF, SIZE, FMT, __VA_ARGS__);
 #else
@@ -102,17 +187,22 @@ void oskar_log_advice(oskar_Log* log, const char* format, ...)
     const int depth = OSKAR_LOG_INFO_PREFIX;
     oskar_log_line(log, priority, ' ');
     va_start(args, format);
-    write_log(log, 0, priority, code, depth, prefix, format, args);
-    va_end(args);
-    va_start(args, format);
-    write_log(log, 1, priority, code, depth, prefix, format, args);
+    write_log(log, priority, code, depth, prefix, format, &args);
     va_end(args);
     oskar_log_line(log, priority, ' ');
 }
 
 
+int oskar_log_async(const oskar_Log* log)
+{
+    if (!log) log = &log_;
+    return log->async;
+}
+
+
 void oskar_log_close(oskar_Log* log)
 {
+    oskar_log_set_async(log, 0);
     if (log->write_header && log->init)
     {
         char time_str[80];
@@ -146,6 +236,7 @@ oskar_Log* oskar_log_create(int file_priority, int term_priority)
     log->file_priority = file_priority;
     log->term_priority = term_priority;
     log->value_width = OSKAR_LOG_DEFAULT_VALUE_WIDTH;
+    log->progress_interval = OSKAR_LOG_DEFAULT_PROGRESS_INTERVAL;
     log->write_header = 1;
     return log;
 }
@@ -181,10 +272,7 @@ void oskar_log_error(oskar_Log* log, const char* format, ...)
     const int depth = OSKAR_LOG_INFO_PREFIX;
     oskar_log_line(log, priority, ' ');
     va_start(args, format);
-    write_log(log, 0, priority, code, depth, prefix, format, args);
-    va_end(args);
-    va_start(args, format);
-    write_log(log, 1, priority, code, depth, prefix, format, args);
+    write_log(log, priority, code, depth, prefix, format, &args);
     va_end(args);
     oskar_log_line(log, priority, ' ');
 }
@@ -202,7 +290,10 @@ char* oskar_log_file_data(oskar_Log* log, size_t* size)
         FILE* temp_handle = 0;
 
         /* Determine the current size of the file. */
+        LOG_LOCK;
+        if (log->async) drain_rings(log);
         fflush(log->file);
+        LOG_UNLOCK;
         temp_handle = fopen(log->name, "rb");
         if (temp_handle)
         {
@@ -245,38 +336,9 @@ void oskar_log_free(oskar_Log* log)
 }
 
 
-#ifdef OSKAR_OS_WIN
-/* http://stackoverflow.com/questions/15321493/how-should-i-pass-null-to-the-va-list-function-parameter */
-static va_list do_create_empty_va_list(int i, ...)
-{
-    va_list vl;
-    va_start(vl, i);
-    return vl;
-}
-static va_list create_empty_va_list()
-{
-    return do_create_empty_va_list(0);
-}
-#endif
-
 void oskar_log_line(oskar_Log* log, char priority, char symbol)
 {
-    const char code = symbol, *format = 0, *prefix = 0;
-    const int depth = OSKAR_LOG_LINE;
-#ifdef OSKAR_OS_WIN
-    {
-        va_list vl = create_empty_va_list();
-        write_log(log, 0, priority, code, depth, prefix, format, vl);
-        va_end(vl);
-    }
-    va_list vl = create_empty_va_list();
-    write_log(log, 1, priority, code, depth, prefix, format, vl);
-    va_end(vl);
-#else
-    va_list vl;
-    write_log(log, 0, priority, code, depth, prefix, format, vl);
-    write_log(log, 1, priority, code, depth, prefix, format, vl);
-#endif
+    write_log(log, priority, symbol, OSKAR_LOG_LINE, 0, 0, 0);
 }
 
 
@@ -286,10 +348,26 @@ void oskar_log_message(oskar_Log* log, char priority, int depth,
     va_list args;
     const char code = get_entry_code(priority), *prefix = 0;
     va_start(args, format);
-    write_log(log, 0, priority, code, depth, prefix, format, args);
+    write_log(log, priority, code, depth, prefix, format, &args);
     va_end(args);
+}
+
+
+void oskar_log_progress(oskar_Log* log, char priority, int depth,
+        double* last_time, const char* format, ...)
+{
+    va_list args;
+    const char code = get_entry_code(priority), *prefix = 0;
+    if (last_time)
+    {
+        const double now = oskar_log_timestamp();
+        const double interval = log ?
+                log->progress_interval : log_.progress_interval;
+        if (*last_time > 0.0 && now - *last_time < interval) return;
+        *last_time = now;
+    }
     va_start(args, format);
-    write_log(log, 1, priority, code, depth, prefix, format, args);
+    write_log(log, priority, code, depth, prefix, format, &args);
     va_end(args);
 }
 
@@ -301,10 +379,7 @@ void oskar_log_section(oskar_Log* log, char priority, const char* format, ...)
     const int depth = OSKAR_LOG_SECTION;
     oskar_log_line(log, priority, ' ');
     va_start(args, format);
-    write_log(log, 0, priority, code, depth, prefix, format, args);
-    va_end(args);
-    va_start(args, format);
-    write_log(log, 1, priority, code, depth, prefix, format, args);
+    write_log(log, priority, code, depth, prefix, format, &args);
     va_end(args);
     oskar_log_line(log, priority, ' ');
 }
@@ -318,10 +393,7 @@ void oskar_log_value(oskar_Log* log, char priority, int depth,
     /* Only depth codes > -1 are valid for value log entries */
     if (depth < -1) return;
     va_start(args, format);
-    write_log(log, 0, priority, code, depth, prefix, format, args);
-    va_end(args);
-    va_start(args, format);
-    write_log(log, 1, priority, code, depth, prefix, format, args);
+    write_log(log, priority, code, depth, prefix, format, &args);
     va_end(args);
 }
 
@@ -333,15 +405,77 @@ void oskar_log_warning(oskar_Log* log, const char* format, ...)
     const int depth = OSKAR_LOG_INFO_PREFIX;
     oskar_log_line(log, priority, ' ');
     va_start(args, format);
-    write_log(log, 0, priority, code, depth, prefix, format, args);
-    va_end(args);
-    va_start(args, format);
-    write_log(log, 1, priority, code, depth, prefix, format, args);
+    write_log(log, priority, code, depth, prefix, format, &args);
     va_end(args);
     oskar_log_line(log, priority, ' ');
 }
 
 
+static void sleep_ms(int ms)
+{
+#ifdef OSKAR_OS_WIN
+    Sleep(ms);
+#else
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000L;
+    nanosleep(&ts, 0);
+#endif
+}
+
+static void* drain_thread(void* arg)
+{
+    oskar_Log* log = (oskar_Log*) arg;
+    int stop = 0;
+    while (!stop)
+    {
+        LOG_LOCK;
+        stop = log->stop;
+        drain_rings(log);
+        LOG_UNLOCK;
+        if (!stop) sleep_ms(LOG_DRAIN_INTERVAL_MS);
+    }
+    return 0;
+}
+
+void oskar_log_set_async(oskar_Log* log, int value)
+{
+    int i;
+    if (!log) log = &log_;
+    value = value ? 1 : 0;
+    if (value == log->async) return;
+    if (value)
+    {
+        /* Make sure the header is written before any buffered entries. */
+        check_init(log);
+        LOG_LOCK;
+        log->async_id = ++async_counter_;
+        log->stop = 0;
+        LOG_UNLOCK;
+        log->drainer = oskar_thread_create(drain_thread, (void*)log, 0);
+        log->async = (log->drainer != 0);
+    }
+    else
+    {
+        /* Stop the drain thread, which writes any remaining entries. */
+        log->async = 0;
+        LOG_LOCK;
+        log->stop = 1;
+        LOG_UNLOCK;
+        oskar_thread_join(log->drainer);
+        oskar_thread_free(log->drainer);
+        log->drainer = 0;
+        LOG_LOCK;
+        drain_rings(log);
+        for (i = 0; i < log->num_rings; ++i) free(log->rings[i]);
+        free(log->rings);
+        log->rings = 0;
+        log->num_rings = 0;
+        log->async_id = 0;
+        LOG_UNLOCK;
+    }
+}
+
 void oskar_log_set_keep_file(oskar_Log* log, int value)
 {
     if (!log) log = &log_;
@@ -354,6 +488,12 @@ void oskar_log_set_file_priority(oskar_Log* log, int value)
     log->file_priority = value;
 }
 
+void oskar_log_set_progress_interval(oskar_Log* log, double value)
+{
+    if (!log) log = &log_;
+    log->progress_interval = value;
+}
+
 void oskar_log_set_term_priority(oskar_Log* log, int value)
 {
     if (!log) log = &log_;
@@ -367,18 +507,25 @@ void oskar_log_set_value_width(oskar_Log* log, int value)
 }
 
 
-void init_log(oskar_Log* log)
+/* Creates the log file, if this has not already been done.
+ * The standard header is written after the lock has been released. */
+static void check_init(oskar_Log* log)
 {
     struct tm* timeinfo;
-    size_t buf_len = 0;
-    char *current_dir = 0, fname1[120], time_str[120];
-    int i = 0, n = 0;
-    log->init = 1;
+    char fname1[120];
+    int i = 0, n = 0, created = 0;
+    if (LOAD_ACQUIRE(log->init)) return;
+    LOG_LOCK;
+    if (log->init)
+    {
+        LOG_UNLOCK;
+        return;
+    }
+    created = 1;
 
     /* Construct log file name root. */
     const time_t unix_time = time(NULL);
     timeinfo = localtime(&unix_time);
-    strftime(time_str, sizeof(time_str), "%Y-%m-%d, %H:%M:%S (%Z)", timeinfo);
     timeinfo->tm_mon += 1;
     timeinfo->tm_year += 1900;
     n = SNPRINTF(fname1, sizeof(fname1),
@@ -386,10 +533,10 @@ void init_log(oskar_Log* log)
             timeinfo->tm_year, timeinfo->tm_mon, timeinfo->tm_mday,
             timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
     if (n < 0 || n >= (int)sizeof(fname1))
-        return;
+        created = 0;
 
     /* Construct a unique log file name. */
-    do
+    if (created) do
     {
         ++i;
         if (i == 1)
@@ -401,7 +548,11 @@ void init_log(oskar_Log* log)
             n = SNPRINTF(log->name, sizeof(log->name), "%s_%d.log", fname1, i);
         }
         if (n < 0 || n >= (int)sizeof(log->name))
-            return;
+        {
+            log->name[0] = 0;
+            created = 0;
+            break;
+        }
         if (i > 1000)
         {
             log->name[0] = 0;
@@ -427,6 +578,21 @@ void init_log(oskar_Log* log)
             }
         }
     }
+    log->timestamp_start = oskar_log_timestamp();
+    STORE_RELEASE(log->init, 1);
+    LOG_UNLOCK;
+    if (created) write_header(log);
+}
+
+
+static void write_header(oskar_Log* log)
+{
+    struct tm* timeinfo;
+    size_t buf_len = 0;
+    char *current_dir = 0, time_str[120];
+    const time_t unix_time = time(NULL);
+    timeinfo = localtime(&unix_time);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d, %H:%M:%S (%Z)", timeinfo);
 
     /* Get the current working directory. */
 #ifdef OSKAR_OS_WIN
@@ -443,7 +609,6 @@ void init_log(oskar_Log* log)
 #endif
 
     /* Write standard header. */
-    log->timestamp_start = oskar_log_timestamp();
     if (log->write_header)
     {
         oskar_log_section(log, 'M', "OSKAR-%s starting at %s.",
@@ -458,32 +623,160 @@ void init_log(oskar_Log* log)
 }
 
 
-static void write_log(oskar_Log* log, int to_file, char priority, char code,
-        int depth, const char* prefix, const char* format, va_list args)
+/* Writes a formatted entry. Must be called with the log lock held. */
+static void output_entry(oskar_Log* log, const char* text,
+        int to_term, int to_file, int is_error)
+{
+    if (to_term) fputs(text, is_error ? stderr : stdout);
+    if (to_file && log->file) fputs(text, log->file);
+}
+
+static void flush_streams(oskar_Log* log)
+{
+    fflush(stdout);
+    fflush(stderr);
+    if (log->file) fflush(log->file);
+}
+
+/* Writes all buffered entries in time order.
+ * Must be called with the log lock held. */
+static void drain_rings(oskar_Log* log)
+{
+    int i, written = 0;
+    for (;;)
+    {
+        LogRing* next = 0;
+        const LogEntry* next_entry = 0;
+        for (i = 0; i < log->num_rings; ++i)
+        {
+            LogRing* ring = log->rings[i];
+            const size_t tail = ring->tail;
+            if (LOAD_ACQUIRE(ring->head) == tail) continue;
+            const LogEntry* e = &ring->entries[tail & (LOG_RING_SIZE - 1)];
+            if (!next_entry || e->time < next_entry->time)
+            {
+                next = ring;
+                next_entry = e;
+            }
+        }
+        if (!next) break;
+        output_entry(log, next_entry->text, next_entry->to_term,
+                next_entry->to_file, next_entry->is_error);
+        STORE_RELEASE(next->tail, next->tail + 1);
+        written = 1;
+    }
+    if (written) flush_streams(log);
+}
+
+/* Returns this thread's ring for the current asynchronous session,
+ * or NULL if it could not be allocated. */
+static LogRing* get_ring(oskar_Log* log)
+{
+    int i;
+    LogRing* ring = 0;
+    LogRing** rings = 0;
+    if (ring_log_ == log && ring_id_ == log->async_id) return ring_;
+    LOG_LOCK;
+    for (i = 0; i < log->num_rings; ++i)
+    {
+        if (log->rings[i]->owner == (const void*) &ring_)
+        {
+            ring = log->rings[i];
+            break;
+        }
+    }
+    if (!ring)
+    {
+        ring = (LogRing*) calloc(1, sizeof(LogRing));
+        if (ring)
+            rings = (LogRing**) realloc(log->rings,
+                    (log->num_rings + 1) * sizeof(LogRing*));
+        if (!rings)
+        {
+            LOG_UNLOCK;
+            free(ring);
+            return 0;
+        }
+        ring->owner = (const void*) &ring_;
+        log->rings = rings;
+        log->rings[log->num_rings++] = ring;
+    }
+    LOG_UNLOCK;
+    ring_ = ring;
+    ring_log_ = log;
+    ring_id_ = log->async_id;
+    return ring;
+}
+
+/* Formats an entry into this thread's ring, waiting if it is full.
+ * Returns 0 if the entry is too long to be buffered, once all earlier
+ * entries from this thread have been written, or if the thread has no ring
+ * and one could not be allocated. */
+static int write_async(oskar_Log* log, char priority, char code,
+        int depth, const char* prefix, const char* format, va_list* args,
+        int to_term, int to_file)
+{
+    LogRing* ring = get_ring(log);
+    if (!ring) return 0;
+    const size_t head = ring->head;
+    while (head - LOAD_ACQUIRE(ring->tail) >= LOG_RING_SIZE)
+        sleep_ms(1);
+    LogEntry* e = &ring->entries[head & (LOG_RING_SIZE - 1)];
+    const size_t len = format_entry(log, e->text, sizeof(e->text),
+            priority, code, depth, prefix, format, args);
+    if (len >= sizeof(e->text))
+    {
+        while (LOAD_ACQUIRE(ring->tail) != head)
+            sleep_ms(1);
+        return 0;
+    }
+    e->time = oskar_log_timestamp();
+    e->to_term = to_term;
+    e->to_file = to_file;
+    e->is_error = (priority == 'E');
+    STORE_RELEASE(ring->head, head + 1);
+    return 1;
+}
+
+static void write_log(oskar_Log* log, char priority, char code,
+        int depth, const char* prefix, const char* format, va_list* args)
 {
+    char buffer[LOG_ENTRY_SIZE], *text = buffer;
     if (!log) log = &log_;
 
     /* If both strings are NULL and not printing a line the entry is invalid */
     if (!format && !prefix && depth != OSKAR_LOG_LINE) return;
 
     /* Check if the log needs to be initialised. */
-    if (!log->init) init_log(log);
+    check_init(log);
+
+    /* Return early if the entry would not be written anywhere. */
     const int priority_level = log_priority_level(priority);
+    const int to_term = (priority_level <= log->term_priority);
+    const int to_file = (priority_level <= log->file_priority) && log->file;
+    if (!to_term && !to_file) return;
 
-    /* Write the entry to the terminal or log file. */
-    if (!to_file && (priority_level <= log->term_priority))
-    {
-        FILE* stream = (priority == 'E' ? stderr : stdout);
-        print_entry(log, stream,
-                priority, code, depth, prefix, format, args);
-        fflush(stream);
-    }
-    else if (to_file && (priority_level <= log->file_priority))
+    /* Buffer the entry if in asynchronous mode. */
+    if (log->async && write_async(log, priority, code, depth, prefix,
+            format, args, to_term, to_file))
+        return;
+
+    /* Otherwise format and write it now. */
+    const size_t len = format_entry(log, buffer, sizeof(buffer),
+            priority, code, depth, prefix, format, args);
+    if (len >= sizeof(buffer))
     {
-        print_entry(log, log->file,
+        text = (char*) malloc(len + 1);
+        if (!text) return;
+        format_entry(log, text, len + 1,
                 priority, code, depth, prefix, format, args);
-        fflush(log->file);
     }
+    LOG_LOCK;
+    output_entry(log, text, to_term, to_file, priority == 'E');
+    if (to_term) fflush(priority == 'E' ? stderr : stdout);
+    if (to_file) fflush(log->file);
+    LOG_UNLOCK;
+    if (text != buffer) free(text);
 }
 
 static char get_entry_code(char priority)
@@ -504,12 +797,49 @@ static char get_entry_code(char priority)
     return ' ';
 }
 
-static void print_entry(oskar_Log* log, FILE* stream, char priority, char code,
-        int depth, const char* prefix, const char* format, va_list args)
+/* Appends formatted text to a buffer. The length is always advanced by the
+ * full amount, so the required size is known if the buffer is too small. */
+static void append_v(char* buf, size_t size, size_t* len,
+        const char* format, va_list* args)
+{
+    int n;
+    va_list copy;
+    va_copy(copy, *args);
+    if (*len < size)
+        n = vsnprintf(buf + *len, size - *len, format, copy);
+    else
+        n = vsnprintf(0, 0, format, copy);
+    va_end(copy);
+    if (n > 0) *len += (size_t) n;
+}
+
+static void append(char* buf, size_t size, size_t* len,
+        const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    append_v(buf, size, len, format, &args);
+    va_end(args);
+}
+
+static void append_chars(char* buf, size_t size, size_t* len,
+        char c, int count)
 {
     int i;
-    if (!stream) return;
+    for (i = 0; i < count; ++i, ++(*len))
+        if (*len + 1 < size) buf[*len] = c;
+    if (size > 0) buf[*len < size ? *len : size - 1] = 0;
+}
+
+/* Formats a complete log entry, including the trailing newline, and
+ * returns its length. The output is truncated if it does not fit. */
+static size_t format_entry(const oskar_Log* log, char* buf, size_t size,
+        char priority, char code, int depth, const char* prefix,
+        const char* format, va_list* args)
+{
+    size_t len = 0;
     const int width = log->value_width;
+    if (size > 0) buf[0] = 0;
 
     /* Ensure code is a printable character. */
     if (code < 32) code += 48;
@@ -517,25 +847,26 @@ static void print_entry(oskar_Log* log, FILE* stream, char priority, char code,
     /* Check if depth signifies a line. */
     if (depth == OSKAR_LOG_LINE)
     {
-        fprintf(stream, "%c|", get_entry_code(priority));
-        for (i = 0; i < 67; ++i) fprintf(stream, "%c", code);
-        fprintf(stream, "\n");
-        return;
+        append(buf, size, &len, "%c|", get_entry_code(priority));
+        append_chars(buf, size, &len, code, 67);
+        append(buf, size, &len, "\n");
+        return len;
     }
 
     /* Print the message code. */
-    fprintf(stream, "%c|", code);
+    append(buf, size, &len, "%c|", code);
 
 #if WRITE_TIMESTAMP
     /* Print the timestamp. */
-    fprintf(stream, "%6.1f ", oskar_log_timestamp() - log->timestamp_start);
+    append(buf, size, &len, "%6.1f ",
+            oskar_log_timestamp() - log->timestamp_start);
 #endif
 
     /* Print leading whitespace and symbol for this depth. */
     if (depth >= 0) {
         char list_symbols[3] = {'+', '-', '*'};
-        for (i = 0; i < depth; ++i) fprintf(stream, "  ");
-        fprintf(stream, " %c ", list_symbols[depth % 3]);
+        append_chars(buf, size, &len, ' ', 2 * depth);
+        append(buf, size, &len, " %c ", list_symbols[depth % 3]);
     }
     else {
         /* Negative depth codes with special meaning */
@@ -545,8 +876,7 @@ static void print_entry(oskar_Log* log, FILE* stream, char priority, char code,
         case OSKAR_LOG_SECTION:
             break;
         default: /* Negative depth means no symbol. */
-            fprintf(stream, " ");
-            for (i = 0; i < abs(depth); ++i) fprintf(stream, "  ");
+            append_chars(buf, size, &len, ' ', 1 + 2 * abs(depth));
             break;
         }
     }
@@ -555,20 +885,21 @@ static void print_entry(oskar_Log* log, FILE* stream, char priority, char code,
     if (prefix && *prefix > 0)
     {
         /* Print prefix. */
-        fprintf(stream, "%s", prefix);
+        append(buf, size, &len, "%s", prefix);
 
         /* Print trailing whitespace if format string is present. */
         if (format && *format > 0)
         {
             const int n = abs(2 * depth + 4 + (int)strlen(prefix));
-            for (i = 0; i < width - n; ++i) fprintf(stream, " ");
-            if (depth != OSKAR_LOG_SECTION) fprintf(stream, ": ");
+            append_chars(buf, size, &len, ' ', width - n);
+            if (depth != OSKAR_LOG_SECTION) append(buf, size, &len, ": ");
         }
     }
 
     /* Print main message from format string and arguments. */
-    if (format && *format > 0) vfprintf(stream, format, args);
-    fprintf(stream, "\n");
+    if (format && *format > 0) append_v(buf, size, &len, format, args);
+    append(buf, size, &len, "\n");
+    return len;
 }
 
 /* Returns the enumerated priority level for the given message code.
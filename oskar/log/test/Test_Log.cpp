@@ -29,7 +29,11 @@
 #include <gtest/gtest.h>
 
 #include "log/oskar_log.h"
+#include "utility/oskar_thread.h"
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
 
 TEST(Log, oskar_log_message)
 {
@@ -122,3 +126,109 @@ TEST(Log, special_methods)
     oskar_log_section(log, 'W', "This is a warning section");
     oskar_log_section(log, 'D', "This is a debug section");
 }
+
+static const int num_log_threads = 4;
+static const int num_log_messages = 2000;
+
+struct LogThreadArgs
+{
+    oskar_Log* log;
+    int thread_id;
+};
+
+static void* log_thread(void* arg)
+{
+    LogThreadArgs* a = (LogThreadArgs*) arg;
+    for (int i = 0; i < num_log_messages; ++i)
+        oskar_log_message(a->log, 'M', 0, "thread %d message %d",
+                a->thread_id, i);
+    return 0;
+}
+
+TEST(Log, async)
+{
+    oskar_Log* log = oskar_log_create(OSKAR_LOG_MESSAGE, OSKAR_LOG_NONE);
+    oskar_log_set_keep_file(log, 0);
+    oskar_log_set_async(log, 1);
+    EXPECT_EQ(1, oskar_log_async(log));
+
+    // Write from several threads at once, so the rings fill up.
+    oskar_Thread* threads[num_log_threads];
+    LogThreadArgs args[num_log_threads];
+    for (int i = 0; i < num_log_threads; ++i)
+    {
+        args[i].log = log;
+        args[i].thread_id = i;
+        threads[i] = oskar_thread_create(log_thread, (void*)&args[i], 0);
+    }
+    for (int i = 0; i < num_log_threads; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+    }
+
+    // An entry too long to be buffered should still be written.
+    std::string long_message(1000, 'x');
+    oskar_log_message(log, 'M', 0, "%s", long_message.c_str());
+    oskar_log_set_async(log, 0);
+    EXPECT_EQ(0, oskar_log_async(log));
+
+    // Check every message was written once, in order for each thread.
+    size_t size = 0;
+    char* data = oskar_log_file_data(log, &size);
+    ASSERT_TRUE(data != 0);
+    int next[num_log_threads] = {0};
+    int thread_id = 0, message = 0;
+    for (char* line = strtok(data, "\n"); line; line = strtok(0, "\n"))
+    {
+        const char* p = strstr(line, "thread ");
+        if (p && sscanf(p, "thread %d message %d",
+                &thread_id, &message) == 2)
+        {
+            ASSERT_GE(thread_id, 0);
+            ASSERT_LT(thread_id, num_log_threads);
+            EXPECT_EQ(next[thread_id], message);
+            next[thread_id] = message + 1;
+        }
+    }
+    for (int i = 0; i < num_log_threads; ++i)
+        EXPECT_EQ(num_log_messages, next[i]);
+    free(data);
+
+    // The long entry was written after the async session ended,
+    // so read the file again.
+    data = oskar_log_file_data(log, &size);
+    ASSERT_TRUE(data != 0);
+    EXPECT_TRUE(strstr(data, long_message.c_str()) != 0);
+    free(data);
+    oskar_log_free(log);
+}
+
+TEST(Log, progress)
+{
+    oskar_Log* log = oskar_log_create(OSKAR_LOG_STATUS, OSKAR_LOG_NONE);
+    oskar_log_set_keep_file(log, 0);
+
+    // Only the first of these should be written.
+    double last = 0.0;
+    oskar_log_set_progress_interval(log, 1000.0);
+    for (int i = 0; i < 10; ++i)
+        oskar_log_progress(log, 'S', 1, &last, "slow progress %d", i);
+
+    // All of these should be written.
+    last = 0.0;
+    oskar_log_set_progress_interval(log, 0.0);
+    for (int i = 0; i < 10; ++i)
+        oskar_log_progress(log, 'S', 1, &last, "fast progress %d", i);
+
+    size_t size = 0;
+    char* data = oskar_log_file_data(log, &size);
+    ASSERT_TRUE(data != 0);
+    EXPECT_TRUE(strstr(data, "slow progress 0") != 0);
+    EXPECT_TRUE(strstr(data, "slow progress 1") == 0);
+    EXPECT_TRUE(strstr(data, "slow progress 9") == 0);
+    EXPECT_TRUE(strstr(data, "fast progress 0") != 0);
+    EXPECT_TRUE(strstr(data, "fast progress 9") != 0);
+    free(data);
+    oskar_log_free(log);
+}
@@ -81,3 +81,170 @@ OSKAR_REGISTER_KERNEL(NAME)
     KERNEL_LOOP_END\
 }\
 OSKAR_REGISTER_KERNEL(NAME)
+
+/* Vectorisable approximations to S = sin(X), C = cos(X).
+ * The argument is reduced to [-pi, pi] using a three-part (Cody-Waite)
+ * representation of 2 pi, and half of it is evaluated using Taylor series
+ * before applying the double-angle formulae. Over the reduced range,
+ * the absolute error is below 2e-15 (double) and 1e-6 (single precision).
+ * There are no branches or function calls, so loops using these macros
+ * can be vectorised by the compiler. */
+#define OSKAR_SINCOS_APPROX_double(X, S, C) {\
+    const double q_ = ((X) * 0.15915494309189535 + 6755399441055744.0) -\
+            6755399441055744.0;\
+    const double h_ = 0.5 * ((((X) - q_ * 6.2831853069365025) -\
+            q_ * 2.4308402025215864e-10) - q_ * 8.089064995183803e-21);\
+    const double h2_ = h_ * h_;\
+    const double s_ = h_ * (1.0 + h2_ * (-0.16666666666666666 +\
+            h2_ * (0.008333333333333333 + h2_ * (-0.0001984126984126984 +\
+            h2_ * (2.7557319223985893e-06 + h2_ * (-2.505210838544172e-08 +\
+            h2_ * (1.6059043836821613e-10 + h2_ * (-7.647163731819816e-13 +\
+            h2_ * (2.8114572543455206e-15 + h2_ * (-8.22063524662433e-18 +\
+            h2_ * 1.9572941063391263e-20))))))))));\
+    const double c_ = 1.0 + h2_ * (-0.5 + h2_ * (0.041666666666666664 +\
+            h2_ * (-0.001388888888888889 + h2_ * (2.48015873015873e-05 +\
+            h2_ * (-2.755731922398589e-07 + h2_ * (2.08767569878681e-09 +\
+            h2_ * (-1.1470745597729725e-11 + h2_ * (4.779477332387385e-14 +\
+            h2_ * (-1.5619206968586225e-16 +\
+            h2_ * 4.110317623312165e-19)))))))));\
+    S = 2.0 * s_ * c_;\
+    C = 1.0 - 2.0 * s_ * s_;\
+    }
+
+#define OSKAR_SINCOS_APPROX_float(X, S, C) {\
+    const float q_ = ((X) * 0.15915494f + 12582912.0f) - 12582912.0f;\
+    const float h_ = 0.5f * ((((X) - q_ * 6.28125f) -\
+            q_ * 0.0019350052f) - q_ * 3.0199161e-07f);\
+    const float h2_ = h_ * h_;\
+    const float s_ = h_ * (1.0f + h2_ * (-0.16666667f +\
+            h2_ * (0.0083333333f + h2_ * (-0.00019841270f +\
+            h2_ * (2.7557319e-06f + h2_ * -2.5052108e-08f)))));\
+    const float c_ = 1.0f + h2_ * (-0.5f + h2_ * (0.041666667f +\
+            h2_ * (-0.0013888889f + h2_ * (2.4801587e-05f +\
+            h2_ * (-2.7557319e-07f + h2_ * 2.0876757e-09f)))));\
+    S = 2.0f * s_ * c_;\
+    C = 1.0f - 2.0f * s_ * s_;\
+    }
+
+/* Number of output points in a tile, evaluated together as SIMD lanes. */
+#define OSKAR_DFT_C2R_TILE 16
+
+/* Number of tiles in a block, which share each chunk of input data. */
+#define OSKAR_DFT_C2R_NUM_TILES 8
+
+/* Number of input points in a chunk, sized so that they stay in L1 cache. */
+#define OSKAR_DFT_C2R_CHUNK 256
+
+/* Tiled CPU version, intended to be compiled as C.
+ * Output points are processed in blocks, in parallel. Each chunk of input
+ * points is weighted and loaded once for all the tiles in a block.
+ * For 2D transforms, tiles of output points that are evenly spaced along
+ * a row (as in an image) use a phase recurrence, so that only two sincos
+ * evaluations are needed per input point per tile. Otherwise, the phase
+ * of each output point in a tile is evaluated as one SIMD vector. */
+#define OSKAR_DFT_C2R_TILED_CPU(NAME, IS_3D, FP, FP2) KERNEL(NAME) (\
+        OSKAR_DFT_C2R_ARGS(FP, FP2))\
+{\
+    int i_block;\
+    const int block_size = OSKAR_DFT_C2R_TILE * OSKAR_DFT_C2R_NUM_TILES;\
+    const int num_blocks = (num_out + block_size - 1) / block_size;\
+    const FP eps = (FP) (sizeof(FP) == sizeof(float) ? 1.2e-7 : 2.3e-16);\
+    (void) max_in_chunk;\
+    DO_PRAGMA(omp parallel for schedule(dynamic))\
+    for (i_block = 0; i_block < num_blocks; ++i_block) {\
+        int i, j, k, t, regular[OSKAR_DFT_C2R_NUM_TILES];\
+        FP xo[OSKAR_DFT_C2R_TILE * OSKAR_DFT_C2R_NUM_TILES];\
+        FP yo[OSKAR_DFT_C2R_TILE * OSKAR_DFT_C2R_NUM_TILES];\
+        FP zo[OSKAR_DFT_C2R_TILE * OSKAR_DFT_C2R_NUM_TILES];\
+        FP out[OSKAR_DFT_C2R_TILE * OSKAR_DFT_C2R_NUM_TILES];\
+        FP dx[OSKAR_DFT_C2R_NUM_TILES];\
+        FP c_re[OSKAR_DFT_C2R_CHUNK], c_im[OSKAR_DFT_C2R_CHUNK];\
+        FP c_x[OSKAR_DFT_C2R_CHUNK], c_y[OSKAR_DFT_C2R_CHUNK];\
+        FP c_z[OSKAR_DFT_C2R_CHUNK];\
+        FP p_re[OSKAR_DFT_C2R_CHUNK], p_im[OSKAR_DFT_C2R_CHUNK];\
+        FP s_re[OSKAR_DFT_C2R_CHUNK], s_im[OSKAR_DFT_C2R_CHUNK];\
+        const int start = i_block * block_size;\
+        int num_block = num_out - start;\
+        if (num_block > block_size) num_block = block_size;\
+        /* Load the output coordinates, repeating the last if required. */\
+        for (k = 0; k < block_size; ++k) {\
+            const int o = offset_coord_out + start +\
+                    (k < num_block ? k : num_block - 1);\
+            xo[k] = wavenumber * x_out[o];\
+            yo[k] = wavenumber * y_out[o];\
+            zo[k] = IS_3D ? wavenumber * z_out[o] : (FP) 0;\
+            out[k] = (FP) 0;\
+        }\
+        /* Find tiles with points evenly spaced along a row. */\
+        for (t = 0; t < OSKAR_DFT_C2R_NUM_TILES; ++t) {\
+            const FP* x = xo + t * OSKAR_DFT_C2R_TILE;\
+            const FP* y = yo + t * OSKAR_DFT_C2R_TILE;\
+            const FP tol = 8 * eps * (fabs(x[0]) +\
+                    fabs(x[OSKAR_DFT_C2R_TILE - 1]));\
+            dx[t] = (x[OSKAR_DFT_C2R_TILE - 1] - x[0]) /\
+                    (OSKAR_DFT_C2R_TILE - 1);\
+            regular[t] = !(IS_3D) &&\
+                    (t + 1) * OSKAR_DFT_C2R_TILE <= num_block;\
+            for (k = 1; k < OSKAR_DFT_C2R_TILE && regular[t]; ++k)\
+                if (!(y[k] == y[0]) ||\
+                        !(fabs(x[k] - (x[0] + k * dx[t])) <= tol))\
+                    regular[t] = 0;\
+        }\
+        for (j = 0; j < num_in; j += OSKAR_DFT_C2R_CHUNK) {\
+            int chunk_size = num_in - j;\
+            if (chunk_size > OSKAR_DFT_C2R_CHUNK)\
+                chunk_size = OSKAR_DFT_C2R_CHUNK;\
+            /* Load and weight the input data for this chunk. */\
+            for (i = 0; i < chunk_size; ++i) {\
+                const FP w = weight_in[i + j];\
+                c_re[i] = w * data_in[i + j].x;\
+                c_im[i] = w * data_in[i + j].y;\
+                c_x[i] = x_in[i + j];\
+                c_y[i] = y_in[i + j];\
+                c_z[i] = IS_3D ? z_in[i + j] : (FP) 0;\
+            }\
+            for (t = 0; t * OSKAR_DFT_C2R_TILE < num_block; ++t) {\
+                const FP* RESTRICT x = xo + t * OSKAR_DFT_C2R_TILE;\
+                const FP* RESTRICT y = yo + t * OSKAR_DFT_C2R_TILE;\
+                const FP* RESTRICT z = zo + t * OSKAR_DFT_C2R_TILE;\
+                FP* RESTRICT o = out + t * OSKAR_DFT_C2R_TILE;\
+                if (regular[t]) {\
+                    /* Phasors at the first point, and step along the row. */\
+                    const FP step = dx[t];\
+                    for (i = 0; i < chunk_size; ++i) {\
+                        const FP a = -(x[0] * c_x[i] + y[0] * c_y[i]);\
+                        const FP b = -step * c_x[i];\
+                        OSKAR_SINCOS_APPROX_##FP(a, p_im[i], p_re[i])\
+                        OSKAR_SINCOS_APPROX_##FP(b, s_im[i], s_re[i])\
+                    }\
+                    for (i = 0; i < chunk_size; ++i) {\
+                        FP re = p_re[i], im = p_im[i];\
+                        const FP d_re = c_re[i], d_im = c_im[i];\
+                        const FP s_r = s_re[i], s_i = s_im[i];\
+                        for (k = 0; k < OSKAR_DFT_C2R_TILE; ++k) {\
+                            const FP tmp = re * s_r - im * s_i;\
+                            o[k] += d_re * re - d_im * im;\
+                            im = re * s_i + im * s_r;\
+                            re = tmp;\
+                        }\
+                    }\
+                }\
+                else {\
+                    for (i = 0; i < chunk_size; ++i) {\
+                        const FP u = c_x[i], v = c_y[i], w = c_z[i];\
+                        const FP d_re = c_re[i], d_im = c_im[i];\
+                        for (k = 0; k < OSKAR_DFT_C2R_TILE; ++k) {\
+                            FP re, im, a = x[k] * u + y[k] * v;\
+                            if (IS_3D) a += z[k] * w;\
+                            a = -a;\
+                            OSKAR_SINCOS_APPROX_##FP(a, im, re)\
+                            o[k] += d_re * re - d_im * im;\
+                        }\
+                    }\
+                }\
+            }\
+        }\
+        for (k = 0; k < num_block; ++k)\
+            output[offset_out + start + k] = out[k];\
+    }\
+}
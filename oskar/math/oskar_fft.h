@@ -50,7 +50,11 @@ typedef struct oskar_FFT oskar_FFT;
  * @brief Create FFT plan.
  *
  * @details
- * Creates a plan for executing FFTs.
+ * Creates a plan for executing forward FFTs.
+ *
+ * On the CPU, 1D transforms are done in batches of contiguous arrays,
+ * and 2D transforms must be square. Rows, columns and batches are
+ * distributed between threads.
  *
  * @param[in] precision     Enumerated data type precision.
  * @param[in] location      Enumerated compute platform.
@@ -97,6 +101,19 @@ void oskar_fft_free(oskar_FFT* h);
 OSKAR_EXPORT
 void oskar_fft_set_ensure_consistent_norm(oskar_FFT* h, int value);
 
+/**
+ * @brief Sets the number of CPU threads used by the plan.
+ *
+ * @details
+ * Sets the number of threads used for transforms on the CPU.
+ * By default, all available cores are used.
+ *
+ * @param[in] h      Handle to FFT plan.
+ * @param[in] value  Number of threads (if < 1, use all cores).
+ */
+OSKAR_EXPORT
+void oskar_fft_set_num_threads(oskar_FFT* h, int value);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_FFT_CPU_H_
+#define OSKAR_PRIVATE_FFT_CPU_H_
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_FFTCPU;
+typedef struct oskar_FFTCPU oskar_FFTCPU;
+
+/**
+ * @brief Creates a plan for forward complex FFTs of a given length on the CPU.
+ *
+ * @details
+ * The length is factorised into radix-4, 2, 3 and 5 passes, with a generic
+ * pass for any other prime factor. Twiddle factors are computed once, in
+ * double precision, when the plan is created.
+ *
+ * @param[in] precision     Enumerated precision (OSKAR_SINGLE or OSKAR_DOUBLE).
+ * @param[in] n             Transform length.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+oskar_FFTCPU* oskar_fft_cpu_create(int precision, int n, int* status);
+
+/**
+ * @brief Performs a batch of unnormalised forward 1D transforms in-place.
+ *
+ * @details
+ * Transforms are contiguous in memory and are distributed between threads.
+ *
+ * @param[in] plan          Plan created by oskar_fft_cpu_create().
+ * @param[in] batch_size    Number of transforms.
+ * @param[in] scale         Factor by which to multiply the results.
+ * @param[in] num_threads   Number of threads to use.
+ * @param[in,out] data      Complex data to transform.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_fft_cpu_exec_1d(const oskar_FFTCPU* plan, int batch_size,
+        double scale, int num_threads, oskar_Mem* data, int* status);
+
+/**
+ * @brief Performs an unnormalised forward 2D transform of a square array.
+ *
+ * @details
+ * Rows are transformed in parallel. Columns are then gathered into
+ * contiguous tiles, transformed and written back, one tile per thread,
+ * so that each pass works on contiguous memory.
+ *
+ * @param[in] plan          Plan created by oskar_fft_cpu_create().
+ * @param[in] scale         Factor by which to multiply the results.
+ * @param[in] num_threads   Number of threads to use.
+ * @param[in,out] data      Complex data to transform (row-major, n * n).
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_fft_cpu_exec_2d(const oskar_FFTCPU* plan, double scale,
+        int num_threads, oskar_Mem* data, int* status);
+
+/**
+ * @brief Frees a plan created by oskar_fft_cpu_create().
+ */
+OSKAR_EXPORT
+void oskar_fft_cpu_free(oskar_FFTCPU* plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_PRIVATE_FFT_CPU_H_ */
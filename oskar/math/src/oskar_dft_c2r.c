@@ -31,10 +31,10 @@
 #include "utility/oskar_device.h"
 #include "utility/oskar_kernel_macros.h"
 
-OSKAR_DFT_C2R_CPU(dft_c2r_2d_float, 0, float, float2)
-OSKAR_DFT_C2R_CPU(dft_c2r_3d_float, 1, float, float2)
-OSKAR_DFT_C2R_CPU(dft_c2r_2d_double, 0, double, double2)
-OSKAR_DFT_C2R_CPU(dft_c2r_3d_double, 1, double, double2)
+OSKAR_DFT_C2R_TILED_CPU(dft_c2r_2d_float, 0, float, float2)
+OSKAR_DFT_C2R_TILED_CPU(dft_c2r_3d_float, 1, float, float2)
+OSKAR_DFT_C2R_TILED_CPU(dft_c2r_2d_double, 0, double, double2)
+OSKAR_DFT_C2R_TILED_CPU(dft_c2r_3d_double, 1, double, double2)
 
 static int oskar_int_range_clamp(int value, int minimum, int maximum)
 {
@@ -32,10 +32,9 @@
 
 #include "log/oskar_log.h"
 #include "math/oskar_fft.h"
-#include "math/oskar_fftpack_cfft.h"
-#include "math/oskar_fftpack_cfft_f.h"
+#include "math/private_fft_cpu.h"
+#include "utility/oskar_get_num_procs.h"
 
-#include <math.h>
 #include <stdlib.h>
 
 #ifdef __cplusplus
@@ -45,8 +44,9 @@ extern "C" {
 struct oskar_FFT
 {
     size_t num_cells_total;
-    oskar_Mem *fftpack_work, *fftpack_wsave;
-    int precision, location, num_dim, dim_size, ensure_consistent_norm;
+    oskar_FFTCPU* cpu_plan;
+    int precision, location, num_dim, dim_size, batch_size_1d;
+    int ensure_consistent_norm, num_threads;
 #ifdef OSKAR_HAVE_CUDA
     cufftHandle cufft_plan;
 #endif
@@ -106,38 +106,23 @@ oskar_FFT* oskar_fft_create(int precision, int location, int num_dim,
     h->location = location;
     h->num_dim = num_dim;
     h->dim_size = dim_size;
+    h->batch_size_1d = batch_size_1d > 0 ? batch_size_1d : 1;
     h->ensure_consistent_norm = 1;
+    h->num_threads = oskar_get_num_procs();
     h->num_cells_total = (size_t) dim_size;
     for (i = 1; i < num_dim; ++i) h->num_cells_total *= (size_t) dim_size;
     if (location == OSKAR_CPU || (location & OSKAR_CL))
     {
-        int len = 4 * dim_size +
-                2 * (int)(log((double)dim_size) / log(2.0)) + 8;
         if (location & OSKAR_CL)
         {
             h->location = OSKAR_CPU;
             oskar_log_warning(0,
                     "OpenCL FFT not implemented; using CPU version instead.");
         }
-        h->fftpack_wsave = oskar_mem_create(precision, OSKAR_CPU, len, status);
-        if (num_dim == 1)
-        {
-            (void) batch_size_1d;
-            *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
-        }
-        else if (num_dim == 2)
-        {
-            if (precision == OSKAR_DOUBLE)
-                oskar_fftpack_cfft2i(dim_size, dim_size,
-                        oskar_mem_double(h->fftpack_wsave, status));
-            else
-                oskar_fftpack_cfft2i_f(dim_size, dim_size,
-                        oskar_mem_float(h->fftpack_wsave, status));
-        }
+        if (num_dim == 1 || num_dim == 2)
+            h->cpu_plan = oskar_fft_cpu_create(precision, dim_size, status);
         else
             *status = OSKAR_ERR_INVALID_ARGUMENT;
-        h->fftpack_work = oskar_mem_create(precision, OSKAR_CPU,
-                2 * h->num_cells_total, status);
     }
     else if (location == OSKAR_GPU)
     {
@@ -175,27 +160,18 @@ void oskar_fft_exec(oskar_FFT* h, oskar_Mem* data, int* status)
     }
     if (h->location == OSKAR_CPU)
     {
+        /* The CPU transforms are unnormalised, like those on the GPU.
+         * The normalisation is not needed for W-kernel generation,
+         * so in that case the result is divided by the number of cells. */
         if (h->num_dim == 1)
-        {
-            *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
-        }
+            oskar_fft_cpu_exec_1d(h->cpu_plan, h->batch_size_1d,
+                    h->ensure_consistent_norm ? 1.0 : 1.0 / h->dim_size,
+                    h->num_threads, data_ptr, status);
         else if (h->num_dim == 2)
-        {
-            if (h->precision == OSKAR_DOUBLE)
-                oskar_fftpack_cfft2f(h->dim_size, h->dim_size, h->dim_size,
-                        oskar_mem_double(data_ptr, status),
-                        oskar_mem_double(h->fftpack_wsave, status),
-                        oskar_mem_double(h->fftpack_work, status));
-            else
-                oskar_fftpack_cfft2f_f(h->dim_size, h->dim_size, h->dim_size,
-                        oskar_mem_float(data_ptr, status),
-                        oskar_mem_float(h->fftpack_wsave, status),
-                        oskar_mem_float(h->fftpack_work, status));
-            /* This step not needed for W-kernel generation, so turn it off. */
-            if (h->ensure_consistent_norm)
-                oskar_mem_scale_real(data_ptr, (double)h->num_cells_total,
-                        0, h->num_cells_total, status);
-        }
+            oskar_fft_cpu_exec_2d(h->cpu_plan,
+                    h->ensure_consistent_norm ? 1.0 :
+                            1.0 / (double)h->num_cells_total,
+                    h->num_threads, data_ptr, status);
     }
     else if (h->location == OSKAR_GPU)
     {
@@ -227,10 +203,8 @@ void oskar_fft_exec(oskar_FFT* h, oskar_Mem* data, int* status)
 
 void oskar_fft_free(oskar_FFT* h)
 {
-    int status = 0;
     if (!h) return;
-    oskar_mem_free(h->fftpack_work, &status);
-    oskar_mem_free(h->fftpack_wsave, &status);
+    oskar_fft_cpu_free(h->cpu_plan);
 #ifdef OSKAR_HAVE_CUDA
     if (h->location == OSKAR_GPU)
         cufftDestroy(h->cufft_plan);
@@ -243,6 +217,11 @@ void oskar_fft_set_ensure_consistent_norm(oskar_FFT* h, int value)
     h->ensure_consistent_norm = value;
 }
 
+void oskar_fft_set_num_threads(oskar_FFT* h, int value)
+{
+    h->num_threads = value > 0 ? value : oskar_get_num_procs();
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,486 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "math/private_fft_cpu.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_vector_types.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_STAGES 64
+#define TILE_SIZE 16
+#define SIN_60 0.86602540378443864676372317075294
+#define COS_72 0.30901699437494742410229341718282
+#define SIN_72 0.95105651629515357211643933337938
+#define COS_144 -0.80901699437494742410229341718282
+#define SIN_144 0.58778525229247312916870595463907
+
+struct oskar_FFTCPU
+{
+    int precision, n, num_stages, max_radix;
+    int radix[MAX_STAGES];
+    size_t twiddle_offset[MAX_STAGES], root_offset[MAX_STAGES];
+    oskar_Mem *twiddles, *roots;
+};
+
+/*
+ * Each pass is one stage of a mixed-radix Stockham autosort FFT.
+ * The input (y) is viewed as l_star columns of length r * p, and the
+ * output (x) as l_star * p columns of length r. The inner loops run over
+ * contiguous elements, so they can be vectorised by the compiler.
+ * Input and output alternate between the data and a work buffer,
+ * so no bit-reversal permutation is needed.
+ */
+
+#define CMUL(A, B, OUT) {\
+        OUT.x = A.x * B.x - A.y * B.y;\
+        OUT.y = A.x * B.y + A.y * B.x; }
+
+#define FFT_PASS(FP, FP2) {\
+    int j, k, s, t;\
+    const size_t xs = (size_t) l_star * r;\
+    for (j = 0; j < l_star; ++j) {\
+        const FP2* w = tw + (size_t) j * (p - 1);\
+        const FP2* yj = y + (size_t) j * r * p;\
+        FP2* xj = x + (size_t) j * r;\
+        if (p == 2) {\
+            for (k = 0; k < r; ++k) {\
+                FP2 a1;\
+                const FP2 a0 = yj[k];\
+                CMUL(w[0], yj[r + k], a1)\
+                xj[k].x = a0.x + a1.x; xj[k].y = a0.y + a1.y;\
+                xj[xs + k].x = a0.x - a1.x; xj[xs + k].y = a0.y - a1.y;\
+            }\
+        }\
+        else if (p == 3) {\
+            for (k = 0; k < r; ++k) {\
+                FP2 a1, a2, t1, t2, t3;\
+                const FP2 a0 = yj[k];\
+                CMUL(w[0], yj[r + k], a1)\
+                CMUL(w[1], yj[2 * r + k], a2)\
+                t1.x = a1.x + a2.x; t1.y = a1.y + a2.y;\
+                t2.x = a0.x - (FP)0.5 * t1.x; t2.y = a0.y - (FP)0.5 * t1.y;\
+                t3.x = (FP)SIN_60 * (a1.y - a2.y);\
+                t3.y = -(FP)SIN_60 * (a1.x - a2.x);\
+                xj[k].x = a0.x + t1.x; xj[k].y = a0.y + t1.y;\
+                xj[xs + k].x = t2.x + t3.x; xj[xs + k].y = t2.y + t3.y;\
+                xj[2 * xs + k].x = t2.x - t3.x;\
+                xj[2 * xs + k].y = t2.y - t3.y;\
+            }\
+        }\
+        else if (p == 4) {\
+            for (k = 0; k < r; ++k) {\
+                FP2 a1, a2, a3, t0, t1, t2, t3;\
+                const FP2 a0 = yj[k];\
+                CMUL(w[0], yj[r + k], a1)\
+                CMUL(w[1], yj[2 * r + k], a2)\
+                CMUL(w[2], yj[3 * r + k], a3)\
+                t0.x = a0.x + a2.x; t0.y = a0.y + a2.y;\
+                t1.x = a0.x - a2.x; t1.y = a0.y - a2.y;\
+                t2.x = a1.x + a3.x; t2.y = a1.y + a3.y;\
+                t3.x = a1.y - a3.y; t3.y = a3.x - a1.x;\
+                xj[k].x = t0.x + t2.x; xj[k].y = t0.y + t2.y;\
+                xj[xs + k].x = t1.x + t3.x; xj[xs + k].y = t1.y + t3.y;\
+                xj[2 * xs + k].x = t0.x - t2.x;\
+                xj[2 * xs + k].y = t0.y - t2.y;\
+                xj[3 * xs + k].x = t1.x - t3.x;\
+                xj[3 * xs + k].y = t1.y - t3.y;\
+            }\
+        }\
+        else if (p == 5) {\
+            for (k = 0; k < r; ++k) {\
+                FP2 a1, a2, a3, a4, b1, b2, d1, d2, t1, t2, m1, m2;\
+                const FP2 a0 = yj[k];\
+                CMUL(w[0], yj[r + k], a1)\
+                CMUL(w[1], yj[2 * r + k], a2)\
+                CMUL(w[2], yj[3 * r + k], a3)\
+                CMUL(w[3], yj[4 * r + k], a4)\
+                b1.x = a1.x + a4.x; b1.y = a1.y + a4.y;\
+                b2.x = a2.x + a3.x; b2.y = a2.y + a3.y;\
+                d1.x = a1.x - a4.x; d1.y = a1.y - a4.y;\
+                d2.x = a2.x - a3.x; d2.y = a2.y - a3.y;\
+                t1.x = a0.x + (FP)COS_72 * b1.x + (FP)COS_144 * b2.x;\
+                t1.y = a0.y + (FP)COS_72 * b1.y + (FP)COS_144 * b2.y;\
+                t2.x = a0.x + (FP)COS_144 * b1.x + (FP)COS_72 * b2.x;\
+                t2.y = a0.y + (FP)COS_144 * b1.y + (FP)COS_72 * b2.y;\
+                m1.x = (FP)SIN_72 * d1.y + (FP)SIN_144 * d2.y;\
+                m1.y = -(FP)SIN_72 * d1.x - (FP)SIN_144 * d2.x;\
+                m2.x = (FP)SIN_144 * d1.y - (FP)SIN_72 * d2.y;\
+                m2.y = -(FP)SIN_144 * d1.x + (FP)SIN_72 * d2.x;\
+                xj[k].x = a0.x + b1.x + b2.x; xj[k].y = a0.y + b1.y + b2.y;\
+                xj[xs + k].x = t1.x + m1.x; xj[xs + k].y = t1.y + m1.y;\
+                xj[2 * xs + k].x = t2.x + m2.x;\
+                xj[2 * xs + k].y = t2.y + m2.y;\
+                xj[3 * xs + k].x = t2.x - m2.x;\
+                xj[3 * xs + k].y = t2.y - m2.y;\
+                xj[4 * xs + k].x = t1.x - m1.x;\
+                xj[4 * xs + k].y = t1.y - m1.y;\
+            }\
+        }\
+        else {\
+            for (k = 0; k < r; ++k) {\
+                scratch[0] = yj[k];\
+                for (s = 1; s < p; ++s)\
+                    CMUL(w[s - 1], yj[s * r + k], scratch[s])\
+                for (t = 0; t < p; ++t) {\
+                    int idx = 0;\
+                    FP2 sum, v;\
+                    sum.x = sum.y = (FP) 0;\
+                    for (s = 0; s < p; ++s) {\
+                        CMUL(roots[idx], scratch[s], v)\
+                        sum.x += v.x; sum.y += v.y;\
+                        idx += t; if (idx >= p) idx -= p;\
+                    }\
+                    xj[t * xs + k] = sum;\
+                }\
+            }\
+        }\
+    }\
+    }
+
+static void pass_f(int p, int l_star, int r, const float2* tw,
+        const float2* roots, const float2* y, float2* x, float2* scratch)
+FFT_PASS(float, float2)
+
+static void pass_d(int p, int l_star, int r, const double2* tw,
+        const double2* roots, const double2* y, double2* x, double2* scratch)
+FFT_PASS(double, double2)
+
+#define FFT_ROW(FP2, PASS) {\
+    int i, l_star = 1, r = plan->n;\
+    FP2 *y = data, *x = work, *tmp;\
+    const FP2* tw = (const FP2*) oskar_mem_void_const(plan->twiddles);\
+    const FP2* roots = (const FP2*) oskar_mem_void_const(plan->roots);\
+    for (i = 0; i < plan->num_stages; ++i) {\
+        const int p = plan->radix[i];\
+        r /= p;\
+        PASS(p, l_star, r, tw + plan->twiddle_offset[i],\
+                roots + plan->root_offset[i], y, x, scratch);\
+        l_star *= p;\
+        tmp = y; y = x; x = tmp;\
+    }\
+    if (y != data) memcpy(data, y, plan->n * sizeof(FP2));\
+    }
+
+static void fft_row_f(const oskar_FFTCPU* plan, float2* data, float2* work,
+        float2* scratch)
+FFT_ROW(float2, pass_f)
+
+static void fft_row_d(const oskar_FFTCPU* plan, double2* data, double2* work,
+        double2* scratch)
+FFT_ROW(double2, pass_d)
+
+/* Transforms one row of a batch, and scales it. */
+#define FFT_BATCH_ROW(FP, FP2, ROW) {\
+        int k;\
+        FP2* row = data + (size_t) b * n;\
+        ROW(plan, row, work, work + n);\
+        if (scale != 1.0)\
+            for (k = 0; k < n; ++k) {\
+                row[k].x *= (FP) scale; row[k].y *= (FP) scale;\
+            }\
+    }
+
+/* Gathers a tile of columns into rows, transforms and scatters them. */
+#define FFT_TILE(FP, FP2, ROW) {\
+        int b, k;\
+        const int c0 = c * TILE_SIZE;\
+        const int nc = (n - c0 < TILE_SIZE) ? n - c0 : TILE_SIZE;\
+        FP2* tile = work + n + plan->max_radix;\
+        for (k = 0; k < n; ++k) {\
+            const FP2* in = data + (size_t) k * n + c0;\
+            for (b = 0; b < nc; ++b) tile[(size_t) b * n + k] = in[b];\
+        }\
+        for (b = 0; b < nc; ++b)\
+            ROW(plan, tile + (size_t) b * n, work, work + n);\
+        for (k = 0; k < n; ++k) {\
+            FP2* out = data + (size_t) k * n + c0;\
+            for (b = 0; b < nc; ++b) {\
+                out[b].x = (FP) scale * tile[(size_t) b * n + k].x;\
+                out[b].y = (FP) scale * tile[(size_t) b * n + k].y;\
+            }\
+        }\
+    }
+
+static int thread_index(void)
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/* Allocates one slice of work space for each thread. */
+static void* work_create(size_t slice_size, int num_threads, int* status)
+{
+    void* work = malloc(slice_size * num_threads);
+    if (!work) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    return work;
+}
+
+static void exec_1d_f(const oskar_FFTCPU* plan, int batch_size, double scale,
+        int num_threads, float2* data, int* status)
+{
+    int b;
+    const int n = plan->n;
+    const size_t slice = (size_t) n + plan->max_radix;
+    float2* work_all = (float2*) work_create(
+            slice * sizeof(float2), num_threads, status);
+    if (!work_all) return;
+#pragma omp parallel num_threads(num_threads)
+    {
+        float2* work = work_all + slice * thread_index();
+#pragma omp for schedule(static)
+        for (b = 0; b < batch_size; ++b)
+            FFT_BATCH_ROW(float, float2, fft_row_f)
+    }
+    free(work_all);
+}
+
+static void exec_1d_d(const oskar_FFTCPU* plan, int batch_size, double scale,
+        int num_threads, double2* data, int* status)
+{
+    int b;
+    const int n = plan->n;
+    const size_t slice = (size_t) n + plan->max_radix;
+    double2* work_all = (double2*) work_create(
+            slice * sizeof(double2), num_threads, status);
+    if (!work_all) return;
+#pragma omp parallel num_threads(num_threads)
+    {
+        double2* work = work_all + slice * thread_index();
+#pragma omp for schedule(static)
+        for (b = 0; b < batch_size; ++b)
+            FFT_BATCH_ROW(double, double2, fft_row_d)
+    }
+    free(work_all);
+}
+
+static void exec_2d_f(const oskar_FFTCPU* plan, double scale,
+        int num_threads, float2* data, int* status)
+{
+    int i, c;
+    const int n = plan->n;
+    const int num_tiles = (n + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t slice = n + plan->max_radix + TILE_SIZE * (size_t) n;
+    float2* work_all = (float2*) work_create(
+            slice * sizeof(float2), num_threads, status);
+    if (!work_all) return;
+#pragma omp parallel num_threads(num_threads)
+    {
+        float2* work = work_all + slice * thread_index();
+#pragma omp for schedule(static)
+        for (i = 0; i < n; ++i)
+            fft_row_f(plan, data + (size_t) i * n, work, work + n);
+#pragma omp for schedule(static)
+        for (c = 0; c < num_tiles; ++c)
+            FFT_TILE(float, float2, fft_row_f)
+    }
+    free(work_all);
+}
+
+static void exec_2d_d(const oskar_FFTCPU* plan, double scale,
+        int num_threads, double2* data, int* status)
+{
+    int i, c;
+    const int n = plan->n;
+    const int num_tiles = (n + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t slice = n + plan->max_radix + TILE_SIZE * (size_t) n;
+    double2* work_all = (double2*) work_create(
+            slice * sizeof(double2), num_threads, status);
+    if (!work_all) return;
+#pragma omp parallel num_threads(num_threads)
+    {
+        double2* work = work_all + slice * thread_index();
+#pragma omp for schedule(static)
+        for (i = 0; i < n; ++i)
+            fft_row_d(plan, data + (size_t) i * n, work, work + n);
+#pragma omp for schedule(static)
+        for (c = 0; c < num_tiles; ++c)
+            FFT_TILE(double, double2, fft_row_d)
+    }
+    free(work_all);
+}
+
+oskar_FFTCPU* oskar_fft_cpu_create(int precision, int n, int* status)
+{
+    int i, m, s;
+    size_t num_twiddles = 0, num_roots = 0;
+    oskar_FFTCPU* plan = 0;
+    if (*status) return 0;
+    if (n < 1 || (precision != OSKAR_SINGLE && precision != OSKAR_DOUBLE))
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+    plan = (oskar_FFTCPU*) calloc(1, sizeof(oskar_FFTCPU));
+    if (!plan)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    plan->precision = precision;
+    plan->n = n;
+    plan->max_radix = 1;
+
+    /* Factorise the length, using radix-4 passes where possible. */
+    for (m = n; m > 1 && plan->num_stages < MAX_STAGES;)
+    {
+        int p = 2;
+        if (m % 4 == 0) p = 4;
+        else if (m % 2 == 0) p = 2;
+        else if (m % 3 == 0) p = 3;
+        else
+        {
+            for (p = 5; p * p <= m; p += 2)
+                if (m % p == 0) break;
+            if (p * p > m) p = m;
+        }
+        plan->radix[plan->num_stages] = p;
+        plan->twiddle_offset[plan->num_stages] = num_twiddles;
+        plan->root_offset[plan->num_stages] = num_roots;
+        num_twiddles += (size_t) (n / m) * (p - 1);
+        num_roots += (size_t) p;
+        if (p > plan->max_radix) plan->max_radix = p;
+        plan->num_stages++;
+        m /= p;
+    }
+
+    /* Compute twiddle factors and roots of unity in double precision. */
+    plan->twiddles = oskar_mem_create(precision | OSKAR_COMPLEX, OSKAR_CPU,
+            num_twiddles > 0 ? num_twiddles : 1, status);
+    plan->roots = oskar_mem_create(precision | OSKAR_COMPLEX, OSKAR_CPU,
+            num_roots > 0 ? num_roots : 1, status);
+    if (*status)
+    {
+        oskar_fft_cpu_free(plan);
+        return 0;
+    }
+    for (s = 0, m = 1; s < plan->num_stages; ++s)
+    {
+        int j;
+        const int p = plan->radix[s];
+        const double two_pi = 2.0 * M_PI;
+        for (j = 0; j < m; ++j)
+        {
+            for (i = 1; i < p; ++i)
+            {
+                const size_t idx = plan->twiddle_offset[s] +
+                        (size_t) j * (p - 1) + (i - 1);
+                const double arg = -two_pi * j * i / (double) (m * p);
+                if (precision == OSKAR_DOUBLE)
+                {
+                    double2* tw = oskar_mem_double2(plan->twiddles, status);
+                    tw[idx].x = cos(arg);
+                    tw[idx].y = sin(arg);
+                }
+                else
+                {
+                    float2* tw = oskar_mem_float2(plan->twiddles, status);
+                    tw[idx].x = (float) cos(arg);
+                    tw[idx].y = (float) sin(arg);
+                }
+            }
+        }
+        for (i = 0; i < p; ++i)
+        {
+            const size_t idx = plan->root_offset[s] + i;
+            const double arg = -two_pi * i / (double) p;
+            if (precision == OSKAR_DOUBLE)
+            {
+                double2* roots = oskar_mem_double2(plan->roots, status);
+                roots[idx].x = cos(arg);
+                roots[idx].y = sin(arg);
+            }
+            else
+            {
+                float2* roots = oskar_mem_float2(plan->roots, status);
+                roots[idx].x = (float) cos(arg);
+                roots[idx].y = (float) sin(arg);
+            }
+        }
+        m *= p;
+    }
+    return plan;
+}
+
+void oskar_fft_cpu_exec_1d(const oskar_FFTCPU* plan, int batch_size,
+        double scale, int num_threads, oskar_Mem* data, int* status)
+{
+    if (*status) return;
+    if (oskar_mem_location(data) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_length(data) < (size_t) plan->n * batch_size)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (batch_size < num_threads) num_threads = batch_size;
+    if (num_threads < 1) num_threads = 1;
+    if (oskar_mem_type(data) == OSKAR_DOUBLE_COMPLEX &&
+            plan->precision == OSKAR_DOUBLE)
+        exec_1d_d(plan, batch_size, scale, num_threads,
+                oskar_mem_double2(data, status), status);
+    else if (oskar_mem_type(data) == OSKAR_SINGLE_COMPLEX &&
+            plan->precision == OSKAR_SINGLE)
+        exec_1d_f(plan, batch_size, scale, num_threads,
+                oskar_mem_float2(data, status), status);
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+void oskar_fft_cpu_exec_2d(const oskar_FFTCPU* plan, double scale,
+        int num_threads, oskar_Mem* data, int* status)
+{
+    if (*status) return;
+    if (oskar_mem_location(data) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_length(data) < (size_t) plan->n * plan->n)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (plan->n < num_threads) num_threads = plan->n;
+    if (num_threads < 1) num_threads = 1;
+    if (oskar_mem_type(data) == OSKAR_DOUBLE_COMPLEX &&
+            plan->precision == OSKAR_DOUBLE)
+        exec_2d_d(plan, scale, num_threads,
+                oskar_mem_double2(data, status), status);
+    else if (oskar_mem_type(data) == OSKAR_SINGLE_COMPLEX &&
+            plan->precision == OSKAR_SINGLE)
+        exec_2d_f(plan, scale, num_threads,
+                oskar_mem_float2(data, status), status);
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+void oskar_fft_cpu_free(oskar_FFTCPU* plan)
+{
+    int status = 0;
+    if (!plan) return;
+    oskar_mem_free(plan->twiddles, &status);
+    oskar_mem_free(plan->roots, &status);
+    free(plan);
+}
+
+#ifdef __cplusplus
+}
+#endif
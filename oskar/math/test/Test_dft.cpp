@@ -150,3 +150,97 @@ TEST(dft, c2r)
     oskar_mem_free(v, &status);
     oskar_mem_free(w, &status);
 }
+
+static void check_c2r_accuracy(int type, int side, int is_3d, double tol)
+{
+    int status = 0;
+    const int num_in = 1000;
+    const int num_out = side * side;
+    const double wavenumber = 2.0 * M_PI;
+    const double fov = 10.0 * M_PI / 180.0;
+
+    // Generate input data, with an image grid for output points.
+    oskar_Mem *l = oskar_mem_create(type, OSKAR_CPU, num_out, &status);
+    oskar_Mem *m = oskar_mem_create(type, OSKAR_CPU, num_out, &status);
+    oskar_Mem *n = oskar_mem_create(type, OSKAR_CPU, num_out, &status);
+    oskar_Mem *u = oskar_mem_create(type, OSKAR_CPU, num_in, &status);
+    oskar_Mem *v = oskar_mem_create(type, OSKAR_CPU, num_in, &status);
+    oskar_Mem *w = oskar_mem_create(type, OSKAR_CPU, num_in, &status);
+    oskar_Mem *amp = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_in, &status);
+    oskar_Mem *wt = oskar_mem_create(type, OSKAR_CPU, num_in, &status);
+    oskar_Mem *out = oskar_mem_create(type, OSKAR_CPU, num_out, &status);
+    oskar_evaluate_image_lmn_grid(side, side, fov, fov, 0, l, m, n, &status);
+    oskar_mem_add_real(n, -1.0, &status);
+    oskar_mem_random_range(u, -3000., 3000., &status);
+    oskar_mem_random_range(v, -3000., 3000., &status);
+    oskar_mem_random_range(w, -500., 500., &status);
+    oskar_mem_random_range(amp, -1., 1., &status);
+    oskar_mem_random_range(wt, 0., 1., &status);
+    oskar_dft_c2r(num_in, wavenumber, u, v, w, amp, wt, num_out,
+            l, m, is_3d ? n : 0, out, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare with a direct evaluation in double precision.
+    oskar_Mem *l_d = oskar_mem_convert_precision(l, OSKAR_DOUBLE, &status);
+    oskar_Mem *m_d = oskar_mem_convert_precision(m, OSKAR_DOUBLE, &status);
+    oskar_Mem *n_d = oskar_mem_convert_precision(n, OSKAR_DOUBLE, &status);
+    oskar_Mem *u_d = oskar_mem_convert_precision(u, OSKAR_DOUBLE, &status);
+    oskar_Mem *v_d = oskar_mem_convert_precision(v, OSKAR_DOUBLE, &status);
+    oskar_Mem *w_d = oskar_mem_convert_precision(w, OSKAR_DOUBLE, &status);
+    oskar_Mem *a_d = oskar_mem_convert_precision(amp, OSKAR_DOUBLE, &status);
+    oskar_Mem *wt_d = oskar_mem_convert_precision(wt, OSKAR_DOUBLE, &status);
+    oskar_Mem *out_d = oskar_mem_convert_precision(out, OSKAR_DOUBLE, &status);
+    const double *l_ = oskar_mem_double_const(l_d, &status);
+    const double *m_ = oskar_mem_double_const(m_d, &status);
+    const double *n_ = oskar_mem_double_const(n_d, &status);
+    const double *u_ = oskar_mem_double_const(u_d, &status);
+    const double *v_ = oskar_mem_double_const(v_d, &status);
+    const double *w_ = oskar_mem_double_const(w_d, &status);
+    const double *a_ = oskar_mem_double_const(a_d, &status);
+    const double *wt_ = oskar_mem_double_const(wt_d, &status);
+    const double *out_ = oskar_mem_double_const(out_d, &status);
+    double max_err = 0.0;
+    for (int j = 0; j < num_out; ++j)
+    {
+        double sum = 0.0;
+        for (int i = 0; i < num_in; ++i)
+        {
+            double phase = l_[j] * u_[i] + m_[j] * v_[i];
+            if (is_3d) phase += n_[j] * w_[i];
+            phase *= -wavenumber;
+            sum += wt_[i] * (a_[2*i] * cos(phase) - a_[2*i + 1] * sin(phase));
+        }
+        const double err = fabs(sum - out_[j]);
+        if (err > max_err) max_err = err;
+    }
+    EXPECT_LT(max_err, tol);
+
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    oskar_mem_free(n, &status);
+    oskar_mem_free(u, &status);
+    oskar_mem_free(v, &status);
+    oskar_mem_free(w, &status);
+    oskar_mem_free(amp, &status);
+    oskar_mem_free(wt, &status);
+    oskar_mem_free(out, &status);
+    oskar_mem_free(l_d, &status);
+    oskar_mem_free(m_d, &status);
+    oskar_mem_free(n_d, &status);
+    oskar_mem_free(u_d, &status);
+    oskar_mem_free(v_d, &status);
+    oskar_mem_free(w_d, &status);
+    oskar_mem_free(a_d, &status);
+    oskar_mem_free(wt_d, &status);
+    oskar_mem_free(out_d, &status);
+}
+
+TEST(dft, c2r_cpu_accuracy)
+{
+    // Odd sizes leave partial tiles and blocks.
+    check_c2r_accuracy(OSKAR_DOUBLE, 64, 0, 1e-10);
+    check_c2r_accuracy(OSKAR_DOUBLE, 37, 1, 1e-10);
+    check_c2r_accuracy(OSKAR_SINGLE, 64, 0, 5e-3);
+    check_c2r_accuracy(OSKAR_SINGLE, 37, 1, 5e-3);
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_cmath.h"
+#include "math/oskar_fft.h"
+#include "math/oskar_fftpack_cfft.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstdlib>
+#include <vector>
+
+static void fill_random(oskar_Mem* data, int* status)
+{
+    oskar_mem_random_range(data, -1.0, 1.0, status);
+}
+
+static double max_rel_diff(const oskar_Mem* a, const oskar_Mem* b)
+{
+    int status = 0;
+    const size_t n = 2 * oskar_mem_length(a);
+    oskar_Mem *a_d = oskar_mem_convert_precision(a, OSKAR_DOUBLE, &status);
+    oskar_Mem *b_d = oskar_mem_convert_precision(b, OSKAR_DOUBLE, &status);
+    const double *pa = oskar_mem_double_const(a_d, &status);
+    const double *pb = oskar_mem_double_const(b_d, &status);
+    double max_abs = 0.0, max_diff = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double d = fabs(pa[i] - pb[i]);
+        if (fabs(pb[i]) > max_abs) max_abs = fabs(pb[i]);
+        if (d > max_diff) max_diff = d;
+    }
+    oskar_mem_free(a_d, &status);
+    oskar_mem_free(b_d, &status);
+    return max_abs > 0.0 ? max_diff / max_abs : max_diff;
+}
+
+static void check_2d(int prec, int n, double tol)
+{
+    int status = 0;
+    const int type = prec | OSKAR_COMPLEX;
+    oskar_Mem* data = oskar_mem_create(type, OSKAR_CPU, n * n, &status);
+    fill_random(data, &status);
+
+    // Reference transform using FFTPACK, in double precision.
+    oskar_Mem* ref = oskar_mem_convert_precision(data, OSKAR_DOUBLE, &status);
+    const int len = 4 * n + 2 * (int)(log((double)n) / log(2.0)) + 8;
+    std::vector<double> wsave(len), work(2 * n * n);
+    oskar_fftpack_cfft2i(n, n, &wsave[0]);
+    oskar_fftpack_cfft2f(n, n, n, oskar_mem_double(ref, &status),
+            &wsave[0], &work[0]);
+    oskar_mem_scale_real(ref, (double)n * n, 0, n * n, &status);
+
+    // Transform using the CPU engine.
+    oskar_FFT* fft = oskar_fft_create(prec, OSKAR_CPU, 2, n, 0, &status);
+    oskar_fft_exec(fft, data, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(max_rel_diff(data, ref), tol) << "n = " << n;
+
+    oskar_fft_free(fft);
+    oskar_mem_free(data, &status);
+    oskar_mem_free(ref, &status);
+}
+
+TEST(fft, 2d_vs_fftpack)
+{
+    const int sizes[] = {1, 2, 6, 15, 49, 64, 100, 128, 210, 256, 360};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(int); ++i)
+    {
+        check_2d(OSKAR_DOUBLE, sizes[i], 1e-12);
+        check_2d(OSKAR_SINGLE, sizes[i], 1e-5);
+    }
+}
+
+TEST(fft, 1d_batch_vs_dft)
+{
+    int status = 0;
+    const int sizes[] = {1, 2, 3, 5, 8, 12, 17, 60, 97, 256};
+    const int batch_size = 7;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(int); ++s)
+    {
+        const int n = sizes[s];
+        oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+                n * batch_size, &status);
+        oskar_Mem* ref = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+                n * batch_size, &status);
+        fill_random(data, &status);
+        const double2* in = oskar_mem_double2_const(data, &status);
+        double2* out = oskar_mem_double2(ref, &status);
+        for (int b = 0; b < batch_size; ++b)
+        {
+            for (int k = 0; k < n; ++k)
+            {
+                double re = 0.0, im = 0.0;
+                for (int j = 0; j < n; ++j)
+                {
+                    const double arg = -2.0 * M_PI * (double)((long)j * k % n) / n;
+                    const double2 v = in[b * n + j];
+                    re += v.x * cos(arg) - v.y * sin(arg);
+                    im += v.x * sin(arg) + v.y * cos(arg);
+                }
+                out[b * n + k].x = re;
+                out[b * n + k].y = im;
+            }
+        }
+        oskar_FFT* fft = oskar_fft_create(OSKAR_DOUBLE, OSKAR_CPU, 1, n,
+                batch_size, &status);
+        oskar_fft_exec(fft, data, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_LT(max_rel_diff(data, ref), 1e-12) << "n = " << n;
+        oskar_fft_free(fft);
+        oskar_mem_free(data, &status);
+        oskar_mem_free(ref, &status);
+    }
+}
+
+TEST(fft, normalisation)
+{
+    int status = 0;
+    const int n = 30;
+    oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            n * n, &status);
+    fill_random(data, &status);
+    oskar_Mem* copy = oskar_mem_create_copy(data, OSKAR_CPU, &status);
+    oskar_FFT* fft = oskar_fft_create(OSKAR_DOUBLE, OSKAR_CPU, 2, n, 0,
+            &status);
+    oskar_fft_exec(fft, data, &status);
+    oskar_fft_set_ensure_consistent_norm(fft, 0);
+    oskar_fft_exec(fft, copy, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_mem_scale_real(copy, (double)n * n, 0, n * n, &status);
+    EXPECT_LT(max_rel_diff(copy, data), 1e-14);
+    oskar_fft_free(fft);
+    oskar_mem_free(data, &status);
+    oskar_mem_free(copy, &status);
+}
+
+TEST(fft, thread_count_independent)
+{
+    int status = 0;
+    const int n = 120;
+    oskar_Mem* data = oskar_mem_create(OSKAR_SINGLE_COMPLEX, OSKAR_CPU,
+            n * n, &status);
+    fill_random(data, &status);
+    oskar_Mem* copy = oskar_mem_create_copy(data, OSKAR_CPU, &status);
+    oskar_FFT* fft = oskar_fft_create(OSKAR_SINGLE, OSKAR_CPU, 2, n, 0,
+            &status);
+    oskar_fft_set_num_threads(fft, 1);
+    oskar_fft_exec(fft, data, &status);
+    oskar_fft_set_num_threads(fft, 4);
+    oskar_fft_exec(fft, copy, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0.0, max_rel_diff(copy, data));
+    oskar_fft_free(fft);
+    oskar_mem_free(data, &status);
+    oskar_mem_free(copy, &status);
+}
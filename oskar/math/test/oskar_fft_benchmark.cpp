@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "math/oskar_fft.h"
+#include "math/oskar_fftpack_cfft.h"
+#include "math/oskar_fftpack_cfft_f.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_fft_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-s", "Grid side length.", 1, "", true);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-nthreads", "Number of threads (default: all cores).",
+            1, "0", false);
+    opt.add_flag("-n", "Number of iterations", 1, "1", false);
+    opt.add_flag("-v", "Display verbose output.", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0;
+    const int n = opt.get_int("-s");
+    const int prec = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    const int num_threads = opt.get_int("-nthreads");
+    const int niter = opt.get_int("-n");
+    const size_t num_cells = (size_t) n * n;
+
+    // Create the grid and FFT plans.
+    oskar_Mem* grid = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_cells, &status);
+    oskar_mem_random_range(grid, -1.0, 1.0, &status);
+    oskar_FFT* fft = oskar_fft_create(prec, OSKAR_CPU, 2, n, 0, &status);
+    oskar_fft_set_num_threads(fft, num_threads);
+    const int len = 4 * n + 2 * (int)(log((double)n) / log(2.0)) + 8;
+    oskar_Mem* wsave = oskar_mem_create(prec, OSKAR_CPU, len, &status);
+    oskar_Mem* work = oskar_mem_create(prec, OSKAR_CPU, 2 * num_cells,
+            &status);
+    if (prec == OSKAR_DOUBLE)
+        oskar_fftpack_cfft2i(n, n, oskar_mem_double(wsave, &status));
+    else
+        oskar_fftpack_cfft2i_f(n, n, oskar_mem_float(wsave, &status));
+
+    // Time the transforms.
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(timer);
+    for (int i = 0; i < niter; ++i)
+        oskar_fft_exec(fft, grid, &status);
+    const double time_fft = oskar_timer_elapsed(timer) / niter;
+    oskar_timer_start(timer);
+    for (int i = 0; i < niter; ++i)
+    {
+        if (prec == OSKAR_DOUBLE)
+            oskar_fftpack_cfft2f(n, n, n, oskar_mem_double(grid, &status),
+                    oskar_mem_double(wsave, &status),
+                    oskar_mem_double(work, &status));
+        else
+            oskar_fftpack_cfft2f_f(n, n, n, oskar_mem_float(grid, &status),
+                    oskar_mem_float(wsave, &status),
+                    oskar_mem_float(work, &status));
+    }
+    const double time_fftpack = oskar_timer_elapsed(timer) / niter;
+
+    // Check for errors.
+    if (status)
+    {
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+
+    // Print results.
+    if (opt.is_set("-v"))
+    {
+        printf("- Grid size: %i x %i\n", n, n);
+        printf("- Precision: %s\n", (prec == OSKAR_SINGLE) ?
+                "single" : "double");
+        printf("==> FFT took %.4f sec (FFTPACK: %.4f sec)\n",
+                time_fft, time_fftpack);
+        printf("==> Speed-up over FFTPACK: %.2f\n", time_fftpack / time_fft);
+    }
+    else
+    {
+        printf("%f %f\n", time_fft, time_fftpack);
+    }
+
+    // Free memory.
+    oskar_timer_free(timer);
+    oskar_fft_free(fft);
+    oskar_mem_free(grid, &status);
+    oskar_mem_free(wsave, &status);
+    oskar_mem_free(work, &status);
+    return EXIT_SUCCESS;
+}
@@ -83,6 +83,37 @@ void oskar_binary_read_mem_ext(oskar_Binary* handle, oskar_Mem* mem,
         const char* name_group, const char* name_tag, int user_index,
         int* status);
 
+/**
+ * @brief
+ * Creates an OSKAR memory block that uses data in a memory-mapped file.
+ *
+ * @details
+ * This function returns a new CPU memory block that is an alias of the
+ * payload of the specified tag, if the binary file was opened in mode 'm'
+ * and the payload can be used in place (see oskar_binary_map_block()),
+ * so no data are copied.
+ *
+ * If the payload cannot be used in place, a null pointer is returned
+ * without setting an error, and the caller should use
+ * oskar_binary_read_mem() instead.
+ *
+ * The returned block must be freed using oskar_mem_free() before the
+ * binary file handle is freed.
+ *
+ * @param[in,out] handle   Binary file handle.
+ * @param[in] type         Type of the memory (as in oskar_Mem).
+ * @param[in] id_group     Tag group identifier.
+ * @param[in] id_tag       Tag identifier.
+ * @param[in] user_index   User-defined index.
+ * @param[in,out] status   Status return code.
+ *
+ * @return Alias of the mapped data, or NULL if not available.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_binary_map_mem(oskar_Binary* handle, int type,
+        unsigned char id_group, unsigned char id_tag, int user_index,
+        int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -91,6 +91,7 @@ enum OSKAR_MEM_LOCATION
 #include <mem/oskar_mem_load_ascii.h>
 #include <mem/oskar_mem_multiply.h>
 #include <mem/oskar_mem_normalise.h>
+#include <mem/oskar_mem_pool.h>
 #include <mem/oskar_mem_random_gaussian.h>
 #include <mem/oskar_mem_random_range.h>
 #include <mem/oskar_mem_random_uniform.h>
@@ -40,6 +40,8 @@
 extern "C" {
 #endif
 
+struct _cl_event;
+
 /**
  * @brief
  * Copies contents of a block of memory into another block of memory.
@@ -63,6 +65,41 @@ OSKAR_EXPORT
 void oskar_mem_copy_contents(oskar_Mem* dst, const oskar_Mem* src,
         size_t offset_dst, size_t offset_src, size_t num_elements, int* status);
 
+/**
+ * @brief
+ * Starts copying the contents of a block of memory into another block.
+ *
+ * @details
+ * This function copies data held in one structure to another structure at a
+ * specified element offset, as oskar_mem_copy_contents(), but transfers
+ * to, from or between OpenCL buffers are enqueued on the transfer queue
+ * of the current device without blocking the host.
+ * The copy does not start until all events in \p wait_events have completed.
+ *
+ * If \p event is not NULL, it returns an event which completes when the
+ * copy has finished. Host memory used in the copy must not be accessed
+ * or freed until then. The event must be released using
+ * oskar_device_events_release() or one of the wait functions.
+ *
+ * Copies that do not involve an OpenCL buffer are done immediately,
+ * and the returned event is NULL.
+ *
+ * @param[out] dst             Pointer to destination data structure.
+ * @param[in]  src             Pointer to source data structure.
+ * @param[in]  offset_dst      Offset into destination memory block.
+ * @param[in]  offset_src      Offset from start of source memory block.
+ * @param[in]  num_elements    Number of elements to copy.
+ * @param[in]  num_wait_events Number of events in the wait list.
+ * @param[in]  wait_events     Events to wait for (NULL entries are ignored).
+ * @param[out] event           Event for the copy (may be NULL).
+ * @param[in,out]  status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mem_copy_contents_async(oskar_Mem* dst, const oskar_Mem* src,
+        size_t offset_dst, size_t offset_src, size_t num_elements,
+        int num_wait_events, struct _cl_event* const* wait_events,
+        struct _cl_event** event, int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -50,6 +50,11 @@ extern "C" {
  * If the block is already large enough, no reallocation is performed.
  * Existing data in the memory block is preserved.
  *
+ * When host or GPU memory must grow, at least 50% more space is reserved
+ * than was previously allocated, so that a sequence of calls with
+ * increasing sizes takes amortised constant time. The length of the block
+ * is always set to exactly \p num_elements.
+ *
  * An error is returned if the data type of the memory block is unsupported.
  *
  * @param[in] mem Pointer to memory block to resize.
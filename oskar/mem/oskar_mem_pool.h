@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_MEM_POOL_H_
+#define OSKAR_MEM_POOL_H_
+
+/**
+ * @file oskar_mem_pool.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns statistics for the host memory pool.
+ *
+ * @details
+ * Host memory owned by oskar_Mem structures is allocated from a pool of
+ * aligned blocks, sorted into size classes. Blocks that are freed are
+ * cached for reuse, up to a limit, instead of being returned to the system.
+ *
+ * Threads pinned to a NUMA node by oskar_thread_create_on_node() do not
+ * use the cache, so that their buffers are always freshly allocated,
+ * and placed on their own node when first touched.
+ *
+ * Any of the output pointers may be NULL.
+ *
+ * @param[out] bytes_in_use   Bytes currently allocated to oskar_Mem blocks.
+ * @param[out] bytes_peak     Largest value of \p bytes_in_use so far.
+ * @param[out] bytes_cached   Bytes held in the cache for reuse.
+ * @param[out] num_allocs     Total number of block allocations.
+ * @param[out] num_reused     Number of allocations served from the cache.
+ */
+OSKAR_EXPORT
+void oskar_mem_pool_stats(size_t* bytes_in_use, size_t* bytes_peak,
+        size_t* bytes_cached, size_t* num_allocs, size_t* num_reused);
+
+/**
+ * @brief
+ * Releases all cached blocks in the host memory pool back to the system.
+ */
+OSKAR_EXPORT
+void oskar_mem_pool_trim(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_POOL_H_ */
@@ -48,6 +48,7 @@ struct oskar_Mem
     int type;            /* Enumerated element type of memory block. */
     int location;        /* Enumerated address space of data pointer. */
     size_t num_elements; /* Number of elements in memory block. */
+    size_t capacity;     /* Allocated size of memory block, in bytes. */
     int owner;           /* Flag set if the structure owns the memory. */
     void* data;          /* Data pointer. */
 
@@ -61,4 +62,17 @@ struct oskar_Mem
 typedef struct oskar_Mem oskar_Mem;
 #endif /* OSKAR_MEM_TYPEDEF_ */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Resizes a block, keeping at least min_capacity bytes allocated.
+ * Any new elements are cleared if clear is set. */
+void oskar_mem_realloc_capacity(oskar_Mem* mem, size_t num_elements,
+        size_t min_capacity, int clear, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* OSKAR_PRIVATE_MEM_H_ */
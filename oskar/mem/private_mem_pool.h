@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_MEM_POOL_H_
+#define OSKAR_PRIVATE_MEM_POOL_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Allocates an aligned block of host memory from the pool.
+ *
+ * @details
+ * The requested size is rounded up to the next size class, and a cached
+ * block of that class is reused if one is available.
+ * The usable size of the block is returned in \p capacity, and must be
+ * passed back to oskar_mem_pool_free() when the block is released.
+ *
+ * @param[in] bytes      Minimum size of the block, in bytes.
+ * @param[in] clear      If set, the block is filled with zeros.
+ * @param[out] capacity  Usable size of the block, in bytes.
+ *
+ * @return A pointer to the block, or NULL if allocation failed.
+ */
+void* oskar_mem_pool_alloc(size_t bytes, int clear, size_t* capacity);
+
+/**
+ * @brief
+ * Returns a block of host memory to the pool.
+ *
+ * @param[in] ptr        Pointer returned by oskar_mem_pool_alloc().
+ * @param[in] capacity   Usable size of the block, in bytes.
+ */
+void oskar_mem_pool_free(void* ptr, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_PRIVATE_MEM_POOL_H_ */
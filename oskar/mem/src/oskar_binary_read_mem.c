@@ -116,6 +116,26 @@ void oskar_binary_read_mem_ext(oskar_Binary* handle, oskar_Mem* mem,
     oskar_mem_free(temp, status);
 }
 
+oskar_Mem* oskar_binary_map_mem(oskar_Binary* handle, int type,
+        unsigned char id_group, unsigned char id_tag, int user_index,
+        int* status)
+{
+    int chunk_index;
+    size_t size_bytes = 0;
+    void* ptr;
+    if (*status) return 0;
+
+    /* Get a pointer to the payload, if it can be used in place. */
+    chunk_index = oskar_binary_query(handle, (unsigned char)type,
+            id_group, id_tag, user_index, &size_bytes, status);
+    ptr = oskar_binary_map_block(handle, chunk_index, status);
+    if (!ptr || *status) return 0;
+
+    /* Create an alias of the payload. */
+    return oskar_mem_create_alias_from_raw(ptr, type, OSKAR_CPU,
+            size_bytes / oskar_mem_element_size(type), status);
+}
+
 #ifdef __cplusplus
 }
 #endif
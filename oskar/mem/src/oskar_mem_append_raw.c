@@ -29,7 +29,7 @@ void oskar_mem_append_raw(oskar_Mem* to, const void* from, int from_type,
     const size_t offset_bytes = to->num_elements * element_size;
 
     /* Reallocate the memory block so it is big enough to hold the new data. */
-    oskar_mem_realloc(to, num_elements + to->num_elements, status);
+    oskar_mem_ensure(to, num_elements + to->num_elements, status);
     if (*status) return;
 
     /* Append to the memory. */
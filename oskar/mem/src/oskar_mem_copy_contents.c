@@ -33,17 +33,50 @@
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
 #include "utility/oskar_device.h"
+#include "utility/oskar_trace.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void oskar_mem_copy_contents(oskar_Mem* dst, const oskar_Mem* src,
-        size_t offset_dst, size_t offset_src, size_t num_elements, int* status)
+#ifdef OSKAR_HAVE_OPENCL
+/* Returns the events in the list that are not NULL. */
+static cl_uint event_list(int num_events, struct _cl_event* const* events,
+        cl_event* list)
+{
+    int i;
+    cl_uint n = 0;
+    for (i = 0; events && i < num_events; ++i)
+        if (events[i]) list[n++] = events[i];
+    return n;
+}
+#endif
+
+static const char* copy_name(int location_src, int location_dst)
+{
+    if (location_src == OSKAR_CPU)
+        return location_dst == OSKAR_CPU ? "copy_host" : "copy_to_device";
+    return location_dst == OSKAR_CPU ? "copy_to_host" : "copy_on_device";
+}
+
+static void copy_contents(oskar_Mem* dst, const oskar_Mem* src,
+        size_t offset_dst, size_t offset_src, size_t num_elements,
+        int blocking, int num_wait_events, struct _cl_event* const* wait_events,
+        struct _cl_event** event, int* status)
 {
     void *destination;
+#ifdef OSKAR_HAVE_OPENCL
+    cl_event* wait = 0;
+    cl_uint num_wait = 0;
+    cl_command_queue queue = 0;
+    cl_event trace_event = 0, *ev = 0;
+#endif
+    int trace = oskar_trace_enabled();
+    const double trace_start = oskar_trace_time();
+    if (event) *event = 0;
     if (*status) return;
     if (src->num_elements == 0 || num_elements == 0)
         return;
@@ -66,6 +99,28 @@ void oskar_mem_copy_contents(oskar_Mem* dst, const oskar_Mem* src,
     const int location_dst    = dst->location;
     const void *source = (const void*)((const char*)(src->data) + start_src);
     destination        = (void*)((char*)(dst->data) + start_dst);
+#ifdef OSKAR_HAVE_OPENCL
+    if ((location_src & OSKAR_CL) || (location_dst & OSKAR_CL))
+    {
+        queue = blocking ?
+                oskar_device_queue_cl() : oskar_device_queue_transfer_cl();
+        if (num_wait_events > 0)
+        {
+            wait = (cl_event*) calloc(num_wait_events, sizeof(cl_event));
+            if (!wait)
+            {
+                *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+                return;
+            }
+            num_wait = event_list(num_wait_events, wait_events, wait);
+        }
+        ev = event ? event : (trace ? &trace_event : 0);
+    }
+#else
+    (void) blocking;
+    (void) num_wait_events;
+    (void) wait_events;
+#endif
 
     /* Host to host. */
     if (location_src == OSKAR_CPU && location_dst == OSKAR_CPU)
@@ -111,9 +166,9 @@ void oskar_mem_copy_contents(oskar_Mem* dst, const oskar_Mem* src,
     {
 #ifdef OSKAR_HAVE_OPENCL
         cl_int error;
-        error = clEnqueueWriteBuffer(oskar_device_queue_cl(),
-                dst->buffer, CL_TRUE, start_dst, bytes, source,
-                0, NULL, NULL);
+        error = clEnqueueWriteBuffer(queue,
+                dst->buffer, blocking ? CL_TRUE : CL_FALSE, start_dst, bytes,
+                source, num_wait, num_wait ? wait : NULL, ev);
         if (error != CL_SUCCESS)
         {
             fprintf(stderr, "clEnqueueWriteBuffer() error (%d)\n", error);
@@ -129,9 +184,9 @@ void oskar_mem_copy_contents(oskar_Mem* dst, const oskar_Mem* src,
     {
 #ifdef OSKAR_HAVE_OPENCL
         cl_int error;
-        error = clEnqueueReadBuffer(oskar_device_queue_cl(),
-                src->buffer, CL_TRUE, start_src, bytes, destination,
-                0, NULL, NULL);
+        error = clEnqueueReadBuffer(queue,
+                src->buffer, blocking ? CL_TRUE : CL_FALSE, start_src, bytes,
+                destination, num_wait, num_wait ? wait : NULL, ev);
         if (error != CL_SUCCESS)
         {
             fprintf(stderr, "clEnqueueReadBuffer() error (%d)\n", error);
@@ -147,9 +202,9 @@ void oskar_mem_copy_contents(oskar_Mem* dst, const oskar_Mem* src,
     {
 #ifdef OSKAR_HAVE_OPENCL
         cl_int error;
-        error = clEnqueueCopyBuffer(oskar_device_queue_cl(),
+        error = clEnqueueCopyBuffer(queue,
                 src->buffer, dst->buffer, start_src, start_dst, bytes,
-                0, NULL, NULL);
+                num_wait, num_wait ? wait : NULL, ev);
         if (error != CL_SUCCESS)
         {
             fprintf(stderr, "clEnqueueCopyBuffer() error (%d)\n", error);
@@ -161,6 +216,35 @@ void oskar_mem_copy_contents(oskar_Mem* dst, const oskar_Mem* src,
     }
     else
         *status = OSKAR_ERR_BAD_LOCATION;
+#ifdef OSKAR_HAVE_OPENCL
+    free(wait);
+    if (trace && !*status && queue)
+    {
+        if (event && *event) clRetainEvent(trace_event = *event);
+        oskar_trace_add_cl("copy", copy_name(location_src, location_dst),
+                trace_start, -1, "bytes", bytes, trace_event);
+        trace = 0;
+    }
+#endif
+    if (trace && !*status)
+        oskar_trace_add("copy", copy_name(location_src, location_dst),
+                trace_start, -1, "bytes", bytes);
+}
+
+void oskar_mem_copy_contents(oskar_Mem* dst, const oskar_Mem* src,
+        size_t offset_dst, size_t offset_src, size_t num_elements, int* status)
+{
+    copy_contents(dst, src, offset_dst, offset_src, num_elements,
+            1, 0, 0, 0, status);
+}
+
+void oskar_mem_copy_contents_async(oskar_Mem* dst, const oskar_Mem* src,
+        size_t offset_dst, size_t offset_src, size_t num_elements,
+        int num_wait_events, struct _cl_event* const* wait_events,
+        struct _cl_event** event, int* status)
+{
+    copy_contents(dst, src, offset_dst, offset_src, num_elements,
+            0, num_wait_events, wait_events, event, status);
 }
 
 #ifdef __cplusplus
@@ -32,17 +32,17 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_pool.h"
 #include "utility/oskar_device.h"
 
 #include <stdlib.h>
-#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
-         int* status)
+static oskar_Mem* mem_create(int type, int location, size_t num_elements,
+        int clear, int* status)
 {
     oskar_Mem* mem = (oskar_Mem*) calloc(1, sizeof(oskar_Mem));
     if (!mem)
@@ -56,6 +56,7 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     mem->type = type;
     mem->location = location;
     mem->num_elements = 0;
+    mem->capacity = 0;
     mem->owner = 1;
     mem->data = NULL;
 
@@ -76,17 +77,16 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     mem->num_elements = num_elements;
     if (location == OSKAR_CPU)
     {
-        /* Allocate host memory. */
-        mem->data = calloc(bytes, 1);
+        /* Allocate aligned host memory from the pool.
+         * If cleared, the memset() forces the allocation
+         * to actually happen by touching the whole block.
+         * This makes subsequent copies much faster. */
+        mem->data = oskar_mem_pool_alloc(bytes, clear, &mem->capacity);
         if (mem->data == NULL)
         {
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
             return mem;
         }
-        /* The memset() call forces the allocation
-         * to actually happen by touching the whole block.
-         * This makes subsequent copies much faster. */
-        memset(mem->data, 0, bytes);
     }
     else if (location == OSKAR_GPU)
     {
@@ -95,6 +95,7 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
         *status = (int)cudaMalloc(&mem->data, bytes);
         if (!*status && mem->data == NULL)
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        if (!*status) mem->capacity = bytes;
 #else
         *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
 #endif
@@ -108,6 +109,8 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
                 CL_MEM_READ_WRITE, bytes, NULL, &error);
         if (error != CL_SUCCESS)
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        else
+            mem->capacity = bytes;
         mem->data = (void*) (mem->buffer);
 #else
         *status = OSKAR_ERR_OPENCL_NOT_AVAILABLE;
@@ -122,6 +125,18 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     return mem;
 }
 
+oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
+         int* status)
+{
+    return mem_create(type, location, num_elements, 1, status);
+}
+
+oskar_Mem* oskar_mem_create_uninit(int type, int location,
+        size_t num_elements, int* status)
+{
+    return mem_create(type, location, num_elements, 0, status);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,7 +36,11 @@ extern "C" {
 void oskar_mem_ensure(oskar_Mem* mem, size_t num_elements, int* status)
 {
     if (oskar_mem_length(mem) < num_elements)
-        oskar_mem_realloc(mem, num_elements, status);
+    {
+        /* Grow geometrically, so repeated calls are amortised. */
+        oskar_mem_realloc_capacity(mem, num_elements,
+                mem->capacity + mem->capacity / 2, 1, status);
+    }
 }
 
 #ifdef __cplusplus
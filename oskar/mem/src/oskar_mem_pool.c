@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* For posix_memalign() and madvise(). */
+#endif
+
+#include "mem/oskar_mem_pool.h"
+#include "mem/private_mem_pool.h"
+#include "utility/oskar_numa.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef OSKAR_OS_WIN
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <pthread.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Alignment of all blocks, in bytes (one cache line, or one AVX-512 word). */
+#define POOL_ALIGNMENT 64
+
+/* Blocks of at least this size are aligned to (transparent) huge pages. */
+#define POOL_HUGE_PAGE (2 << 20)
+
+/* Size classes run from 2^POOL_MIN_SHIFT to 2^POOL_MAX_SHIFT bytes,
+ * with POOL_STEPS classes per power of two, so at most 25% is wasted.
+ * Larger blocks are allocated and freed directly. */
+#define POOL_MIN_SHIFT 6
+#define POOL_MAX_SHIFT 26
+#define POOL_STEPS 4
+#define POOL_NUM_CLASSES ((POOL_MAX_SHIFT - POOL_MIN_SHIFT) * POOL_STEPS + 1)
+
+/* Upper limit on the total size of cached blocks, in bytes. */
+#define POOL_MAX_CACHED ((size_t)256 << 20)
+
+static void* free_list[POOL_NUM_CLASSES];
+static size_t bytes_in_use_, bytes_peak_, bytes_cached_;
+static size_t num_allocs_, num_reused_;
+
+#ifdef OSKAR_OS_WIN
+static SRWLOCK pool_lock = SRWLOCK_INIT;
+#define POOL_LOCK AcquireSRWLockExclusive(&pool_lock)
+#define POOL_UNLOCK ReleaseSRWLockExclusive(&pool_lock)
+#else
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+#define POOL_LOCK pthread_mutex_lock(&pool_lock)
+#define POOL_UNLOCK pthread_mutex_unlock(&pool_lock)
+#endif
+
+/* Returns the size class for a block, or -1 if it is too big to cache. */
+static int size_class(size_t bytes, size_t* class_bytes)
+{
+    int shift = POOL_MIN_SHIFT;
+    if (bytes <= ((size_t)1 << POOL_MIN_SHIFT))
+    {
+        *class_bytes = (size_t)1 << POOL_MIN_SHIFT;
+        return 0;
+    }
+    if (bytes > ((size_t)1 << POOL_MAX_SHIFT)) return -1;
+    while (((size_t)2 << shift) < bytes) shift++;
+    const size_t base = (size_t)1 << shift;
+    const size_t step = base / POOL_STEPS;
+    const size_t k = (bytes - base + step - 1) / step;
+    *class_bytes = base + k * step;
+    return (int) ((shift - POOL_MIN_SHIFT) * POOL_STEPS + k);
+}
+
+/* Returns the size of blocks in a size class. */
+static size_t class_size(int c)
+{
+    if (c == 0) return (size_t)1 << POOL_MIN_SHIFT;
+    const size_t base = (size_t)1 << (POOL_MIN_SHIFT + (c - 1) / POOL_STEPS);
+    return base + ((c - 1) % POOL_STEPS + 1) * (base / POOL_STEPS);
+}
+
+static void* system_alloc(size_t bytes)
+{
+    void* ptr = 0;
+    const size_t align = bytes >= POOL_HUGE_PAGE ?
+            POOL_HUGE_PAGE : POOL_ALIGNMENT;
+#ifdef OSKAR_OS_WIN
+    ptr = _aligned_malloc(bytes, align);
+#else
+    if (posix_memalign(&ptr, align, bytes)) return 0;
+#ifdef MADV_HUGEPAGE
+    if (bytes >= POOL_HUGE_PAGE)
+        (void) madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+#endif
+    return ptr;
+}
+
+static void system_free(void* ptr)
+{
+#ifdef OSKAR_OS_WIN
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+/* Threads pinned to a NUMA node bypass the cache: a cached block may have
+ * been first touched by a thread on another node, so its pages would not
+ * be local to the pinned thread. */
+void* oskar_mem_pool_alloc(size_t bytes, int clear, size_t* capacity)
+{
+    void* ptr = 0;
+    size_t class_bytes = 0;
+    const int c = size_class(bytes, &class_bytes);
+    const int use_cache = oskar_numa_thread_node() < 0;
+    if (c < 0)
+    {
+        /* Round large blocks up to a whole number of huge pages. */
+        class_bytes = (bytes + POOL_HUGE_PAGE - 1) &
+                ~((size_t)POOL_HUGE_PAGE - 1);
+    }
+    POOL_LOCK;
+    num_allocs_++;
+    if (c >= 0 && use_cache && free_list[c])
+    {
+        /* Pop a cached block. Its first word links to the next one. */
+        ptr = free_list[c];
+        memcpy(&free_list[c], ptr, sizeof(void*));
+        bytes_cached_ -= class_bytes;
+        num_reused_++;
+    }
+    bytes_in_use_ += class_bytes;
+    if (bytes_in_use_ > bytes_peak_) bytes_peak_ = bytes_in_use_;
+    POOL_UNLOCK;
+    if (!ptr)
+    {
+        ptr = system_alloc(class_bytes);
+        if (!ptr)
+        {
+            POOL_LOCK;
+            bytes_in_use_ -= class_bytes;
+            POOL_UNLOCK;
+            *capacity = 0;
+            return 0;
+        }
+    }
+    if (clear) memset(ptr, 0, bytes);
+    *capacity = class_bytes;
+    return ptr;
+}
+
+void oskar_mem_pool_free(void* ptr, size_t capacity)
+{
+    size_t class_bytes = 0;
+    if (!ptr) return;
+    const int c = size_class(capacity, &class_bytes);
+    const int use_cache = oskar_numa_thread_node() < 0;
+    POOL_LOCK;
+    bytes_in_use_ -= capacity;
+    if (c >= 0 && use_cache && class_bytes == capacity &&
+            bytes_cached_ + capacity <= POOL_MAX_CACHED)
+    {
+        memcpy(ptr, &free_list[c], sizeof(void*));
+        free_list[c] = ptr;
+        bytes_cached_ += capacity;
+        ptr = 0;
+    }
+    POOL_UNLOCK;
+    if (ptr) system_free(ptr);
+}
+
+void oskar_mem_pool_stats(size_t* bytes_in_use, size_t* bytes_peak,
+        size_t* bytes_cached, size_t* num_allocs, size_t* num_reused)
+{
+    POOL_LOCK;
+    if (bytes_in_use) *bytes_in_use = bytes_in_use_;
+    if (bytes_peak) *bytes_peak = bytes_peak_;
+    if (bytes_cached) *bytes_cached = bytes_cached_;
+    if (num_allocs) *num_allocs = num_allocs_;
+    if (num_reused) *num_reused = num_reused_;
+    POOL_UNLOCK;
+}
+
+void oskar_mem_pool_trim(void)
+{
+    int c;
+    for (c = 0; c < POOL_NUM_CLASSES; ++c)
+    {
+        void* ptr;
+        size_t freed = 0;
+        POOL_LOCK;
+        ptr = free_list[c];
+        free_list[c] = 0;
+        POOL_UNLOCK;
+        while (ptr)
+        {
+            void* next = 0;
+            memcpy(&next, ptr, sizeof(void*));
+            system_free(ptr);
+            freed += class_size(c);
+            ptr = next;
+        }
+        POOL_LOCK;
+        bytes_cached_ -= freed;
+        POOL_UNLOCK;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -32,6 +32,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_pool.h"
 #include "utility/oskar_device.h"
 
 #include <string.h>
@@ -43,6 +44,12 @@ extern "C" {
 #endif
 
 void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
+{
+    oskar_mem_realloc_capacity(mem, num_elements, 0, 1, status);
+}
+
+void oskar_mem_realloc_capacity(oskar_Mem* mem, size_t num_elements,
+        size_t min_capacity, int clear, int* status)
 {
     if (*status || !mem) return;
 
@@ -67,23 +74,45 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
     if (new_size == old_size)
         return;
 
+    /* Keep the current block if it is big enough, and not far too big. */
+    if (min_capacity < new_size) min_capacity = new_size;
+    const int keep = new_size > 0 && new_size <= mem->capacity &&
+            mem->capacity / 4 <= min_capacity;
+
     /* Check memory location. */
     if (mem->location == OSKAR_CPU)
     {
-        /* Reallocate the memory. */
-        void* mem_new = realloc(mem->data, new_size);
-        if (!mem_new && (new_size > 0))
+        if (!keep)
         {
-            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
-            return;
+            /* Move the contents to a new block from the pool. */
+            size_t capacity = 0;
+            void* mem_new = 0;
+            if (new_size > 0)
+            {
+                mem_new = oskar_mem_pool_alloc(min_capacity, 0, &capacity);
+                if (!mem_new)
+                {
+                    *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+                    return;
+                }
+                if (old_size > 0)
+                    memcpy(mem_new, mem->data,
+                            (old_size > new_size) ? new_size : old_size);
+            }
+            oskar_mem_pool_free(mem->data, mem->capacity);
+            mem->data = mem_new;
+            mem->capacity = capacity;
         }
 
         /* Initialise the new memory if it's larger than the old block. */
-        if (new_size > old_size)
-            memset((char*)mem_new + old_size, 0, new_size - old_size);
+        if (clear && new_size > old_size)
+            memset((char*)mem->data + old_size, 0, new_size - old_size);
 
         /* Set the new meta-data. */
-        mem->data = (new_size > 0) ? mem_new : 0;
+        mem->num_elements = num_elements;
+    }
+    else if (mem->location == OSKAR_GPU && keep)
+    {
         mem->num_elements = num_elements;
     }
     else if (mem->location == OSKAR_GPU)
@@ -93,7 +122,7 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
         void* mem_new = NULL;
         if (new_size > 0)
         {
-            const int cuda_error = (int)cudaMalloc(&mem_new, new_size);
+            const int cuda_error = (int)cudaMalloc(&mem_new, min_capacity);
             if (cuda_error)
             {
                 *status = cuda_error;
@@ -123,6 +152,7 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
         /* Set the new meta-data. */
         mem->data = mem_new;
         mem->num_elements = num_elements;
+        mem->capacity = (new_size > 0) ? min_capacity : 0;
 #else
         *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
 #endif
@@ -160,6 +190,7 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
         mem->buffer = mem_new;
         mem->data = (void*) (mem->buffer);
         mem->num_elements = num_elements;
+        mem->capacity = new_size;
 #else
         *status = OSKAR_ERR_OPENCL_NOT_AVAILABLE;
 #endif
@@ -30,6 +30,7 @@
 
 #include "utility/oskar_get_error_string.h"
 #include "mem/oskar_mem.h"
+#include "utility/oskar_device.h"
 
 TEST(Mem, copy_to_device)
 {
@@ -67,3 +68,45 @@ TEST(Mem, copy_to_device)
     oskar_mem_free(temp, &status);
 }
 
+
+TEST(Mem, copy_contents_async)
+{
+    int location = OSKAR_CPU, n = 100, status = 0;
+    struct _cl_event *event[2] = {0, 0}, *done = 0;
+#ifdef OSKAR_HAVE_OPENCL
+    location = OSKAR_CL;
+#endif
+
+    // Create test array and fill with data.
+    oskar_Mem* cpu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, &status);
+    oskar_Mem* cpu2 = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, &status);
+    oskar_Mem* temp = oskar_mem_create(OSKAR_DOUBLE, location, n, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    double* cpu_ = oskar_mem_double(cpu, &status);
+    for (int i = 0; i < n; ++i)
+    {
+        cpu_[i] = (double)i;
+    }
+
+    // Copy to the device and back again, chaining the copies with events.
+    oskar_mem_copy_contents_async(temp, cpu, 0, 0, n, 0, 0,
+            &event[0], &status);
+    oskar_device_event_record(location, &done, &status);
+    oskar_mem_copy_contents_async(cpu2, temp, 0, 0, n, 1, &event[0],
+            &event[1], &status);
+    oskar_device_events_wait(2, event, &status);
+    oskar_device_events_release(1, &done);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_TRUE(event[0] == 0);
+    EXPECT_TRUE(event[1] == 0);
+    double* cpu2_ = oskar_mem_double(cpu2, &status);
+    for (int i = 0; i < n; ++i)
+    {
+        EXPECT_DOUBLE_EQ(cpu_[i], cpu2_[i]);
+    }
+
+    // Free memory.
+    oskar_mem_free(cpu, &status);
+    oskar_mem_free(cpu2, &status);
+    oskar_mem_free(temp, &status);
+}
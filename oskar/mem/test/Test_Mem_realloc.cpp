@@ -30,6 +30,7 @@
 
 #include "utility/oskar_get_error_string.h"
 #include "mem/oskar_mem.h"
+#include "utility/oskar_numa.h"
 
 #ifdef OSKAR_HAVE_CUDA
 TEST(Mem, realloc_gpu)
@@ -60,3 +61,76 @@ TEST(Mem, realloc_cpu)
     oskar_mem_free(mem, &status);
     ASSERT_EQ(0, status) << oskar_get_error_string(status);
 }
+
+
+TEST(Mem, ensure_cpu_pooled)
+{
+    int status = 0;
+    size_t num_allocs[2], num_reused[2];
+    oskar_mem_pool_stats(0, 0, 0, &num_allocs[0], &num_reused[0]);
+    oskar_Mem *mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 10, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(0u, ((size_t) oskar_mem_void(mem)) % 64);
+    for (int i = 0; i < 10; ++i) oskar_mem_double(mem, &status)[i] = i;
+
+    // Grow one element at a time: contents must be kept and
+    // new elements cleared, with few reallocations.
+    for (int n = 11; n <= 10000; ++n)
+    {
+        oskar_mem_ensure(mem, n, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ((size_t) n, oskar_mem_length(mem));
+        ASSERT_EQ(0.0, oskar_mem_double(mem, &status)[n - 1]);
+        oskar_mem_double(mem, &status)[n - 1] = n - 1;
+    }
+    const double* data = oskar_mem_double_const(mem, &status);
+    for (int i = 0; i < 10000; ++i) ASSERT_EQ((double) i, data[i]);
+    oskar_mem_pool_stats(0, 0, 0, &num_allocs[1], &num_reused[1]);
+    EXPECT_LT(num_allocs[1] - num_allocs[0], 40u);
+
+    // Shrinking then growing again must clear the reused elements.
+    oskar_mem_realloc(mem, 5000, &status);
+    oskar_mem_ensure(mem, 6000, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0.0, oskar_mem_double(mem, &status)[5500]);
+    EXPECT_EQ(4999.0, oskar_mem_double(mem, &status)[4999]);
+    oskar_mem_free(mem, &status);
+
+    // A block of a freed size should come from the cache, and be cleared.
+    mem = oskar_mem_create_uninit(OSKAR_DOUBLE, OSKAR_CPU, 6000, &status);
+    oskar_mem_set_value_real(mem, 1.0, 0, 6000, &status);
+    oskar_mem_free(mem, &status);
+    oskar_mem_pool_stats(0, 0, 0, &num_allocs[0], &num_reused[0]);
+    mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 6000, &status);
+    oskar_Mem *copy = oskar_mem_create_copy(mem, OSKAR_CPU, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    data = oskar_mem_double_const(mem, &status);
+    for (int i = 0; i < 6000; ++i) ASSERT_EQ(0.0, data[i]);
+    EXPECT_EQ(0, oskar_mem_different(mem, copy, 0, &status));
+    oskar_mem_pool_stats(0, 0, 0, &num_allocs[1], &num_reused[1]);
+    EXPECT_EQ(num_allocs[0] + 2, num_allocs[1]);
+    EXPECT_LE(num_reused[0] + 1, num_reused[1]);
+    oskar_mem_free(mem, &status);
+    oskar_mem_free(copy, &status);
+    oskar_mem_pool_trim();
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(Mem, pool_bypassed_on_numa_node)
+{
+    int status = 0;
+    size_t num_reused[2];
+
+    // Blocks freed in a pinned thread should not be cached or reused.
+    oskar_numa_set_thread_node(0);
+    oskar_Mem* mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 7000, &status);
+    oskar_mem_free(mem, &status);
+    oskar_mem_pool_stats(0, 0, 0, 0, &num_reused[0]);
+    mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 7000, &status);
+    oskar_mem_pool_stats(0, 0, 0, 0, &num_reused[1]);
+    EXPECT_EQ(num_reused[0], num_reused[1]);
+    oskar_mem_free(mem, &status);
+    oskar_numa_set_thread_node(-1);
+    EXPECT_EQ(-1, oskar_numa_thread_node());
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
@@ -39,6 +39,8 @@
 extern "C" {
 #endif
 
+struct _cl_event;
+
 /**
  * @brief Make a copy of a sky model.
  *
@@ -56,6 +58,32 @@ extern "C" {
 OSKAR_EXPORT
 void oskar_sky_copy(oskar_Sky* dst, const oskar_Sky* src, int* status);
 
+/**
+ * @brief Starts making a copy of a sky model.
+ *
+ * @details
+ * Makes a copy of the supplied sky model, as oskar_sky_copy(), but
+ * transfers to or from OpenCL devices are enqueued on the transfer queue
+ * of the current device without blocking the host, after all events in
+ * \p wait_events have completed.
+ *
+ * The meta-data are copied immediately. The returned \p event completes
+ * when all the source data have been copied, and must be waited for
+ * before the destination model is used on the device.
+ * It is NULL if the copy has already finished.
+ *
+ * @param[out] dst             Sky model to copy into.
+ * @param[in]  src             Sky model to copy from.
+ * @param[in]  num_wait_events Number of events in the wait list.
+ * @param[in]  wait_events     Events to wait for (NULL entries are ignored).
+ * @param[out] event           Event for the copy.
+ * @param[in,out] status       Status return code.
+*/
+OSKAR_EXPORT
+void oskar_sky_copy_async(oskar_Sky* dst, const oskar_Sky* src,
+        int num_wait_events, struct _cl_event* const* wait_events,
+        struct _cl_event** event, int* status);
+
 #ifdef __cplusplus
 }
 #endif
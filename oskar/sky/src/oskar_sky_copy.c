@@ -29,14 +29,17 @@
 #include "sky/oskar_sky.h"
 #include "sky/private_sky.h"
 #include "mem/oskar_mem.h"
+#include "utility/oskar_device.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void oskar_sky_copy(oskar_Sky* dst, const oskar_Sky* src, int* status)
+static void copy(oskar_Sky* dst, const oskar_Sky* src, int async,
+        int num_wait_events, struct _cl_event* const* wait_events,
+        struct _cl_event** event, int* status)
 {
-    int num_sources;
+    int i, num_sources;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -60,35 +63,47 @@ void oskar_sky_copy(oskar_Sky* dst, const oskar_Sky* src, int* status)
     dst->reference_dec_rad = src->reference_dec_rad;
 
     /* Copy the memory blocks */
-    oskar_mem_copy_contents(dst->ra_rad, src->ra_rad,
-            0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->dec_rad, src->dec_rad,
-            0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->I, src->I, 0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->Q, src->Q, 0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->U, src->U, 0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->V, src->V, 0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->reference_freq_hz, src->reference_freq_hz,
-            0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->spectral_index, src->spectral_index,
-            0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->rm_rad, src->rm_rad,
-            0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->l, src->l, 0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->m, src->m, 0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->n, src->n, 0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->fwhm_major_rad, src->fwhm_major_rad,
-            0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->fwhm_minor_rad, src->fwhm_minor_rad,
-            0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->pa_rad, src->pa_rad,
-            0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->gaussian_a, src->gaussian_a,
-            0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->gaussian_b, src->gaussian_b,
-            0, 0, num_sources, status);
-    oskar_mem_copy_contents(dst->gaussian_c, src->gaussian_c,
-            0, 0, num_sources, status);
+    oskar_Mem* const d[] = {
+            dst->ra_rad, dst->dec_rad, dst->I, dst->Q, dst->U, dst->V,
+            dst->reference_freq_hz, dst->spectral_index, dst->rm_rad,
+            dst->l, dst->m, dst->n,
+            dst->fwhm_major_rad, dst->fwhm_minor_rad, dst->pa_rad,
+            dst->gaussian_a, dst->gaussian_b, dst->gaussian_c
+    };
+    const oskar_Mem* const s[] = {
+            src->ra_rad, src->dec_rad, src->I, src->Q, src->U, src->V,
+            src->reference_freq_hz, src->spectral_index, src->rm_rad,
+            src->l, src->m, src->n,
+            src->fwhm_major_rad, src->fwhm_minor_rad, src->pa_rad,
+            src->gaussian_a, src->gaussian_b, src->gaussian_c
+    };
+    for (i = 0; i < (int) (sizeof(d) / sizeof(oskar_Mem*)); ++i)
+    {
+        if (!async)
+        {
+            oskar_mem_copy_contents(d[i], s[i], 0, 0, num_sources, status);
+            continue;
+        }
+
+        /* The transfer queue is in order, so only the event for the
+         * last copy needs to be kept. */
+        oskar_device_events_release(1, event);
+        oskar_mem_copy_contents_async(d[i], s[i], 0, 0, num_sources,
+                num_wait_events, wait_events, event, status);
+    }
+}
+
+void oskar_sky_copy(oskar_Sky* dst, const oskar_Sky* src, int* status)
+{
+    copy(dst, src, 0, 0, 0, 0, status);
+}
+
+void oskar_sky_copy_async(oskar_Sky* dst, const oskar_Sky* src,
+        int num_wait_events, struct _cl_event* const* wait_events,
+        struct _cl_event** event, int* status)
+{
+    *event = 0;
+    copy(dst, src, 1, num_wait_events, wait_events, event, status);
 }
 
 #ifdef __cplusplus
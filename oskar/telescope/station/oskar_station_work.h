@@ -91,6 +91,20 @@ OSKAR_EXPORT
 oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int depth, int* status);
 
+/**
+ * @brief Returns the approximate work buffer size per direction, in bytes.
+ *
+ * @details
+ * Returns an estimate of the number of bytes held in the work buffers
+ * for each direction at which a station beam is evaluated.
+ * This is used to plan how many directions can be processed at once.
+ *
+ * @param[in] beam_type  OSKAR memory type of the station beam.
+ * @param[in] max_depth  Maximum beamforming hierarchy depth of the stations.
+ */
+OSKAR_EXPORT
+size_t oskar_station_work_bytes_per_point(int beam_type, int max_depth);
+
 #ifdef __cplusplus
 }
 #endif
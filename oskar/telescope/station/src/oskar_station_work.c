@@ -195,6 +195,16 @@ oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
     return work->beam[depth];
 }
 
+size_t oskar_station_work_bytes_per_point(int beam_type, int max_depth)
+{
+    /* Direction cosines, modified angles, indices, TEC screen and beams. */
+    const size_t real_size = oskar_mem_element_size(
+            oskar_type_precision(beam_type));
+    const size_t beam_size = oskar_mem_element_size(beam_type);
+    return 15 * real_size + 2 * sizeof(int) + 2 * real_size +
+            (size_t)(2 + max_depth) * beam_size;
+}
+
 static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
         size_t length, int* status)
 {
@@ -41,6 +41,9 @@ extern "C" {
 #endif
 
 struct oskar_Device;
+struct oskar_DeviceKernel;
+typedef struct oskar_DeviceKernel oskar_DeviceKernel;
+struct _cl_event;
 #ifndef OSKAR_DEVICE_TYPEDEF_
 #define OSKAR_DEVICE_TYPEDEF_
 typedef struct oskar_Device oskar_Device;
@@ -188,6 +191,112 @@ int oskar_device_is_gpu(int location);
 OSKAR_EXPORT
 int oskar_device_is_nv(int location);
 
+/**
+ * @brief Records an event after all work on the current compute queue.
+ *
+ * @details
+ * Enqueues a marker on the compute queue of the current OpenCL device,
+ * and returns an event that completes once all previously-enqueued
+ * commands on that queue have finished. This can be passed as a dependency
+ * to work on the transfer queue, to make sure a buffer is no longer in use
+ * before it is overwritten.
+ *
+ * For other locations, the returned event is NULL, as all work
+ * is already ordered.
+ *
+ * The event must be released using oskar_device_events_release()
+ * or one of the wait functions.
+ *
+ * @param[in] location       Enumerated location type.
+ * @param[out] event         Event handle (may be NULL).
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_device_event_record(int location, struct _cl_event** event,
+        int* status);
+
+/**
+ * @brief Makes subsequent work on the compute queue wait for events.
+ *
+ * @details
+ * Enqueues a barrier on the compute queue of the current OpenCL device,
+ * so that no later command on that queue starts until all the given
+ * events have completed. The host does not block.
+ *
+ * The events are released, and set to NULL.
+ * NULL events in the list are ignored.
+ *
+ * @param[in] num_events     Number of events in the list.
+ * @param[in,out] events     List of events.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_device_events_enqueue_wait(int num_events,
+        struct _cl_event** events, int* status);
+
+/**
+ * @brief Releases a list of events.
+ *
+ * @details
+ * Releases each event in the list, and sets it to NULL.
+ * NULL events in the list are ignored.
+ *
+ * @param[in] num_events     Number of events in the list.
+ * @param[in,out] events     List of events.
+ */
+OSKAR_EXPORT
+void oskar_device_events_release(int num_events, struct _cl_event** events);
+
+/**
+ * @brief Blocks the host until a list of events has completed.
+ *
+ * @details
+ * Waits until all the given events have completed, then releases them
+ * and sets them to NULL. NULL events in the list are ignored.
+ *
+ * @param[in] num_events     Number of events in the list.
+ * @param[in,out] events     List of events.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_device_events_wait(int num_events, struct _cl_event** events,
+        int* status);
+
+/**
+ * @brief Returns a handle to a named compute kernel.
+ *
+ * @details
+ * Returns a handle to the named compute kernel, which can be passed to
+ * oskar_device_launch_kernel_handle() to avoid looking the kernel up by
+ * name every time it is launched.
+ *
+ * The same handle is always returned for the same name, and it remains
+ * valid until the end of the application (including across calls to
+ * oskar_device_reset_all()), so it can be cached by the caller
+ * using oskar_device_kernel_cached(). This function is thread-safe.
+ *
+ * @param[in] name           Name of the kernel.
+ */
+OSKAR_EXPORT
+const oskar_DeviceKernel* oskar_device_kernel(const char* name);
+
+/**
+ * @brief Returns a handle to a named compute kernel, using a cache.
+ *
+ * @details
+ * Returns the handle stored in \p cache, or if that is NULL, looks it up
+ * using oskar_device_kernel() and stores it there first.
+ *
+ * The cache is read and written atomically, so it can be a static variable
+ * shared by all threads that launch the kernel.
+ *
+ * @param[in,out] cache      Cached handle, initially NULL.
+ * @param[in] name           Name of the kernel.
+ */
+OSKAR_EXPORT
+const oskar_DeviceKernel* oskar_device_kernel_cached(
+        const oskar_DeviceKernel** cache, const char* name);
+
 /**
  * @brief Launches a compute kernel.
  *
@@ -211,6 +320,124 @@ void oskar_device_launch_kernel(const char* name, int location,
         size_t num_args, const oskar_Arg* arg,
         size_t num_local_args, const size_t* arg_size_local, int* status);
 
+/**
+ * @brief Launches a compute kernel, with event dependencies.
+ *
+ * @details
+ * Launches a compute kernel on the current CUDA or OpenCL device,
+ * as oskar_device_launch_kernel(), but for OpenCL devices the kernel
+ * does not start until all events in \p wait_events have completed,
+ * and an event is returned in \p event that can be used to wait for
+ * the kernel to finish.
+ *
+ * For CUDA devices, work is already ordered in the default stream,
+ * so the wait list is ignored and the returned event is NULL.
+ *
+ * The returned event must be released using oskar_device_events_release()
+ * or one of the wait functions.
+ *
+ * @param[in] name            Name of the kernel to launch.
+ * @param[in] location        Either OSKAR_GPU or OSKAR_CL.
+ * @param[in] num_dims        Number of kernel work group dimensions (up to 3).
+ * @param[in] local_size[3]   3D work group, or thread block size.
+ * @param[in] global_size[3]  Total size of 3D grid. (Multiple of local size.)
+ * @param[in] num_args        Number of kernel arguments, excluding local memory.
+ * @param[in] args            Array of oskar_Arg kernel arguments.
+ * @param[in] num_local_args  Number of local memory arguments.
+ * @param[in] arg_size_local  Size of each local memory argument, in bytes.
+ * @param[in] num_wait_events Number of events in the wait list.
+ * @param[in] wait_events     Events to wait for (NULL entries are ignored).
+ * @param[out] event          Event for the kernel (may be NULL).
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_device_launch_kernel_async(const char* name, int location,
+        int num_dims, size_t local_size[3], size_t global_size[3],
+        size_t num_args, const oskar_Arg* arg,
+        size_t num_local_args, const size_t* arg_size_local,
+        int num_wait_events, struct _cl_event* const* wait_events,
+        struct _cl_event** event, int* status);
+
+/**
+ * @brief Launches a compute kernel using a kernel handle.
+ *
+ * @details
+ * Launches a compute kernel on the current CUDA or OpenCL device,
+ * as oskar_device_launch_kernel(), using a handle returned by
+ * oskar_device_kernel().
+ *
+ * Several threads can launch the same kernel at the same time:
+ * for OpenCL, each launching thread uses its own copy of the kernel object
+ * while it sets the arguments.
+ *
+ * @param[in] kernel         Handle to the kernel to launch.
+ * @param[in] location       Either OSKAR_GPU or OSKAR_CL.
+ * @param[in] num_dims       Number of kernel work group dimensions (up to 3).
+ * @param[in] local_size[3]  3D work group, or thread block size.
+ * @param[in] global_size[3] Total size of 3D grid. (Multiple of local size.)
+ * @param[in] num_args       Number of kernel arguments, excluding local memory.
+ * @param[in] args           Array of oskar_Arg kernel arguments.
+ * @param[in] num_local_args Number of local memory arguments.
+ * @param[in] arg_size_local Size of each local memory argument, in bytes.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_device_launch_kernel_handle(const oskar_DeviceKernel* kernel,
+        int location, int num_dims, size_t local_size[3],
+        size_t global_size[3], size_t num_args, const oskar_Arg* arg,
+        size_t num_local_args, const size_t* arg_size_local, int* status);
+
+/**
+ * @brief Launches a compute kernel using a kernel handle, with events.
+ *
+ * @details
+ * Launches a compute kernel as oskar_device_launch_kernel_handle(),
+ * with event dependencies as oskar_device_launch_kernel_async().
+ *
+ * @param[in] kernel          Handle to the kernel to launch.
+ * @param[in] location        Either OSKAR_GPU or OSKAR_CL.
+ * @param[in] num_dims        Number of kernel work group dimensions (up to 3).
+ * @param[in] local_size[3]   3D work group, or thread block size.
+ * @param[in] global_size[3]  Total size of 3D grid. (Multiple of local size.)
+ * @param[in] num_args        Number of kernel arguments, excluding local memory.
+ * @param[in] args            Array of oskar_Arg kernel arguments.
+ * @param[in] num_local_args  Number of local memory arguments.
+ * @param[in] arg_size_local  Size of each local memory argument, in bytes.
+ * @param[in] num_wait_events Number of events in the wait list.
+ * @param[in] wait_events     Events to wait for (NULL entries are ignored).
+ * @param[out] event          Event for the kernel (may be NULL).
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_device_launch_kernel_handle_async(const oskar_DeviceKernel* kernel,
+        int location, int num_dims, size_t local_size[3],
+        size_t global_size[3], size_t num_args, const oskar_Arg* arg,
+        size_t num_local_args, const size_t* arg_size_local,
+        int num_wait_events, struct _cl_event* const* wait_events,
+        struct _cl_event** event, int* status);
+
+/**
+ * @brief Returns the amount of memory available on the specified device.
+ *
+ * @details
+ * Returns the amount of free and total memory on the specified device,
+ * and the size of the largest single allocation that can be made, in bytes.
+ *
+ * For CPU locations, the physical memory of the host is returned.
+ * OpenCL cannot report free memory, so the total is returned instead.
+ *
+ * Note that this function will select the device if it is a CUDA device.
+ *
+ * @param[in] location   Enumerated device location.
+ * @param[in] id         Device ID.
+ * @param[out] mem_free  Free memory, in bytes.
+ * @param[out] mem_total Total memory, in bytes.
+ * @param[out] max_alloc Size of the largest allocation allowed, in bytes.
+ */
+OSKAR_EXPORT
+void oskar_device_mem_info(int location, int id, size_t* mem_free,
+        size_t* mem_total, size_t* max_alloc);
+
 /**
  * @brief Returns the name of the specified device.
  *
@@ -234,6 +461,19 @@ char* oskar_device_name(int location, int id);
 OSKAR_EXPORT
 struct _cl_command_queue* oskar_device_queue_cl(void);
 
+/**
+ * @brief Returns the transfer command queue for the current OpenCL device.
+ *
+ * @details
+ * Returns the command queue used for asynchronous memory transfers
+ * on the current OpenCL device. Commands on this queue can run concurrently
+ * with kernels on the default queue, so any dependencies between the two
+ * must be expressed using events.
+ * Note that this function will initialise the device if necessary.
+ */
+OSKAR_EXPORT
+struct _cl_command_queue* oskar_device_queue_transfer_cl(void);
+
 /**
  * @brief
  * Returns the flag specifying whether or not double precision is required.
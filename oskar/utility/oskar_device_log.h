@@ -64,6 +64,20 @@ void oskar_device_log_details(const oskar_Device* device, oskar_Log* log);
 OSKAR_EXPORT
 void oskar_device_log_mem(int location, int depth, int id, oskar_Log* log);
 
+/**
+ * @brief Log the NUMA nodes used by CPU devices.
+ *
+ * @details
+ * This function writes the NUMA node chosen for each group of CPU devices
+ * by oskar_numa_node_for_device() to the log.
+ * Nothing is written if the system has only one NUMA node.
+ *
+ * @param[in] first_device  Index of the first CPU device.
+ * @param[in] num_devices   Number of CPU devices.
+ */
+OSKAR_EXPORT
+void oskar_device_log_numa(int first_device, int num_devices, oskar_Log* log);
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,15 @@
 #define DO_PRAGMA(X)
 #endif
 
+/* Vectorised loops, using OpenMP 4.0 or later. */
+#if defined(_OPENMP) && (_OPENMP >= 201307) && !defined(__CUDACC__)
+#define OMP_SIMD DO_PRAGMA(omp simd)
+#define OMP_SIMD_SUM(...) DO_PRAGMA(omp simd reduction(+: __VA_ARGS__))
+#else
+#define OMP_SIMD
+#define OMP_SIMD_SUM(...)
+#endif
+
 #define ATOMIC_ADD_CAPTURE(TYPE, ARRAY, IDX, VAL, OLD)\
     M_CAT(ATOMIC_ADD_CAPTURE_, TYPE)(ARRAY, IDX, VAL, OLD)
 #define ATOMIC_ADD_UPDATE(TYPE, ARRAY, IDX, VAL)\
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_NUMA_H_
+#define OSKAR_NUMA_H_
+
+/**
+ * @file oskar_numa.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns the number of NUMA nodes on the system.
+ *
+ * @details
+ * The topology is read from /sys/devices/system/node.
+ * Returns 1 if it is not available.
+ */
+OSKAR_EXPORT
+int oskar_numa_num_nodes(void);
+
+/**
+ * @brief
+ * Returns the CPUs belonging to a NUMA node.
+ *
+ * @details
+ * Fills \p cpus with up to \p max_cpus CPU indices belonging to the
+ * NUMA node at index \p node (in the range 0 to oskar_numa_num_nodes() - 1),
+ * and returns the number of CPUs found.
+ * Returns 0 if the topology is not available.
+ *
+ * @param[in] node       Index of the NUMA node.
+ * @param[in] max_cpus   Size of the \p cpus array.
+ * @param[out] cpus      CPU indices in the node.
+ */
+OSKAR_EXPORT
+int oskar_numa_node_cpus(int node, int max_cpus, int* cpus);
+
+/**
+ * @brief
+ * Returns the NUMA node to use for a CPU compute device.
+ *
+ * @details
+ * CPU devices are divided evenly between the NUMA nodes in contiguous
+ * groups, so that devices 0 to (n / num_nodes - 1) use node 0, and so on.
+ * Returns -1 if there is only one node, in which case no pinning is needed.
+ *
+ * @param[in] i_device      Index of the CPU device.
+ * @param[in] num_devices   Number of CPU devices.
+ */
+OSKAR_EXPORT
+int oskar_numa_node_for_device(int i_device, int num_devices);
+
+/**
+ * @brief
+ * Returns the NUMA node the calling thread is pinned to.
+ *
+ * @details
+ * Returns the node index given to oskar_thread_create_on_node() when the
+ * calling thread was started, or -1 if the thread is not pinned.
+ */
+OSKAR_EXPORT
+int oskar_numa_thread_node(void);
+
+/**
+ * @brief
+ * Records the NUMA node the calling thread is pinned to.
+ *
+ * @details
+ * This is called by oskar_thread_create_on_node() at the start of each
+ * pinned thread, and should not normally be needed elsewhere.
+ *
+ * @param[in] node   Index of the NUMA node, or -1 if not pinned.
+ */
+OSKAR_EXPORT
+void oskar_numa_set_thread_node(int node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_NUMA_H_ */
@@ -42,9 +42,11 @@ extern "C" {
 struct oskar_Mutex;
 struct oskar_Thread;
 struct oskar_Barrier;
+struct oskar_ThreadPool;
 typedef struct oskar_Mutex oskar_Mutex;
 typedef struct oskar_Thread oskar_Thread;
 typedef struct oskar_Barrier oskar_Barrier;
+typedef struct oskar_ThreadPool oskar_ThreadPool;
 
 /**
  * @brief Creates a mutex.
@@ -100,6 +102,22 @@ OSKAR_EXPORT
 oskar_Thread* oskar_thread_create(void *(*start_routine)(void*), void* arg,
         int detached);
 
+/**
+ * @brief Creates and starts a thread pinned to a NUMA node.
+ *
+ * @details
+ * Creates and starts a thread that may only run on the CPUs of the
+ * given NUMA node, so that memory it touches first is allocated on that
+ * node. The node index is in the range 0 to oskar_numa_num_nodes() - 1.
+ * The thread can read its node using oskar_numa_thread_node().
+ *
+ * If \p numa_node is negative, or pinning is not supported, this is the
+ * same as oskar_thread_create().
+ */
+OSKAR_EXPORT
+oskar_Thread* oskar_thread_create_on_node(void *(*start_routine)(void*),
+        void* arg, int detached, int numa_node);
+
 /**
  * @brief Deallocates thread resources.
  *
@@ -163,6 +181,74 @@ void oskar_barrier_set_num_threads(oskar_Barrier* barrier, int num_threads);
 OSKAR_EXPORT
 int oskar_barrier_wait(oskar_Barrier* barrier);
 
+/**
+ * @brief Creates a pool of worker threads.
+ *
+ * @details
+ * Creates a pool of long-lived worker threads, which run tasks
+ * submitted using oskar_thread_pool_submit().
+ *
+ * This avoids the cost of creating and joining threads each time
+ * a parallel section needs to be run.
+ *
+ * @param[in] num_threads Number of worker threads in the pool.
+ */
+OSKAR_EXPORT
+oskar_ThreadPool* oskar_thread_pool_create(int num_threads);
+
+/**
+ * @brief Destroys the thread pool.
+ *
+ * @details
+ * Waits for any outstanding tasks to finish, then stops the worker
+ * threads and destroys the pool.
+ *
+ * @param[in,out] pool Pointer to thread pool.
+ */
+OSKAR_EXPORT
+void oskar_thread_pool_free(oskar_ThreadPool* pool);
+
+/**
+ * @brief Returns the number of worker threads in the pool.
+ *
+ * @details
+ * Returns the number of worker threads in the pool.
+ *
+ * @param[in] pool Pointer to thread pool.
+ */
+OSKAR_EXPORT
+int oskar_thread_pool_num_threads(const oskar_ThreadPool* pool);
+
+/**
+ * @brief Submits a task to the thread pool.
+ *
+ * @details
+ * Adds a task to the queue, to be run by the next available worker thread.
+ * Tasks are started in the order in which they are submitted.
+ *
+ * The return value of the task function is ignored.
+ *
+ * @param[in,out] pool          Pointer to thread pool.
+ * @param[in]     start_routine Task function.
+ * @param[in]     arg           Argument to pass to the task function.
+ */
+OSKAR_EXPORT
+void oskar_thread_pool_submit(oskar_ThreadPool* pool,
+        void *(*start_routine)(void*), void* arg);
+
+/**
+ * @brief Blocks the caller until all submitted tasks have finished.
+ *
+ * @details
+ * Blocks the caller until all submitted tasks have finished.
+ *
+ * Tasks must not call this function on their own pool.
+ *
+ * @param[in,out] pool Pointer to thread pool.
+ */
+OSKAR_EXPORT
+void oskar_thread_pool_wait(oskar_ThreadPool* pool);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_TRACE_H_
+#define OSKAR_TRACE_H_
+
+/**
+ * @file oskar_trace.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _cl_event;
+
+/**
+ * @brief
+ * Enables tracing, and sets the name of the trace file.
+ *
+ * @details
+ * Enables a process-wide record of every kernel launch, memory copy,
+ * file write and barrier wait, and sets the name of the file the trace
+ * will be written to, in Chrome trace event (JSON) format.
+ * The trace can be viewed using chrome://tracing or https://ui.perfetto.dev
+ *
+ * Tracing can also be enabled by setting the environment variable
+ * OSKAR_TRACE_FILE to the name of the trace file.
+ *
+ * The trace is written by oskar_trace_write(), and again automatically
+ * when the process exits.
+ *
+ * @param[in] filename  Name of the trace file. If NULL or empty,
+ *                      tracing is disabled.
+ */
+OSKAR_EXPORT
+void oskar_trace_set_file(const char* filename);
+
+/**
+ * @brief
+ * Returns true if tracing is enabled.
+ *
+ * @details
+ * Returns true if tracing is enabled. This is cheap to call, and should be
+ * checked before recording anything.
+ */
+OSKAR_EXPORT
+int oskar_trace_enabled(void);
+
+/**
+ * @brief
+ * Returns the current trace time, in microseconds.
+ *
+ * @details
+ * Returns the time since tracing was enabled, in microseconds,
+ * or 0 if tracing is not enabled.
+ */
+OSKAR_EXPORT
+double oskar_trace_time(void);
+
+/**
+ * @brief
+ * Adds a completed event to the trace.
+ *
+ * @details
+ * Adds an event that started at \p start_us and ends now,
+ * on the calling thread.
+ *
+ * The category and count name must be string literals, as only pointers
+ * to them are stored.
+ *
+ * @param[in] category   Category of the event ("kernel", "copy", "io"...).
+ * @param[in] name       Name of the event (copied).
+ * @param[in] start_us   Start time of the event, from oskar_trace_time().
+ * @param[in] device     Device index, or -1 if not applicable.
+ * @param[in] count_name Name of the count (e.g. "bytes"), or NULL.
+ * @param[in] count      Number of bytes or elements processed.
+ */
+OSKAR_EXPORT
+void oskar_trace_add(const char* category, const char* name,
+        double start_us, int device, const char* count_name, size_t count);
+
+/**
+ * @brief
+ * Adds an OpenCL command to the trace.
+ *
+ * @details
+ * Adds an event for an OpenCL command that was enqueued at \p queued_us.
+ * The trace takes ownership of the reference to \p event, and uses its
+ * profiling information to find when the command actually ran on the device.
+ * Events are resolved and released in batches as their commands complete.
+ * If too many are still pending, the calling thread waits for the oldest
+ * ones, so the number held at once is bounded.
+ *
+ * If OpenCL is not available, or the event is NULL, this behaves as
+ * oskar_trace_add().
+ *
+ * @param[in] category   Category of the event ("kernel", "copy", "io"...).
+ * @param[in] name       Name of the event (copied).
+ * @param[in] queued_us  Time the command was enqueued.
+ * @param[in] device     Device index, or -1 if not applicable.
+ * @param[in] count_name Name of the count (e.g. "bytes"), or NULL.
+ * @param[in] count      Number of bytes or elements processed.
+ * @param[in] event      OpenCL event for the command.
+ */
+OSKAR_EXPORT
+void oskar_trace_add_cl(const char* category, const char* name,
+        double queued_us, int device, const char* count_name, size_t count,
+        struct _cl_event* event);
+
+/**
+ * @brief
+ * Writes the trace file.
+ *
+ * @details
+ * Writes all events recorded so far to the trace file.
+ * Events are kept, so the file always holds the whole trace.
+ * Does nothing if tracing is not enabled.
+ *
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_trace_write(int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_TRACE_H_ */
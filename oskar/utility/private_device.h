@@ -60,6 +60,7 @@ struct oskar_Device
     struct _cl_device_id* device_id_cl;
     struct _cl_context* context;
     struct _cl_command_queue* default_queue;
+    struct _cl_command_queue* transfer_queue;
     struct _cl_program* program;
 };
 #ifndef OSKAR_DEVICE_TYPEDEF_
@@ -48,8 +48,10 @@
 #include "utility/oskar_cl_registrar.h"
 #include "utility/oskar_cuda_registrar.h"
 #include "utility/oskar_dir.h"
+#include "utility/oskar_get_memory_usage.h"
 #include "utility/oskar_lock_file.h"
 #include "utility/oskar_thread.h"
+#include "utility/oskar_trace.h"
 
 #ifdef OSKAR_OS_WIN
 #define THREAD_LOCAL __declspec(thread)
@@ -91,6 +93,69 @@ struct LocalMutex
 };
 static LocalMutex mutex_;
 
+// Ordered loads and stores, for kernel handles cached by callers.
+// (x86 and x64 loads and stores are already ordered, so MSVC only needs
+// a compiler barrier.)
+#if defined(__GNUC__) || defined(__clang__)
+#define LOAD_ACQUIRE(X) __atomic_load_n(&(X), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(X, V) __atomic_store_n(&(X), (V), __ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define LOAD_ACQUIRE(X) (_ReadWriteBarrier(), (X))
+#define STORE_RELEASE(X, V) { _ReadWriteBarrier(); (X) = (V); }
+#else
+#define LOAD_ACQUIRE(X) (X)
+#define STORE_RELEASE(X, V) (X) = (V)
+#endif
+
+struct oskar_DeviceKernel
+{
+    std::string name;
+    const void* cuda_function;
+#ifdef OSKAR_HAVE_OPENCL
+    // Idle copies of the OpenCL kernel object for each device.
+    // A launching thread takes one for its own use, so that no two threads
+    // ever set arguments on the same cl_kernel at the same time.
+    LocalMutex lock;
+    std::vector<std::vector<cl_kernel> > idle;
+#endif
+};
+static std::map<std::string, oskar_DeviceKernel*> kernel_handles_;
+
+#ifdef OSKAR_HAVE_OPENCL
+static cl_kernel kernel_acquire_cl(const oskar_DeviceKernel* kernel,
+        unsigned int device_index, oskar_Device* device)
+{
+    cl_kernel k = 0;
+    oskar_DeviceKernel* h = const_cast<oskar_DeviceKernel*>(kernel);
+    h->lock.lock();
+    if (device_index < h->idle.size() && !h->idle[device_index].empty())
+    {
+        k = h->idle[device_index].back();
+        h->idle[device_index].pop_back();
+    }
+    h->lock.unlock();
+    if (!k && device->program &&
+            device->kern->kernel.count(kernel->name) > 0)
+    {
+        cl_int error = 0;
+        k = clCreateKernel(device->program, kernel->name.c_str(), &error);
+        if (error != CL_SUCCESS) k = 0;
+    }
+    return k;
+}
+
+static void kernel_release_cl(const oskar_DeviceKernel* kernel,
+        unsigned int device_index, cl_kernel k)
+{
+    oskar_DeviceKernel* h = const_cast<oskar_DeviceKernel*>(kernel);
+    h->lock.lock();
+    if (device_index >= h->idle.size()) h->idle.resize(device_index + 1);
+    h->idle[device_index].push_back(k);
+    h->lock.unlock();
+}
+#endif
+
 void oskar_device_check_error_cuda(int* status)
 {
     if (*status) return;
@@ -142,6 +207,12 @@ void oskar_device_free(oskar_Device* device)
     free(device->cl_driver_version);
     if (device->kern) delete device->kern;
 #ifdef OSKAR_HAVE_OPENCL
+    if (device->transfer_queue)
+    {
+        clFlush(device->transfer_queue);
+        clFinish(device->transfer_queue);
+        clReleaseCommandQueue(device->transfer_queue);
+    }
     if (device->default_queue)
     {
         clFlush(device->default_queue);
@@ -210,17 +281,192 @@ int oskar_device_is_nv(int location)
     return 0;
 }
 
+void oskar_device_event_record(int location, struct _cl_event** event,
+        int* status)
+{
+    if (!event) return;
+    *event = 0;
+    if (*status || !(location & OSKAR_CL)) return;
+#ifdef OSKAR_HAVE_OPENCL
+    const cl_int error = clEnqueueMarkerWithWaitList(oskar_device_queue_cl(),
+            0, NULL, event);
+    if (error != CL_SUCCESS)
+    {
+        oskar_log_error(0, "clEnqueueMarkerWithWaitList() error (%d).", error);
+        *status = OSKAR_ERR_COMPUTE_DEVICES;
+    }
+#else
+    *status = OSKAR_ERR_OPENCL_NOT_AVAILABLE;
+#endif
+}
+
+#ifdef OSKAR_HAVE_OPENCL
+// Returns the events in the list that are not NULL.
+static std::vector<cl_event> event_list(int num_events,
+        struct _cl_event* const* events)
+{
+    std::vector<cl_event> list;
+    for (int i = 0; events && i < num_events; ++i)
+        if (events[i]) list.push_back(events[i]);
+    return list;
+}
+#endif
+
+void oskar_device_events_enqueue_wait(int num_events,
+        struct _cl_event** events, int* status)
+{
+#ifdef OSKAR_HAVE_OPENCL
+    std::vector<cl_event> list = event_list(num_events, events);
+    if (!*status && !list.empty())
+    {
+        const cl_int error = clEnqueueBarrierWithWaitList(
+                oskar_device_queue_cl(), (cl_uint) list.size(), &list[0], NULL);
+        if (error != CL_SUCCESS)
+        {
+            oskar_log_error(0, "clEnqueueBarrierWithWaitList() error (%d).",
+                    error);
+            *status = OSKAR_ERR_COMPUTE_DEVICES;
+        }
+    }
+#else
+    (void) status;
+#endif
+    oskar_device_events_release(num_events, events);
+}
+
+void oskar_device_events_release(int num_events, struct _cl_event** events)
+{
+    if (!events) return;
+    for (int i = 0; i < num_events; ++i)
+    {
+#ifdef OSKAR_HAVE_OPENCL
+        if (events[i]) clReleaseEvent(events[i]);
+#endif
+        events[i] = 0;
+    }
+}
+
+void oskar_device_events_wait(int num_events, struct _cl_event** events,
+        int* status)
+{
+#ifdef OSKAR_HAVE_OPENCL
+    std::vector<cl_event> list = event_list(num_events, events);
+    if (!*status && !list.empty())
+    {
+        const cl_int error = clWaitForEvents((cl_uint) list.size(), &list[0]);
+        if (error != CL_SUCCESS)
+        {
+            oskar_log_error(0, "clWaitForEvents() error (%d).", error);
+            *status = OSKAR_ERR_COMPUTE_DEVICES;
+        }
+    }
+#else
+    (void) status;
+#endif
+    oskar_device_events_release(num_events, events);
+}
+
+const oskar_DeviceKernel* oskar_device_kernel(const char* name)
+{
+    if (!name) return 0;
+    oskar_DeviceKernel* kernel = 0;
+    const std::string key(name);
+    mutex_.lock();
+    std::map<std::string, oskar_DeviceKernel*>::iterator iter =
+            kernel_handles_.find(key);
+    if (iter != kernel_handles_.end())
+        kernel = iter->second;
+    else
+    {
+        kernel = new oskar_DeviceKernel;
+        kernel->name = key;
+        kernel->cuda_function = 0;
+#ifdef OSKAR_HAVE_CUDA
+        if (cuda_kernels_.empty())
+        {
+            const oskar::CudaKernelRegistrar::List& kernels =
+                    oskar::CudaKernelRegistrar::kernels();
+            for (int i = 0; i < kernels.size(); ++i)
+            {
+                std::string k = std::string(kernels[i].first);
+                cuda_kernels_.insert(make_pair(k, kernels[i].second));
+            }
+        }
+        std::map<std::string, const void*>::iterator f =
+                cuda_kernels_.find(key);
+        if (f != cuda_kernels_.end()) kernel->cuda_function = f->second;
+#endif
+        kernel_handles_[key] = kernel;
+    }
+    mutex_.unlock();
+    return kernel;
+}
+
+const oskar_DeviceKernel* oskar_device_kernel_cached(
+        const oskar_DeviceKernel** cache, const char* name)
+{
+    const oskar_DeviceKernel* kernel = LOAD_ACQUIRE(*cache);
+    if (!kernel)
+    {
+        kernel = oskar_device_kernel(name);
+        STORE_RELEASE(*cache, kernel);
+    }
+    return kernel;
+}
+
 void oskar_device_launch_kernel(const char* name, int location,
         int num_dims, size_t local_size[3], size_t global_size[3],
         size_t num_args, const oskar_Arg* arg,
         size_t num_local_args, const size_t* arg_size_local, int* status)
 {
+    oskar_device_launch_kernel_handle_async(oskar_device_kernel(name),
+            location, num_dims, local_size, global_size, num_args, arg,
+            num_local_args, arg_size_local, 0, 0, 0, status);
+}
+
+void oskar_device_launch_kernel_async(const char* name, int location,
+        int num_dims, size_t local_size[3], size_t global_size[3],
+        size_t num_args, const oskar_Arg* arg,
+        size_t num_local_args, const size_t* arg_size_local,
+        int num_wait_events, struct _cl_event* const* wait_events,
+        struct _cl_event** event, int* status)
+{
+    oskar_device_launch_kernel_handle_async(oskar_device_kernel(name),
+            location, num_dims, local_size, global_size, num_args, arg,
+            num_local_args, arg_size_local, num_wait_events, wait_events,
+            event, status);
+}
+
+void oskar_device_launch_kernel_handle(const oskar_DeviceKernel* kernel,
+        int location, int num_dims, size_t local_size[3],
+        size_t global_size[3], size_t num_args, const oskar_Arg* arg,
+        size_t num_local_args, const size_t* arg_size_local, int* status)
+{
+    oskar_device_launch_kernel_handle_async(kernel, location, num_dims,
+            local_size, global_size, num_args, arg,
+            num_local_args, arg_size_local, 0, 0, 0, status);
+}
+
+void oskar_device_launch_kernel_handle_async(const oskar_DeviceKernel* kernel,
+        int location, int num_dims, size_t local_size[3],
+        size_t global_size[3], size_t num_args, const oskar_Arg* arg,
+        size_t num_local_args, const size_t* arg_size_local,
+        int num_wait_events, struct _cl_event* const* wait_events,
+        struct _cl_event** event, int* status)
+{
+    (void) num_wait_events;
+    (void) wait_events;
+    if (event) *event = 0;
     if (*status) return;
-    if (!name)
+    if (!kernel)
     {
         *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
         return;
     }
+    const int trace = oskar_trace_enabled();
+    const double trace_start = oskar_trace_time();
+    (void) trace;
+    (void) trace_start;
     if (local_size[0] == 0) local_size[0] = 1;
     if (local_size[1] == 0) local_size[1] = 1;
     if (local_size[2] == 0) local_size[2] = 1;
@@ -230,6 +476,7 @@ void oskar_device_launch_kernel(const char* name, int location,
     if (location == OSKAR_GPU)
     {
 #ifdef OSKAR_HAVE_CUDA
+        const char* name = kernel->name.c_str();
         size_t j, shared_mem = 0;
         dim3 num_threads, num_blocks;
         void* arg_[40];
@@ -247,23 +494,19 @@ void oskar_device_launch_kernel(const char* name, int location,
         num_blocks.z  = (unsigned int) (global_size[2] / local_size[2]);
         for (j = 0; j < num_args; ++j) arg_[j] = const_cast<void*>(arg[j].ptr);
         for (j = 0; j < num_local_args; ++j) shared_mem += arg_size_local[j];
-        mutex_.lock();
-        if (cuda_kernels_.empty())
+        if (kernel->cuda_function)
         {
-            const oskar::CudaKernelRegistrar::List& kernels =
-                    oskar::CudaKernelRegistrar::kernels();
-            for (int i = 0; i < kernels.size(); ++i)
+            *status = (int) cudaLaunchKernel(kernel->cuda_function,
+                    num_blocks, num_threads, arg_, shared_mem, 0);
+            if (trace)
             {
-                std::string key = std::string(kernels[i].first);
-                cuda_kernels_.insert(make_pair(key, kernels[i].second));
+                int device_id = -1;
+                cudaGetDevice(&device_id);
+                oskar_trace_add("kernel", name, trace_start, device_id,
+                        "work_items", global_size[0] * global_size[1] *
+                        global_size[2]);
             }
         }
-        std::map<std::string, const void*>::iterator iter =
-                cuda_kernels_.find(std::string(name));
-        mutex_.unlock();
-        if (iter != cuda_kernels_.end())
-            *status = (int) cudaLaunchKernel(iter->second,
-                    num_blocks, num_threads, arg_, shared_mem, 0);
         else
         {
             oskar_log_error(0, "Kernel '%s' has not been registered.", name);
@@ -276,15 +519,13 @@ void oskar_device_launch_kernel(const char* name, int location,
     else if (location & OSKAR_CL)
     {
 #ifdef OSKAR_HAVE_OPENCL
+        const char* name = kernel->name.c_str();
         size_t i, j, work_group_size = 0;
         cl_int error = 0;
-        cl_kernel k = 0;
         if (cl_devices_.size() == 0) oskar_device_init_cl();
         if (current_device_ >= cl_devices_.size()) return;
         oskar_Device* device = cl_devices_[current_device_];
-        std::map<std::string, cl_kernel>::iterator iter =
-                device->kern->kernel.find(name);
-        if (iter != device->kern->kernel.end()) k = iter->second;
+        cl_kernel k = kernel_acquire_cl(kernel, current_device_, device);
         if (!k)
         {
             oskar_log_error(0, "Kernel '%s' has not been registered.", name);
@@ -302,12 +543,24 @@ void oskar_device_launch_kernel(const char* name, int location,
             }
         if (error != CL_SUCCESS)
         {
+            kernel_release_cl(kernel, current_device_, k);
             *status = OSKAR_ERR_INVALID_ARGUMENT;
             return;
         }
+        std::vector<cl_event> wait = event_list(num_wait_events, wait_events);
+        cl_event trace_event = 0;
         error = clEnqueueNDRangeKernel(oskar_device_queue_cl(), k,
                 (cl_uint) num_dims, NULL, global_size, local_size,
-                0, NULL, NULL);
+                (cl_uint) wait.size(), wait.empty() ? NULL : &wait[0],
+                event ? event : (trace ? &trace_event : NULL));
+        if (trace && error == CL_SUCCESS)
+        {
+            if (event) clRetainEvent(trace_event = *event);
+            oskar_trace_add_cl("kernel", name, trace_start,
+                    (int) current_device_, "work_items",
+                    global_size[0] * global_size[1] * global_size[2],
+                    trace_event);
+        }
         if (error != CL_SUCCESS)
         {
             oskar_log_error(0, "Kernel '%s' launch failure (OpenCL error %d).",
@@ -324,6 +577,10 @@ void oskar_device_launch_kernel(const char* name, int location,
             }
             *status = OSKAR_ERR_KERNEL_LAUNCH_FAILURE;
         }
+
+        // The arguments have been captured by the enqueue,
+        // so the kernel object can now be used by another thread.
+        kernel_release_cl(kernel, current_device_, k);
 #else
         *status = OSKAR_ERR_OPENCL_NOT_AVAILABLE;
 #endif
@@ -332,6 +589,36 @@ void oskar_device_launch_kernel(const char* name, int location,
         *status = OSKAR_ERR_BAD_LOCATION;
 }
 
+void oskar_device_mem_info(int location, int id, size_t* mem_free,
+        size_t* mem_total, size_t* max_alloc)
+{
+    *mem_free = *mem_total = *max_alloc = 0;
+    if (location == OSKAR_CPU)
+    {
+        *mem_free = oskar_get_free_physical_memory();
+        *mem_total = oskar_get_total_physical_memory();
+        *max_alloc = *mem_free;
+    }
+#ifdef OSKAR_HAVE_CUDA
+    else if (location == OSKAR_GPU)
+    {
+        int status = 0;
+        oskar_device_set(location, id, &status);
+        if (status) return;
+        cudaMemGetInfo(mem_free, mem_total);
+        *max_alloc = *mem_free;
+    }
+#endif
+    else if (location & OSKAR_CL)
+    {
+        if (cl_devices_.size() == 0) oskar_device_init_cl();
+        if (id >= (int) cl_devices_.size()) return;
+        *mem_free = cl_devices_[id]->global_mem_size;
+        *mem_total = cl_devices_[id]->global_mem_size;
+        *max_alloc = cl_devices_[id]->max_mem_alloc_size;
+    }
+}
+
 char* oskar_device_name(int location, int id)
 {
     char* name = 0;
@@ -361,6 +648,13 @@ struct _cl_command_queue* oskar_device_queue_cl(void)
     return i < cl_devices_.size() ? cl_devices_[i]->default_queue : 0;
 }
 
+struct _cl_command_queue* oskar_device_queue_transfer_cl(void)
+{
+    if (cl_devices_.size() == 0) oskar_device_init_cl();
+    unsigned int i = current_device_;
+    return i < cl_devices_.size() ? cl_devices_[i]->transfer_queue : 0;
+}
+
 int oskar_device_require_double(void)
 {
     return require_double_;
@@ -378,6 +672,21 @@ void oskar_device_reset_all(void)
     }
 #endif
     mutex_.lock();
+#ifdef OSKAR_HAVE_OPENCL
+    // Release the per-thread kernel copies, but keep the handles,
+    // as callers may still hold them.
+    for (std::map<std::string, oskar_DeviceKernel*>::iterator i =
+            kernel_handles_.begin(); i != kernel_handles_.end(); ++i)
+    {
+        oskar_DeviceKernel* h = i->second;
+        h->lock.lock();
+        for (size_t d = 0; d < h->idle.size(); ++d)
+            for (size_t k = 0; k < h->idle[d].size(); ++k)
+                clReleaseKernel(h->idle[d][k]);
+        h->idle.clear();
+        h->lock.unlock();
+    }
+#endif
     for (size_t i = 0; i < cl_devices_.size(); ++i)
         oskar_device_free(cl_devices_[i]);
     cl_devices_.clear();
@@ -715,6 +1024,13 @@ static void oskar_device_set_up_cl(oskar_Device* device)
                 device->device_id_cl, CL_QUEUE_PROFILING_ENABLE, &error);
         if (error != CL_SUCCESS) func = "clCreateCommandQueue";
     }
+    if (error == CL_SUCCESS)
+    {
+        // Create a second queue, so transfers can overlap with kernels.
+        device->transfer_queue = clCreateCommandQueue(device->context,
+                device->device_id_cl, CL_QUEUE_PROFILING_ENABLE, &error);
+        if (error != CL_SUCCESS) func = "clCreateCommandQueue";
+    }
     if (error || func) oskar_log_error(0, "%s error (%d).", func, error);
 #endif
     free(program_binary);
@@ -34,6 +34,7 @@
 #include "utility/private_device.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_device_log.h"
+#include "utility/oskar_numa.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -143,6 +144,27 @@ void oskar_device_log_mem(int location, int depth, int id, oskar_Log* log)
     }
 }
 
+void oskar_device_log_numa(int first_device, int num_devices, oskar_Log* log)
+{
+    int i = 0, cpus[1024];
+    const int num_nodes = oskar_numa_num_nodes();
+    if (num_nodes < 2 || num_devices < 1) return;
+    oskar_log_message(log, 'M', 0,
+            "Pinning CPU devices to %d NUMA nodes.", num_nodes);
+    while (i < num_devices)
+    {
+        int j = i;
+        const int node = oskar_numa_node_for_device(i, num_devices);
+        while (j + 1 < num_devices &&
+                oskar_numa_node_for_device(j + 1, num_devices) == node) j++;
+        oskar_log_message(log, 'M', 1,
+                "Devices %d-%d: NUMA node %d (%d CPUs).",
+                first_device + i, first_device + j, node,
+                oskar_numa_node_cpus(node, 1024, cpus));
+        i = j + 1;
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,6 +26,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "mem/oskar_mem_pool.h"
 #include "utility/oskar_get_memory_usage.h"
 
 #include <stdio.h>
@@ -258,6 +259,20 @@ void oskar_log_mem(oskar_Log* log)
     oskar_log_message(log, 'M', 0,
             "System memory used by current process: %.1f MB.",
             (double) mem_resident / (1024. * 1024.));
+    size_t in_use = 0, peak = 0, cached = 0, num_allocs = 0, num_reused = 0;
+    oskar_mem_pool_stats(&in_use, &peak, &cached, &num_allocs, &num_reused);
+    if (num_allocs > 0)
+    {
+        oskar_log_message(log, 'M', 0, "Host arrays use %.1f MB "
+                "(peak %.1f MB), with %.1f MB cached for reuse.",
+                (double) in_use / (1024. * 1024.),
+                (double) peak / (1024. * 1024.),
+                (double) cached / (1024. * 1024.));
+        oskar_log_message(log, 'M', 0, "%lu of %lu host array allocations "
+                "(%.1f%%) reused cached memory.",
+                (unsigned long) num_reused, (unsigned long) num_allocs,
+                100. * (double) num_reused / num_allocs);
+    }
 }
 
 #ifdef __cplusplus
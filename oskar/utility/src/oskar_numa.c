@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "utility/oskar_numa.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_NODES 256
+
+#ifdef OSKAR_OS_WIN
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+/* Node the current thread is pinned to, offset by one so that
+ * the zero-initialised value means "not pinned". */
+static THREAD_LOCAL int thread_node_ = 0;
+
+/* Parses a sysfs list, such as "0-7,16-23", and returns its length. */
+static int read_list(const char* path, int max_items, int* items)
+{
+    int num = 0, lo = 0, hi = 0, i;
+    char sep = 0;
+    FILE* file = fopen(path, "r");
+    if (!file) return 0;
+    while (fscanf(file, "%d", &lo) == 1)
+    {
+        hi = lo;
+        if (fscanf(file, "%c", &sep) == 1 && sep == '-')
+        {
+            if (fscanf(file, "%d", &hi) != 1) break;
+            if (fscanf(file, "%c", &sep) != 1) sep = 0;
+        }
+        for (i = lo; i <= hi; ++i)
+        {
+            if (num < max_items) items[num] = i;
+            num++;
+        }
+        if (sep != ',') break;
+    }
+    fclose(file);
+    return num < max_items ? num : max_items;
+}
+
+static int node_ids(int* ids)
+{
+    return read_list("/sys/devices/system/node/online", MAX_NODES, ids);
+}
+
+int oskar_numa_num_nodes(void)
+{
+    int ids[MAX_NODES];
+    const int num_nodes = node_ids(ids);
+    return num_nodes > 0 ? num_nodes : 1;
+}
+
+int oskar_numa_node_cpus(int node, int max_cpus, int* cpus)
+{
+    char path[128];
+    int ids[MAX_NODES];
+    const int num_nodes = node_ids(ids);
+    if (node < 0 || node >= num_nodes) return 0;
+    snprintf(path, sizeof(path),
+            "/sys/devices/system/node/node%d/cpulist", ids[node]);
+    return read_list(path, max_cpus, cpus);
+}
+
+int oskar_numa_node_for_device(int i_device, int num_devices)
+{
+    const int num_nodes = oskar_numa_num_nodes();
+    if (num_nodes < 2 || num_devices < 1) return -1;
+    return (int) (((long) i_device * num_nodes) / num_devices);
+}
+
+int oskar_numa_thread_node(void)
+{
+    return thread_node_ - 1;
+}
+
+void oskar_numa_set_thread_node(int node)
+{
+    thread_node_ = node < 0 ? 0 : node + 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -26,7 +26,13 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* For pthread_attr_setaffinity_np(). */
+#endif
+
+#include "utility/oskar_numa.h"
 #include "utility/oskar_thread.h"
+#include "utility/oskar_trace.h"
 #include <stdlib.h>
 
 #ifdef OSKAR_OS_WIN
@@ -197,11 +203,39 @@ unsigned __stdcall thread_func_win(void* arg)
 }
 #endif
 
+#ifdef CPU_SET
+struct PinnedThreadArgs
+{
+    void *(*start_routine)(void*);
+    void *arg;
+    int numa_node;
+};
+typedef struct PinnedThreadArgs PinnedThreadArgs;
+
+/* Records the node of a pinned thread before running it. */
+static void* thread_func_pinned(void* arg)
+{
+    PinnedThreadArgs a = *((PinnedThreadArgs*)arg);
+    free(arg);
+    oskar_numa_set_thread_node(a.numa_node);
+    return a.start_routine(a.arg);
+}
+#endif
+
 oskar_Thread* oskar_thread_create(void *(*start_routine)(void*), void* arg,
         int detached)
+{
+    return oskar_thread_create_on_node(start_routine, arg, detached, -1);
+}
+
+oskar_Thread* oskar_thread_create_on_node(void *(*start_routine)(void*),
+        void* arg, int detached, int numa_node)
 {
 #ifndef OSKAR_OS_WIN
     pthread_attr_t attr;
+#endif
+#ifndef CPU_SET
+    (void) numa_node;
 #endif
     oskar_Thread* thread;
     thread = (oskar_Thread*) calloc(1, sizeof(oskar_Thread));
@@ -218,6 +252,28 @@ oskar_Thread* oskar_thread_create(void *(*start_routine)(void*), void* arg,
     pthread_attr_init(&attr);
     pthread_attr_setdetachstate(&attr,
             detached ? PTHREAD_CREATE_DETACHED : PTHREAD_CREATE_JOINABLE);
+#ifdef CPU_SET
+    if (numa_node >= 0)
+    {
+        int i, cpus[CPU_SETSIZE];
+        cpu_set_t cpu_set;
+        const int num_cpus = oskar_numa_node_cpus(numa_node,
+                CPU_SETSIZE, cpus);
+        CPU_ZERO(&cpu_set);
+        for (i = 0; i < num_cpus; ++i) CPU_SET(cpus[i], &cpu_set);
+        if (num_cpus > 0)
+        {
+            PinnedThreadArgs* a = (PinnedThreadArgs*)
+                    malloc(sizeof(PinnedThreadArgs));
+            a->start_routine = start_routine;
+            a->arg = arg;
+            a->numa_node = numa_node;
+            start_routine = thread_func_pinned;
+            arg = a;
+            pthread_attr_setaffinity_np(&attr, sizeof(cpu_set), &cpu_set);
+        }
+    }
+#endif
     pthread_create(&thread->thread, &attr, start_routine, arg);
     pthread_attr_destroy(&attr);
 #endif
@@ -281,6 +337,7 @@ void oskar_barrier_set_num_threads(oskar_Barrier* barrier, int num_threads)
 
 int oskar_barrier_wait(oskar_Barrier* barrier)
 {
+    const double t0 = oskar_trace_time();
     oskar_condition_lock(&barrier->var);
     {
         const unsigned int i = barrier->iter;
@@ -290,6 +347,7 @@ int oskar_barrier_wait(oskar_Barrier* barrier)
             barrier->count = barrier->num_threads;
             oskar_condition_notify_all(&barrier->var);
             oskar_condition_unlock(&barrier->var);
+            oskar_trace_add("wait", "barrier", t0, -1, 0, 0);
             return 1;
         }
         /* Release lock and block this thread until notified/woken. */
@@ -299,9 +357,123 @@ int oskar_barrier_wait(oskar_Barrier* barrier)
         } while (i == barrier->iter);
     }
     oskar_condition_unlock(&barrier->var);
+    oskar_trace_add("wait", "barrier", t0, -1, 0, 0);
     return 0;
 }
 
+/* =========================================================================
+ *  THREAD POOL
+ * =========================================================================*/
+
+struct oskar_ThreadPoolTask
+{
+    void *(*start_routine)(void*);
+    void *arg;
+    struct oskar_ThreadPoolTask* next;
+};
+typedef struct oskar_ThreadPoolTask oskar_ThreadPoolTask;
+
+struct oskar_ThreadPool
+{
+    oskar_ConditionVar var;
+    oskar_Thread** threads;
+    oskar_ThreadPoolTask *head, *tail;
+    int num_threads, num_unfinished, finish;
+};
+
+static void* thread_pool_worker(void* arg)
+{
+    oskar_ThreadPool* pool = (oskar_ThreadPool*) arg;
+    oskar_condition_lock(&pool->var);
+    for (;;)
+    {
+        oskar_ThreadPoolTask* task;
+
+        /* Allow for spurious wake-ups. */
+        while (!pool->head && !pool->finish)
+            oskar_condition_wait(&pool->var);
+        if (!pool->head) break;
+
+        /* Remove the task from the queue, and run it without the lock. */
+        task = pool->head;
+        pool->head = task->next;
+        if (!pool->head) pool->tail = 0;
+        oskar_condition_unlock(&pool->var);
+        task->start_routine(task->arg);
+        free(task);
+        oskar_condition_lock(&pool->var);
+        if (--(pool->num_unfinished) == 0)
+            oskar_condition_notify_all(&pool->var);
+    }
+    oskar_condition_unlock(&pool->var);
+    return 0;
+}
+
+oskar_ThreadPool* oskar_thread_pool_create(int num_threads)
+{
+    int i;
+    oskar_ThreadPool* pool;
+    if (num_threads < 1) num_threads = 1;
+    pool = (oskar_ThreadPool*) calloc(1, sizeof(oskar_ThreadPool));
+    oskar_condition_init(&pool->var);
+    pool->num_threads = num_threads;
+    pool->threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+    for (i = 0; i < num_threads; ++i)
+        pool->threads[i] = oskar_thread_create(thread_pool_worker,
+                (void*)pool, 0);
+    return pool;
+}
+
+void oskar_thread_pool_free(oskar_ThreadPool* pool)
+{
+    int i;
+    if (!pool) return;
+    oskar_thread_pool_wait(pool);
+    oskar_condition_lock(&pool->var);
+    pool->finish = 1;
+    oskar_condition_notify_all(&pool->var);
+    oskar_condition_unlock(&pool->var);
+    for (i = 0; i < pool->num_threads; ++i)
+    {
+        oskar_thread_join(pool->threads[i]);
+        oskar_thread_free(pool->threads[i]);
+    }
+    free(pool->threads);
+    oskar_condition_uninit(&pool->var);
+    free(pool);
+}
+
+int oskar_thread_pool_num_threads(const oskar_ThreadPool* pool)
+{
+    return pool ? pool->num_threads : 0;
+}
+
+void oskar_thread_pool_submit(oskar_ThreadPool* pool,
+        void *(*start_routine)(void*), void* arg)
+{
+    oskar_ThreadPoolTask* task;
+    task = (oskar_ThreadPoolTask*) calloc(1, sizeof(oskar_ThreadPoolTask));
+    task->start_routine = start_routine;
+    task->arg = arg;
+    oskar_condition_lock(&pool->var);
+    if (pool->tail)
+        pool->tail->next = task;
+    else
+        pool->head = task;
+    pool->tail = task;
+    (pool->num_unfinished)++;
+    oskar_condition_notify_all(&pool->var);
+    oskar_condition_unlock(&pool->var);
+}
+
+void oskar_thread_pool_wait(oskar_ThreadPool* pool)
+{
+    oskar_condition_lock(&pool->var);
+    while (pool->num_unfinished > 0)
+        oskar_condition_wait(&pool->var);
+    oskar_condition_unlock(&pool->var);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* For clock_gettime(). */
+#endif
+
+#include "utility/oskar_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef OSKAR_OS_WIN
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef OSKAR_HAVE_OPENCL
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef OSKAR_OS_WIN
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+typedef struct
+{
+    char name[64];
+    const char *category, *count_name;
+    double start_us, end_us;
+    size_t count;
+    int thread, device;
+#ifdef OSKAR_HAVE_OPENCL
+    cl_event event;
+#endif
+} TraceEvent;
+
+/* OpenCL events are resolved in batches once this many are pending,
+ * and the host waits for the oldest ones if twice this many are pending,
+ * so that the number of live events stays bounded in long runs. */
+#define TRACE_CL_BATCH 1024
+
+static TraceEvent* events_ = 0;
+static size_t num_events_ = 0, capacity_ = 0;
+static size_t num_pending_cl_ = 0, first_pending_cl_ = 0;
+static char* filename_ = 0;
+static int enabled_ = -1; /* Set to -1 until the environment is checked. */
+static int registered_ = 0, num_threads_ = 0;
+static double t0_ = 0.0;
+static THREAD_LOCAL int thread_id_ = 0;
+
+#ifdef OSKAR_OS_WIN
+static SRWLOCK trace_lock = SRWLOCK_INIT;
+#define TRACE_LOCK AcquireSRWLockExclusive(&trace_lock)
+#define TRACE_UNLOCK ReleaseSRWLockExclusive(&trace_lock)
+#else
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+#define TRACE_LOCK pthread_mutex_lock(&trace_lock)
+#define TRACE_UNLOCK pthread_mutex_unlock(&trace_lock)
+#endif
+
+static double wall_time_us(void)
+{
+#ifdef OSKAR_OS_WIN
+    LARGE_INTEGER cntr, freq;
+    QueryPerformanceCounter(&cntr);
+    QueryPerformanceFrequency(&freq);
+    return 1e6 * (double)(cntr.QuadPart) / (double)(freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1e6 * ts.tv_sec + ts.tv_nsec / 1e3;
+#endif
+}
+
+static void write_at_exit(void)
+{
+    int status = 0;
+    oskar_trace_write(&status);
+}
+
+/* Must be called with the lock held. */
+static void set_file(const char* filename)
+{
+    free(filename_);
+    filename_ = 0;
+    enabled_ = (filename && strlen(filename) > 0);
+    if (!enabled_) return;
+    filename_ = (char*) malloc(1 + strlen(filename));
+    if (!filename_)
+    {
+        enabled_ = 0;
+        return;
+    }
+    strcpy(filename_, filename);
+    if (t0_ == 0.0) t0_ = wall_time_us();
+    if (!registered_)
+    {
+        atexit(write_at_exit);
+        registered_ = 1;
+    }
+}
+
+/* Must be called with the lock held. */
+static TraceEvent* new_event(const char* category, const char* name,
+        double start_us, int device, const char* count_name, size_t count)
+{
+    TraceEvent* e;
+    if (num_events_ == capacity_)
+    {
+        const size_t new_capacity = capacity_ ? 2 * capacity_ : 4096;
+        TraceEvent* t = (TraceEvent*) realloc(events_,
+                new_capacity * sizeof(TraceEvent));
+        if (!t) return 0;
+        events_ = t;
+        capacity_ = new_capacity;
+    }
+    e = &events_[num_events_++];
+    memset(e, 0, sizeof(TraceEvent));
+    if (name)
+    {
+        strncpy(e->name, name, sizeof(e->name) - 1);
+        e->name[sizeof(e->name) - 1] = 0;
+    }
+    e->category = category;
+    e->count_name = count_name;
+    e->count = count;
+    e->start_us = start_us;
+    e->device = device;
+    e->thread = thread_id_;
+    return e;
+}
+
+static void assign_thread_id(void)
+{
+    if (thread_id_) return;
+    TRACE_LOCK;
+    thread_id_ = ++num_threads_;
+    TRACE_UNLOCK;
+}
+
+void oskar_trace_set_file(const char* filename)
+{
+    TRACE_LOCK;
+    set_file(filename);
+    TRACE_UNLOCK;
+}
+
+int oskar_trace_enabled(void)
+{
+    if (enabled_ < 0)
+    {
+        TRACE_LOCK;
+        if (enabled_ < 0) set_file(getenv("OSKAR_TRACE_FILE"));
+        TRACE_UNLOCK;
+    }
+    return enabled_;
+}
+
+double oskar_trace_time(void)
+{
+    if (!oskar_trace_enabled()) return 0.0;
+    return wall_time_us() - t0_;
+}
+
+void oskar_trace_add(const char* category, const char* name,
+        double start_us, int device, const char* count_name, size_t count)
+{
+    TraceEvent* e;
+    if (!oskar_trace_enabled()) return;
+    const double end_us = oskar_trace_time();
+    assign_thread_id();
+    TRACE_LOCK;
+    e = new_event(category, name, start_us, device, count_name, count);
+    if (e) e->end_us = end_us;
+    TRACE_UNLOCK;
+}
+
+/* Replaces the host times of an OpenCL command with its device times,
+ * and releases the event. If wait is false, the event is only resolved if
+ * the command has completed. Returns false if the command is still pending.
+ * Must be called with the lock held. */
+static int resolve_cl(TraceEvent* e, int wait)
+{
+#ifdef OSKAR_HAVE_OPENCL
+    cl_ulong queued = 0, start = 0, end = 0;
+    cl_int error, exec_status = CL_COMPLETE;
+    if (!e->event) return 1;
+    if (!wait)
+    {
+        error = clGetEventInfo(e->event, CL_EVENT_COMMAND_EXECUTION_STATUS,
+                sizeof(cl_int), &exec_status, NULL);
+        if (error == CL_SUCCESS && exec_status > CL_COMPLETE) return 0;
+    }
+    else
+        error = clWaitForEvents(1, &e->event);
+    error |= clGetEventProfilingInfo(e->event, CL_PROFILING_COMMAND_QUEUED,
+            sizeof(cl_ulong), &queued, NULL);
+    error |= clGetEventProfilingInfo(e->event, CL_PROFILING_COMMAND_START,
+            sizeof(cl_ulong), &start, NULL);
+    error |= clGetEventProfilingInfo(e->event, CL_PROFILING_COMMAND_END,
+            sizeof(cl_ulong), &end, NULL);
+    if (error == CL_SUCCESS && exec_status == CL_COMPLETE &&
+            start >= queued && end >= start)
+    {
+        /* Device clocks are not host clocks, so only use the offsets
+         * from the time the command was queued. */
+        e->start_us += (double)(start - queued) / 1e3;
+        e->end_us = e->start_us + (double)(end - start) / 1e3;
+    }
+    clReleaseEvent(e->event);
+    e->event = 0;
+    num_pending_cl_--;
+    return 1;
+#else
+    (void) e;
+    (void) wait;
+    return 1;
+#endif
+}
+
+/* Resolves pending OpenCL events, oldest first, until at most max_pending
+ * are left. If wait is false, stops at the first command that has not
+ * completed. Must be called with the lock held. */
+static void resolve_pending_cl(int wait, size_t max_pending)
+{
+    for (; first_pending_cl_ < num_events_ && num_pending_cl_ > max_pending;
+            ++first_pending_cl_)
+    {
+        if (!resolve_cl(&events_[first_pending_cl_], wait)) break;
+    }
+}
+
+void oskar_trace_add_cl(const char* category, const char* name,
+        double queued_us, int device, const char* count_name, size_t count,
+        struct _cl_event* event)
+{
+    TraceEvent* e;
+    if (!oskar_trace_enabled())
+    {
+#ifdef OSKAR_HAVE_OPENCL
+        if (event) clReleaseEvent(event);
+#endif
+        return;
+    }
+    const double end_us = oskar_trace_time();
+    assign_thread_id();
+    TRACE_LOCK;
+    e = new_event(category, name, queued_us, device, count_name, count);
+    if (e) e->end_us = end_us;
+#ifdef OSKAR_HAVE_OPENCL
+    if (e && event)
+    {
+        e->event = event;
+        if (++num_pending_cl_ >= TRACE_CL_BATCH)
+        {
+            resolve_pending_cl(0, 0);
+            if (num_pending_cl_ >= 2 * TRACE_CL_BATCH)
+                resolve_pending_cl(1, TRACE_CL_BATCH);
+        }
+    }
+    else if (event) clReleaseEvent(event);
+#else
+    (void) event;
+#endif
+    TRACE_UNLOCK;
+}
+
+static void write_string(FILE* f, const char* s)
+{
+    for (; *s; ++s)
+    {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((unsigned char)(*s) >= 0x20) fputc(*s, f);
+    }
+}
+
+void oskar_trace_write(int* status)
+{
+    size_t i;
+    FILE* f;
+    if (*status || !oskar_trace_enabled()) return;
+    TRACE_LOCK;
+    f = filename_ ? fopen(filename_, "w") : 0;
+    if (!f)
+    {
+        TRACE_UNLOCK;
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    resolve_pending_cl(1, 0);
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (i = 0; i < num_events_; ++i)
+    {
+        TraceEvent* e = &events_[i];
+        fprintf(f, "%s{\"name\":\"", i > 0 ? ",\n" : "");
+        write_string(f, e->name);
+        fprintf(f, "\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                "\"pid\":1,\"tid\":%d,\"args\":{", e->category ?
+                e->category : "", e->start_us, e->end_us - e->start_us,
+                e->thread);
+        if (e->device >= 0)
+            fprintf(f, "\"device\":%d%s", e->device, e->count_name ? "," : "");
+        if (e->count_name)
+            fprintf(f, "\"%s\":%lu", e->count_name, (unsigned long) e->count);
+        fprintf(f, "}}");
+    }
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+    TRACE_UNLOCK;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -28,6 +28,7 @@
 
 #include <gtest/gtest.h>
 #include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_numa.h"
 #include "utility/oskar_thread.h"
 #include "utility/oskar_timer.h"
 #include <cstdlib>
@@ -68,6 +69,13 @@ void* thread_barriers(void* arg)
     return 0;
 }
 
+void* thread_pool_task(void* arg)
+{
+    int* value = (int*) arg;
+    *value += 1;
+    return 0;
+}
+
 TEST(thread, create_and_join)
 {
     // Get the number of CPU cores.
@@ -124,3 +132,96 @@ TEST(thread, barriers)
     free(args);
     free(threads);
 }
+
+TEST(thread, pool)
+{
+    // Create a pool with fewer threads than tasks.
+    const int num_tasks = 100;
+    oskar_ThreadPool* pool = oskar_thread_pool_create(4);
+    ASSERT_EQ(4, oskar_thread_pool_num_threads(pool));
+    int* values = (int*) calloc((size_t) num_tasks, sizeof(int));
+
+    // Submit the tasks several times, re-using the same threads.
+    for (int j = 0; j < 3; ++j)
+    {
+        for (int i = 0; i < num_tasks; ++i)
+            oskar_thread_pool_submit(pool, thread_pool_task, &values[i]);
+        oskar_thread_pool_wait(pool);
+        for (int i = 0; i < num_tasks; ++i)
+            ASSERT_EQ(j + 1, values[i]);
+    }
+
+    // Clean up.
+    oskar_thread_pool_free(pool);
+    free(values);
+}
+
+TEST(thread, create_on_numa_node)
+{
+    // Every CPU device must be given a valid node, in contiguous groups.
+    const int num_nodes = oskar_numa_num_nodes();
+    const int num_devices = 3 * num_nodes + 1;
+    ASSERT_GE(num_nodes, 1);
+    int previous = 0;
+    for (int i = 0; i < num_devices; ++i)
+    {
+        const int node = oskar_numa_node_for_device(i, num_devices);
+        if (num_nodes == 1)
+        {
+            EXPECT_EQ(-1, node);
+            continue;
+        }
+        EXPECT_GE(node, previous);
+        EXPECT_LT(node, num_nodes);
+        previous = node;
+    }
+
+    // Start a thread on each node, and check they all run.
+    int* values = (int*) calloc(num_nodes, sizeof(int));
+    oskar_Thread** threads = (oskar_Thread**)
+            calloc(num_nodes, sizeof(oskar_Thread*));
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        threads[i] = oskar_thread_create_on_node(thread_pool_task,
+                (void*)&values[i], 0, i);
+    }
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+        EXPECT_EQ(1, values[i]);
+    }
+    free(threads);
+    free(values);
+}
+
+static void* get_thread_node(void* arg)
+{
+    *((int*)arg) = oskar_numa_thread_node();
+    return 0;
+}
+
+TEST(thread, numa_thread_node)
+{
+    // Unpinned threads report no node.
+    int node = 0;
+    EXPECT_EQ(-1, oskar_numa_thread_node());
+    oskar_Thread* thread = oskar_thread_create(get_thread_node,
+            (void*)&node, 0);
+    oskar_thread_join(thread);
+    oskar_thread_free(thread);
+    EXPECT_EQ(-1, node);
+
+    // Pinned threads report their node, if the topology is available.
+    int cpus[1];
+    for (int i = 0; i < oskar_numa_num_nodes(); ++i)
+    {
+        if (oskar_numa_node_cpus(i, 1, cpus) == 0) continue;
+        node = -1;
+        thread = oskar_thread_create_on_node(get_thread_node,
+                (void*)&node, 0, i);
+        oskar_thread_join(thread);
+        oskar_thread_free(thread);
+        EXPECT_EQ(i, node);
+    }
+}
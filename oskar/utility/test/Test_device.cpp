@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mem/oskar_mem.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_thread.h"
+
+#include <cstdio>
+
+TEST(device, kernel_handle)
+{
+    const oskar_DeviceKernel* k1 = 0;
+    const oskar_DeviceKernel* k2 = 0;
+    const oskar_DeviceKernel* k3 = 0;
+
+    // Look up the same kernel from several threads at once.
+#pragma omp parallel for
+    for (int i = 0; i < 64; ++i)
+    {
+        const oskar_DeviceKernel* k = oskar_device_kernel("acorr_float");
+#pragma omp critical
+        {
+            if (!k1) k1 = k;
+            EXPECT_EQ(k1, k);
+        }
+    }
+    k2 = oskar_device_kernel("acorr_float");
+    k3 = oskar_device_kernel("acorr_double");
+    ASSERT_TRUE(k1 != 0);
+    EXPECT_EQ(k1, k2);
+    EXPECT_NE(k1, k3);
+    EXPECT_TRUE(oskar_device_kernel(0) == 0);
+
+    // A cached handle can be shared between threads.
+    static const oskar_DeviceKernel* cache = 0;
+#pragma omp parallel for
+    for (int i = 0; i < 64; ++i)
+    {
+        const oskar_DeviceKernel* k = oskar_device_kernel_cached(&cache,
+                "acorr_float");
+#pragma omp critical
+        EXPECT_EQ(k1, k);
+    }
+    EXPECT_EQ(k1, cache);
+
+    // Handles must remain valid after a device reset.
+    oskar_device_reset_all();
+    EXPECT_EQ(k1, oskar_device_kernel("acorr_float"));
+
+    // Launching a kernel at the wrong location must fail cleanly.
+    int status = 0;
+    size_t local_size[] = {1, 1, 1}, global_size[] = {1, 1, 1};
+    oskar_device_launch_kernel_handle(k1, OSKAR_CPU, 1,
+            local_size, global_size, 0, 0, 0, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_BAD_LOCATION, status);
+    status = 0;
+    oskar_device_launch_kernel_handle(0, OSKAR_CPU, 1,
+            local_size, global_size, 0, 0, 0, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_FUNCTION_NOT_AVAILABLE, status);
+}
+
+TEST(device, mem_info)
+{
+    size_t mem_free = 0, mem_total = 0, max_alloc = 0;
+    oskar_device_mem_info(OSKAR_CPU, 0, &mem_free, &mem_total, &max_alloc);
+    ASSERT_GT(mem_total, (size_t)0);
+    EXPECT_GT(mem_free, (size_t)0);
+    EXPECT_LE(mem_free, mem_total);
+    EXPECT_LE(max_alloc, mem_total);
+}
+
+#ifdef OSKAR_HAVE_OPENCL
+struct LaunchArgs
+{
+    int location, index, status, num_wrong;
+};
+
+static void* launch_many(void* arg)
+{
+    // Add arrays holding values unique to this thread, many times over.
+    // If kernel arguments were shared between threads, some launches
+    // would use the arrays of another thread.
+    LaunchArgs* a = (LaunchArgs*) arg;
+    const int n = 1000;
+    oskar_device_set(a->location, 0, &a->status);
+    oskar_Mem* in1 = oskar_mem_create(OSKAR_SINGLE, a->location, n,
+            &a->status);
+    oskar_Mem* in2 = oskar_mem_create(OSKAR_SINGLE, a->location, n,
+            &a->status);
+    oskar_Mem* out = oskar_mem_create(OSKAR_SINGLE, a->location, n,
+            &a->status);
+    oskar_mem_set_value_real(in1, a->index, 0, n, &a->status);
+    oskar_mem_set_value_real(in2, 2 * a->index, 0, n, &a->status);
+    for (int i = 0; i < 500; ++i)
+        oskar_mem_add(out, in1, in2, 0, 0, 0, n, &a->status);
+    oskar_Mem* out_cpu = oskar_mem_create_copy(out, OSKAR_CPU, &a->status);
+    const float* p = oskar_mem_float_const(out_cpu, &a->status);
+    for (int i = 0; !a->status && i < n; ++i)
+        if (p[i] != 3.0f * a->index) a->num_wrong++;
+    oskar_mem_free(in1, &a->status);
+    oskar_mem_free(in2, &a->status);
+    oskar_mem_free(out, &a->status);
+    oskar_mem_free(out_cpu, &a->status);
+    return 0;
+}
+
+TEST(device, kernel_launch_threads_opencl)
+{
+    int location = 0;
+    oskar_device_set_require_double_precision(0);
+    if (oskar_device_count("OpenCL", &location) < 1)
+    {
+        printf("No OpenCL devices found: skipping test.\n");
+        return;
+    }
+    const int num_threads = 8;
+    LaunchArgs args[num_threads];
+    oskar_Thread* threads[num_threads];
+    for (int i = 0; i < num_threads; ++i)
+    {
+        args[i].location = location;
+        args[i].index = i + 1;
+        args[i].status = 0;
+        args[i].num_wrong = 0;
+        threads[i] = oskar_thread_create(launch_many, &args[i], 0);
+    }
+    for (int i = 0; i < num_threads; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+        EXPECT_EQ(0, args[i].status);
+        EXPECT_EQ(0, args[i].num_wrong);
+    }
+}
+#endif
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mem/oskar_mem.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_trace.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+TEST(trace, write_chrome_trace)
+{
+    int status = 0;
+    const char* filename = "temp_test_trace.json";
+    oskar_trace_set_file(filename);
+    ASSERT_TRUE(oskar_trace_enabled());
+
+    // Record an event directly, and one from a memory copy.
+    const double start = oskar_trace_time();
+    oskar_trace_add("io", "test_event", start, -1, "bytes", 1234);
+    oskar_Mem* a = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 100, &status);
+    oskar_Mem* b = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 100, &status);
+    oskar_mem_clear_contents(a, &status);
+    oskar_mem_copy_contents(b, a, 0, 0, 100, &status);
+    oskar_mem_free(a, &status);
+    oskar_mem_free(b, &status);
+    ASSERT_EQ(0, status);
+
+    // Write the trace and check its contents.
+    oskar_trace_write(&status);
+    ASSERT_EQ(0, status);
+    oskar_trace_set_file(0);
+    EXPECT_FALSE(oskar_trace_enabled());
+    EXPECT_EQ(0.0, oskar_trace_time());
+    std::string json;
+    FILE* f = fopen(filename, "r");
+    ASSERT_TRUE(f != 0);
+    char buffer[4096];
+    size_t n = 0;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        json.append(buffer, n);
+    fclose(f);
+    remove(filename);
+    EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"test_event\""));
+    EXPECT_NE(std::string::npos, json.find("\"cat\":\"io\""));
+    EXPECT_NE(std::string::npos, json.find("\"bytes\":1234"));
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"copy_host\""));
+    EXPECT_NE(std::string::npos, json.find("\"bytes\":800"));
+}
+
+#ifdef OSKAR_HAVE_OPENCL
+TEST(trace, opencl_events)
+{
+    // Record more OpenCL copies than are kept pending at once,
+    // and check they are all written with their device times.
+    int status = 0, location = 0;
+    oskar_device_set_require_double_precision(0);
+    if (oskar_device_count("OpenCL", &location) < 1)
+    {
+        printf("No OpenCL devices found: skipping test.\n");
+        return;
+    }
+    oskar_device_set(location, 0, &status);
+    const char* filename = "temp_test_trace_cl.json";
+    oskar_trace_set_file(filename);
+    const int num_copies = 5000;
+    oskar_Mem* a = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU, 100, &status);
+    oskar_mem_clear_contents(a, &status);
+    oskar_Mem* b = oskar_mem_create(OSKAR_SINGLE, location, 100, &status);
+    for (int i = 0; i < num_copies; ++i)
+    {
+        struct _cl_event* event = 0;
+        oskar_mem_copy_contents_async(b, a, 0, 0, 100, 0, 0, &event,
+                &status);
+        oskar_device_events_release(1, &event);
+    }
+    oskar_mem_free(a, &status);
+    oskar_mem_free(b, &status);
+    ASSERT_EQ(0, status);
+    oskar_trace_write(&status);
+    ASSERT_EQ(0, status);
+    oskar_trace_set_file(0);
+    std::string json;
+    FILE* f = fopen(filename, "r");
+    ASSERT_TRUE(f != 0);
+    char buffer[4096];
+    size_t n = 0;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        json.append(buffer, n);
+    fclose(f);
+    remove(filename);
+    int num_found = 0;
+    for (size_t i = json.find("\"name\":\"copy_to_device\"");
+            i != std::string::npos;
+            i = json.find("\"name\":\"copy_to_device\"", i + 1))
+    {
+        const size_t j = json.find("\"dur\":", i);
+        ASSERT_NE(std::string::npos, j);
+        EXPECT_GE(atof(json.c_str() + j + 6), 0.0);
+        num_found++;
+    }
+    EXPECT_EQ(num_copies, num_found);
+}
+#endif
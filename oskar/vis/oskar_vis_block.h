@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2020, The OSKAR Developers.
+ * Copyright (c) 2015-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -49,6 +49,7 @@ enum OSKAR_VIS_BLOCK_TAGS
 #include <vis/oskar_vis_block_create_from_header.h>
 #include <vis/oskar_vis_block_free.h>
 #include <vis/oskar_vis_block_read.h>
+#include <vis/oskar_vis_block_reorder_ms.h>
 #include <vis/oskar_vis_block_resize.h>
 #include <vis/oskar_vis_block_station_to_baseline_coords.h>
 #include <vis/oskar_vis_block_write.h>
@@ -44,6 +44,11 @@ extern "C" {
 /**
  * @brief Add a random Gaussian noise component to the visibilities.
  *
+ * @details
+ * The noise is generated in parallel, using all available processor cores.
+ * This is equivalent to calling oskar_vis_block_add_system_noise_threads()
+ * with \p num_threads set to 0.
+ *
  * @param[in,out] vis             Visibility structure to which to add noise.
  * @param[in]     telescope       Telescope model in use.
  * @param[in]     block_index     Simulation time index for the block.
@@ -55,6 +60,28 @@ void oskar_vis_block_add_system_noise(oskar_VisBlock* vis,
         const oskar_VisHeader* header, const oskar_Telescope* telescope,
         unsigned int block_index, oskar_Mem* station_work, int* status);
 
+/**
+ * @brief Add a random Gaussian noise component to the visibilities.
+ *
+ * @details
+ * The noise is generated in parallel, using the given number of threads
+ * (or all available processor cores, if \p num_threads is less than 1).
+ * Each visibility uses its own random number generator counter, so the
+ * result does not depend on the number of threads.
+ *
+ * @param[in,out] vis             Visibility structure to which to add noise.
+ * @param[in]     telescope       Telescope model in use.
+ * @param[in]     block_index     Simulation time index for the block.
+ * @param[in]     num_threads     Number of threads to use.
+ * @param[in,out] station_work    Work buffer of length num_stations.
+ * @param[in,out] status          Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_block_add_system_noise_threads(oskar_VisBlock* vis,
+        const oskar_VisHeader* header, const oskar_Telescope* telescope,
+        unsigned int block_index, int num_threads, oskar_Mem* station_work,
+        int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,6 +49,11 @@ extern "C" {
  * This function fills an empty visibility structure by
  * reading data using the specified file handle.
  *
+ * If the file was opened in mode 'm' (memory-mapped) and the block is in
+ * CPU memory, the visibility amplitudes are used in place without being
+ * copied, where possible. In that case, the block must not be used after
+ * the file handle has been freed.
+ *
  * @param[in,out] vis         The visibility block structure to fill.
  * @param[in,out] hdr         The visibility header.
  * @param[in,out] h           The OSKAR binary file handle, opened for read.
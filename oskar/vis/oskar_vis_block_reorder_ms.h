@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_VIS_BLOCK_REORDER_MS_H_
+#define OSKAR_VIS_BLOCK_REORDER_MS_H_
+
+/**
+ * @file oskar_vis_block_reorder_ms.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+#include <vis/oskar_vis_block.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Reorders a visibility block into Measurement Set row order.
+ *
+ * @details
+ * Copies the visibility amplitudes and baseline coordinates in the block
+ * into the supplied output arrays, in the order required by
+ * oskar_vis_block_write_ms_reordered().
+ *
+ * Autocorrelations (if present) are interleaved with the cross-correlations,
+ * so that each station's autocorrelation row precedes the rows of the
+ * baselines it forms with all higher-numbered stations.
+ * Scalar visibilities are expanded to 4 polarisations if
+ * \p num_pols_out is 4, with zeros in the cross-hand terms.
+ *
+ * The output visibility array has dimension order
+ * (time, channel, row, polarisation), where the number of rows is the
+ * number of baselines plus the number of stations if autocorrelations
+ * are present. The output coordinate arrays have dimension order
+ * (time, row), and are zero for autocorrelation rows.
+ *
+ * The output arrays must be in CPU memory. They are resized only if they
+ * are too small, so they can be reused for subsequent blocks.
+ * The visibility array must be of complex type, and all arrays must have
+ * the same precision as the block.
+ *
+ * The time and channel dimensions are processed in parallel.
+ * If \p num_threads is less than 1, the number of available processor
+ * cores is used.
+ *
+ * @param[in] blk          Pointer to visibility block to reorder.
+ * @param[in] num_pols_out Number of output polarisations (1 or 4).
+ * @param[in] num_threads  Number of threads to use.
+ * @param[in,out] vis      Output visibility amplitudes.
+ * @param[in,out] uu       Output baseline uu-coordinates, in metres.
+ * @param[in,out] vv       Output baseline vv-coordinates, in metres.
+ * @param[in,out] ww       Output baseline ww-coordinates, in metres.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_block_reorder_ms(const oskar_VisBlock* blk, int num_pols_out,
+        int num_threads, oskar_Mem* vis, oskar_Mem* uu, oskar_Mem* vv,
+        oskar_Mem* ww, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -37,6 +37,7 @@
 #include <vis/oskar_vis_block.h>
 #include <vis/oskar_vis_header.h>
 #include <ms/oskar_measurement_set.h>
+#include <mem/oskar_mem.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -57,6 +58,33 @@ OSKAR_APPS_EXPORT
 void oskar_vis_block_write_ms(const oskar_VisBlock* blk,
         const oskar_VisHeader* hdr, oskar_MeasurementSet* ms, int* status);
 
+/**
+ * @brief Writes a reordered visibility data block to a CASA Measurement Set.
+ *
+ * @details
+ * This function writes a visibility data block to a CASA Measurement Set,
+ * using data that have already been put into Measurement Set row order
+ * by oskar_vis_block_reorder_ms().
+ *
+ * The block itself supplies only the dimensions and start indices.
+ * This allows the reordering to be done ahead of time, outside the thread
+ * that writes the data, using buffers that persist between blocks.
+ *
+ * @param[in] blk          Pointer to visibility block to write.
+ * @param[in] hdr          Pointer to visibility header.
+ * @param[in,out] ms       Handle to a Measurement Set open for write.
+ * @param[in] vis          Reordered visibility amplitudes.
+ * @param[in] uu           Reordered baseline uu-coordinates, in metres.
+ * @param[in] vv           Reordered baseline vv-coordinates, in metres.
+ * @param[in] ww           Reordered baseline ww-coordinates, in metres.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_APPS_EXPORT
+void oskar_vis_block_write_ms_reordered(const oskar_VisBlock* blk,
+        const oskar_VisHeader* hdr, oskar_MeasurementSet* ms,
+        const oskar_Mem* vis, const oskar_Mem* uu, const oskar_Mem* vv,
+        const oskar_Mem* ww, int* status);
+
 #ifdef __cplusplus
 }
 #endif
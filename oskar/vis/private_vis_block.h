@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2020, The OSKAR Developers.
+ * Copyright (c) 2015-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -47,6 +47,10 @@ struct oskar_VisBlock
     oskar_Mem* cross_correlations; /* Cross-correlation visibility amplitudes. */
     oskar_Mem* auto_correlations;  /* Autocorrelation visibility amplitudes. */
 
+    /* True if the amplitude arrays alias data in a memory-mapped file. */
+    int cross_correlations_mapped;
+    int auto_correlations_mapped;
+
     /* Baseline coordinate arrays have sizes num_baselines * num_times. */
     /* [real] */
     oskar_Mem* baseline_uvw_metres[3]; /* Baseline coordinates, in metres. */
@@ -61,4 +65,16 @@ struct oskar_VisBlock
 typedef struct oskar_VisBlock oskar_VisBlock;
 #endif /* OSKAR_VIS_BLOCK_TYPEDEF_ */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Replaces any amplitude arrays that alias a memory-mapped file
+ * with copies that own their memory. */
+void oskar_vis_block_unmap(oskar_VisBlock* vis, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* include guard */
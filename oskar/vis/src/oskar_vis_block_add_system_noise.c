@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2020, The OSKAR Developers.
+ * Copyright (c) 2015-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -7,6 +7,7 @@
 #include "vis/oskar_vis_block.h"
 #include "math/oskar_random_gaussian.h"
 #include "math/oskar_find_closest_match.h"
+#include "utility/oskar_get_num_procs.h"
 #include <math.h>
 
 #ifdef __cplusplus
@@ -35,15 +36,78 @@ static void oskar_get_station_std_dev_for_channel(oskar_Mem* station_std_dev,
     }
 }
 
+/*
+ * Random numbers are generated using the counter-based Philox generator,
+ * so each visibility has its own counter value, which depends only on its
+ * position in the block. The counters match those of a serial loop over
+ * times, then baselines, then stations, so the noise is the same whatever
+ * the number of threads used.
+ */
+
+#define CROSS_SCALAR(FP2) {\
+        const int a1 = j % num_stations, t = j / num_stations;\
+        const int b0 = a1 * (2 * num_stations - a1 - 1) / 2;\
+        unsigned int c = t * num_per_time + b0;\
+        FP2* data = (FP2*) xcorr_ptr +\
+                num_baselines * (num_channels * t + channel_idx) + b0;\
+        for (a2 = a1 + 1; a2 < num_stations; ++a2, ++data) {\
+            double rnd[2];\
+            oskar_random_gaussian2(seed, c++, block_idx, rnd);\
+            const double std = sqrt(st_std[a1] * st_std[a2]) * inv_sqrt2;\
+            data->x += std * rnd[0];\
+            data->y += std * rnd[1];\
+        }\
+    }
+
+#define CROSS_MATRIX(FP4c) {\
+        const int a1 = j % num_stations, t = j / num_stations;\
+        const int b0 = a1 * (2 * num_stations - a1 - 1) / 2;\
+        unsigned int c = t * num_per_time + 2 * b0;\
+        FP4c* data = (FP4c*) xcorr_ptr +\
+                num_baselines * (num_channels * t + channel_idx) + b0;\
+        for (a2 = a1 + 1; a2 < num_stations; ++a2, ++data) {\
+            double rnd[8];\
+            oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);\
+            oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd + 4);\
+            const double std = sqrt(st_std[a1] * st_std[a2]);\
+            data->a.x += std * rnd[0];\
+            data->a.y += std * rnd[1];\
+            data->b.x += std * rnd[2];\
+            data->b.y += std * rnd[3];\
+            data->c.x += std * rnd[4];\
+            data->c.y += std * rnd[5];\
+            data->d.x += std * rnd[6];\
+            data->d.y += std * rnd[7];\
+        }\
+    }
+
+#define AUTO_MATRIX(FP4c) {\
+        const int a1 = j % num_stations, t = j / num_stations;\
+        const unsigned int c = t * num_per_time + 2 * (num_cross + a1);\
+        FP4c* data = (FP4c*) acorr_ptr +\
+                num_stations * (num_channels * t + channel_idx) + a1;\
+        double rnd[8];\
+        oskar_random_gaussian4(seed, c, block_idx, 0, 0, rnd);\
+        oskar_random_gaussian4(seed, c + 1, block_idx, 0, 0, rnd + 4);\
+        const double std = st_std[a1] * sqrt(2.0);\
+        const double mean = std * sefd_factor;\
+        data->a.x += std * rnd[0] + mean;\
+        data->b.x += std * rnd[1];\
+        data->b.y += std * rnd[2];\
+        data->c.x += std * rnd[3];\
+        data->c.y += std * rnd[4];\
+        data->d.x += std * rnd[5] + mean;\
+    }
+
 /* Applies noise to data in a visibility block, for the given channel. */
 static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
         const oskar_Mem* station_std_dev, unsigned int seed,
         unsigned int block_idx, unsigned int channel_idx,
-        double channel_bandwidth_hz, double time_int_sec, int* status)
+        double channel_bandwidth_hz, double time_int_sec, int num_threads,
+        int* status)
 {
-    int a1, a2, block_start, b, c = 0, t;
+    int a2, j;
     void *acorr_ptr, *xcorr_ptr;
-    double rnd[8];
     const double inv_sqrt2 = 1.0 / sqrt(2.0);
 
     /* Get pointer to start of block, and block dimensions. */
@@ -55,6 +119,14 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
     const int num_channels   = oskar_vis_block_num_channels(vis);
     const int num_stations   = oskar_vis_block_num_stations(vis);
     const int num_times      = oskar_vis_block_num_times(vis);
+    const int num_loop       = num_times * num_stations;
+    const int type = oskar_mem_type(oskar_vis_block_cross_correlations(vis));
+
+    /* Get the number of counter values used per time sample. */
+    const int num_cross = have_crosscorr ? num_baselines : 0;
+    const int num_auto  = have_autocorr ? num_stations : 0;
+    const unsigned int num_per_time = (num_cross + num_auto) *
+            (oskar_mem_is_matrix(oskar_vis_block_cross_correlations(vis)) ? 2 : 1);
 
     /* Get factor for conversion of sigma to SEFD. */
     const double sefd_factor = sqrt(2.0*channel_bandwidth_hz * time_int_sec);
@@ -66,195 +138,95 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
      * falls out naturally when evaluating Stokes I from the dipole
      * correlations (i.e. I = 0.5 (XX+YY) ). */
 
-    switch (oskar_mem_type(oskar_vis_block_cross_correlations(vis)))
+    /* Autocorrelation noise: phases are all zero after autocorrelation,
+     * so the imaginary components are ignored. */
+    switch (type)
     {
     case OSKAR_SINGLE_COMPLEX:
     {
-        const float* st_std;
-        float2* data;
-        st_std = oskar_mem_float_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
+        const float* st_std = oskar_mem_float_const(station_std_dev, status);
+        if (have_crosscorr)
         {
-            if (have_crosscorr)
-            {
-                /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (float2*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                    {
-                        oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                        const double std = sqrt(st_std[a1] * st_std[a2]) * inv_sqrt2;
-                        data[b].x += std * rnd[0];
-                        data[b].y += std * rnd[1];
-                    }
-                }
-            }
-
-            if (have_autocorr)
+#pragma omp parallel for private(j, a2) num_threads(num_threads)
+            for (j = 0; j < num_loop; ++j)
+                CROSS_SCALAR(float2)
+        }
+        if (have_autocorr)
+        {
+#pragma omp parallel for private(j) num_threads(num_threads)
+            for (j = 0; j < num_loop; ++j)
             {
-                /* Autocorrelation noise. Phases are all zero after
-                 * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (float2*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                    const double std = st_std[a1];
-                    const double mean = sqrt(2.0)*st_std[a1];
-                    data[a1].x += std * rnd[0] + mean * sefd_factor;
-                }
+                const int a1 = j % num_stations, t = j / num_stations;
+                const unsigned int c = t * num_per_time + num_cross + a1;
+                float2* data = (float2*) acorr_ptr +
+                        num_stations * (num_channels * t + channel_idx) + a1;
+                double rnd[2];
+                oskar_random_gaussian2(seed, c, block_idx, rnd);
+                const double std = st_std[a1];
+                const double mean = sqrt(2.0)*st_std[a1];
+                data->x += std * rnd[0] + mean * sefd_factor;
             }
         }
         break;
     }
     case OSKAR_SINGLE_COMPLEX_MATRIX:
     {
-        const float* st_std;
-        float4c* data;
-        st_std = oskar_mem_float_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
+        const float* st_std = oskar_mem_float_const(station_std_dev, status);
+        if (have_crosscorr)
         {
-            if (have_crosscorr)
-            {
-                /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (float4c*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                    {
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd + 4);
-                        const double std = sqrt(st_std[a1] * st_std[a2]);
-                        data[b].a.x += std * rnd[0];
-                        data[b].a.y += std * rnd[1];
-                        data[b].b.x += std * rnd[2];
-                        data[b].b.y += std * rnd[3];
-                        data[b].c.x += std * rnd[4];
-                        data[b].c.y += std * rnd[5];
-                        data[b].d.x += std * rnd[6];
-                        data[b].d.y += std * rnd[7];
-                    }
-                }
-            }
-
-            if (have_autocorr)
-            {
-                /* Autocorrelation noise. Phases are all zero after
-                 * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (float4c*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd + 4);
-                    const double std = st_std[a1] * sqrt(2.0);
-                    const double mean = std * sefd_factor;
-                    data[a1].a.x += std * rnd[0] + mean;
-                    data[a1].b.x += std * rnd[1];
-                    data[a1].b.y += std * rnd[2];
-                    data[a1].c.x += std * rnd[3];
-                    data[a1].c.y += std * rnd[4];
-                    data[a1].d.x += std * rnd[5] + mean;
-                }
-            }
+#pragma omp parallel for private(j, a2) num_threads(num_threads)
+            for (j = 0; j < num_loop; ++j)
+                CROSS_MATRIX(float4c)
+        }
+        if (have_autocorr)
+        {
+#pragma omp parallel for private(j) num_threads(num_threads)
+            for (j = 0; j < num_loop; ++j)
+                AUTO_MATRIX(float4c)
         }
         break;
     }
     case OSKAR_DOUBLE_COMPLEX:
     {
-        const double* st_std;
-        double2* data;
-        st_std = oskar_mem_double_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
+        const double* st_std = oskar_mem_double_const(station_std_dev, status);
+        if (have_crosscorr)
         {
-            if (have_crosscorr)
-            {
-                /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (double2*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                    {
-                        oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                        const double std = sqrt(st_std[a1] * st_std[a2]) * inv_sqrt2;
-                        data[b].x += std * rnd[0];
-                        data[b].y += std * rnd[1];
-                    }
-                }
-            }
-
-            if (have_autocorr)
+#pragma omp parallel for private(j, a2) num_threads(num_threads)
+            for (j = 0; j < num_loop; ++j)
+                CROSS_SCALAR(double2)
+        }
+        if (have_autocorr)
+        {
+#pragma omp parallel for private(j) num_threads(num_threads)
+            for (j = 0; j < num_loop; ++j)
             {
-                /* Autocorrelation noise. Phases are all zero after
-                 * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (double2*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                    const double std  = st_std[a1];
-                    const double mean = st_std[a1] * sefd_factor * sqrt(2.0);
-                    data[a1].x += std * rnd[0] + mean;
-                }
+                const int a1 = j % num_stations, t = j / num_stations;
+                const unsigned int c = t * num_per_time + num_cross + a1;
+                double2* data = (double2*) acorr_ptr +
+                        num_stations * (num_channels * t + channel_idx) + a1;
+                double rnd[2];
+                oskar_random_gaussian2(seed, c, block_idx, rnd);
+                const double std  = st_std[a1];
+                const double mean = st_std[a1] * sefd_factor * sqrt(2.0);
+                data->x += std * rnd[0] + mean;
             }
         }
         break;
     }
     case OSKAR_DOUBLE_COMPLEX_MATRIX:
     {
-        const double* st_std;
-        double4c* data;
-        st_std = oskar_mem_double_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
+        const double* st_std = oskar_mem_double_const(station_std_dev, status);
+        if (have_crosscorr)
         {
-            if (have_crosscorr)
-            {
-                /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (double4c*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                    {
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd + 4);
-                        const double std = sqrt(st_std[a1] * st_std[a2]);
-                        data[b].a.x += std * rnd[0];
-                        data[b].a.y += std * rnd[1];
-                        data[b].b.x += std * rnd[2];
-                        data[b].b.y += std * rnd[3];
-                        data[b].c.x += std * rnd[4];
-                        data[b].c.y += std * rnd[5];
-                        data[b].d.x += std * rnd[6];
-                        data[b].d.y += std * rnd[7];
-                    }
-                }
-            }
-
-            if (have_autocorr)
-            {
-                /* Autocorrelation noise. Phases are all zero after
-                 * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (double4c*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd+4);
-                    const double std  = st_std[a1]*sqrt(2.0);
-                    const double mean = std * sefd_factor;
-                    data[a1].a.x += std * rnd[0] + mean;
-                    data[a1].b.x += std * rnd[1];
-                    data[a1].b.y += std * rnd[2];
-                    data[a1].c.x += std * rnd[3];
-                    data[a1].c.y += std * rnd[4];
-                    data[a1].d.x += std * rnd[5] + mean;
-                }
-            }
+#pragma omp parallel for private(j, a2) num_threads(num_threads)
+            for (j = 0; j < num_loop; ++j)
+                CROSS_MATRIX(double4c)
+        }
+        if (have_autocorr)
+        {
+#pragma omp parallel for private(j) num_threads(num_threads)
+            for (j = 0; j < num_loop; ++j)
+                AUTO_MATRIX(double4c)
         }
         break;
     }
@@ -264,6 +236,15 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
 void oskar_vis_block_add_system_noise(oskar_VisBlock* vis,
         const oskar_VisHeader* header, const oskar_Telescope* telescope,
         unsigned int block_index, oskar_Mem* station_work, int* status)
+{
+    oskar_vis_block_add_system_noise_threads(vis, header, telescope,
+            block_index, 0, station_work, status);
+}
+
+void oskar_vis_block_add_system_noise_threads(oskar_VisBlock* vis,
+        const oskar_VisHeader* header, const oskar_Telescope* telescope,
+        unsigned int block_index, int num_threads, oskar_Mem* station_work,
+        int* status)
 {
     int c, num_channels, start_channel;
     unsigned int seed;
@@ -289,6 +270,7 @@ void oskar_vis_block_add_system_noise(oskar_VisBlock* vis,
     freq_inc_hz          = oskar_vis_header_freq_inc_hz(header);
 
     /* Apply noise to each channel. */
+    if (num_threads < 1) num_threads = oskar_get_num_procs();
     for (c = 0; c < num_channels; ++c)
     {
         const int channel_index = c + start_channel;
@@ -296,7 +278,8 @@ void oskar_vis_block_add_system_noise(oskar_VisBlock* vis,
         oskar_get_station_std_dev_for_channel(station_work, freq_hz,
                 telescope, status);
         oskar_vis_block_apply_noise(vis, station_work, seed,
-                block_index, c, channel_bandwidth_hz, time_int_sec, status);
+                block_index, c, channel_bandwidth_hz, time_int_sec,
+                num_threads, status);
     }
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2020, The OSKAR Developers.
+ * Copyright (c) 2015-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -23,6 +23,7 @@ void oskar_vis_block_copy(oskar_VisBlock* dst, const oskar_VisBlock* src,
     dst->has_cross_correlations = src->has_cross_correlations;
 
     /* Copy the memory. */
+    oskar_vis_block_unmap(dst, status);
     for (i = 0; i < 3; ++i)
     {
         if (oskar_mem_length(src->baseline_uvw_metres[i]) > 0)
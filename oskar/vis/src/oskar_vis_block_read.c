@@ -13,6 +13,57 @@
 extern "C" {
 #endif
 
+static void read_amplitudes(oskar_Binary* h, oskar_Mem** amp, int* mapped,
+        int tag, int block_index, int* status)
+{
+    oskar_Mem* alias = 0;
+    if (*status) return;
+
+    /* Use the data in place if the file is memory-mapped. */
+    if (oskar_mem_location(*amp) == OSKAR_CPU)
+        alias = oskar_binary_map_mem(h, oskar_mem_type(*amp),
+                OSKAR_TAG_GROUP_VIS_BLOCK, tag, block_index, status);
+    if (alias)
+    {
+        oskar_mem_free(*amp, status);
+        *amp = alias;
+        *mapped = 1;
+        return;
+    }
+
+    /* Otherwise, read the data into owned memory. */
+    if (*mapped)
+    {
+        oskar_Mem* temp = oskar_mem_create(oskar_mem_type(*amp),
+                oskar_mem_location(*amp), 0, status);
+        oskar_mem_free(*amp, status);
+        *amp = temp;
+        *mapped = 0;
+    }
+    oskar_binary_read_mem(h, *amp, OSKAR_TAG_GROUP_VIS_BLOCK, tag,
+            block_index, status);
+}
+
+void oskar_vis_block_unmap(oskar_VisBlock* vis, int* status)
+{
+    if (vis->cross_correlations_mapped)
+    {
+        oskar_Mem* temp = oskar_mem_create_copy(vis->cross_correlations,
+                OSKAR_CPU, status);
+        oskar_mem_free(vis->cross_correlations, status);
+        vis->cross_correlations = temp;
+        vis->cross_correlations_mapped = 0;
+    }
+    if (vis->auto_correlations_mapped)
+    {
+        oskar_Mem* temp = oskar_mem_create_copy(vis->auto_correlations,
+                OSKAR_CPU, status);
+        oskar_mem_free(vis->auto_correlations, status);
+        vis->auto_correlations = temp;
+        vis->auto_correlations_mapped = 0;
+    }
+}
+
 void oskar_vis_block_read(oskar_VisBlock* vis, const oskar_VisHeader* hdr,
         oskar_Binary* h, int block_index, int* status)
 {
@@ -33,8 +84,8 @@ void oskar_vis_block_read(oskar_VisBlock* vis, const oskar_VisHeader* hdr,
     /* Read the auto-correlation data. */
     if (oskar_vis_header_write_auto_correlations(hdr))
     {
-        oskar_binary_read_mem(h, vis->auto_correlations,
-                OSKAR_TAG_GROUP_VIS_BLOCK,
+        read_amplitudes(h, &vis->auto_correlations,
+                &vis->auto_correlations_mapped,
                 OSKAR_VIS_BLOCK_TAG_AUTO_CORRELATIONS, block_index, status);
     }
 
@@ -42,8 +93,8 @@ void oskar_vis_block_read(oskar_VisBlock* vis, const oskar_VisHeader* hdr,
     if (oskar_vis_header_write_cross_correlations(hdr))
     {
         int tag_error = 0;
-        oskar_binary_read_mem(h, vis->cross_correlations,
-                OSKAR_TAG_GROUP_VIS_BLOCK,
+        read_amplitudes(h, &vis->cross_correlations,
+                &vis->cross_correlations_mapped,
                 OSKAR_VIS_BLOCK_TAG_CROSS_CORRELATIONS, block_index, status);
 
         /*
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2015-2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "vis/oskar_vis_block_reorder_ms.h"
+#include "utility/oskar_get_num_procs.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Local helper macros. */
+
+#define REORDER_COORDS(FP) {\
+    int a1, a2, b = 0;\
+    size_t j = (size_t)num_rows * t;\
+    const size_t i0 = (size_t)num_baseln_in * t;\
+    for (a1 = 0; a1 < num_stations; ++a1) {\
+        if (have_auto) {\
+            ((FP*)uu_out)[j] = ((FP*)vv_out)[j] = ((FP*)ww_out)[j] = 0;\
+            ++j;\
+        }\
+        if (have_cross) {\
+            for (a2 = a1 + 1; a2 < num_stations; ++a2, ++b, ++j) {\
+                if (have_coords) {\
+                    ((FP*)uu_out)[j] = ((const FP*)uu_in)[i0 + b];\
+                    ((FP*)vv_out)[j] = ((const FP*)vv_in)[i0 + b];\
+                    ((FP*)ww_out)[j] = ((const FP*)ww_in)[i0 + b];\
+                }\
+                else {\
+                    ((FP*)uu_out)[j] = ((FP*)vv_out)[j] = 0;\
+                    ((FP*)ww_out)[j] = 0;\
+                }\
+            }\
+        }\
+    }\
+}
+
+#define REORDER_VIS(FP2, FP4c) {\
+    int a1, a2, b = 0;\
+    size_t j = 0;\
+    const size_t ia = (size_t)num_stations * s;\
+    const size_t ix = (size_t)num_baseln_in * s;\
+    if (num_pols_in == 4) COPY_VIS(FP4c)\
+    else if (num_pols_out == 1) COPY_VIS(FP2)\
+    else {\
+        FP2 zero;\
+        FP2* out_ = (FP2*)out + 4 * (size_t)num_rows * s;\
+        zero.x = zero.y = 0;\
+        for (a1 = 0; a1 < num_stations; ++a1) {\
+            if (have_auto) COPY_SCALAR(FP2, acorr, ia + a1)\
+            if (have_cross)\
+                for (a2 = a1 + 1; a2 < num_stations; ++a2, ++b)\
+                    COPY_SCALAR(FP2, xcorr, ix + b)\
+        }\
+    }\
+}
+
+#define COPY_VIS(T) {\
+        T* out_ = (T*)out + (size_t)num_rows * s;\
+        for (a1 = 0; a1 < num_stations; ++a1) {\
+            if (have_auto) out_[j++] = ((const T*)acorr)[ia + a1];\
+            if (have_cross)\
+                for (a2 = a1 + 1; a2 < num_stations; ++a2, ++b)\
+                    out_[j++] = ((const T*)xcorr)[ix + b];\
+        }\
+    }\
+
+#define COPY_SCALAR(FP2, DATA, IDX) {\
+                const FP2 val = ((const FP2*)DATA)[IDX];\
+                out_[j + 0] = val;  out_[j + 1] = zero;\
+                out_[j + 2] = zero; out_[j + 3] = val;\
+                j += 4;\
+            }\
+
+static void reorder_ms_f(int num_threads, int num_times, int num_channels,
+        int num_stations, int num_baseln_in, int num_rows, int num_pols_in,
+        int num_pols_out, int have_auto, int have_cross, int have_coords,
+        const void* acorr, const void* xcorr, const void* uu_in,
+        const void* vv_in, const void* ww_in, void* out,
+        void* uu_out, void* vv_out, void* ww_out)
+{
+    int s, t;
+    const int num_slices = num_times * num_channels;
+#pragma omp parallel for private(s) num_threads(num_threads)
+    for (s = 0; s < num_slices; ++s)
+        REORDER_VIS(float2, float4c)
+#pragma omp parallel for private(t) num_threads(num_threads)
+    for (t = 0; t < num_times; ++t)
+        REORDER_COORDS(float)
+}
+
+static void reorder_ms_d(int num_threads, int num_times, int num_channels,
+        int num_stations, int num_baseln_in, int num_rows, int num_pols_in,
+        int num_pols_out, int have_auto, int have_cross, int have_coords,
+        const void* acorr, const void* xcorr, const void* uu_in,
+        const void* vv_in, const void* ww_in, void* out,
+        void* uu_out, void* vv_out, void* ww_out)
+{
+    int s, t;
+    const int num_slices = num_times * num_channels;
+#pragma omp parallel for private(s) num_threads(num_threads)
+    for (s = 0; s < num_slices; ++s)
+        REORDER_VIS(double2, double4c)
+#pragma omp parallel for private(t) num_threads(num_threads)
+    for (t = 0; t < num_times; ++t)
+        REORDER_COORDS(double)
+}
+
+void oskar_vis_block_reorder_ms(const oskar_VisBlock* blk, int num_pols_out,
+        int num_threads, oskar_Mem* vis, oskar_Mem* uu, oskar_Mem* vv,
+        oskar_Mem* ww, int* status)
+{
+    const oskar_Mem *in_acorr, *in_xcorr, *in_uu, *in_vv, *in_ww;
+    if (*status) return;
+
+    /* Get dimensions. */
+    const int num_pols_in   = oskar_vis_block_num_pols(blk);
+    const int num_stations  = oskar_vis_block_num_stations(blk);
+    const int num_baseln_in = oskar_vis_block_num_baselines(blk);
+    const int num_channels  = oskar_vis_block_num_channels(blk);
+    const int num_times     = oskar_vis_block_num_times(blk);
+    const int have_auto     = oskar_vis_block_has_auto_correlations(blk);
+    const int have_cross    = oskar_vis_block_has_cross_correlations(blk);
+    in_acorr = oskar_vis_block_auto_correlations_const(blk);
+    in_xcorr = oskar_vis_block_cross_correlations_const(blk);
+    in_uu    = oskar_vis_block_baseline_uu_metres_const(blk);
+    in_vv    = oskar_vis_block_baseline_vv_metres_const(blk);
+    in_ww    = oskar_vis_block_baseline_ww_metres_const(blk);
+    const int prec = oskar_mem_precision(in_xcorr);
+    if (!have_auto && !have_cross) return;
+
+    /* Check polarisation dimension consistency:
+     * num_pols_in can be less than num_pols_out, but not vice-versa. */
+    if (num_pols_in > num_pols_out ||
+            (num_pols_out != 1 && num_pols_out != 4))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Check data types and locations. */
+    if (oskar_mem_type(vis) != (prec | OSKAR_COMPLEX) ||
+            oskar_mem_type(uu) != prec || oskar_mem_type(vv) != prec ||
+            oskar_mem_type(ww) != prec)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (oskar_vis_block_location(blk) != OSKAR_CPU ||
+            oskar_mem_location(vis) != OSKAR_CPU ||
+            oskar_mem_location(uu) != OSKAR_CPU ||
+            oskar_mem_location(vv) != OSKAR_CPU ||
+            oskar_mem_location(ww) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Resize the output arrays if required. */
+    const int num_rows = num_baseln_in + (have_auto ? num_stations : 0);
+    const size_t num_coords = (size_t)num_rows * num_times;
+    oskar_mem_ensure(vis, num_coords * num_channels * num_pols_out, status);
+    oskar_mem_ensure(uu, num_coords, status);
+    oskar_mem_ensure(vv, num_coords, status);
+    oskar_mem_ensure(ww, num_coords, status);
+    if (*status) return;
+
+    /* Baseline coordinates are only present if they have been set. */
+    const int have_coords = have_cross &&
+            oskar_mem_length(in_uu) >= (size_t)num_baseln_in * num_times &&
+            oskar_mem_length(in_vv) >= (size_t)num_baseln_in * num_times &&
+            oskar_mem_length(in_ww) >= (size_t)num_baseln_in * num_times;
+
+    /* Reorder the data. */
+    if (num_threads < 1) num_threads = oskar_get_num_procs();
+    if (prec == OSKAR_DOUBLE)
+        reorder_ms_d(num_threads, num_times, num_channels, num_stations,
+                num_baseln_in, num_rows, num_pols_in, num_pols_out,
+                have_auto, have_cross, have_coords,
+                oskar_mem_void_const(in_acorr), oskar_mem_void_const(in_xcorr),
+                oskar_mem_void_const(in_uu), oskar_mem_void_const(in_vv),
+                oskar_mem_void_const(in_ww), oskar_mem_void(vis),
+                oskar_mem_void(uu), oskar_mem_void(vv), oskar_mem_void(ww));
+    else if (prec == OSKAR_SINGLE)
+        reorder_ms_f(num_threads, num_times, num_channels, num_stations,
+                num_baseln_in, num_rows, num_pols_in, num_pols_out,
+                have_auto, have_cross, have_coords,
+                oskar_mem_void_const(in_acorr), oskar_mem_void_const(in_xcorr),
+                oskar_mem_void_const(in_uu), oskar_mem_void_const(in_vv),
+                oskar_mem_void_const(in_ww), oskar_mem_void(vis),
+                oskar_mem_void(uu), oskar_mem_void(vv), oskar_mem_void(ww));
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+#ifdef __cplusplus
+}
+#endif
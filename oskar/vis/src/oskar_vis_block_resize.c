@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2020, The OSKAR Developers.
+ * Copyright (c) 2016-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -28,6 +28,7 @@ void oskar_vis_block_resize(oskar_VisBlock* vis, int num_times,
         num_autocorr = num_channels * num_times * num_stations;
 
     /* Resize arrays as required. */
+    oskar_vis_block_unmap(vis, status);
     for (i = 0; i < 3; ++i)
     {
         if (oskar_mem_length(vis->baseline_uvw_metres[i]) > 0)
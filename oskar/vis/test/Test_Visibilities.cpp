@@ -5,6 +5,7 @@
 
 #include <gtest/gtest.h>
 
+#include "mem/oskar_binary_read_mem.h"
 #include "vis/oskar_vis_header.h"
 #include "vis/oskar_vis_block.h"
 #include "utility/oskar_get_error_string.h"
@@ -116,10 +117,12 @@ TEST(Visibilities, read_write)
         oskar_binary_free(h);
     }
 
-    // Read visibilities.
+    // Read visibilities, using both stream and memory-mapped reads.
+    for (int mapped = 0; mapped < 2; ++mapped)
     {
         // Read the header.
-        oskar_Binary* h = oskar_binary_create(filename, 'r', &status);
+        oskar_Binary* h = oskar_binary_create(filename,
+                mapped ? 'm' : 'r', &status);
         oskar_VisHeader* hdr = oskar_vis_header_read(h, &status);
         ASSERT_EQ(0, status) << oskar_get_error_string(status);
         ASSERT_EQ(amp_type, oskar_vis_header_amp_type(hdr));
@@ -190,3 +193,109 @@ TEST(Visibilities, read_write)
     // Delete temporary file.
     remove(filename);
 }
+
+TEST(Visibilities, read_mapped)
+{
+    int status = 0;
+    const int num_stations = 8, num_channels = 3, num_times = 5;
+    const int max_times_per_block = 2, num_blocks = 3;
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    const char* filename = "temp_test_vis_mapped.dat";
+
+    // Write single-precision visibilities with autocorrelations.
+    {
+        oskar_VisHeader* hdr = oskar_vis_header_create(
+                OSKAR_SINGLE_COMPLEX, OSKAR_SINGLE, max_times_per_block,
+                num_times, num_channels, num_channels, num_stations,
+                1, 1, &status);
+        oskar_Binary* h = oskar_vis_header_write(hdr, filename, &status);
+        oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+                OSKAR_CPU, hdr, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        oskar_Mem* xc = oskar_vis_block_cross_correlations(blk);
+        oskar_Mem* ac = oskar_vis_block_auto_correlations(blk);
+        for (int dim = 0; dim < 3; ++dim)
+        {
+            oskar_Mem* uvw = oskar_vis_block_station_uvw_metres(blk, dim);
+            oskar_mem_realloc(uvw, num_stations * max_times_per_block,
+                    &status);
+            oskar_mem_clear_contents(uvw, &status);
+        }
+        for (int i_block = 0; i_block < num_blocks; ++i_block)
+        {
+            float2* xc_ = oskar_mem_float2(xc, &status);
+            float2* ac_ = oskar_mem_float2(ac, &status);
+            for (size_t i = 0; i < oskar_mem_length(xc); ++i)
+            {
+                xc_[i].x = (float) i;
+                xc_[i].y = (float) i_block;
+            }
+            for (size_t i = 0; i < oskar_mem_length(ac); ++i)
+            {
+                ac_[i].x = (float) i_block;
+                ac_[i].y = -(float) i;
+            }
+            oskar_vis_block_write(blk, h, i_block, &status);
+        }
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        oskar_vis_header_free(hdr, &status);
+        oskar_vis_block_free(blk, &status);
+        oskar_binary_free(h);
+    }
+
+    // Read the blocks back in place, and check the data.
+    oskar_Binary* h = oskar_binary_create(filename, 'm', &status);
+    oskar_VisHeader* hdr = oskar_vis_header_read(h, &status);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    for (int i_block = num_blocks - 1; i_block >= 0; --i_block)
+    {
+        oskar_vis_block_read(blk, hdr, h, i_block, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const oskar_Mem* xc = oskar_vis_block_cross_correlations_const(blk);
+        const oskar_Mem* ac = oskar_vis_block_auto_correlations_const(blk);
+        ASSERT_EQ((size_t) (num_baselines * num_channels *
+                max_times_per_block), oskar_mem_length(xc));
+        const float2* xc_ = oskar_mem_float2_const(xc, &status);
+        const float2* ac_ = oskar_mem_float2_const(ac, &status);
+        for (size_t i = 0; i < oskar_mem_length(xc); ++i)
+        {
+            ASSERT_FLOAT_EQ((float) i, xc_[i].x);
+            ASSERT_FLOAT_EQ((float) i_block, xc_[i].y);
+        }
+        for (size_t i = 0; i < oskar_mem_length(ac); ++i)
+        {
+            ASSERT_FLOAT_EQ((float) i_block, ac_[i].x);
+            ASSERT_FLOAT_EQ(-(float) i, ac_[i].y);
+        }
+    }
+
+    // If the payload can be used in place, check the block is using it.
+    oskar_Mem* alias = oskar_binary_map_mem(h, OSKAR_SINGLE_COMPLEX,
+            OSKAR_TAG_GROUP_VIS_BLOCK, OSKAR_VIS_BLOCK_TAG_CROSS_CORRELATIONS,
+            0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    if (alias)
+    {
+        EXPECT_EQ(oskar_mem_void_const(alias), oskar_mem_void_const(
+                oskar_vis_block_cross_correlations_const(blk)));
+        oskar_mem_free(alias, &status);
+    }
+
+    // Check the data can be modified, and the block resized.
+    oskar_mem_scale_real(oskar_vis_block_cross_correlations(blk), 2.0,
+            0, num_baselines, &status);
+    oskar_vis_block_resize(blk, 1, num_channels, num_stations, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const float2* xc_ = oskar_mem_float2_const(
+            oskar_vis_block_cross_correlations_const(blk), &status);
+    for (int i = 0; i < num_baselines * num_channels; ++i)
+        ASSERT_FLOAT_EQ((float) (i < num_baselines ? 2 * i : i), xc_[i].x);
+
+    // Clean up.
+    oskar_vis_header_free(hdr, &status);
+    oskar_vis_block_free(blk, &status);
+    oskar_binary_free(h);
+    remove(filename);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/oskar_telescope.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstring>
+
+static void add_noise(int precision, int matrix, int num_threads_a,
+        int num_threads_b)
+{
+    int status = 0;
+    const int num_stations = 9, num_times = 5, num_channels = 3;
+    const int amp_type = precision | OSKAR_COMPLEX |
+            (matrix ? OSKAR_MATRIX : 0);
+    const double freq_start_hz = 100e6, freq_inc_hz = 1e6;
+
+    // Create a telescope model with noise enabled.
+    oskar_Telescope* tel = oskar_telescope_create(precision, OSKAR_CPU,
+            num_stations, &status);
+    oskar_telescope_set_enable_noise(tel, 1, 42);
+    oskar_telescope_set_noise_freq(tel, freq_start_hz, freq_inc_hz,
+            num_channels, &status);
+    oskar_telescope_set_noise_rms(tel, 1.0, 2.0, &status);
+
+    // Create the header and two blocks, both cleared.
+    oskar_VisHeader* hdr = oskar_vis_header_create(amp_type, precision,
+            num_times, num_times, num_channels, num_channels, num_stations,
+            1, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, freq_start_hz);
+    oskar_vis_header_set_freq_inc_hz(hdr, freq_inc_hz);
+    oskar_vis_header_set_channel_bandwidth_hz(hdr, 10e3);
+    oskar_vis_header_set_time_average_sec(hdr, 1.0);
+    oskar_VisBlock* blk[2];
+    oskar_Mem* work = oskar_mem_create(precision, OSKAR_CPU, 0, &status);
+    for (int i = 0; i < 2; ++i)
+    {
+        blk[i] = oskar_vis_block_create_from_header(OSKAR_CPU, hdr, &status);
+        oskar_vis_block_clear(blk[i], &status);
+    }
+
+    // Add noise to each block using a different number of threads.
+    oskar_vis_block_add_system_noise_threads(blk[0], hdr, tel, 3,
+            num_threads_a, work, &status);
+    oskar_vis_block_add_system_noise_threads(blk[1], hdr, tel, 3,
+            num_threads_b, work, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the noise was added, and is identical in both blocks.
+    const oskar_Mem* data[][2] = {
+            {oskar_vis_block_cross_correlations_const(blk[0]),
+                    oskar_vis_block_cross_correlations_const(blk[1])},
+            {oskar_vis_block_auto_correlations_const(blk[0]),
+                    oskar_vis_block_auto_correlations_const(blk[1])}
+    };
+    for (int i = 0; i < 2; ++i)
+    {
+        const size_t bytes = oskar_mem_length(data[i][0]) *
+                oskar_mem_element_size(oskar_mem_type(data[i][0]));
+        ASSERT_GT(bytes, 0u);
+        ASSERT_EQ(bytes, oskar_mem_length(data[i][1]) *
+                oskar_mem_element_size(oskar_mem_type(data[i][1])));
+        const void* a = oskar_mem_void_const(data[i][0]);
+        EXPECT_NE(0.0, precision == OSKAR_DOUBLE ?
+                ((const double*) a)[0] : ((const float*) a)[0]);
+        EXPECT_EQ(0, memcmp(a, oskar_mem_void_const(data[i][1]), bytes));
+    }
+
+    for (int i = 0; i < 2; ++i)
+        oskar_vis_block_free(blk[i], &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_mem_free(work, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(vis_block_add_system_noise, threads_single_scalar)
+{
+    add_noise(OSKAR_SINGLE, 0, 1, 4);
+}
+
+TEST(vis_block_add_system_noise, threads_single_matrix)
+{
+    add_noise(OSKAR_SINGLE, 1, 1, 4);
+}
+
+TEST(vis_block_add_system_noise, threads_double_scalar)
+{
+    add_noise(OSKAR_DOUBLE, 0, 1, 4);
+}
+
+TEST(vis_block_add_system_noise, threads_double_matrix)
+{
+    add_noise(OSKAR_DOUBLE, 1, 1, 4);
+}
+
+TEST(vis_block_add_system_noise, threads_all_cores)
+{
+    add_noise(OSKAR_DOUBLE, 1, 1, 0);
+}
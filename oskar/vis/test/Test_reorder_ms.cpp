@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "vis/oskar_vis_block.h"
+#include "utility/oskar_get_error_string.h"
+
+static void fill_block(oskar_VisBlock* blk, int* status)
+{
+    oskar_Mem* xc = oskar_vis_block_cross_correlations(blk);
+    oskar_Mem* ac = oskar_vis_block_auto_correlations(blk);
+    double* xc_ = (double*) oskar_mem_void(xc);
+    double* ac_ = (double*) oskar_mem_void(ac);
+    const size_t num_xc = 2 * oskar_mem_length(xc) *
+            (oskar_mem_is_matrix(xc) ? 4 : 1);
+    const size_t num_ac = 2 * oskar_mem_length(ac) *
+            (oskar_mem_is_matrix(ac) ? 4 : 1);
+    for (size_t i = 0; i < num_xc; ++i) xc_[i] = (double) i;
+    for (size_t i = 0; i < num_ac; ++i) ac_[i] = -(double) i;
+    for (int dim = 0; dim < 3; ++dim)
+    {
+        oskar_Mem* uvw = oskar_vis_block_baseline_uvw_metres(blk, dim);
+        oskar_mem_realloc(uvw, oskar_vis_block_num_times(blk) *
+                oskar_vis_block_num_baselines(blk), status);
+        double* uvw_ = oskar_mem_double(uvw, status);
+        for (size_t i = 0; i < oskar_mem_length(uvw); ++i)
+            uvw_[i] = (double) (i + 1) * (dim + 1);
+    }
+}
+
+TEST(vis_block_reorder_ms, scalar_to_4pol_with_autos)
+{
+    int status = 0;
+    const int num_stations = 6, num_channels = 3, num_times = 4;
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    const int num_rows = num_baselines + num_stations;
+    oskar_VisBlock* blk = oskar_vis_block_create(OSKAR_CPU,
+            OSKAR_DOUBLE_COMPLEX, num_times, num_channels, num_stations,
+            1, 1, &status);
+    fill_block(blk, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Reorder the block.
+    oskar_Mem* vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, 0,
+            &status);
+    oskar_Mem* uvw[3];
+    for (int dim = 0; dim < 3; ++dim)
+        uvw[dim] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_vis_block_reorder_ms(blk, 4, 2, vis, uvw[0], uvw[1], uvw[2],
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_GE(oskar_mem_length(vis),
+            (size_t) (num_times * num_channels * num_rows * 4));
+
+    // Check the contents.
+    const double2* xc = oskar_mem_double2_const(
+            oskar_vis_block_cross_correlations_const(blk), &status);
+    const double2* ac = oskar_mem_double2_const(
+            oskar_vis_block_auto_correlations_const(blk), &status);
+    const double2* out = oskar_mem_double2_const(vis, &status);
+    for (int t = 0; t < num_times; ++t)
+    {
+        for (int c = 0; c < num_channels; ++c)
+        {
+            const int s = t * num_channels + c;
+            for (int a1 = 0, b = 0, row = 0; a1 < num_stations; ++a1)
+            {
+                const double2* o = &out[4 * (num_rows * s + row++)];
+                const double2 a = ac[num_stations * s + a1];
+                EXPECT_DOUBLE_EQ(a.x, o[0].x);
+                EXPECT_DOUBLE_EQ(a.y, o[3].y);
+                EXPECT_DOUBLE_EQ(0.0, o[1].x);
+                EXPECT_DOUBLE_EQ(0.0, o[2].y);
+                for (int a2 = a1 + 1; a2 < num_stations; ++a2, ++b)
+                {
+                    o = &out[4 * (num_rows * s + row++)];
+                    const double2 x = xc[num_baselines * s + b];
+                    EXPECT_DOUBLE_EQ(x.x, o[0].x);
+                    EXPECT_DOUBLE_EQ(x.y, o[0].y);
+                    EXPECT_DOUBLE_EQ(x.x, o[3].x);
+                    EXPECT_DOUBLE_EQ(x.y, o[3].y);
+                    EXPECT_DOUBLE_EQ(0.0, o[1].y);
+                    EXPECT_DOUBLE_EQ(0.0, o[2].x);
+                }
+            }
+        }
+        const double* uu_in = oskar_mem_double_const(
+                oskar_vis_block_baseline_uu_metres_const(blk), &status);
+        const double* ww_out = oskar_mem_double_const(uvw[2], &status);
+        const double* uu_out = oskar_mem_double_const(uvw[0], &status);
+        for (int a1 = 0, b = 0, row = 0; a1 < num_stations; ++a1)
+        {
+            EXPECT_DOUBLE_EQ(0.0, ww_out[num_rows * t + row++]);
+            for (int a2 = a1 + 1; a2 < num_stations; ++a2, ++b)
+                EXPECT_DOUBLE_EQ(uu_in[num_baselines * t + b],
+                        uu_out[num_rows * t + row++]);
+        }
+    }
+
+    // Check that a second call reuses the output arrays.
+    const void* ptr = oskar_mem_void_const(vis);
+    oskar_vis_block_reorder_ms(blk, 4, 0, vis, uvw[0], uvw[1], uvw[2],
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(ptr, oskar_mem_void_const(vis));
+
+    // Check that polarised data cannot be reordered to one polarisation.
+    oskar_VisBlock* blk_pol = oskar_vis_block_create(OSKAR_CPU,
+            OSKAR_DOUBLE_COMPLEX_MATRIX, num_times, num_channels,
+            num_stations, 1, 0, &status);
+    oskar_vis_block_reorder_ms(blk_pol, 1, 0, vis, uvw[0], uvw[1], uvw[2],
+            &status);
+    EXPECT_EQ((int) OSKAR_ERR_DIMENSION_MISMATCH, status);
+    status = 0;
+
+    // Clean up.
+    oskar_vis_block_free(blk_pol, &status);
+    oskar_vis_block_free(blk, &status);
+    oskar_mem_free(vis, &status);
+    for (int dim = 0; dim < 3; ++dim)
+        oskar_mem_free(uvw[dim], &status);
+}
+
+TEST(vis_block_reorder_ms, matrix_cross_only)
+{
+    int status = 0;
+    const int num_stations = 5, num_channels = 2, num_times = 3;
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    oskar_VisBlock* blk = oskar_vis_block_create(OSKAR_CPU,
+            OSKAR_DOUBLE_COMPLEX_MATRIX, num_times, num_channels,
+            num_stations, 1, 0, &status);
+    fill_block(blk, &status);
+    oskar_Mem* vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, 0,
+            &status);
+    oskar_Mem* uvw[3];
+    for (int dim = 0; dim < 3; ++dim)
+        uvw[dim] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_vis_block_reorder_ms(blk, 4, 0, vis, uvw[0], uvw[1], uvw[2],
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // With no autocorrelations, the order is unchanged.
+    const size_t num = 8 * num_baselines * num_channels * num_times;
+    const double* in = (const double*) oskar_mem_void_const(
+            oskar_vis_block_cross_correlations_const(blk));
+    const double* out = (const double*) oskar_mem_void_const(vis);
+    for (size_t i = 0; i < num; ++i)
+        ASSERT_DOUBLE_EQ(in[i], out[i]);
+
+    // Clean up.
+    oskar_vis_block_free(blk, &status);
+    oskar_mem_free(vis, &status);
+    for (int dim = 0; dim < 3; ++dim)
+        oskar_mem_free(uvw[dim], &status);
+}
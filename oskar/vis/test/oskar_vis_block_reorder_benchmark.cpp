@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "vis/oskar_vis_block.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_vis_block_reorder_benchmark",
+            OSKAR_VERSION_STR);
+    opt.add_flag("-nst", "Number of stations.", 1, "", true);
+    opt.add_flag("-nc", "Number of channels per block.", 1, "", true);
+    opt.add_flag("-nt", "Number of times per block.", 1, "", true);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-s", "Use scalar visibilities (default: matrix/polarised).");
+    opt.add_flag("-a", "Include autocorrelations.");
+    opt.add_flag("-nthreads", "Number of threads (default: all cores).",
+            1, "0", false);
+    opt.add_flag("-n", "Number of iterations", 1, "1", false);
+    opt.add_flag("-v", "Display verbose output.", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0;
+    const int num_stations = opt.get_int("-nst");
+    const int num_channels = opt.get_int("-nc");
+    const int num_times = opt.get_int("-nt");
+    const int prec = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    const int num_threads = opt.get_int("-nthreads");
+    const int niter = opt.get_int("-n");
+    int amp_type = prec | OSKAR_COMPLEX;
+    if (!opt.is_set("-s"))
+        amp_type |= OSKAR_MATRIX;
+
+    // Create a block and the reusable output buffers.
+    oskar_VisBlock* blk = oskar_vis_block_create(OSKAR_CPU, amp_type,
+            num_times, num_channels, num_stations, 1, opt.is_set("-a"),
+            &status);
+    oskar_Mem* vis = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU, 0,
+            &status);
+    oskar_Mem *uvw[3];
+    for (int i = 0; i < 3; ++i)
+        uvw[i] = oskar_mem_create(prec, OSKAR_CPU, 0, &status);
+    oskar_mem_random_range(oskar_vis_block_cross_correlations(blk),
+            -1.0, 1.0, &status);
+
+    // Run benchmark.
+    std::vector<double> times(niter);
+    double time_taken_sec = 0.0;
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    for (int i = 0; i < niter; ++i)
+    {
+        oskar_timer_start(timer);
+        oskar_vis_block_reorder_ms(blk, 4, num_threads,
+                vis, uvw[0], uvw[1], uvw[2], &status);
+        times[i] = oskar_timer_elapsed(timer);
+        time_taken_sec += times[i];
+    }
+
+    // Check for errors.
+    if (status)
+    {
+        fprintf(stderr, "ERROR: reorder failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+
+    // Print average time per block.
+    if (opt.is_set("-v"))
+    {
+        printf("- Number of stations: %i\n", num_stations);
+        printf("- Block dimensions: %i times, %i channels\n",
+                num_times, num_channels);
+        printf("- Precision: %s\n", (prec == OSKAR_SINGLE) ?
+                "single" : "double");
+        printf("- Visibility type: %s\n", (opt.is_set("-s")) ?
+                "scalar" : "matrix");
+        printf("- Output size: %.1f MB\n", oskar_mem_length(vis) *
+                oskar_mem_element_size(prec | OSKAR_COMPLEX) / 1e6);
+        printf("==> Total time taken: %f seconds.\n", time_taken_sec);
+        printf("==> Writer thread time per block: %f seconds.\n",
+                time_taken_sec / niter);
+    }
+    else
+    {
+        printf("%f\n", time_taken_sec / niter);
+    }
+
+    // Free memory.
+    oskar_timer_free(timer);
+    oskar_vis_block_free(blk, &status);
+    oskar_mem_free(vis, &status);
+    for (int i = 0; i < 3; ++i)
+        oskar_mem_free(uvw[i], &status);
+    return EXIT_SUCCESS;
+}
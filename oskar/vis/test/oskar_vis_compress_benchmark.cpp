@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "binary/oskar_binary.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_vis_compress_benchmark",
+            OSKAR_VERSION_STR);
+    opt.add_flag("-nst", "Number of stations.", 1, "", true);
+    opt.add_flag("-nc", "Number of channels per block.", 1, "", true);
+    opt.add_flag("-nt", "Number of times per block.", 1, "", true);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-r", "Use random data (default: smooth, noise-free data).");
+    opt.add_flag("-nthreads", "Number of threads (default: all cores).",
+            1, "0", false);
+    opt.add_flag("-n", "Number of blocks", 1, "1", false);
+    opt.add_flag("-v", "Display verbose output.", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0;
+    const char* filename = "temp_vis_compress_benchmark.dat";
+    const int num_stations = opt.get_int("-nst");
+    const int num_channels = opt.get_int("-nc");
+    const int num_times = opt.get_int("-nt");
+    const int prec = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    const int num_threads = opt.get_int("-nthreads");
+    const int niter = opt.get_int("-n");
+    const int type = prec | OSKAR_COMPLEX | OSKAR_MATRIX;
+    const size_t num_baselines = num_stations * (num_stations - 1) / 2;
+    const size_t num_vis = num_baselines * num_channels * num_times;
+
+    // Create a block of visibility amplitudes.
+    oskar_Mem* vis = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    if (opt.is_set("-r"))
+        oskar_mem_random_range(vis, -1.0, 1.0, &status);
+    else
+    {
+        // Smooth data: slowly varying phases on the diagonal terms.
+        for (size_t i = 0; i < 4 * num_vis; ++i)
+        {
+            const double phase = 1e-3 * (double) (i / 4 % num_baselines);
+            const int diag = (i % 4 == 0 || i % 4 == 3);
+            if (prec == OSKAR_DOUBLE)
+            {
+                double* t = (double*) oskar_mem_void(vis);
+                t[2 * i]     = diag ? cos(phase) : 0.0;
+                t[2 * i + 1] = diag ? sin(phase) : 0.0;
+            }
+            else
+            {
+                float* t = (float*) oskar_mem_void(vis);
+                t[2 * i]     = diag ? (float) cos(phase) : 0.0f;
+                t[2 * i + 1] = diag ? (float) sin(phase) : 0.0f;
+            }
+        }
+    }
+    const size_t bytes = oskar_mem_length(vis) * oskar_mem_element_size(type);
+
+    // Write the blocks, with and without compression.
+    double time_write[2] = {0.0, 0.0}, time_read[2] = {0.0, 0.0};
+    long file_size[2] = {0, 0};
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    for (int compress = 0; compress < 2; ++compress)
+    {
+        oskar_Binary* h = oskar_binary_create(filename, 'w', &status);
+        if (compress)
+            oskar_binary_set_compression(h,
+                    OSKAR_BINARY_COMPRESSION_SHUFFLE_LZ, num_threads, &status);
+        oskar_timer_start(timer);
+        for (int i = 0; i < niter; ++i)
+            oskar_binary_write_mem(h, vis, 1, 1, i, 0, &status);
+        oskar_binary_free(h);
+        time_write[compress] = oskar_timer_elapsed(timer);
+        FILE* stream = fopen(filename, "rb");
+        if (stream)
+        {
+            fseek(stream, 0, SEEK_END);
+            file_size[compress] = ftell(stream);
+            fclose(stream);
+        }
+
+        // Read the blocks back.
+        h = oskar_binary_create(filename, 'r', &status);
+        oskar_timer_start(timer);
+        for (int i = 0; i < niter; ++i)
+            oskar_binary_read_mem(h, vis, 1, 1, i, &status);
+        time_read[compress] = oskar_timer_elapsed(timer);
+        oskar_binary_free(h);
+    }
+    remove(filename);
+
+    // Check for errors.
+    if (status)
+    {
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+
+    // Print results.
+    const double total_mb = niter * bytes / 1e6;
+    if (opt.is_set("-v"))
+    {
+        printf("- Number of stations: %i\n", num_stations);
+        printf("- Block dimensions: %i times, %i channels\n",
+                num_times, num_channels);
+        printf("- Precision: %s\n", (prec == OSKAR_SINGLE) ?
+                "single" : "double");
+        printf("- Data: %s\n", opt.is_set("-r") ? "random" : "smooth");
+        printf("- Uncompressed size: %.1f MB\n", file_size[0] / 1e6);
+        printf("- Compressed size: %.1f MB\n", file_size[1] / 1e6);
+        printf("==> Compression ratio: %.2f\n",
+                (double) file_size[0] / file_size[1]);
+        printf("==> Write throughput: %.1f MB/s (uncompressed), "
+                "%.1f MB/s (compressed)\n",
+                total_mb / time_write[0], total_mb / time_write[1]);
+        printf("==> Read throughput: %.1f MB/s (uncompressed), "
+                "%.1f MB/s (compressed)\n",
+                total_mb / time_read[0], total_mb / time_read[1]);
+    }
+    else
+    {
+        printf("%f %f %f %f %f\n", (double) file_size[0] / file_size[1],
+                total_mb / time_write[0], total_mb / time_write[1],
+                total_mb / time_read[0], total_mb / time_read[1]);
+    }
+
+    // Free memory.
+    oskar_timer_free(timer);
+    oskar_mem_free(vis, &status);
+    return EXIT_SUCCESS;
+}
@@ -199,7 +199,8 @@ class Imager(object):
     @property
     def algorithm(self):
         """Returns or sets the algorithm used by the imager.
-        Currently one of 'FFT', 'DFT 2D', 'DFT 3D' or 'W-projection'.
+        Currently one of 'FFT', 'DFT 2D', 'DFT 3D', 'W-projection'
+        or 'W-stacking'.
 
         The default is 'FFT', which corresponds to basic but quick 2D gridding,
         ignoring baseline w-components.
@@ -219,6 +220,14 @@ class Imager(object):
         of image you are making, as an extra copy of the grid
         will be made by the FFT library.
 
+        'W-stacking' is an alternative to W-projection which grids the
+        visibilities into a number of W-layers using a small kernel, and
+        corrects each layer in the image domain after its FFT.
+        Layers are processed one at a time, so this may be a better choice
+        than W-projection for large images, where the W-kernels become
+        very large. The visibilities for each image plane are held in
+        memory until :meth:`finalise() <oskar.Imager.finalise>` is called.
+
         Type
             str
         """
@@ -229,6 +238,26 @@ class Imager(object):
     def algorithm(self, value):
         self.set_algorithm(value)
 
+    @property
+    def bda_max_cell_fraction(self):
+        """Returns or sets the uv cell fraction used for averaging baselines.
+
+        If greater than zero, consecutive visibilities on each baseline
+        are averaged in time before gridding, for as long as the baseline's
+        (u,v) coordinates stay within this fraction of a uv cell.
+        Only visibility blocks and OSKAR visibility files are averaged.
+        The default is 0, which disables averaging.
+
+        Type
+            float
+        """
+        self.capsule_ensure()
+        return _imager_lib.bda_max_cell_fraction(self._capsule)
+
+    @bda_max_cell_fraction.setter
+    def bda_max_cell_fraction(self, value):
+        self.set_bda_max_cell_fraction(value)
+
     @property
     def cellsize_arcsec(self):
         """Returns or sets the cell (pixel) size, in arcsec.
@@ -532,6 +561,27 @@ class Imager(object):
     def scale_norm_with_num_input_files(self, value):
         self.set_scale_norm_with_num_input_files(value)
 
+    @property
+    def single_precision_grids(self):
+        """Returns or sets the option to store grids in single precision.
+
+        If true, a double-precision imager using the FFT algorithm on the
+        host stores its grids in single precision, halving the memory they
+        need. Visibilities are still accumulated in double precision for
+        each tile of the grid before being added to the grids.
+
+        By default, this is false.
+
+        Type
+            boolean
+        """
+        self.capsule_ensure()
+        return _imager_lib.single_precision_grids(self._capsule)
+
+    @single_precision_grids.setter
+    def single_precision_grids(self, value):
+        self.set_single_precision_grids(value)
+
     @property
     def size(self):
         """Returns or sets the image side length in pixels.
@@ -612,6 +662,24 @@ class Imager(object):
     def uv_filter_min(self, value):
         self.set_uv_filter_min(value)
 
+    @property
+    def w_kernel_cache_dir(self):
+        """Returns or sets the directory used to cache W-projection kernels.
+
+        Kernels are saved in a file named according to the imaging
+        parameters, and are loaded from it by later runs using identical
+        parameters. If None or empty, kernels are not cached.
+
+        Type
+            str
+        """
+        self.capsule_ensure()
+        return _imager_lib.w_kernel_cache_dir(self._capsule)
+
+    @w_kernel_cache_dir.setter
+    def w_kernel_cache_dir(self, value):
+        self.set_w_kernel_cache_dir(value)
+
     @property
     def weighting(self):
         """Returns or sets the type of visibility weighting to use.
@@ -851,6 +919,15 @@ class Imager(object):
         self.capsule_ensure()
         _imager_lib.set_algorithm(self._capsule, algorithm_type)
 
+    def set_bda_max_cell_fraction(self, value):
+        """Sets the uv cell fraction for baseline-dependent averaging.
+
+        Args:
+            value (float): Maximum fraction of a uv cell, or 0 to disable.
+        """
+        self.capsule_ensure()
+        _imager_lib.set_bda_max_cell_fraction(self._capsule, value)
+
     def set_cellsize(self, cellsize_arcsec):
         """Sets the cell (pixel) size.
 
@@ -1058,6 +1135,15 @@ class Imager(object):
         self.capsule_ensure()
         _imager_lib.set_scale_norm_with_num_input_files(self._capsule, value)
 
+    def set_single_precision_grids(self, value):
+        """Sets the option to store grids in single precision.
+
+        Args:
+            value (boolean): Option value.
+        """
+        self.capsule_ensure()
+        _imager_lib.set_single_precision_grids(self._capsule, value)
+
     def set_size(self, size):
         """Sets image side length.
 
@@ -1133,6 +1219,15 @@ class Imager(object):
         self.capsule_ensure()
         _imager_lib.set_vis_phase_centre(self._capsule, ra_deg, dec_deg)
 
+    def set_w_kernel_cache_dir(self, dir_path):
+        """Sets the directory used to cache W-projection kernels.
+
+        Args:
+            dir_path (str): Path to cache directory.
+        """
+        self.capsule_ensure()
+        _imager_lib.set_w_kernel_cache_dir(self._capsule, dir_path)
+
     def set_weighting(self, weighting):
         """Sets the type of visibility weighting to use.
 
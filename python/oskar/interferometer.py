@@ -332,8 +332,11 @@ class Interferometer(object):
     def set_max_sources_per_chunk(self, value):
         """Sets the maximum number of sources processed concurrently on one GPU.
 
+        If zero, the chunk size is chosen automatically from the
+        available memory.
+
         Args:
-            value (int): Number of sources per chunk.
+            value (int): Number of sources per chunk, or 0 for automatic.
         """
         self.capsule_ensure()
         _interferometer_lib.set_max_sources_per_chunk(self._capsule, value)
@@ -341,8 +344,11 @@ class Interferometer(object):
     def set_max_times_per_block(self, value):
         """Sets the maximum number of times in a visibility block.
 
+        If zero, the block size is chosen automatically from the
+        available memory.
+
         Args:
-            value (int): Number of time samples per block.
+            value (int): Number of time samples per block, or 0 for automatic.
         """
         self.capsule_ensure()
         _interferometer_lib.set_max_times_per_block(self._capsule, value)
@@ -103,6 +103,16 @@ static PyObject* algorithm(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* bda_max_cell_fraction(PyObject* self, PyObject* args)
+{
+    oskar_Imager* h = 0;
+    PyObject* capsule = 0;
+    if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
+    if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    return Py_BuildValue("d", oskar_imager_bda_max_cell_fraction(h));
+}
+
+
 static PyObject* capsule_name(PyObject* self, PyObject* args)
 {
     PyObject *capsule = 0;
@@ -763,6 +773,18 @@ static PyObject* set_algorithm(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* set_bda_max_cell_fraction(PyObject* self, PyObject* args)
+{
+    oskar_Imager* h = 0;
+    PyObject* capsule = 0;
+    double value = 0.0;
+    if (!PyArg_ParseTuple(args, "Od", &capsule, &value)) return 0;
+    if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    oskar_imager_set_bda_max_cell_fraction(h, value);
+    return Py_BuildValue("");
+}
+
+
 static PyObject* set_cellsize(PyObject* self, PyObject* args)
 {
     oskar_Imager* h = 0;
@@ -1068,6 +1090,18 @@ static PyObject* set_scale_norm_with_num_input_files(PyObject* self,
 }
 
 
+static PyObject* set_single_precision_grids(PyObject* self, PyObject* args)
+{
+    oskar_Imager* h = 0;
+    PyObject* capsule = 0;
+    int value = 0;
+    if (!PyArg_ParseTuple(args, "Oi", &capsule, &value)) return 0;
+    if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    oskar_imager_set_single_precision_grids(h, value);
+    return Py_BuildValue("");
+}
+
+
 static PyObject* set_size(PyObject* self, PyObject* args)
 {
     oskar_Imager* h = 0;
@@ -1162,6 +1196,18 @@ static PyObject* set_vis_phase_centre(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* set_w_kernel_cache_dir(PyObject* self, PyObject* args)
+{
+    oskar_Imager* h = 0;
+    PyObject* capsule = 0;
+    const char* dir = 0;
+    if (!PyArg_ParseTuple(args, "Oz", &capsule, &dir)) return 0;
+    if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    oskar_imager_set_w_kernel_cache_dir(h, dir);
+    return Py_BuildValue("");
+}
+
+
 static PyObject* set_weighting(PyObject* self, PyObject* args)
 {
     oskar_Imager* h = 0;
@@ -1184,6 +1230,17 @@ static PyObject* set_weighting(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* single_precision_grids(PyObject* self, PyObject* args)
+{
+    oskar_Imager* h = 0;
+    PyObject* capsule = 0;
+    if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
+    if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    return Py_BuildValue("O",
+            oskar_imager_single_precision_grids(h) ? Py_True : Py_False);
+}
+
+
 static PyObject* size(PyObject* self, PyObject* args)
 {
     oskar_Imager* h = 0;
@@ -1603,6 +1660,16 @@ static PyObject* weighting(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* w_kernel_cache_dir(PyObject* self, PyObject* args)
+{
+    oskar_Imager* h = 0;
+    PyObject* capsule = 0;
+    if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
+    if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    return Py_BuildValue("s", oskar_imager_w_kernel_cache_dir(h));
+}
+
+
 static PyObject* make_image(PyObject* self, PyObject* args)
 {
     oskar_Imager* h;
@@ -1789,6 +1856,8 @@ fail:
 static PyMethodDef methods[] =
 {
         {"algorithm", (PyCFunction)algorithm, METH_VARARGS, "algorithm()"},
+        {"bda_max_cell_fraction", (PyCFunction)bda_max_cell_fraction,
+                METH_VARARGS, "bda_max_cell_fraction()"},
         {"capsule_name", (PyCFunction)capsule_name,
                 METH_VARARGS, "capsule_name()"},
         {"cellsize", (PyCFunction)cellsize, METH_VARARGS, "cellsize()"},
@@ -1836,6 +1905,8 @@ static PyMethodDef methods[] =
                 METH_VARARGS, "scale_norm_with_num_input_files()"},
         {"set_algorithm", (PyCFunction)set_algorithm,
                 METH_VARARGS, "set_algorithm(type)"},
+        {"set_bda_max_cell_fraction", (PyCFunction)set_bda_max_cell_fraction,
+                METH_VARARGS, "set_bda_max_cell_fraction(value)"},
         {"set_cellsize", (PyCFunction)set_cellsize,
                 METH_VARARGS, "set_cellsize(value)"},
         {"set_channel_snapshots", (PyCFunction)set_channel_snapshots,
@@ -1875,6 +1946,8 @@ static PyMethodDef methods[] =
         {"set_scale_norm_with_num_input_files",
                 (PyCFunction)set_scale_norm_with_num_input_files,
                 METH_VARARGS, "set_scale_norm_with_num_input_files(value)"},
+        {"set_single_precision_grids", (PyCFunction)set_single_precision_grids,
+                METH_VARARGS, "set_single_precision_grids(value)"},
         {"set_size", (PyCFunction)set_size, METH_VARARGS, "set_size(value)"},
         {"set_time_max_utc", (PyCFunction)set_time_max_utc,
                 METH_VARARGS, "set_time_max_utc(value)"},
@@ -1888,8 +1961,12 @@ static PyMethodDef methods[] =
                 "set_vis_frequency(ref_hz, inc_hz, num_channels)"},
         {"set_vis_phase_centre", (PyCFunction)set_vis_phase_centre,
                 METH_VARARGS, "set_vis_phase_centre(ra_deg, dec_deg)"},
+        {"set_w_kernel_cache_dir", (PyCFunction)set_w_kernel_cache_dir,
+                METH_VARARGS, "set_w_kernel_cache_dir(dir)"},
         {"set_weighting", (PyCFunction)set_weighting,
                 METH_VARARGS, "set_weighting(type)"},
+        {"single_precision_grids", (PyCFunction)single_precision_grids,
+                METH_VARARGS, "single_precision_grids()"},
         {"size", (PyCFunction)size, METH_VARARGS, "size()"},
         {"time_max_utc", (PyCFunction)time_max_utc,
                 METH_VARARGS, "time_max_utc()"},
@@ -1906,6 +1983,8 @@ static PyMethodDef methods[] =
                 METH_VARARGS, "uv_filter_max()"},
         {"uv_filter_min", (PyCFunction)uv_filter_min,
                 METH_VARARGS, "uv_filter_min()"},
+        {"w_kernel_cache_dir", (PyCFunction)w_kernel_cache_dir,
+                METH_VARARGS, "w_kernel_cache_dir()"},
         {"weighting", (PyCFunction)weighting, METH_VARARGS, "weighting()"},
         {NULL, NULL, 0, NULL}
 };